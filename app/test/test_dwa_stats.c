@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_dwa_stats.h>
+
+#include "test.h"
+
+#define DWA_STATS_NAME		"test_dwa_stats"
+#define TELEMETRY_BUF_SIZE	(16 * 1024)
+
+static struct rte_dwa_stats_shm shm;
+
+static void
+stats_fill(void)
+{
+	uint16_t i;
+
+	memset(&shm, 0, sizeof(shm));
+	rte_dwa_stats_write_begin(&shm);
+	shm.nb_ports = 2;
+	shm.nb_profiles = 1;
+	for (i = 0; i < shm.nb_ports; i++) {
+		shm.ports[i].port_id = i;
+		shm.ports[i].rx_pkts = 100 + i;
+		shm.ports[i].drops = 7;
+	}
+	shm.profiles[0].profile = 3;
+	shm.profiles[0].lookup_hits = 42;
+	rte_dwa_stats_write_end(&shm);
+}
+
+static int
+test_dwa_stats_register(void)
+{
+	char name[RTE_DWA_STATS_NAME_LEN + 1];
+
+	memset(name, 'a', sizeof(name) - 1);
+	name[sizeof(name) - 1] = '\0';
+	TEST_ASSERT_EQUAL(rte_dwa_stats_register(NULL, &shm), -EINVAL,
+		"Registered a block without name");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_register(DWA_STATS_NAME, NULL), -EINVAL,
+		"Registered a NULL block");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_register(name, &shm), -EINVAL,
+		"Registered a block with a too long name");
+
+	TEST_ASSERT_SUCCESS(rte_dwa_stats_register(DWA_STATS_NAME, &shm),
+		"Failed to register a block");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_register(DWA_STATS_NAME, &shm),
+		-EEXIST, "Registered a block twice");
+	TEST_ASSERT_SUCCESS(rte_dwa_stats_unregister(DWA_STATS_NAME),
+		"Failed to unregister a block");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_unregister(DWA_STATS_NAME), -ENOENT,
+		"Unregistered a block twice");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_unregister(NULL), -EINVAL,
+		"Unregistered a block without name");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_dwa_stats_read(void)
+{
+	struct rte_dwa_profile_stats profile;
+	struct rte_dwa_port_stats port;
+	uint32_t seq;
+
+	stats_fill();
+
+	TEST_ASSERT_SUCCESS(rte_dwa_stats_port_read(&shm, 1, &port),
+		"Failed to read a port");
+	TEST_ASSERT(port.port_id == 1 && port.rx_pkts == 101 &&
+		port.drops == 7, "Unexpected port counters");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_port_read(&shm, 2, &port), -EINVAL,
+		"Read a port beyond nb_ports");
+	TEST_ASSERT_SUCCESS(rte_dwa_stats_profile_read(&shm, 0, &profile),
+		"Failed to read a profile");
+	TEST_ASSERT(profile.profile == 3 && profile.lookup_hits == 42,
+		"Unexpected profile counters");
+	TEST_ASSERT_EQUAL(rte_dwa_stats_profile_read(&shm, 1, &profile),
+		-EINVAL, "Read a profile beyond nb_profiles");
+
+	/* a read overlapping an update is retried */
+	seq = rte_dwa_stats_read_begin(&shm);
+	TEST_ASSERT((seq & 1) == 0, "Odd sequence number after an update");
+	TEST_ASSERT(!rte_dwa_stats_read_retry(&shm, seq),
+		"Retry without update");
+	rte_dwa_stats_write_begin(&shm);
+	shm.ports[0].rx_pkts++;
+	rte_dwa_stats_write_end(&shm);
+	TEST_ASSERT(rte_dwa_stats_read_retry(&shm, seq),
+		"No retry after an update");
+
+	return TEST_SUCCESS;
+}
+
+/* send a telemetry request and read its response */
+static int
+telemetry_request(int sock, const char *req, char *buf)
+{
+	ssize_t bytes;
+
+	if (write(sock, req, strlen(req)) < 0)
+		return -1;
+	bytes = read(sock, buf, TELEMETRY_BUF_SIZE - 1);
+	if (bytes < 0)
+		return -1;
+	buf[bytes] = '\0';
+	printf("%s: %s\n", req, buf);
+
+	return 0;
+}
+
+/* the telemetry commands, which give up on a block stuck in an update */
+static int
+test_dwa_stats_telemetry(void)
+{
+	static char buf[TELEMETRY_BUF_SIZE];
+	struct sockaddr_un addr;
+	int sock, ret = TEST_FAILED;
+
+	sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (sock < 0)
+		return TEST_FAILED;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path),
+		"%s/dpdk_telemetry.v2", rte_eal_get_runtime_dir());
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(sock);
+		return TEST_SKIPPED;
+	}
+	/* welcome message */
+	if (read(sock, buf, sizeof(buf)) < 0)
+		goto close;
+
+	stats_fill();
+	if (rte_dwa_stats_register(DWA_STATS_NAME, &shm) != 0)
+		goto close;
+
+	if (telemetry_request(sock, "/dwa/stats/list", buf) != 0 ||
+			strstr(buf, "\"" DWA_STATS_NAME "\"") == NULL)
+		goto exit;
+	if (telemetry_request(sock, "/dwa/stats," DWA_STATS_NAME, buf) != 0 ||
+			strstr(buf, "\"port1\":{\"rx_pkts\":101") == NULL ||
+			strstr(buf, "\"profile0x3\":{\"lookup_hits\":42") ==
+			NULL)
+		goto exit;
+	if (telemetry_request(sock, "/dwa/stats,unknown", buf) != 0 ||
+			strcmp(buf, "{\"/dwa/stats\":null}") != 0)
+		goto exit;
+
+	/* writer stuck in an update */
+	rte_dwa_stats_write_begin(&shm);
+	if (telemetry_request(sock, "/dwa/stats," DWA_STATS_NAME, buf) != 0 ||
+			strcmp(buf, "{\"/dwa/stats\":null}") != 0)
+		goto exit;
+	rte_dwa_stats_write_end(&shm);
+
+	ret = TEST_SUCCESS;
+exit:
+	rte_dwa_stats_unregister(DWA_STATS_NAME);
+close:
+	close(sock);
+	return ret;
+}
+
+static struct unit_test_suite dwa_stats_tests = {
+	.suite_name = "dwa stats autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_dwa_stats_register),
+	TEST_CASE(test_dwa_stats_read),
+	TEST_CASE(test_dwa_stats_telemetry),
+	TEST_CASES_END()
+	}
+};
+
+static int
+test_dwa_stats(void)
+{
+	return unit_test_suite_runner(&dwa_stats_tests);
+}
+
+REGISTER_TEST_COMMAND(dwa_stats_autotest, test_dwa_stats);
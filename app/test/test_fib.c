@@ -9,7 +9,11 @@
 
 #include <rte_ip.h>
 #include <rte_log.h>
+#include <rte_errno.h>
 #include <rte_fib.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
 
 #include "test.h"
 
@@ -21,6 +25,12 @@ static int32_t test_free_null(void);
 static int32_t test_add_del_invalid(void);
 static int32_t test_get_invalid(void);
 static int32_t test_lookup(void);
+static int32_t test_tbl8_parent_nh(void);
+static int32_t test_rcu_qsbr_add(void);
+static int32_t test_rcu_churn(void);
+static int32_t test_build(void);
+static int32_t test_save_load(void);
+static int32_t test_save_load_tbl8s(void);
 
 #define MAX_ROUTES	(1 << 16)
 #define MAX_TBL8	(1 << 15)
@@ -371,6 +381,551 @@ test_lookup(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * Check that a route with the next hop of its parent reserves the tbl8
+ * released by its deletion
+ */
+int32_t
+test_tbl8_parent_nh(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = 64;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_add(fib, RTE_IPV4(10, 0, 0, 0), 24, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_add(fib, RTE_IPV4(10, 0, 0, 16), 28, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_delete(fib, RTE_IPV4(10, 0, 0, 16), 28);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+
+	/* the reservations are not exhausted */
+	ret = rte_fib_add(fib, RTE_IPV4(10, 0, 1, 16), 28, 6);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the association of a RCU QSBR variable with a FIB
+ */
+int32_t
+test_rcu_qsbr_add(void)
+{
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_fib_conf config = { 0 };
+	struct rte_rcu_qsbr *qsv;
+	struct rte_fib *fib;
+	int32_t status;
+
+	qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.type = RTE_FIB_DUMMY;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.v = qsv;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -ENOTSUP,
+		"RCU QSBR variable added to dummy FIB\n");
+	rte_fib_free(fib);
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	status = rte_fib_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = NULL;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC + 1;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Failed to add RCU QSBR variable\n");
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EEXIST,
+		"RCU QSBR variable added twice\n");
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+#define RCU_NB_TBL8	64
+#define RCU_NH		100
+#define RCU_DEF_NH	10
+#define RCU_ITERATIONS	200
+
+static struct rte_fib *rcu_fib;
+static struct rte_rcu_qsbr *rcu_qsv;
+static volatile uint8_t rcu_writer_done;
+
+/* one /32 route in each of RCU_NB_TBL8 /24 networks */
+static uint32_t
+rcu_ip(uint32_t i)
+{
+	return RTE_IPV4(10, 0, i, 1);
+}
+
+/* readers only see the default or the route next hop, never a freed tbl8 */
+static int
+rcu_reader(void *arg)
+{
+	uint32_t ips[RCU_NB_TBL8 * 2];
+	uint64_t nh[RTE_DIM(ips)];
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t i;
+	int ret = 0;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < RCU_NB_TBL8; i++) {
+		ips[2 * i] = rcu_ip(i);
+		ips[2 * i + 1] = rcu_ip(i) + 1;
+	}
+
+	rte_rcu_qsbr_thread_register(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_online(rcu_qsv, lcore_id);
+	while (!rcu_writer_done && ret == 0) {
+		rte_fib_lookup_bulk(rcu_fib, ips, nh, RTE_DIM(ips));
+		for (i = 0; i < RTE_DIM(ips); i++)
+			if (nh[i] != RCU_DEF_NH && nh[i] != RCU_NH)
+				ret = -1;
+		rte_rcu_qsbr_quiescent(rcu_qsv, lcore_id);
+	}
+	rte_rcu_qsbr_thread_offline(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(rcu_qsv, lcore_id);
+
+	return ret;
+}
+
+static int
+rcu_churn(enum rte_fib_qsbr_mode mode)
+{
+	struct rte_fib_route_update upd[RCU_NB_TBL8];
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_fib_conf config = { 0 };
+	unsigned int lcore_id, n;
+	uint32_t i, j;
+	int ret = 0;
+
+	rcu_qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(rcu_qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(rcu_qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = RCU_DEF_NH;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = RCU_NB_TBL8;
+	rcu_fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rcu_fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.v = rcu_qsv;
+	rcu_cfg.mode = mode;
+	RTE_TEST_ASSERT(rte_fib_rcu_qsbr_add(rcu_fib, &rcu_cfg) == 0,
+		"Failed to add RCU QSBR variable\n");
+
+	rcu_writer_done = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(rcu_reader, NULL, lcore_id);
+
+	/*
+	 * Every iteration needs all the tbl8s freed by the previous one,
+	 * alternately with bulk and single route updates.
+	 */
+	for (i = 0; i < RCU_ITERATIONS && ret == 0; i++) {
+		for (j = 0; j < RCU_NB_TBL8; j++) {
+			upd[j].ip = rcu_ip(j);
+			upd[j].depth = 32;
+			upd[j].op = RTE_FIB_ADD;
+			upd[j].next_hop = RCU_NH;
+		}
+		if (i % 2 == 0) {
+			n = rte_fib_update_bulk(rcu_fib, upd, RTE_DIM(upd));
+			if (n != RTE_DIM(upd))
+				ret = -1;
+		} else {
+			for (j = 0; j < RCU_NB_TBL8; j++)
+				if (rte_fib_add(rcu_fib, rcu_ip(j), 32,
+						RCU_NH) != 0)
+					ret = -1;
+		}
+		for (j = 0; j < RCU_NB_TBL8; j++)
+			upd[j].op = RTE_FIB_DEL;
+		if (i % 2 == 0) {
+			n = rte_fib_update_bulk(rcu_fib, upd, RTE_DIM(upd));
+			if (n != RTE_DIM(upd))
+				ret = -1;
+		} else {
+			for (j = 0; j < RCU_NB_TBL8; j++)
+				if (rte_fib_delete(rcu_fib, rcu_ip(j), 32) != 0)
+					ret = -1;
+		}
+	}
+
+	rcu_writer_done = 1;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+
+	rte_fib_free(rcu_fib);
+	rte_free(rcu_qsv);
+
+	return ret;
+}
+
+/*
+ * Churn routes needing all the tbl8s while lookup threads are running
+ */
+int32_t
+test_rcu_churn(void)
+{
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB_QSBR_MODE_DQ) == 0,
+		"Route churn failed in defer queue mode\n");
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB_QSBR_MODE_SYNC) == 0,
+		"Route churn failed in blocking mode\n");
+
+	return TEST_SUCCESS;
+}
+
+#define BUILD_NB_ROUTES		4096
+#define BUILD_NB_LOOKUPS	(4 * BUILD_NB_ROUTES)
+#define BUILD_DEF_NH		1
+
+static struct rte_fib_route build_routes[BUILD_NB_ROUTES];
+static struct rte_fib *build_fib;
+static unsigned int build_nb_parts;
+
+/* routes of all lengths nested in a few networks of several /8 */
+static void
+build_gen_routes(void)
+{
+	static const uint8_t nets[] = { 0, 10, 192, 255 };
+	uint32_t i;
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		build_routes[i].ip = RTE_IPV4(nets[rte_rand_max(RTE_DIM(nets))],
+			rte_rand_max(4), 0, 0) | (uint16_t)rte_rand();
+		build_routes[i].depth = rte_rand_max(RTE_FIB_MAXDEPTH + 1);
+		build_routes[i].next_hop = rte_rand_max(1 << 15);
+	}
+}
+
+/* lookup the edges of the routes in both FIBs */
+static int
+build_compare(struct rte_fib *ref, struct rte_fib *fib)
+{
+	static uint32_t ips[BUILD_NB_LOOKUPS];
+	static uint64_t nh_ref[BUILD_NB_LOOKUPS];
+	static uint64_t nh[BUILD_NB_LOOKUPS];
+	uint32_t i, ip, mask;
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		mask = (build_routes[i].depth == 0) ? 0 :
+			UINT32_MAX << (32 - build_routes[i].depth);
+		ip = build_routes[i].ip & mask;
+		ips[4 * i] = ip;
+		ips[4 * i + 1] = ip | ~mask;
+		ips[4 * i + 2] = ip - 1;
+		ips[4 * i + 3] = (ip | ~mask) + 1;
+	}
+	rte_fib_lookup_bulk(ref, ips, nh_ref, BUILD_NB_LOOKUPS);
+	rte_fib_lookup_bulk(fib, ips, nh, BUILD_NB_LOOKUPS);
+	for (i = 0; i < BUILD_NB_LOOKUPS; i++)
+		if (nh[i] != nh_ref[i])
+			return -1;
+
+	return 0;
+}
+
+static int
+build_worker(void *arg)
+{
+	unsigned int part = (uintptr_t)arg;
+
+	return rte_fib_build_range(build_fib,
+		part * 256 / build_nb_parts,
+		(part + 1) * 256 / build_nb_parts - 1);
+}
+
+/*
+ * Check that a bulk built FIB matches the one built route by route,
+ * on one lcore and split between the lcores
+ */
+int32_t
+test_build(void)
+{
+	struct rte_fib_conf config = { 0 };
+	struct rte_fib *ref, *fib;
+	unsigned int lcore_id, part = 0;
+	uint32_t i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_2B;
+	config.dir24_8.num_tbl8 = BUILD_NB_ROUTES;
+	ref = rte_fib_create("test_build_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	build_gen_routes();
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib_add(ref, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+
+	ret = rte_fib_build_start(NULL, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_build_range(fib, 0, UINT8_MAX);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Range filled without a build\n");
+	ret = rte_fib_build_finish(fib);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Build finished without a start\n");
+	ret = rte_fib_build(ref, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EEXIST, "Built a FIB which is not empty\n");
+
+	ret = rte_fib_build(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to build FIB\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after build\n");
+
+	/* the built FIB is updated route by route as usual */
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib_delete(ref, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib_delete(fib, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch after build\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+				"Lookup mismatch after delete\n");
+	}
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after delete\n");
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++)
+		rte_fib_add(ref, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+
+	build_fib = fib;
+	build_nb_parts = rte_lcore_count();
+	ret = rte_fib_build_start(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start FIB build\n");
+	ret = rte_fib_build_start(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Started two builds\n");
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(build_worker, (void *)(uintptr_t)part++,
+			lcore_id);
+	ret = build_worker((void *)(uintptr_t)part);
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+	RTE_TEST_ASSERT(ret == 0, "Failed to fill FIB ranges\n");
+	ret = rte_fib_build_finish(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to finish FIB build\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after parallel build\n");
+
+	rte_fib_free(ref);
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define SAVE_PATH	"/tmp/test_fib_save.bin"
+
+/*
+ * Check that a FIB loaded from a file matches the saved one and is
+ * updated the same way
+ */
+int32_t
+test_save_load(void)
+{
+	struct rte_fib_conf config = { 0 };
+	struct rte_fib *fib, *loaded;
+	uint32_t magic = 0;
+	uint32_t i;
+	FILE *f;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_2B;
+	config.dir24_8.num_tbl8 = BUILD_NB_ROUTES;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* some tbl8s are used then freed */
+	build_gen_routes();
+	for (i = 0; i < BUILD_NB_ROUTES; i++)
+		rte_fib_add(fib, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+	for (i = 0; i < BUILD_NB_ROUTES; i += 4)
+		rte_fib_delete(fib, build_routes[i].ip, build_routes[i].depth);
+
+	ret = rte_fib_save(NULL, SAVE_PATH);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	loaded = rte_fib_load("test_load", SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(loaded == NULL,
+		"Call succeeded with invalid parameters\n");
+	loaded = rte_fib_load("test_load", SOCKET_ID_ANY,
+		"/nonexistent/test_fib_save.bin");
+	RTE_TEST_ASSERT((loaded == NULL) && (rte_errno == ENOENT),
+		"Loaded a FIB from a missing file\n");
+
+	ret = rte_fib_save(fib, SAVE_PATH);
+	RTE_TEST_ASSERT(ret == 0, "Failed to save FIB\n");
+	loaded = rte_fib_load(__func__, SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT((loaded == NULL) && (rte_errno == EEXIST),
+		"Loaded two FIBs with the same name\n");
+	loaded = rte_fib_load("test_load", SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT(loaded != NULL, "Failed to load FIB\n");
+	RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+		"Lookup mismatch after load\n");
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib_delete(fib, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib_delete(loaded, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch after load\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+				"Lookup mismatch after delete\n");
+	}
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		rte_fib_add(fib, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+		ret = rte_fib_add(loaded, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+		"Lookup mismatch after add\n");
+	rte_fib_free(loaded);
+
+	/* a file with a bad header is rejected */
+	f = fopen(SAVE_PATH, "r+b");
+	RTE_TEST_ASSERT(f != NULL, "Failed to open FIB file\n");
+	fwrite(&magic, sizeof(magic), 1, f);
+	fclose(f);
+	loaded = rte_fib_load("test_load", SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT((loaded == NULL) && (rte_errno == EINVAL),
+		"Loaded an invalid file\n");
+
+	remove(SAVE_PATH);
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Save and load a FIB using num_tbl8 tbl8s, num_tbl8 not being a
+ * multiple of the 64 bits of a tbl8 bitmap slab
+ */
+static int
+save_load_tbl8s(uint32_t num_tbl8)
+{
+	struct rte_fib_conf config = { 0 };
+	struct rte_fib *fib, *loaded;
+	uint32_t ips[3];
+	uint64_t nh[3], nh_ref[3];
+	uint32_t i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = num_tbl8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* one tbl8 for each /24, with its own next hop */
+	for (i = 0; i < num_tbl8; i++) {
+		build_routes[i].ip = RTE_IPV4(10, 0, i, 16);
+		build_routes[i].depth = 28;
+		build_routes[i].next_hop = i + 2;
+	}
+	ret = rte_fib_build(fib, build_routes, num_tbl8);
+	RTE_TEST_ASSERT(ret == 0, "Failed to build FIB\n");
+
+	ret = rte_fib_save(fib, SAVE_PATH);
+	RTE_TEST_ASSERT(ret == 0, "Failed to save FIB\n");
+	loaded = rte_fib_load("test_load", SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT(loaded != NULL, "Failed to load FIB\n");
+	remove(SAVE_PATH);
+
+	for (i = 0; i < num_tbl8; i++) {
+		ips[0] = build_routes[i].ip;
+		ips[1] = build_routes[i].ip - 1;
+		ips[2] = build_routes[i].ip + 16;
+		rte_fib_lookup_bulk(fib, ips, nh_ref, RTE_DIM(ips));
+		rte_fib_lookup_bulk(loaded, ips, nh, RTE_DIM(ips));
+		RTE_TEST_ASSERT((nh_ref[0] == i + 2) &&
+			(memcmp(nh, nh_ref, sizeof(nh)) == 0),
+			"Lookup mismatch after load\n");
+	}
+
+	/* the tbl8s in use are not given to a new /24 */
+	ret = rte_fib_add(fib, RTE_IPV4(11, 0, 0, 16), 28, 1000);
+	RTE_TEST_ASSERT(rte_fib_add(loaded, RTE_IPV4(11, 0, 0, 16), 28,
+		1000) == ret, "Add mismatch after load\n");
+	for (i = 0; i < num_tbl8; i++) {
+		ips[0] = build_routes[i].ip;
+		rte_fib_lookup_bulk(loaded, ips, nh, 1);
+		RTE_TEST_ASSERT(nh[0] == i + 2,
+			"Lookup mismatch after add\n");
+	}
+
+	rte_fib_free(loaded);
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+int32_t
+test_save_load_tbl8s(void)
+{
+	RTE_TEST_ASSERT(save_load_tbl8s(37) == TEST_SUCCESS,
+		"Save and load failed with less than a slab of tbl8s\n");
+	RTE_TEST_ASSERT(save_load_tbl8s(101) == TEST_SUCCESS,
+		"Save and load failed with a partial slab of tbl8s\n");
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite fib_fast_tests = {
 	.suite_name = "fib autotest",
 	.setup = NULL,
@@ -381,6 +936,12 @@ static struct unit_test_suite fib_fast_tests = {
 	TEST_CASE(test_add_del_invalid),
 	TEST_CASE(test_get_invalid),
 	TEST_CASE(test_lookup),
+	TEST_CASE(test_tbl8_parent_nh),
+	TEST_CASE(test_rcu_qsbr_add),
+	TEST_CASE(test_rcu_churn),
+	TEST_CASE(test_build),
+	TEST_CASE(test_save_load),
+	TEST_CASE(test_save_load_tbl8s),
 	TEST_CASES_END()
 	}
 };
@@ -6,11 +6,16 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <rte_memory.h>
 #include <rte_log.h>
+#include <rte_errno.h>
 #include <rte_rib6.h>
 #include <rte_fib6.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
 
 #include "test.h"
 
@@ -22,10 +27,19 @@ static int32_t test_free_null(void);
 static int32_t test_add_del_invalid(void);
 static int32_t test_get_invalid(void);
 static int32_t test_lookup(void);
+static int32_t test_tbl8_parent_nh(void);
+static int32_t test_rcu_qsbr_add(void);
+static int32_t test_rcu_churn(void);
+static int32_t test_tbl8_release(void);
+static int32_t test_build(void);
+static int32_t test_poptrie(void);
+static int32_t test_save_load(void);
 
 #define MAX_ROUTES	(1 << 16)
 /** Maximum number of tbl8 for 2-byte entries */
 #define MAX_TBL8	(1 << 15)
+#define MAX_NODES	(1 << 15)
+#define MAX_LEAVES	(1 << 18)
 
 /*
  * Check that rte_fib6_create fails gracefully for incorrect user input
@@ -63,7 +77,7 @@ test_create_invalid(void)
 		"Call succeeded with invalid parameters\n");
 	config.max_routes = MAX_ROUTES;
 
-	config.type = RTE_FIB6_TRIE + 1;
+	config.type = RTE_FIB6_POPTRIE + 1;
 	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
 	RTE_TEST_ASSERT(fib == NULL,
 		"Call succeeded with invalid parameters\n");
@@ -82,6 +96,23 @@ test_create_invalid(void)
 	RTE_TEST_ASSERT(fib == NULL,
 		"Call succeeded with invalid parameters\n");
 
+	config.type = RTE_FIB6_POPTRIE;
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_2B;
+	config.poptrie.num_nodes = MAX_NODES;
+	config.poptrie.num_leaves = MAX_LEAVES;
+
+	/* node indexes do not fit in 2B next hops */
+	config.poptrie.num_nodes = MAX_NODES * 2;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.poptrie.num_nodes = MAX_NODES;
+
+	config.poptrie.num_leaves = 0;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
 	return TEST_SUCCESS;
 }
 
@@ -377,9 +408,694 @@ test_lookup(void)
 		"Check_fib fails for TRIE_8B type\n");
 	rte_fib6_free(fib);
 
+	config.type = RTE_FIB6_POPTRIE;
+	config.poptrie.num_nodes = MAX_NODES - 1;
+	config.poptrie.num_leaves = MAX_LEAVES;
+
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_2B;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for POPTRIE_2B type\n");
+	rte_fib6_free(fib);
+
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_4B;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for POPTRIE_4B type\n");
+	rte_fib6_free(fib);
+
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_8B;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for POPTRIE_8B type\n");
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that a route with the next hop of its parent reserves the tbl8s
+ * released by its deletion
+ */
+int32_t
+test_tbl8_parent_nh(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8};
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = 16;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib6_add(fib, ip, 32, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib6_add(fib, ip, 48, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib6_delete(fib, ip, 48);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+
+	/* the reservations are not exhausted */
+	ip[5] = 1;
+	ret = rte_fib6_add(fib, ip, 48, 6);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the association of a RCU QSBR variable with a FIB
+ */
+int32_t
+test_rcu_qsbr_add(void)
+{
+	struct rte_fib6_rcu_config rcu_cfg = {0};
+	struct rte_fib6_conf config = { 0 };
+	struct rte_rcu_qsbr *qsv;
+	struct rte_fib6 *fib;
+	int32_t status;
+
+	qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.type = RTE_FIB6_DUMMY;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.v = qsv;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -ENOTSUP,
+		"RCU QSBR variable added to dummy FIB\n");
+	rte_fib6_free(fib);
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	status = rte_fib6_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = NULL;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_SYNC + 1;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_DQ;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Failed to add RCU QSBR variable\n");
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EEXIST,
+		"RCU QSBR variable added twice\n");
+
+	rte_fib6_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+#define RCU_NB_TBL8	64
+#define RCU_NH		100
+#define RCU_DEF_NH	10
+#define RCU_ITERATIONS	200
+#define RCU_POPTRIE_NB_NODES	1024
+
+static struct rte_fib6 *rcu_fib;
+static struct rte_rcu_qsbr *rcu_qsv;
+static volatile uint8_t rcu_writer_done;
+
+/* one /32 route in each of RCU_NB_TBL8 /24 networks */
+static void
+rcu_ip(uint32_t i, uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE])
+{
+	memset(ip, 0, RTE_FIB6_IPV6_ADDR_SIZE);
+	ip[0] = 0x20;
+	ip[1] = 0x01;
+	ip[2] = i;
+	ip[3] = 1;
+}
+
+/* readers only see the default or the route next hop, never a freed tbl8 */
+static int
+rcu_reader(void *arg)
+{
+	uint8_t ips[RCU_NB_TBL8 * 2][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t nh[RTE_DIM(ips)];
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t i;
+	int ret = 0;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < RCU_NB_TBL8; i++) {
+		rcu_ip(i, ips[2 * i]);
+		rcu_ip(i, ips[2 * i + 1]);
+		ips[2 * i + 1][3]++;
+	}
+
+	rte_rcu_qsbr_thread_register(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_online(rcu_qsv, lcore_id);
+	while (!rcu_writer_done && ret == 0) {
+		rte_fib6_lookup_bulk(rcu_fib, ips, nh, RTE_DIM(ips));
+		for (i = 0; i < RTE_DIM(ips); i++)
+			if (nh[i] != RCU_DEF_NH && nh[i] != RCU_NH)
+				ret = -1;
+		rte_rcu_qsbr_quiescent(rcu_qsv, lcore_id);
+	}
+	rte_rcu_qsbr_thread_offline(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(rcu_qsv, lcore_id);
+
+	return ret;
+}
+
+static int
+rcu_churn(enum rte_fib6_type type, enum rte_fib6_qsbr_mode mode)
+{
+	struct rte_fib6_route_update upd[RCU_NB_TBL8];
+	struct rte_fib6_rcu_config rcu_cfg = {0};
+	struct rte_fib6_conf config = { 0 };
+	unsigned int lcore_id, n;
+	uint32_t i, j;
+	int ret = 0;
+
+	rcu_qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(rcu_qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(rcu_qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = RCU_DEF_NH;
+	config.type = type;
+	if (type == RTE_FIB6_TRIE) {
+		config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+		/* the trie keeps one tbl8 out of the reservations */
+		config.trie.num_tbl8 = RCU_NB_TBL8 + 1;
+	} else {
+		/* the blocks are reused many times over the iterations */
+		config.poptrie.nh_sz = RTE_FIB6_TRIE_4B;
+		config.poptrie.num_nodes = RCU_POPTRIE_NB_NODES;
+		config.poptrie.num_leaves = RCU_POPTRIE_NB_NODES;
+	}
+	rcu_fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rcu_fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.v = rcu_qsv;
+	rcu_cfg.mode = mode;
+	RTE_TEST_ASSERT(rte_fib6_rcu_qsbr_add(rcu_fib, &rcu_cfg) == 0,
+		"Failed to add RCU QSBR variable\n");
+
+	rcu_writer_done = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(rcu_reader, NULL, lcore_id);
+
+	/*
+	 * Every iteration needs all the tbl8s freed by the previous one,
+	 * alternately with bulk and single route updates.
+	 */
+	for (i = 0; i < RCU_ITERATIONS && ret == 0; i++) {
+		for (j = 0; j < RCU_NB_TBL8; j++) {
+			rcu_ip(j, upd[j].ip);
+			upd[j].depth = 32;
+			upd[j].op = RTE_FIB6_ADD;
+			upd[j].next_hop = RCU_NH;
+		}
+		if (i % 2 == 0) {
+			n = rte_fib6_update_bulk(rcu_fib, upd, RTE_DIM(upd));
+			if (n != RTE_DIM(upd))
+				ret = -1;
+		} else {
+			for (j = 0; j < RCU_NB_TBL8; j++)
+				if (rte_fib6_add(rcu_fib, upd[j].ip, 32,
+						RCU_NH) != 0)
+					ret = -1;
+		}
+		for (j = 0; j < RCU_NB_TBL8; j++)
+			upd[j].op = RTE_FIB6_DEL;
+		if (i % 2 == 0) {
+			n = rte_fib6_update_bulk(rcu_fib, upd, RTE_DIM(upd));
+			if (n != RTE_DIM(upd))
+				ret = -1;
+		} else {
+			for (j = 0; j < RCU_NB_TBL8; j++)
+				if (rte_fib6_delete(rcu_fib, upd[j].ip,
+						32) != 0)
+					ret = -1;
+		}
+	}
+
+	rcu_writer_done = 1;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+
+	rte_fib6_free(rcu_fib);
+	rte_free(rcu_qsv);
+
+	return ret;
+}
+
+/*
+ * Churn routes needing all the tbl8s, or all the POPTRIE nodes, while
+ * lookup threads are running
+ */
+int32_t
+test_rcu_churn(void)
+{
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB6_TRIE, RTE_FIB6_QSBR_MODE_DQ) == 0,
+		"Route churn failed in defer queue mode\n");
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB6_TRIE,
+		RTE_FIB6_QSBR_MODE_SYNC) == 0,
+		"Route churn failed in blocking mode\n");
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB6_POPTRIE,
+		RTE_FIB6_QSBR_MODE_DQ) == 0,
+		"POPTRIE route churn failed in defer queue mode\n");
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB6_POPTRIE,
+		RTE_FIB6_QSBR_MODE_SYNC) == 0,
+		"POPTRIE route churn failed in blocking mode\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that deleting a route releases the tbl8s reserved when adding it
+ */
+int32_t
+test_tbl8_release(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8};
+	int i, ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = 16;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* a /64 reserves 5 tbl8s below the tbl24 */
+	for (i = 0; i < 64; i++) {
+		ret = rte_fib6_add(fib, ip, 64, 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib6_delete(fib, ip, 64);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define BUILD_NB_ROUTES		4096
+#define BUILD_NB_SEEDS		8
+#define BUILD_NB_LOOKUPS	(4 * BUILD_NB_ROUTES)
+#define BUILD_DEF_NH		1
+
+static struct rte_fib6_route build_routes[BUILD_NB_ROUTES];
+static struct rte_fib6 *build_fib;
+static unsigned int build_nb_parts;
+
+/* routes of all lengths nested around a few addresses of several /8 */
+static void
+build_gen_routes(void)
+{
+	static const uint8_t nets[] = { 0, 0x20, 0xfe, 0xff };
+	uint8_t seeds[BUILD_NB_SEEDS][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint32_t i, j;
+
+	for (i = 0; i < BUILD_NB_SEEDS; i++) {
+		for (j = 0; j < RTE_FIB6_IPV6_ADDR_SIZE; j++)
+			seeds[i][j] = rte_rand();
+		seeds[i][0] = nets[i % RTE_DIM(nets)];
+	}
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		memcpy(build_routes[i].ip, seeds[rte_rand_max(BUILD_NB_SEEDS)],
+			RTE_FIB6_IPV6_ADDR_SIZE);
+		build_routes[i].ip[1 + rte_rand_max(RTE_FIB6_IPV6_ADDR_SIZE -
+			1)] ^= rte_rand_max(4);
+		build_routes[i].depth = rte_rand_max(RTE_FIB6_MAXDEPTH + 1);
+		build_routes[i].next_hop = rte_rand_max(1 << 15);
+	}
+}
+
+/* lookup the edges of the routes in both FIBs */
+static int
+build_compare(struct rte_fib6 *ref, struct rte_fib6 *fib)
+{
+	static uint8_t ips[BUILD_NB_LOOKUPS][RTE_FIB6_IPV6_ADDR_SIZE];
+	static uint64_t nh_ref[BUILD_NB_LOOKUPS];
+	static uint64_t nh[BUILD_NB_LOOKUPS];
+	uint8_t *first, *last, *prev, *next;
+	uint32_t i;
+	int j;
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		first = ips[4 * i];
+		last = ips[4 * i + 1];
+		prev = ips[4 * i + 2];
+		next = ips[4 * i + 3];
+		for (j = 0; j < RTE_FIB6_IPV6_ADDR_SIZE; j++) {
+			first[j] = build_routes[i].ip[j] &
+				get_msk_part(build_routes[i].depth, j);
+			last[j] = first[j] |
+				~get_msk_part(build_routes[i].depth, j);
+		}
+		memcpy(prev, first, RTE_FIB6_IPV6_ADDR_SIZE);
+		for (j = RTE_FIB6_IPV6_ADDR_SIZE - 1; j >= 0 && prev[j]-- == 0;
+				j--)
+			;
+		memcpy(next, last, RTE_FIB6_IPV6_ADDR_SIZE);
+		for (j = RTE_FIB6_IPV6_ADDR_SIZE - 1; j >= 0 && ++next[j] == 0;
+				j--)
+			;
+	}
+	rte_fib6_lookup_bulk(ref, ips, nh_ref, BUILD_NB_LOOKUPS);
+	rte_fib6_lookup_bulk(fib, ips, nh, BUILD_NB_LOOKUPS);
+	for (i = 0; i < BUILD_NB_LOOKUPS; i++)
+		if (nh[i] != nh_ref[i])
+			return -1;
+
+	return 0;
+}
+
+static int
+build_worker(void *arg)
+{
+	unsigned int part = (uintptr_t)arg;
+
+	return rte_fib6_build_range(build_fib,
+		part * 256 / build_nb_parts,
+		(part + 1) * 256 / build_nb_parts - 1);
+}
+
+/*
+ * Check that a bulk built FIB matches the one built route by route,
+ * on one lcore and split between the lcores
+ */
+int32_t
+test_build(void)
+{
+	struct rte_fib6_conf config = { 0 };
+	struct rte_fib6 *ref, *fib;
+	unsigned int lcore_id, part = 0;
+	uint32_t i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+	ref = rte_fib6_create("test_build_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	build_gen_routes();
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib6_add(ref, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+
+	ret = rte_fib6_build_start(NULL, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib6_build_range(fib, 0, UINT8_MAX);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Range filled without a build\n");
+	ret = rte_fib6_build_finish(fib);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Build finished without a start\n");
+	ret = rte_fib6_build(ref, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EEXIST, "Built a FIB which is not empty\n");
+
+	ret = rte_fib6_build(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to build FIB\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after build\n");
+
+	/* the built FIB is updated route by route as usual */
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib6_delete(ref, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib6_delete(fib, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch after build\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+				"Lookup mismatch after delete\n");
+	}
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after delete\n");
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++)
+		rte_fib6_add(ref, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+
+	build_fib = fib;
+	build_nb_parts = rte_lcore_count();
+	ret = rte_fib6_build_start(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start FIB build\n");
+	ret = rte_fib6_build_start(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Started two builds\n");
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(build_worker, (void *)(uintptr_t)part++,
+			lcore_id);
+	ret = build_worker((void *)(uintptr_t)part);
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+	RTE_TEST_ASSERT(ret == 0, "Failed to fill FIB ranges\n");
+	ret = rte_fib6_build_finish(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to finish FIB build\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after parallel build\n");
+
+	rte_fib6_free(ref);
+	rte_fib6_free(fib);
+
 	return TEST_SUCCESS;
 }
 
+/*
+ * Check that a POPTRIE FIB matches a TRIE one while routes are added
+ * and deleted, with both lookup implementations, and once bulk built
+ */
+int32_t
+test_poptrie(void)
+{
+	struct rte_fib6_conf config = { 0 };
+	struct rte_fib6 *ref, *fib;
+	uint32_t i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+	ref = rte_fib6_create("test_poptrie_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+	config.type = RTE_FIB6_POPTRIE;
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.poptrie.num_nodes = MAX_NODES;
+	config.poptrie.num_leaves = MAX_LEAVES;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	build_gen_routes();
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib6_add(ref, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib6_add(fib, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+				"Lookup mismatch after add\n");
+	}
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after add\n");
+	ret = rte_fib6_select_lookup(fib, RTE_FIB6_LOOKUP_POPTRIE_SCALAR);
+	RTE_TEST_ASSERT(ret == 0, "Failed to select scalar lookup\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch with scalar lookup\n");
+	rte_fib6_select_lookup(fib, RTE_FIB6_LOOKUP_DEFAULT);
+
+	for (i = 0; i < BUILD_NB_ROUTES; i += 2) {
+		ret = rte_fib6_delete(ref, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib6_delete(fib, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+				"Lookup mismatch after delete\n");
+	}
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after delete\n");
+	rte_fib6_free(fib);
+
+	/* the same routes bulk built */
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	for (i = 0; i < BUILD_NB_ROUTES; i++)
+		rte_fib6_add(ref, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+	ret = rte_fib6_build(fib, build_routes, BUILD_NB_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to build FIB\n");
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after build\n");
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib6_delete(ref, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib6_delete(fib, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch after build\n");
+	}
+	RTE_TEST_ASSERT(build_compare(ref, fib) == 0,
+		"Lookup mismatch after delete\n");
+
+	rte_fib6_free(ref);
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define SAVE_PATH	"/tmp/test_fib6_save.bin"
+
+static int
+save_load_check(struct rte_fib6_conf *config)
+{
+	struct rte_fib6 *fib, *loaded;
+	uint32_t magic = 0;
+	uint32_t i;
+	FILE *f;
+	int ret;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* some tbl8s or nodes are used then freed */
+	build_gen_routes();
+	for (i = 0; i < BUILD_NB_ROUTES; i++)
+		rte_fib6_add(fib, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+	for (i = 0; i < BUILD_NB_ROUTES; i += 4)
+		rte_fib6_delete(fib, build_routes[i].ip,
+			build_routes[i].depth);
+
+	ret = rte_fib6_save(fib, SAVE_PATH);
+	RTE_TEST_ASSERT(ret == 0, "Failed to save FIB\n");
+	loaded = rte_fib6_load(__func__, SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT((loaded == NULL) && (rte_errno == EEXIST),
+		"Loaded two FIBs with the same name\n");
+	loaded = rte_fib6_load("test_load", SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT(loaded != NULL, "Failed to load FIB\n");
+	RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+		"Lookup mismatch after load\n");
+
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		ret = rte_fib6_delete(fib, build_routes[i].ip,
+			build_routes[i].depth);
+		RTE_TEST_ASSERT(rte_fib6_delete(loaded, build_routes[i].ip,
+			build_routes[i].depth) == ret,
+			"Delete mismatch after load\n");
+		if ((i % 64) == 0)
+			RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+				"Lookup mismatch after delete\n");
+	}
+	for (i = 0; i < BUILD_NB_ROUTES; i++) {
+		rte_fib6_add(fib, build_routes[i].ip, build_routes[i].depth,
+			build_routes[i].next_hop);
+		ret = rte_fib6_add(loaded, build_routes[i].ip,
+			build_routes[i].depth, build_routes[i].next_hop);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	RTE_TEST_ASSERT(build_compare(fib, loaded) == 0,
+		"Lookup mismatch after add\n");
+	rte_fib6_free(loaded);
+
+	/* a file with a bad header is rejected */
+	f = fopen(SAVE_PATH, "r+b");
+	RTE_TEST_ASSERT(f != NULL, "Failed to open FIB file\n");
+	fwrite(&magic, sizeof(magic), 1, f);
+	fclose(f);
+	loaded = rte_fib6_load("test_load", SOCKET_ID_ANY, SAVE_PATH);
+	RTE_TEST_ASSERT((loaded == NULL) && (rte_errno == EINVAL),
+		"Loaded an invalid file\n");
+
+	remove(SAVE_PATH);
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that a FIB loaded from a file matches the saved one and is
+ * updated the same way
+ */
+int32_t
+test_save_load(void)
+{
+	struct rte_fib6_conf config = { 0 };
+	struct rte_fib6 *fib;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = BUILD_DEF_NH;
+	config.type = RTE_FIB6_DUMMY;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib6_save(NULL, SAVE_PATH);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib6_save(fib, NULL);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_fib6_load("test_load", SOCKET_ID_ANY,
+		"/nonexistent/test_fib6_save.bin") == NULL,
+		"Loaded a FIB from a missing file\n");
+	rte_fib6_free(fib);
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+	ret = save_load_check(&config);
+	if (ret != TEST_SUCCESS)
+		return ret;
+
+	config.type = RTE_FIB6_POPTRIE;
+	config.poptrie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.poptrie.num_nodes = MAX_NODES;
+	config.poptrie.num_leaves = MAX_LEAVES;
+	return save_load_check(&config);
+}
+
 static struct unit_test_suite fib6_fast_tests = {
 	.suite_name = "fib6 autotest",
 	.setup = NULL,
@@ -390,6 +1106,13 @@ static struct unit_test_suite fib6_fast_tests = {
 	TEST_CASE(test_add_del_invalid),
 	TEST_CASE(test_get_invalid),
 	TEST_CASE(test_lookup),
+	TEST_CASE(test_tbl8_parent_nh),
+	TEST_CASE(test_rcu_qsbr_add),
+	TEST_CASE(test_rcu_churn),
+	TEST_CASE(test_tbl8_release),
+	TEST_CASE(test_build),
+	TEST_CASE(test_poptrie),
+	TEST_CASE(test_save_load),
 	TEST_CASES_END()
 	}
 };
@@ -10,6 +10,7 @@
 #include <rte_cycles.h>
 #include <rte_random.h>
 #include <rte_memory.h>
+#include <rte_malloc.h>
 #include <rte_fib6.h>
 
 #include "test.h"
@@ -25,6 +26,10 @@
 #define ITERATIONS (1 << 10)
 #define BATCH_SIZE 100000
 #define NUMBER_TBL8S                                           (1 << 16)
+#define NUMBER_NODES	(1 << 14)
+#define NUMBER_LEAVES	(1 << 16)
+
+static struct rte_fib6_route build_route_table[NUM_ROUTE_ENTRIES];
 
 static void
 print_route_distribution(const struct rules_tbl_entry *table, uint32_t n)
@@ -62,39 +67,60 @@ get_max_nh(uint8_t nh_sz)
 	return ((1ULL << (bits_in_nh(nh_sz) - 1)) - 1);
 }
 
+/* Memory allocated from the heaps of all the sockets */
+static size_t
+heap_allocated(void)
+{
+	struct rte_malloc_socket_stats stats;
+	unsigned int i;
+	size_t sz = 0;
+
+	for (i = 0; i < rte_socket_count(); i++)
+		if (rte_malloc_get_socket_stats(rte_socket_id_by_idx(i),
+				&stats) == 0)
+			sz += stats.heap_allocsz_bytes;
+	return sz;
+}
+
+/* Size of the FIB memory, without the RIB */
+static size_t
+fib6_mem(struct rte_fib6_conf *conf, struct rte_fib6 **fib)
+{
+	struct rte_fib6_conf dummy_conf = *conf;
+	struct rte_fib6 *dummy;
+	size_t mem, rib_mem;
+
+	dummy_conf.type = RTE_FIB6_DUMMY;
+	rib_mem = heap_allocated();
+	dummy = rte_fib6_create("fib6_perf_dummy", SOCKET_ID_ANY,
+		&dummy_conf);
+	rib_mem = heap_allocated() - rib_mem;
+	rte_fib6_free(dummy);
+
+	mem = heap_allocated();
+	*fib = rte_fib6_create(__func__, SOCKET_ID_ANY, conf);
+	return heap_allocated() - mem - rib_mem;
+}
+
 static int
-test_fib6_perf(void)
+fib6_perf(struct rte_fib6_conf *conf, const char *type)
 {
+	static uint8_t ip_batch[NUM_IPS_ENTRIES][16];
+	static uint64_t next_hops[NUM_IPS_ENTRIES];
 	struct rte_fib6 *fib = NULL;
-	struct rte_fib6_conf conf;
 	uint64_t begin, total_time;
 	unsigned int i, j;
 	uint64_t next_hop_add;
 	int status = 0;
 	int64_t count = 0;
-	uint8_t ip_batch[NUM_IPS_ENTRIES][16];
-	uint64_t next_hops[NUM_IPS_ENTRIES];
-
-	conf.type = RTE_FIB6_TRIE;
-	conf.default_nh = 0;
-	conf.max_routes = 1000000;
-	conf.trie.nh_sz = RTE_FIB6_TRIE_4B;
-	conf.trie.num_tbl8 = RTE_MIN(get_max_nh(conf.trie.nh_sz), 1000000U);
+	size_t mem;
 
-	rte_srand(rte_rdtsc());
+	printf("\n%s FIB:\n", type);
 
-	printf("No. routes = %u\n", (unsigned int) NUM_ROUTE_ENTRIES);
-
-	print_route_distribution(large_route_table,
-		(uint32_t)NUM_ROUTE_ENTRIES);
-
-	/* Only generate IPv6 address of each item in large IPS table,
-	 * here next_hop is not needed.
-	 */
-	generate_large_ips_table(0);
-
-	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &conf);
+	mem = fib6_mem(conf, &fib);
 	TEST_FIB_ASSERT(fib != NULL);
+	printf("FIB memory: %zu KB, %zu bytes per route\n", mem >> 10,
+		mem / NUM_ROUTE_ENTRIES);
 
 	/* Measure add. */
 	begin = rte_rdtsc();
@@ -149,9 +175,59 @@ test_fib6_perf(void)
 	printf("Average FIB Delete: %g cycles\n",
 			(double)total_time / NUM_ROUTE_ENTRIES);
 
+	/* Measure bulk build of the emptied FIB */
+	begin = rte_rdtsc();
+	status = rte_fib6_build(fib, build_route_table, NUM_ROUTE_ENTRIES);
+	total_time = rte_rdtsc() - begin;
+	TEST_FIB_ASSERT(status == 0);
+
+	printf("Average FIB Build: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
 	rte_fib6_free(fib);
 
 	return 0;
 }
 
+static int
+test_fib6_perf(void)
+{
+	struct rte_fib6_conf conf;
+	unsigned int i;
+
+	conf.type = RTE_FIB6_TRIE;
+	conf.default_nh = 0;
+	conf.max_routes = 1000000;
+	conf.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	conf.trie.num_tbl8 = RTE_MIN(get_max_nh(conf.trie.nh_sz), 1000000U);
+
+	rte_srand(rte_rdtsc());
+
+	printf("No. routes = %u\n", (unsigned int) NUM_ROUTE_ENTRIES);
+
+	print_route_distribution(large_route_table,
+		(uint32_t)NUM_ROUTE_ENTRIES);
+
+	/* Only generate IPv6 address of each item in large IPS table,
+	 * here next_hop is not needed.
+	 */
+	generate_large_ips_table(0);
+
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		memcpy(build_route_table[i].ip, large_route_table[i].ip, 16);
+		build_route_table[i].depth = large_route_table[i].depth;
+		build_route_table[i].next_hop = (i & ((1 << 14) - 1)) + 1;
+	}
+
+	if (fib6_perf(&conf, "TRIE") != 0)
+		return -1;
+
+	conf.type = RTE_FIB6_POPTRIE;
+	conf.poptrie.nh_sz = RTE_FIB6_TRIE_4B;
+	conf.poptrie.num_nodes = NUMBER_NODES;
+	conf.poptrie.num_leaves = NUMBER_LEAVES;
+
+	return fib6_perf(&conf, "POPTRIE");
+}
+
 REGISTER_TEST_COMMAND(fib6_perf_autotest, test_fib6_perf);
@@ -27,6 +27,7 @@
 #define ITERATIONS (1 << 10)
 #define BATCH_SIZE (1 << 12)
 #define BULK_SIZE 32
+#define SAVE_PATH "/tmp/test_fib_perf_save.bin"
 
 #define MAX_RULE_NUM (1200000)
 
@@ -36,6 +37,7 @@ struct route_rule {
 };
 
 static struct route_rule large_route_table[MAX_RULE_NUM];
+static struct rte_fib_route build_route_table[MAX_RULE_NUM];
 
 static uint32_t num_route_entries;
 #define NUM_ROUTE_ENTRIES num_route_entries
@@ -319,7 +321,7 @@ print_route_distribution(const struct route_rule *table, uint32_t n)
 static int
 test_fib_perf(void)
 {
-	struct rte_fib *fib = NULL;
+	struct rte_fib *fib = NULL, *loaded;
 	struct rte_fib_conf config;
 
 	config.max_routes = 2000000;
@@ -327,7 +329,7 @@ test_fib_perf(void)
 	config.default_nh = 0;
 	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
 	config.dir24_8.num_tbl8 = 65535;
-	uint64_t begin, total_time;
+	uint64_t begin, total_time, create_time;
 	unsigned int i, j;
 	uint32_t next_hop_add = 0xAA;
 	int status = 0;
@@ -403,6 +405,60 @@ test_fib_perf(void)
 	printf("Average FIB Delete: %g cycles\n",
 			(double)total_time / NUM_ROUTE_ENTRIES);
 
+	/* Measure bulk build of the emptied FIB */
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		build_route_table[i].ip = large_route_table[i].ip;
+		build_route_table[i].depth = large_route_table[i].depth;
+		build_route_table[i].next_hop = next_hop_add;
+	}
+	begin = rte_rdtsc();
+	status = rte_fib_build(fib, build_route_table, NUM_ROUTE_ENTRIES);
+	total_time = rte_rdtsc() - begin;
+	TEST_FIB_ASSERT(status == 0);
+
+	printf("Average FIB Build: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
+	/* Measure save and load of the built FIB */
+	begin = rte_rdtsc();
+	status = rte_fib_save(fib, SAVE_PATH);
+	total_time = rte_rdtsc() - begin;
+	TEST_FIB_ASSERT(status == 0);
+
+	printf("Average FIB Save: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
+	/* the load includes the creation of the FIB, once memory is touched */
+	for (i = 0; i < 2; i++) {
+		begin = rte_rdtsc();
+		loaded = rte_fib_create("test_fib_perf_load", SOCKET_ID_ANY,
+			&config);
+		create_time = rte_rdtsc() - begin;
+		TEST_FIB_ASSERT(loaded != NULL);
+		rte_fib_free(loaded);
+	}
+
+	begin = rte_rdtsc();
+	loaded = rte_fib_load("test_fib_perf_load", SOCKET_ID_ANY, SAVE_PATH);
+	total_time = rte_rdtsc() - begin;
+	remove(SAVE_PATH);
+	TEST_FIB_ASSERT(loaded != NULL);
+
+	printf("Average FIB Load: %g cycles (%g creating the FIB)\n",
+			(double)total_time / NUM_ROUTE_ENTRIES,
+			(double)create_time / NUM_ROUTE_ENTRIES);
+
+	/* the loaded FIB gives the same next hops */
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		uint64_t nh, nh_loaded;
+
+		rte_fib_lookup_bulk(fib, &large_route_table[i].ip, &nh, 1);
+		rte_fib_lookup_bulk(loaded, &large_route_table[i].ip,
+			&nh_loaded, 1);
+		TEST_FIB_ASSERT(nh == nh_loaded);
+	}
+	rte_fib_free(loaded);
+
 	rte_fib_free(fib);
 
 	return 0;
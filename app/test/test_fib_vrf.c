@@ -0,0 +1,713 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+#include <rte_fib_vrf.h>
+#include <rte_random.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+typedef int32_t (*rte_fib_vrf_test)(void);
+
+static int32_t test_create_invalid(void);
+static int32_t test_add_del_invalid(void);
+static int32_t test_shared_tbl8(void);
+static int32_t test_tbl8_exhausted(void);
+static int32_t test_lookup(void);
+static int32_t test_rcu(void);
+
+#define MAX_ROUTES	(1 << 16)
+#define MAX_TBL8	(1 << 12)
+#define MAX_VRFS	64
+#define DEF_NH		0x7fff
+
+/*
+ * Check that rte_fib_vrf_create fails gracefully for incorrect user input
+ * arguments
+ */
+int32_t
+test_create_invalid(void)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_2B,
+		.default_nh = 0,
+		.max_vrfs = MAX_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = MAX_TBL8,
+	};
+	struct rte_fib_vrf_conf bad;
+
+	/* rte_fib_vrf_create: fib name == NULL */
+	fib = rte_fib_vrf_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_vrf_create: config == NULL */
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* max_routes == 0 */
+	bad = config;
+	bad.max_routes = 0;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* max_vrfs == 0 */
+	bad = config;
+	bad.max_vrfs = 0;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* max_vrfs > RTE_FIB_VRF_MAX_VRFS */
+	bad = config;
+	bad.max_vrfs = RTE_FIB_VRF_MAX_VRFS + 1;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* max_large_vrfs > max_vrfs */
+	bad = config;
+	bad.max_large_vrfs = MAX_VRFS + 1;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* invalid next hop size */
+	bad = config;
+	bad.nh_sz = RTE_FIB_DIR24_8_8B + 1;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* num_tbl8 == 0 */
+	bad = config;
+	bad.num_tbl8 = 0;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* too many tbl8s for the next hop size */
+	bad = config;
+	bad.nh_sz = RTE_FIB_DIR24_8_1B;
+	bad.num_tbl8 = 128;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* default next hop too large for the next hop size */
+	bad = config;
+	bad.default_nh = 1 << 15;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &bad);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	RTE_TEST_ASSERT(rte_fib_vrf_find_existing(__func__) == fib,
+		"Failed to find FIB\n");
+	RTE_TEST_ASSERT(rte_fib_vrf_create(__func__, SOCKET_ID_ANY,
+		&config) == NULL, "Call succeeded with an existing name\n");
+	rte_fib_vrf_free(fib);
+	RTE_TEST_ASSERT(rte_fib_vrf_find_existing(__func__) == NULL,
+		"Found a freed FIB\n");
+
+	/* rte_fib_vrf_free: fib == NULL */
+	rte_fib_vrf_free(NULL);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib_vrf_add and rte_fib_vrf_delete fail gracefully
+ * for incorrect user input arguments
+ */
+int32_t
+test_add_del_invalid(void)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_2B,
+		.default_nh = 0,
+		.max_vrfs = MAX_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = MAX_TBL8,
+	};
+	struct rte_fib_vrf_stats stats;
+	uint32_t ip = RTE_IPV4(1, 2, 3, 4);
+	int ret;
+
+	/* rte_fib_vrf_add: fib == NULL */
+	ret = rte_fib_vrf_add(NULL, 0, ip, 24, 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_vrf_delete: fib == NULL */
+	ret = rte_fib_vrf_delete(NULL, 0, ip, 24);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* depth > RTE_FIB_MAXDEPTH */
+	ret = rte_fib_vrf_add(fib, 0, ip, RTE_FIB_MAXDEPTH + 1, 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_vrf_delete(fib, 0, ip, RTE_FIB_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* vrf_id >= max_vrfs */
+	ret = rte_fib_vrf_add(fib, MAX_VRFS, ip, 24, 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* next hop too large for the next hop size */
+	ret = rte_fib_vrf_add(fib, 0, ip, 24, 1 << 15);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* delete of a route of another VRF */
+	ret = rte_fib_vrf_add(fib, 1, ip, 24, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_vrf_delete(fib, 2, ip, 24);
+	RTE_TEST_ASSERT(ret == -ENOENT,
+		"Deleted a route of another VRF\n");
+	ret = rte_fib_vrf_delete(fib, 1, ip, 24);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+
+	/* rte_fib_vrf_get_stats: invalid arguments */
+	RTE_TEST_ASSERT(rte_fib_vrf_get_stats(NULL, &stats) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_fib_vrf_get_stats(fib, NULL) < 0,
+		"Call succeeded with invalid parameters\n");
+
+	rte_fib_vrf_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that the tbl8 groups are shared by all the VRFs
+ */
+int32_t
+test_shared_tbl8(void)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_4B,
+		.default_nh = DEF_NH,
+		.max_vrfs = MAX_VRFS,
+		.max_routes = MAX_ROUTES,
+		/* 3 levels of tbl8s below the root of a small VRF per /32 */
+		.num_tbl8 = 3 * 8,
+	};
+	struct rte_fib_vrf_stats stats;
+	uint32_t ip = RTE_IPV4(10, 1, 2, 3);
+	uint16_t vrf_ids[2];
+	uint32_t ips[2];
+	uint64_t nhs[2];
+	uint16_t vrf;
+	int ret;
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (vrf = 0; vrf < 8; vrf++) {
+		ret = rte_fib_vrf_add(fib, vrf, ip, 32, vrf);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	ret = rte_fib_vrf_add(fib, 8, ip, 32, 8);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route with all the tbl8s in use\n");
+
+	rte_fib_vrf_get_stats(fib, &stats);
+	RTE_TEST_ASSERT((stats.nb_routes == 8) && (stats.used_tbl8s == 24) &&
+		(stats.nb_large_vrfs == 0), "Unexpected FIB usage\n");
+
+	/* the tbl8s freed by a VRF are used by another one */
+	ret = rte_fib_vrf_delete(fib, 3, ip, 32);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_vrf_add(fib, 8, ip, 32, 8);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	vrf_ids[0] = 3;
+	vrf_ids[1] = 8;
+	ips[0] = ip;
+	ips[1] = ip;
+	rte_fib_vrf_lookup_bulk(fib, vrf_ids, ips, nhs, 2);
+	RTE_TEST_ASSERT((nhs[0] == DEF_NH) && (nhs[1] == 8),
+		"Failed to get proper nexthop\n");
+
+	for (vrf = 0; vrf <= 8; vrf++)
+		rte_fib_vrf_delete(fib, vrf, ip, 32);
+	rte_fib_vrf_get_stats(fib, &stats);
+	RTE_TEST_ASSERT((stats.nb_routes == 0) && (stats.used_tbl8s == 0),
+		"tbl8s not freed\n");
+
+	rte_fib_vrf_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that a route needing more tbl8s than free is refused without
+ * modifying the FIB, when added, deleted or given another next hop
+ */
+int32_t
+test_tbl8_exhausted(void)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_4B,
+		.default_nh = DEF_NH,
+		.max_vrfs = MAX_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = 3,
+	};
+	uint16_t vrf_ids[3] = { 0, 0, 0 };
+	uint32_t ips[3] = {
+		RTE_IPV4(10, 0, 0, 1), RTE_IPV4(10, 200, 0, 1),
+		RTE_IPV4(11, 2, 0, 1)
+	};
+	uint64_t nhs[3];
+	int ret;
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* the /16 with the same next hop as the /7 is not written */
+	ret = rte_fib_vrf_add(fib, 0, RTE_IPV4(10, 0, 0, 0), 7, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_vrf_add(fib, 0, RTE_IPV4(11, 1, 0, 0), 16, 5);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_vrf_add(fib, 0, RTE_IPV4(10, 200, 0, 0), 16, 7);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_vrf_add(fib, 1, RTE_IPV4(10, 1, 2, 0), 24, 8);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_vrf_add(fib, 2, RTE_IPV4(10, 1, 0, 0), 16, 9);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route with all the tbl8s in use\n");
+
+	/* the addresses of the /7 left in 10/8 are written first, then
+	 * 11/8 needs a tbl8 for the hole of the /16
+	 */
+	ret = rte_fib_vrf_delete(fib, 0, RTE_IPV4(10, 0, 0, 0), 7);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Deleted a route with all the tbl8s in use\n");
+	ret = rte_fib_vrf_add(fib, 0, RTE_IPV4(10, 0, 0, 0), 7, 6);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Changed a route with all the tbl8s in use\n");
+	rte_fib_vrf_lookup_bulk(fib, vrf_ids, ips, nhs, 3);
+	RTE_TEST_ASSERT((nhs[0] == 5) && (nhs[1] == 7) && (nhs[2] == 5),
+		"FIB modified by a failed operation\n");
+
+	ret = rte_fib_vrf_delete(fib, 1, RTE_IPV4(10, 1, 2, 0), 24);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_vrf_delete(fib, 0, RTE_IPV4(10, 0, 0, 0), 7);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	rte_fib_vrf_lookup_bulk(fib, vrf_ids, ips, nhs, 3);
+	RTE_TEST_ASSERT((nhs[0] == DEF_NH) && (nhs[1] == 7) &&
+		(nhs[2] == DEF_NH), "Failed to get proper nexthop\n");
+
+	rte_fib_vrf_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define LOOKUP_NB_VRFS		4
+#define LOOKUP_NB_ROUTES	2048
+#define LOOKUP_LARGE_ROUTES	1024
+#define LOOKUP_BURST		64
+
+struct lookup_route {
+	uint16_t vrf;
+	uint32_t ip;
+	uint8_t depth;
+	uint64_t nh;
+};
+
+static struct lookup_route lookup_routes[LOOKUP_NB_VRFS * LOOKUP_NB_ROUTES];
+
+/*
+ * Check the lookups in all the VRFs against one RIB based FIB per VRF
+ * at the edges of each route and at random addresses.
+ */
+static int
+lookup_compare(struct rte_fib_vrf *fib, struct rte_fib **ref,
+	uint32_t nb_routes)
+{
+	uint16_t vrf_ids[LOOKUP_BURST];
+	uint32_t ips[LOOKUP_BURST];
+	uint64_t nhs[LOOKUP_BURST];
+	uint64_t ref_nh;
+	uint32_t i, j, k, n = 0;
+	uint32_t last;
+
+	for (i = 0; i < nb_routes; i++) {
+		last = lookup_routes[i].ip |
+			~rte_rib_depth_to_mask(lookup_routes[i].depth);
+		for (j = 0; j < 5; j++) {
+			vrf_ids[n] = lookup_routes[i].vrf;
+			switch (j) {
+			case 0:
+				ips[n] = lookup_routes[i].ip;
+				break;
+			case 1:
+				ips[n] = last;
+				break;
+			case 2:
+				ips[n] = lookup_routes[i].ip - 1;
+				break;
+			case 3:
+				ips[n] = last + 1;
+				break;
+			default:
+				vrf_ids[n] = rte_rand_max(LOOKUP_NB_VRFS);
+				ips[n] = rte_rand();
+				break;
+			}
+			if (++n < LOOKUP_BURST && !(i == nb_routes - 1 &&
+					j == 4))
+				continue;
+			rte_fib_vrf_lookup_bulk(fib, vrf_ids, ips, nhs, n);
+			for (k = 0; k < n; k++) {
+				rte_fib_lookup_bulk(ref[vrf_ids[k]], &ips[k],
+					&ref_nh, 1);
+				RTE_TEST_ASSERT(nhs[k] == ref_nh,
+					"Lookup mismatch in VRF %u for "
+					"0x%08x\n", vrf_ids[k], ips[k]);
+			}
+			n = 0;
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Add routes to several VRFs, one getting its own tbl24, and check
+ * the lookups while adding, replacing and deleting them.
+ */
+int32_t
+test_lookup(void)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_fib *ref[LOOKUP_NB_VRFS] = { NULL };
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_2B,
+		.default_nh = DEF_NH,
+		.max_vrfs = LOOKUP_NB_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = (1 << 14),
+		.max_large_vrfs = 1,
+		.large_vrf_routes = LOOKUP_LARGE_ROUTES,
+	};
+	struct rte_fib_conf ref_config = {
+		.type = RTE_FIB_DUMMY,
+		.default_nh = DEF_NH,
+		.max_routes = MAX_ROUTES,
+	};
+	struct rte_fib_vrf_stats stats;
+	char name[64];
+	struct lookup_route *rt;
+	uint32_t i, nb, nb_routes = 0;
+	int ret = TEST_FAILED;
+	uint16_t vrf;
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	for (vrf = 0; vrf < LOOKUP_NB_VRFS; vrf++) {
+		snprintf(name, sizeof(name), "%s_ref%u", __func__, vrf);
+		ref[vrf] = rte_fib_create(name, SOCKET_ID_ANY, &ref_config);
+		if (ref[vrf] == NULL) {
+			printf("Failed to create the reference FIB\n");
+			goto out;
+		}
+	}
+
+	/* VRF 0 and 1 go beyond the large VRF threshold, 2 and 3 do not */
+	for (vrf = 0; vrf < LOOKUP_NB_VRFS; vrf++) {
+		nb = (vrf < 2) ? LOOKUP_NB_ROUTES : LOOKUP_LARGE_ROUTES / 4;
+		for (i = 0; i < nb; i++) {
+			rt = &lookup_routes[nb_routes];
+			rt->vrf = vrf;
+			/* nest the routes in a few networks */
+			rt->depth = rte_rand_max(RTE_FIB_MAXDEPTH + 1);
+			rt->ip = (RTE_IPV4(10 * (i % 4), 0, 0, 0) |
+				(rte_rand() & 0xffffff)) &
+				rte_rib_depth_to_mask(rt->depth);
+			rt->nh = rte_rand_max(DEF_NH);
+			if (rte_fib_vrf_add(fib, vrf, rt->ip, rt->depth,
+					rt->nh) != 0 ||
+					rte_fib_add(ref[vrf], rt->ip, rt->depth,
+					rt->nh) != 0) {
+				printf("Failed to add a route\n");
+				goto out;
+			}
+			nb_routes++;
+		}
+		if (lookup_compare(fib, ref, nb_routes) != TEST_SUCCESS)
+			goto out;
+	}
+
+	rte_fib_vrf_get_stats(fib, &stats);
+	if (stats.nb_large_vrfs != 1) {
+		printf("Unexpected number of large VRFs %u\n",
+			stats.nb_large_vrfs);
+		goto out;
+	}
+
+	/* replace the next hop of half of the routes */
+	for (i = 0; i < nb_routes; i += 2) {
+		rt = &lookup_routes[i];
+		rt->nh = rte_rand_max(DEF_NH);
+		if (rte_fib_vrf_add(fib, rt->vrf, rt->ip, rt->depth,
+				rt->nh) != 0 ||
+				rte_fib_add(ref[rt->vrf], rt->ip, rt->depth,
+				rt->nh) != 0) {
+			printf("Failed to replace a route\n");
+			goto out;
+		}
+	}
+	if (lookup_compare(fib, ref, nb_routes) != TEST_SUCCESS)
+		goto out;
+
+	/* delete all the routes, the same prefix may appear twice */
+	for (i = 0; i < nb_routes; i++) {
+		rt = &lookup_routes[i];
+		rte_fib_vrf_delete(fib, rt->vrf, rt->ip, rt->depth);
+		rte_fib_delete(ref[rt->vrf], rt->ip, rt->depth);
+		if ((i % (nb_routes / 8) == 0) &&
+				(lookup_compare(fib, ref, nb_routes) !=
+				TEST_SUCCESS))
+			goto out;
+	}
+	if (lookup_compare(fib, ref, nb_routes) != TEST_SUCCESS)
+		goto out;
+
+	rte_fib_vrf_get_stats(fib, &stats);
+	if ((stats.nb_routes != 0) || (stats.used_tbl8s != 0)) {
+		printf("Routes or tbl8s left: %u %u\n", stats.nb_routes,
+			stats.used_tbl8s);
+		goto out;
+	}
+	ret = TEST_SUCCESS;
+
+out:
+	for (vrf = 0; vrf < LOOKUP_NB_VRFS; vrf++)
+		rte_fib_free(ref[vrf]);
+	rte_fib_vrf_free(fib);
+
+	return ret;
+}
+
+#define RCU_NB_VRFS	8
+#define RCU_LARGE_ROUTES	4
+/* a /32 per small VRF, and the tbl24 of VRF 0 with a tbl8 per route */
+#define RCU_NB_TBL8	(3 * RCU_NB_VRFS + RCU_LARGE_ROUTES)
+#define RCU_NH		100
+#define RCU_DEF_NH	10
+#define RCU_ITERATIONS	200
+
+static struct rte_fib_vrf *rcu_fib;
+static struct rte_rcu_qsbr *rcu_qsv;
+static volatile uint8_t rcu_writer_done;
+
+/* VRF 0 gets RCU_LARGE_ROUTES routes, the other VRFs one */
+static uint32_t
+rcu_ip(uint32_t i)
+{
+	return RTE_IPV4(10, 0, i, 1);
+}
+
+/* readers only see the default or the route next hop, never a freed tbl8 */
+static int
+rcu_reader(void *arg)
+{
+	uint16_t vrf_ids[(RCU_NB_VRFS + RCU_LARGE_ROUTES) * 2];
+	uint32_t ips[RTE_DIM(vrf_ids)];
+	uint64_t nh[RTE_DIM(vrf_ids)];
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t i;
+	int ret = 0;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < RTE_DIM(vrf_ids) / 2; i++) {
+		vrf_ids[2 * i] = (i < RCU_NB_VRFS) ? i : 0;
+		vrf_ids[2 * i + 1] = vrf_ids[2 * i];
+		ips[2 * i] = rcu_ip((i < RCU_NB_VRFS) ? i : i - RCU_NB_VRFS);
+		ips[2 * i + 1] = ips[2 * i] + 1;
+	}
+
+	rte_rcu_qsbr_thread_register(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_online(rcu_qsv, lcore_id);
+	while (!rcu_writer_done && ret == 0) {
+		rte_fib_vrf_lookup_bulk(rcu_fib, vrf_ids, ips, nh,
+			RTE_DIM(ips));
+		for (i = 0; i < RTE_DIM(ips); i++)
+			if (nh[i] != RCU_DEF_NH && nh[i] != RCU_NH)
+				ret = -1;
+		rte_rcu_qsbr_quiescent(rcu_qsv, lcore_id);
+	}
+	rte_rcu_qsbr_thread_offline(rcu_qsv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(rcu_qsv, lcore_id);
+
+	return ret;
+}
+
+static int
+rcu_churn(enum rte_fib_qsbr_mode mode)
+{
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_4B,
+		.default_nh = RCU_DEF_NH,
+		.max_vrfs = RCU_NB_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = RCU_NB_TBL8,
+		.max_large_vrfs = 1,
+		.large_vrf_routes = RCU_LARGE_ROUTES,
+	};
+	struct rte_fib_vrf_stats stats;
+	unsigned int lcore_id;
+	uint32_t i, j;
+	int ret = 0;
+
+	rcu_qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(rcu_qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(rcu_qsv, RTE_MAX_LCORE);
+
+	rcu_fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rcu_fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.v = rcu_qsv;
+	rcu_cfg.mode = mode;
+	RTE_TEST_ASSERT(rte_fib_vrf_rcu_qsbr_add(rcu_fib, &rcu_cfg) == 0,
+		"Failed to add RCU QSBR variable\n");
+
+	rcu_writer_done = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(rcu_reader, NULL, lcore_id);
+
+	/* VRF 0 gets a tbl24 while it is looked up */
+	for (i = 0; i < RCU_LARGE_ROUTES; i++)
+		if (rte_fib_vrf_add(rcu_fib, 0, rcu_ip(i), 32, RCU_NH) != 0)
+			ret = -1;
+	rte_fib_vrf_get_stats(rcu_fib, &stats);
+	if (stats.nb_large_vrfs != 1)
+		ret = -1;
+
+	/* every iteration needs all the tbl8s freed by the previous one */
+	for (i = 0; i < RCU_ITERATIONS && ret == 0; i++) {
+		for (j = 1; j < RCU_NB_VRFS; j++)
+			if (rte_fib_vrf_add(rcu_fib, j, rcu_ip(j), 32,
+					RCU_NH) != 0)
+				ret = -1;
+		for (j = 1; j < RCU_NB_VRFS; j++)
+			if (rte_fib_vrf_delete(rcu_fib, j, rcu_ip(j), 32) != 0)
+				ret = -1;
+	}
+
+	rcu_writer_done = 1;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+
+	rte_fib_vrf_free(rcu_fib);
+	rte_free(rcu_qsv);
+
+	return ret;
+}
+
+/*
+ * Check the association of a RCU QSBR variable, and churn routes needing
+ * all the tbl8s while lookup threads are running
+ */
+int32_t
+test_rcu(void)
+{
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_fib_vrf_conf config = {
+		.nh_sz = RTE_FIB_DIR24_8_4B,
+		.default_nh = DEF_NH,
+		.max_vrfs = MAX_VRFS,
+		.max_routes = MAX_ROUTES,
+		.num_tbl8 = MAX_TBL8,
+	};
+	struct rte_fib_vrf *fib;
+	struct rte_rcu_qsbr *qsv;
+	int32_t status;
+
+	qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rcu_cfg.v = qsv;
+	status = rte_fib_vrf_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = NULL;
+	status = rte_fib_vrf_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC + 1;
+	status = rte_fib_vrf_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	status = rte_fib_vrf_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Failed to add RCU QSBR variable\n");
+	status = rte_fib_vrf_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EEXIST,
+		"RCU QSBR variable added twice\n");
+	rte_fib_vrf_free(fib);
+	rte_free(qsv);
+
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB_QSBR_MODE_DQ) == 0,
+		"Route churn failed in defer queue mode\n");
+	RTE_TEST_ASSERT(rcu_churn(RTE_FIB_QSBR_MODE_SYNC) == 0,
+		"Route churn failed in blocking mode\n");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib_vrf_tests = {
+	.suite_name = "fib vrf autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_add_del_invalid),
+	TEST_CASE(test_shared_tbl8),
+	TEST_CASE(test_tbl8_exhausted),
+	TEST_CASE(test_lookup),
+	TEST_CASE(test_rcu),
+	TEST_CASES_END()
+	}
+};
+
+static int
+test_fib_vrf(void)
+{
+	return unit_test_suite_runner(&fib_vrf_tests);
+}
+
+REGISTER_TEST_COMMAND(fib_vrf_autotest, test_fib_vrf);
@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+#include <rte_fib_vrf.h>
+
+#include "test.h"
+
+#define TEST_FIB_ASSERT(cond) do {				\
+	if (!(cond)) {						\
+		printf("Error at line %d:\n", __LINE__);	\
+		return -1;					\
+	}                                                       \
+} while (0)
+
+#define ITERATIONS (1 << 8)
+#define BATCH_SIZE (1 << 12)
+#define BULK_SIZE 32
+
+#define NB_LARGE_VRFS	2
+#define NB_LARGE_ROUTES	(1 << 17)
+#define NB_SMALL_VRFS	1024
+#define NB_SMALL_ROUTES	16
+
+struct route_rule {
+	uint32_t ip;
+	uint8_t depth;
+};
+
+static struct route_rule large_routes[NB_LARGE_ROUTES];
+static uint32_t ip_batch[BATCH_SIZE];
+static uint16_t vrf_batch[BATCH_SIZE];
+
+/* Mostly /24 routes, with some shorter and some longer ones */
+static void
+generate_route(struct route_rule *rt)
+{
+	uint32_t r = rte_rand_max(100);
+
+	if (r < 5)
+		rt->depth = 8 + rte_rand_max(8);
+	else if (r < 25)
+		rt->depth = 16 + rte_rand_max(8);
+	else if (r < 85)
+		rt->depth = 24;
+	else
+		rt->depth = 25 + rte_rand_max(8);
+	rt->ip = (uint32_t)rte_rand() & rte_rib_depth_to_mask(rt->depth);
+}
+
+static double
+fib_lookup_cycles(struct rte_fib *fib)
+{
+	uint64_t next_hops[BULK_SIZE];
+	uint64_t begin, total_time = 0;
+	unsigned int i, j;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE)
+			rte_fib_lookup_bulk(fib, &ip_batch[j], next_hops,
+				BULK_SIZE);
+		total_time += rte_rdtsc() - begin;
+	}
+
+	return (double)total_time / ((double)ITERATIONS * BATCH_SIZE);
+}
+
+static double
+fib_vrf_lookup_cycles(struct rte_fib_vrf *fib, uint16_t first_vrf,
+	uint16_t nb_vrfs)
+{
+	uint64_t next_hops[BULK_SIZE];
+	uint64_t begin, total_time = 0;
+	unsigned int i, j;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		for (j = 0; j < BATCH_SIZE; j++) {
+			ip_batch[j] = rte_rand();
+			vrf_batch[j] = first_vrf + rte_rand_max(nb_vrfs);
+		}
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE)
+			rte_fib_vrf_lookup_bulk(fib, &vrf_batch[j],
+				&ip_batch[j], next_hops, BULK_SIZE);
+		total_time += rte_rdtsc() - begin;
+	}
+
+	return (double)total_time / ((double)ITERATIONS * BATCH_SIZE);
+}
+
+static int
+test_fib_vrf_perf(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_vrf *fib_vrf = NULL;
+	struct rte_fib_conf config = {
+		.type = RTE_FIB_DIR24_8,
+		.default_nh = 0,
+		.max_routes = NB_LARGE_ROUTES,
+		.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B,
+		.dir24_8.num_tbl8 = 1 << 15,
+	};
+	struct rte_fib_vrf_conf vrf_config = {
+		.nh_sz = RTE_FIB_DIR24_8_4B,
+		.default_nh = 0,
+		.max_vrfs = NB_LARGE_VRFS + NB_SMALL_VRFS,
+		.max_routes = NB_LARGE_VRFS * NB_LARGE_ROUTES +
+			NB_SMALL_VRFS * NB_SMALL_ROUTES,
+		.num_tbl8 = 1 << 17,
+		.max_large_vrfs = NB_LARGE_VRFS,
+		.large_vrf_routes = NB_LARGE_ROUTES / 2,
+	};
+	struct rte_fib_vrf_stats stats;
+	struct route_rule rt;
+	uint64_t begin, total_time;
+	unsigned int i, j;
+	uint16_t vrf;
+
+	rte_srand(rte_rdtsc());
+
+	for (i = 0; i < NB_LARGE_ROUTES; i++)
+		generate_route(&large_routes[i]);
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_FIB_ASSERT(fib != NULL);
+	fib_vrf = rte_fib_vrf_create("perf_vrf", SOCKET_ID_ANY, &vrf_config);
+	TEST_FIB_ASSERT(fib_vrf != NULL);
+
+	for (i = 0; i < NB_LARGE_ROUTES; i++)
+		rte_fib_add(fib, large_routes[i].ip, large_routes[i].depth,
+			i + 1);
+
+	/* the same routes in each large VRF */
+	begin = rte_rdtsc();
+	for (vrf = 0; vrf < NB_LARGE_VRFS; vrf++)
+		for (i = 0; i < NB_LARGE_ROUTES; i++)
+			rte_fib_vrf_add(fib_vrf, vrf, large_routes[i].ip,
+				large_routes[i].depth, i + 1);
+	total_time = rte_rdtsc() - begin;
+	printf("Average FIB VRF Add to large VRFs: %g cycles\n",
+		(double)total_time / (NB_LARGE_VRFS * NB_LARGE_ROUTES));
+
+	begin = rte_rdtsc();
+	for (vrf = NB_LARGE_VRFS; vrf < NB_LARGE_VRFS + NB_SMALL_VRFS;
+			vrf++) {
+		for (j = 0; j < NB_SMALL_ROUTES; j++) {
+			generate_route(&rt);
+			rte_fib_vrf_add(fib_vrf, vrf, rt.ip, rt.depth, j + 1);
+		}
+	}
+	total_time = rte_rdtsc() - begin;
+	printf("Average FIB VRF Add to small VRFs: %g cycles\n",
+		(double)total_time / (NB_SMALL_VRFS * NB_SMALL_ROUTES));
+
+	rte_fib_vrf_get_stats(fib_vrf, &stats);
+	printf("%u routes, %u large VRFs, %u tbl8s in use\n",
+		stats.nb_routes, stats.nb_large_vrfs, stats.used_tbl8s);
+	TEST_FIB_ASSERT(stats.nb_large_vrfs == NB_LARGE_VRFS);
+
+	printf("BULK FIB Lookup: %.1f cycles\n", fib_lookup_cycles(fib));
+	printf("BULK FIB VRF Lookup, one large VRF: %.1f cycles\n",
+		fib_vrf_lookup_cycles(fib_vrf, 0, 1));
+	printf("BULK FIB VRF Lookup, %u large VRFs: %.1f cycles\n",
+		NB_LARGE_VRFS, fib_vrf_lookup_cycles(fib_vrf, 0,
+		NB_LARGE_VRFS));
+	printf("BULK FIB VRF Lookup, %u small VRFs: %.1f cycles\n",
+		NB_SMALL_VRFS, fib_vrf_lookup_cycles(fib_vrf, NB_LARGE_VRFS,
+		NB_SMALL_VRFS));
+
+	rte_fib_vrf_free(fib_vrf);
+	rte_fib_free(fib);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(fib_vrf_perf_autotest, test_fib_vrf_perf);
@@ -18,6 +18,7 @@
 #include <rte_eal.h>
 #include <rte_ip.h>
 #include <rte_string_fns.h>
+#include <rte_vect.h>
 
 #include "test.h"
 
@@ -2174,6 +2175,561 @@ test_hash_rcu_qsbr_sync_mode(uint8_t ext_bkt)
 
 }
 
+/*
+ * Bulk lookups find the same keys whatever the SIMD width of the signature
+ * compare, with the locked and lock-free readers.
+ */
+static int
+test_hash_bulk_lookup_width(uint16_t bitwidth, uint8_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_bulk_simd",
+		.entries = 1024,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+		.extra_flag = extra_flag,
+	};
+	/* odd bulk, to check the last key of the vector compare */
+	const unsigned int nb_keys = RTE_HASH_LOOKUP_BULK_MAX - 1;
+	uint32_t keys[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash *handle;
+	uint64_t hit_mask;
+	uint32_t key, i;
+	int32_t pos;
+	int ret;
+
+	for (i = 0; i < nb_keys; i++) {
+		keys[i] = i * 13;
+		key_ptrs[i] = &keys[i];
+	}
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	/* one key out of two of the bulk is in the table */
+	for (i = 0; i < 512; i++) {
+		key = i * 26;
+		ret = rte_hash_add_key_data(handle, &key,
+			(void *)(uintptr_t)(i + 1));
+		RETURN_IF_ERROR(ret < 0, "failed to add key %u", key);
+	}
+
+	ret = rte_hash_lookup_bulk(handle, key_ptrs, nb_keys, positions);
+	RETURN_IF_ERROR(ret != 0, "bulk lookup failed");
+	for (i = 0; i < nb_keys; i++) {
+		pos = rte_hash_lookup(handle, &keys[i]);
+		RETURN_IF_ERROR(positions[i] != pos ||
+			(pos >= 0) != (i % 2 == 0),
+			"wrong position %d of key %u with %u bits",
+			positions[i], keys[i], bitwidth);
+	}
+
+	ret = rte_hash_lookup_bulk_data(handle, key_ptrs, nb_keys, &hit_mask,
+		data);
+	RETURN_IF_ERROR(ret != (int)(nb_keys + 1) / 2,
+		"%d keys found with %u bits", ret, bitwidth);
+	for (i = 0; i < nb_keys; i += 2)
+		RETURN_IF_ERROR((hit_mask & (1ULL << i)) == 0 ||
+			data[i] != (void *)(uintptr_t)(i / 2 + 1),
+			"wrong data of key %u with %u bits", keys[i], bitwidth);
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+static int
+test_hash_bulk_lookup_simd(void)
+{
+	static const uint16_t bitwidths[] = {
+		RTE_VECT_SIMD_128, RTE_VECT_SIMD_256, RTE_VECT_SIMD_512,
+	};
+	uint16_t max_bitwidth = rte_vect_get_max_simd_bitwidth();
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < RTE_DIM(bitwidths) && ret == 0; i++) {
+		/* the bitwidth cannot be changed if set on command line */
+		if (rte_vect_set_max_simd_bitwidth(bitwidths[i]) != 0)
+			return 0;
+		ret = test_hash_bulk_lookup_width(bitwidths[i], 0);
+		if (ret == 0)
+			ret = test_hash_bulk_lookup_width(bitwidths[i],
+				RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF);
+	}
+
+	rte_vect_set_max_simd_bitwidth(max_bitwidth);
+	return ret;
+}
+
+#define RESIZE_INIT_ENTRIES	64
+#define RESIZE_NB_KEYS		4096
+#define RESIZE_READER_KEYS	(RESIZE_INIT_ENTRIES / 2)
+
+static uint32_t
+resize_key(uint32_t i)
+{
+	return i * 7 + 1;
+}
+
+/*
+ * Resizable table: the keys added beyond the initial size are found by
+ * all the lookup functions, while their buckets are migrated and after.
+ */
+static int
+test_hash_resize(uint8_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resize",
+		.entries = RESIZE_INIT_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZE | extra_flag,
+	};
+	uint32_t keys[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash *handle;
+	const void *next_key;
+	void *next_data, *data;
+	uint32_t i, j, key, iter = 0, nb_iter = 0;
+	int32_t pos;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < RESIZE_NB_KEYS; i++) {
+		key = resize_key(i);
+		ret = rte_hash_add_key_data(handle, &key,
+			(void *)(uintptr_t)(i + 1));
+		RETURN_IF_ERROR(ret != 0, "failed to add key %u", i);
+		if (i % 256 != 255)
+			continue;
+		for (j = 0; j <= i; j++) {
+			key = resize_key(j);
+			ret = rte_hash_lookup_data(handle, &key, &data);
+			RETURN_IF_ERROR(ret < 0 ||
+				data != (void *)(uintptr_t)(j + 1),
+				"key %u not found after %u adds", j, i + 1);
+		}
+	}
+	RETURN_IF_ERROR(rte_hash_max_key_id(handle) < RESIZE_NB_KEYS,
+		"table not resized");
+	RETURN_IF_ERROR(rte_hash_count(handle) != RESIZE_NB_KEYS,
+		"wrong count %d", rte_hash_count(handle));
+
+	for (i = 0; i < RESIZE_NB_KEYS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			keys[j] = resize_key(i + j);
+			key_ptrs[j] = &keys[j];
+		}
+		ret = rte_hash_lookup_bulk(handle, key_ptrs,
+			RTE_HASH_LOOKUP_BULK_MAX, positions);
+		RETURN_IF_ERROR(ret != 0, "bulk lookup failed");
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			pos = rte_hash_lookup(handle, &keys[j]);
+			RETURN_IF_ERROR(pos < 0 || positions[j] != pos,
+				"wrong bulk position of key %u", i + j);
+		}
+	}
+
+	while (rte_hash_iterate(handle, &next_key, &next_data, &iter) >= 0)
+		nb_iter++;
+	RETURN_IF_ERROR(nb_iter != RESIZE_NB_KEYS, "%u keys iterated",
+		nb_iter);
+
+	for (i = 1; i < RESIZE_NB_KEYS; i += 2) {
+		key = resize_key(i);
+		pos = rte_hash_del_key(handle, &key);
+		RETURN_IF_ERROR(pos < 0, "failed to delete key %u", i);
+		if (extra_flag & RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+			rte_hash_free_key_with_position(handle, pos);
+	}
+	for (i = 0; i < RESIZE_NB_KEYS; i++) {
+		key = resize_key(i);
+		pos = rte_hash_lookup(handle, &key);
+		RETURN_IF_ERROR((pos >= 0) != (i % 2 == 0),
+			"wrong lookup of key %u after deletes", i);
+	}
+
+	rte_hash_free(handle);
+
+	/* keys are migrated by a single writer, without ext buckets */
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZE |
+				RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle != NULL, "resize with ext table accepted");
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZE |
+				RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle != NULL, "resize with multi writer accepted");
+
+	return 0;
+}
+
+/* Signature unrelated to the hash function of the table */
+static hash_sig_t
+resize_sig(uint32_t i)
+{
+	return i * 0x9e3779b9;
+}
+
+/*
+ * Resizable table: the keys added with their own signature are migrated
+ * with it, and found with it while and after their buckets are migrated.
+ */
+static int
+test_hash_resize_with_hash(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resize_with_hash",
+		.entries = RESIZE_INIT_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZE,
+	};
+	struct rte_hash *handle;
+	uint32_t i, j, key;
+	void *data;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < RESIZE_NB_KEYS; i++) {
+		key = resize_key(i);
+		ret = rte_hash_add_key_with_hash_data(handle, &key,
+			resize_sig(i), (void *)(uintptr_t)(i + 1));
+		RETURN_IF_ERROR(ret != 0, "failed to add key %u", i);
+		if (i % 256 != 255)
+			continue;
+		for (j = 0; j <= i; j++) {
+			key = resize_key(j);
+			ret = rte_hash_lookup_with_hash_data(handle, &key,
+				resize_sig(j), &data);
+			RETURN_IF_ERROR(ret < 0 ||
+				data != (void *)(uintptr_t)(j + 1),
+				"key %u not found after %u adds", j, i + 1);
+		}
+	}
+	RETURN_IF_ERROR(rte_hash_max_key_id(handle) < RESIZE_NB_KEYS,
+		"table not resized");
+
+	for (i = 0; i < RESIZE_NB_KEYS; i += 2) {
+		key = resize_key(i);
+		ret = rte_hash_del_key_with_hash(handle, &key, resize_sig(i));
+		RETURN_IF_ERROR(ret < 0, "failed to delete key %u", i);
+	}
+	for (i = 0; i < RESIZE_NB_KEYS; i++) {
+		key = resize_key(i);
+		ret = rte_hash_lookup_with_hash(handle, &key, resize_sig(i));
+		RETURN_IF_ERROR((ret >= 0) != (i % 2 == 1),
+			"wrong lookup of key %u after deletes", i);
+	}
+
+	rte_hash_free(handle);
+
+	return 0;
+}
+
+/*
+ * Lock-free reader looking up the first keys of a resizable table.
+ */
+static int
+test_hash_resize_reader(void *arg)
+{
+	uint32_t keys[RESIZE_READER_KEYS];
+	const void *key_ptrs[RESIZE_READER_KEYS];
+	uint64_t hit_mask;
+	void *data[RESIZE_READER_KEYS];
+	unsigned int misses = 0;
+	uint32_t i;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < RESIZE_READER_KEYS; i++) {
+		keys[i] = resize_key(i);
+		key_ptrs[i] = &keys[i];
+	}
+
+	(void)rte_rcu_qsbr_thread_register(g_qsv, 0);
+	rte_rcu_qsbr_thread_online(g_qsv, 0);
+
+	do {
+		for (i = 0; i < RESIZE_READER_KEYS; i++)
+			if (rte_hash_lookup(g_handle, &keys[i]) < 0)
+				misses++;
+		if (rte_hash_lookup_bulk_data(g_handle, key_ptrs,
+				RESIZE_READER_KEYS, &hit_mask, data) !=
+				RESIZE_READER_KEYS)
+			misses++;
+
+		/* Update quiescent state */
+		rte_rcu_qsbr_quiescent(g_qsv, 0);
+	} while (!writer_done);
+
+	rte_rcu_qsbr_thread_offline(g_qsv, 0);
+	(void)rte_rcu_qsbr_thread_unregister(g_qsv, 0);
+
+	return misses == 0 ? 0 : -1;
+}
+
+/*
+ * Resizable lock-free table with RCU: a reader keeps finding the keys
+ * while the writer grows the table many times.
+ */
+static int
+test_hash_resize_rcu(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resize_rcu",
+		.entries = RESIZE_INIT_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZE |
+				RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	struct rte_hash_rcu_config rcu_cfg = {0};
+	unsigned int reader_lcore;
+	uint32_t i, key;
+	int32_t status;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the resize RCU test\n");
+		return 0;
+	}
+
+	g_qsv = NULL;
+	writer_done = 0;
+	g_handle = rte_hash_create(&params);
+	RETURN_IF_ERROR_RCU_QSBR(g_handle == NULL, "Hash creation failed");
+
+	g_qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+			RTE_CACHE_LINE_SIZE);
+	RETURN_IF_ERROR_RCU_QSBR(g_qsv == NULL,
+				 "RCU QSBR variable creation failed");
+	status = rte_rcu_qsbr_init(g_qsv, RTE_MAX_LCORE);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				 "RCU QSBR variable initialization failed");
+
+	rcu_cfg.v = g_qsv;
+	rcu_cfg.mode = RTE_HASH_QSBR_MODE_SYNC;
+	status = rte_hash_rcu_qsbr_add(g_handle, &rcu_cfg);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				 "Attach RCU QSBR to hash table failed");
+
+	for (i = 0; i < RESIZE_READER_KEYS; i++) {
+		key = resize_key(i);
+		status = rte_hash_add_key(g_handle, &key);
+		RETURN_IF_ERROR_RCU_QSBR(status < 0, "failed to add key %u",
+					 i);
+	}
+
+	reader_lcore = rte_get_next_lcore(-1, 1, 0);
+	rte_eal_remote_launch(test_hash_resize_reader, NULL, reader_lcore);
+
+	for (i = RESIZE_READER_KEYS; i < RESIZE_NB_KEYS; i++) {
+		key = resize_key(i);
+		status = rte_hash_add_key(g_handle, &key);
+		RETURN_IF_ERROR_RCU_QSBR(status < 0, "failed to add key %u",
+					 i);
+		/* delete some keys to recycle their slots */
+		if (i % 16 == 0) {
+			status = rte_hash_del_key(g_handle, &key);
+			RETURN_IF_ERROR_RCU_QSBR(status < 0,
+					 "failed to delete key %u", i);
+		}
+	}
+
+	writer_done = 1;
+	status = rte_eal_wait_lcore(reader_lcore);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				 "reader missed keys during the resizes");
+	RETURN_IF_ERROR_RCU_QSBR(rte_hash_max_key_id(g_handle) <
+				 RESIZE_NB_KEYS, "table not resized");
+
+	rte_hash_free(g_handle);
+	rte_free(g_qsv);
+
+	return 0;
+}
+
+#define AGING_ENTRIES	1024
+#define AGING_NB_KEYS	256
+
+/*
+ * Sweep a part of the table and check the expired keys are the odd ones.
+ * The extra buckets are the extendable buckets or the old buckets of a
+ * resize, whose number is only bounded when dup is set: the sweep wraps
+ * around and the keys can be returned again.
+ */
+static int
+test_hash_aging_sweep(struct rte_hash *handle, uint16_t part,
+		uint16_t nb_parts, uint32_t nb_main, uint32_t nb_extra,
+		uint64_t expiry, uint8_t *expired, int dup)
+{
+	struct rte_hash_expire_cursor cursor = {
+		.part = part,
+		.nb_parts = nb_parts,
+	};
+	const void *keys[AGING_NB_KEYS];
+	void *data[AGING_NB_KEYS];
+	/* buckets of the part */
+	uint32_t nb_buckets = (nb_main - part + nb_parts - 1) / nb_parts +
+			(nb_extra - part + nb_parts - 1) / nb_parts;
+	uint32_t key;
+	int i, ret;
+
+	/* visit all the buckets of the part 4 by 4 */
+	while (nb_buckets > 0) {
+		ret = rte_hash_expire(handle, &cursor, RTE_MIN(nb_buckets, 4u),
+			expiry, keys, data, RTE_DIM(keys));
+		if (ret < 0)
+			return -1;
+		for (i = 0; i < ret; i++) {
+			key = *(const uint32_t *)keys[i];
+			if (key >= AGING_NB_KEYS || key % 2 == 0 ||
+					(expired[key] != 0 && !dup) ||
+					data[i] != (void *)(uintptr_t)(key + 1)) {
+				printf("Wrong expired key %u\n", key);
+				return -1;
+			}
+			expired[key] = 1;
+		}
+		nb_buckets -= RTE_MIN(nb_buckets, 4u);
+	}
+
+	return 0;
+}
+
+/*
+ * Entries not refreshed by lookup_touch are returned by the expiry sweep,
+ * with the whole table or split in parts. With a small table, the keys
+ * overflow in the extendable buckets, or are left in the old buckets of
+ * the last resize.
+ */
+static int
+test_hash_aging_table(uint32_t entries, uint8_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_aging",
+		.entries = entries,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_AGING | extra_flag,
+	};
+	struct rte_hash_expire_cursor cursor = { 0 };
+	uint32_t keys[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *expired_keys[4];
+	uint8_t expired[AGING_NB_KEYS];
+	struct rte_hash *handle;
+	uint64_t hit_mask, added;
+	uint32_t i, j, nb_parts, nb_main, nb_extra;
+	int ret, dup;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < AGING_NB_KEYS; i++) {
+		ret = rte_hash_add_key_data(handle, &i,
+			(void *)(uintptr_t)(i + 1));
+		RETURN_IF_ERROR(ret != 0, "failed to add key %u", i);
+	}
+	added = rte_get_tsc_cycles();
+
+	/* nothing expires before the adds */
+	ret = rte_hash_expire(handle, &cursor, AGING_ENTRIES, 0,
+		expired_keys, NULL, RTE_DIM(expired_keys));
+	RETURN_IF_ERROR(ret != 0, "%d keys expired before being added", ret);
+	/* the number of expired keys is bounded */
+	ret = rte_hash_expire(handle, &cursor, AGING_ENTRIES, added + 1,
+		expired_keys, NULL, RTE_DIM(expired_keys));
+	RETURN_IF_ERROR(ret != RTE_DIM(expired_keys), "%d keys expired", ret);
+
+	/* refresh the even keys, and look up a missing key */
+	for (i = 0; i < AGING_NB_KEYS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			keys[j] = (j % 2 == 0) ? i + j : AGING_NB_KEYS;
+			key_ptrs[j] = &keys[j];
+		}
+		ret = rte_hash_lookup_touch_bulk_data(handle, key_ptrs,
+			RTE_HASH_LOOKUP_BULK_MAX, added + 1000, &hit_mask,
+			data);
+		RETURN_IF_ERROR(ret != RTE_HASH_LOOKUP_BULK_MAX / 2 ||
+			hit_mask != 0x5555555555555555ULL,
+			"wrong touch lookup of keys %u", i);
+	}
+
+	/* the bucket count of a resized table is only bounded */
+	dup = (extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZE) != 0;
+	nb_main = dup ? AGING_ENTRIES / 8 : entries / 8;
+	nb_extra = (extra_flag != 0) ? nb_main : 0;
+	for (nb_parts = 1; nb_parts <= 3; nb_parts++) {
+		memset(expired, 0, sizeof(expired));
+		for (i = 0; i < nb_parts; i++) {
+			ret = test_hash_aging_sweep(handle, i, nb_parts,
+				nb_main, nb_extra, added + 500, expired, dup);
+			RETURN_IF_ERROR(ret != 0, "sweep of part %u/%u failed",
+				i, nb_parts);
+		}
+		for (i = 1; i < AGING_NB_KEYS; i += 2)
+			RETURN_IF_ERROR(expired[i] == 0,
+				"key %u not expired with %u parts", i,
+				nb_parts);
+	}
+
+	cursor.part = 1;
+	ret = rte_hash_expire(handle, &cursor, 1, 0, expired_keys, NULL,
+		RTE_DIM(expired_keys));
+	RETURN_IF_ERROR(ret != -EINVAL, "part out of the table accepted");
+	rte_hash_free(handle);
+
+	return 0;
+}
+
+static int
+test_hash_aging(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_aging",
+		.entries = AGING_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = 0,
+	};
+	struct rte_hash_expire_cursor cursor = { 0 };
+	const void *expired_keys[4];
+	struct rte_hash *handle;
+	int ret;
+
+	if (test_hash_aging_table(AGING_ENTRIES, 0) < 0)
+		return -1;
+	if (test_hash_aging_table(AGING_NB_KEYS,
+			RTE_HASH_EXTRA_FLAGS_EXT_TABLE) < 0)
+		return -1;
+	if (test_hash_aging_table(RESIZE_INIT_ENTRIES,
+			RTE_HASH_EXTRA_FLAGS_RESIZE) < 0)
+		return -1;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	ret = rte_hash_expire(handle, &cursor, 1, 0, expired_keys, NULL,
+		RTE_DIM(expired_keys));
+	RETURN_IF_ERROR(ret != -ENOTSUP, "expiry without aging accepted");
+	rte_hash_free(handle);
+
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -2208,6 +2764,18 @@ test_hash(void)
 		return -1;
 	if (test_extendable_bucket() < 0)
 		return -1;
+	if (test_hash_bulk_lookup_simd() < 0)
+		return -1;
+	if (test_hash_resize(0) < 0)
+		return -1;
+	if (test_hash_resize(RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY) < 0)
+		return -1;
+	if (test_hash_resize(RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) < 0)
+		return -1;
+	if (test_hash_resize_with_hash() < 0)
+		return -1;
+	if (test_hash_aging() < 0)
+		return -1;
 
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
@@ -2250,6 +2818,9 @@ test_hash(void)
 	if (test_hash_rcu_qsbr_sync_mode(1) < 0)
 		return -1;
 
+	if (test_hash_resize_rcu() < 0)
+		return -1;
+
 	return 0;
 }
 
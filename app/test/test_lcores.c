@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_lcore.h>
 
@@ -340,6 +341,73 @@ test_non_eal_lcores_callback(unsigned int eal_threads_count)
 	return -1;
 }
 
+/* report device or ring polls of the calling lcore for ms milliseconds */
+static void
+lcore_poll(unsigned int ms, uint16_t nb_rx, bool ring)
+{
+	uint64_t end = rte_get_timer_cycles() + rte_get_timer_hz() * ms / 1000;
+
+	while (rte_get_timer_cycles() < end) {
+		if (ring)
+			__rte_lcore_poll_busyness_ring_timestamp(nb_rx);
+		else
+			__rte_lcore_poll_busyness_timestamp(nb_rx);
+		rte_delay_us(1);
+	}
+}
+
+static int
+test_lcore_poll_busyness(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	int busyness;
+
+	if (!rte_lcore_poll_busyness_enabled()) {
+		printf("lcore poll busyness accounting not enabled, skipping\n");
+		return 0;
+	}
+
+	lcore_poll(1000, 0, false);
+	busyness = rte_lcore_poll_busyness(lcore_id);
+	if (busyness < 0 || busyness > 10) {
+		printf("Error: lcore polling empty queues is %d%% busy\n",
+			busyness);
+		return -1;
+	}
+
+	lcore_poll(2000, 32, false);
+	busyness = rte_lcore_poll_busyness(lcore_id);
+	if (busyness != 100) {
+		printf("Error: lcore always getting work is %d%% busy\n",
+			busyness);
+		return -1;
+	}
+
+	/* rings polled by an lcore polling devices are not counted again */
+	lcore_poll(500, 0, true);
+	busyness = rte_lcore_poll_busyness(lcore_id);
+	if (busyness != 100) {
+		printf("Error: lcore ring polls counted with device polls, %d%% busy\n",
+			busyness);
+		return -1;
+	}
+
+	rte_lcore_poll_busyness_enabled_set(false);
+	if (rte_lcore_poll_busyness(lcore_id) != -ENOTSUP) {
+		printf("Error: lcore poll busyness reported while disabled\n");
+		return -1;
+	}
+
+	/* accounting restarts from scratch once enabled again */
+	rte_lcore_poll_busyness_enabled_set(true);
+	if (rte_lcore_poll_busyness(lcore_id) != -ENODATA) {
+		printf("Error: stale lcore poll busyness reported\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_lcores(void)
 {
@@ -367,6 +435,9 @@ test_lcores(void)
 	if (test_non_eal_lcores_callback(eal_threads_count) < 0)
 		return TEST_FAILED;
 
+	if (test_lcore_poll_busyness() < 0)
+		return TEST_FAILED;
+
 	return TEST_SUCCESS;
 }
 
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <rte_errno.h>
 #include <rte_ip.h>
 #include <rte_lpm.h>
 #include <rte_malloc.h>
@@ -44,6 +45,7 @@ static int32_t test18(void);
 static int32_t test19(void);
 static int32_t test20(void);
 static int32_t test21(void);
+static int32_t test22(void);
 
 rte_lpm_test tests[] = {
 /* Test Cases */
@@ -68,7 +70,8 @@ rte_lpm_test tests[] = {
 	test18,
 	test19,
 	test20,
-	test21
+	test21,
+	test22
 };
 
 #define MAX_DEPTH 32
@@ -1563,6 +1566,140 @@ test21(void)
 	return (status == 0) ? PASS : -1;
 }
 
+#define SAVE_PATH "/tmp/test_lpm_save.bin"
+
+static uint32_t
+test22_ip(uint32_t i)
+{
+	return RTE_IPV4(i, i * 3, i * 7, i * 11);
+}
+
+static uint8_t
+test22_depth(uint32_t i)
+{
+	return 1 + (i % MAX_DEPTH);
+}
+
+/* Lookup the first and last address of all the rules in both tables */
+static int32_t
+test22_compare(struct rte_lpm *lpm1, struct rte_lpm *lpm2)
+{
+	uint32_t i, ip, mask, nh1, nh2;
+	int s1, s2;
+
+	for (i = 0; i < MAX_RULES; i++) {
+		mask = UINT32_MAX << (32 - test22_depth(i));
+		ip = test22_ip(i) & mask;
+		s1 = rte_lpm_lookup(lpm1, ip, &nh1);
+		s2 = rte_lpm_lookup(lpm2, ip, &nh2);
+		TEST_LPM_ASSERT((s1 == s2) && ((s1 != 0) || (nh1 == nh2)));
+		s1 = rte_lpm_lookup(lpm1, ip | ~mask, &nh1);
+		s2 = rte_lpm_lookup(lpm2, ip | ~mask, &nh2);
+		TEST_LPM_ASSERT((s1 == s2) && ((s1 != 0) || (nh1 == nh2)));
+	}
+
+	return PASS;
+}
+
+/*
+ * Save and load an LPM table.
+ *  - Add rules of all depths, delete some of them and save the table
+ *  - Load it as a new table, lookups in both tables must match
+ *  - Delete then add again all the rules in both tables, lookups in
+ *    both tables must still match
+ *  - A file with a bad header is rejected
+ *  - tbl8 groups waiting in the RCU defer queue are free once loaded
+ */
+int32_t
+test22(void)
+{
+	struct rte_lpm *lpm, *loaded;
+	struct rte_lpm_config config;
+	struct rte_lpm_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	uint32_t i, ip, next_hop, magic = 0;
+	int32_t status;
+	FILE *f;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	for (i = 0; i < MAX_RULES; i++) {
+		status = rte_lpm_add(lpm, test22_ip(i), test22_depth(i), i);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	for (i = 0; i < MAX_RULES; i += 4)
+		rte_lpm_delete(lpm, test22_ip(i), test22_depth(i));
+
+	status = rte_lpm_save(NULL, SAVE_PATH);
+	TEST_LPM_ASSERT(status == -EINVAL);
+	status = rte_lpm_save(lpm, SAVE_PATH);
+	TEST_LPM_ASSERT(status == 0);
+	loaded = rte_lpm_load(__func__, SOCKET_ID_ANY, SAVE_PATH);
+	TEST_LPM_ASSERT((loaded == NULL) && (rte_errno == EEXIST));
+	loaded = rte_lpm_load("lpm_load", SOCKET_ID_ANY, SAVE_PATH);
+	TEST_LPM_ASSERT(loaded != NULL);
+	TEST_LPM_ASSERT(test22_compare(lpm, loaded) == PASS);
+
+	for (i = 0; i < MAX_RULES; i++) {
+		status = rte_lpm_delete(lpm, test22_ip(i), test22_depth(i));
+		TEST_LPM_ASSERT(rte_lpm_delete(loaded, test22_ip(i),
+			test22_depth(i)) == status);
+	}
+	TEST_LPM_ASSERT(test22_compare(lpm, loaded) == PASS);
+	for (i = 0; i < MAX_RULES; i++) {
+		rte_lpm_add(lpm, test22_ip(i), test22_depth(i), i);
+		status = rte_lpm_add(loaded, test22_ip(i), test22_depth(i), i);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	TEST_LPM_ASSERT(test22_compare(lpm, loaded) == PASS);
+	rte_lpm_free(loaded);
+	rte_lpm_free(lpm);
+
+	f = fopen(SAVE_PATH, "r+b");
+	TEST_LPM_ASSERT(f != NULL);
+	fwrite(&magic, sizeof(magic), 1, f);
+	fclose(f);
+	loaded = rte_lpm_load("lpm_load", SOCKET_ID_ANY, SAVE_PATH);
+	TEST_LPM_ASSERT((loaded == NULL) && (rte_errno == EINVAL));
+
+	/* The only tbl8 group is waiting for the reader when saved */
+	config.number_tbl8s = 1;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+	qsv = rte_zmalloc_socket(NULL, rte_rcu_qsbr_get_memsize(1),
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	TEST_LPM_ASSERT(qsv != NULL);
+	TEST_LPM_ASSERT(rte_rcu_qsbr_init(qsv, 1) == 0);
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_LPM_QSBR_MODE_DQ;
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_cfg) == 0);
+	TEST_LPM_ASSERT(rte_rcu_qsbr_thread_register(qsv, 0) == 0);
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	ip = RTE_IPV4(192, 0, 2, 100);
+	next_hop = 1;
+	TEST_LPM_ASSERT(rte_lpm_add(lpm, ip, 28, next_hop) == 0);
+	TEST_LPM_ASSERT(rte_lpm_delete(lpm, ip, 28) == 0);
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	status = rte_lpm_save(lpm, SAVE_PATH);
+	TEST_LPM_ASSERT(status == 0);
+	loaded = rte_lpm_load("lpm_load", SOCKET_ID_ANY, SAVE_PATH);
+	TEST_LPM_ASSERT(loaded != NULL);
+	TEST_LPM_ASSERT(rte_lpm_add(loaded, ip, 28, next_hop) == 0);
+
+	rte_rcu_qsbr_thread_unregister(qsv, 0);
+	rte_lpm_free(loaded);
+	rte_lpm_free(lpm);
+	rte_free(qsv);
+	remove(SAVE_PATH);
+
+	return PASS;
+}
+
 /*
  * Do all unit tests.
  */
@@ -9,6 +9,8 @@
 
 #include <rte_memory.h>
 #include <rte_lpm6.h>
+#include <rte_random.h>
+#include <rte_vect.h>
 
 #include "test.h"
 #include "test_lpm6_data.h"
@@ -51,6 +53,7 @@ static int32_t test25(void);
 static int32_t test26(void);
 static int32_t test27(void);
 static int32_t test28(void);
+static int32_t test29(void);
 
 rte_lpm6_test tests6[] = {
 /* Test Cases */
@@ -83,6 +86,7 @@ rte_lpm6_test tests6[] = {
 	test26,
 	test27,
 	test28,
+	test29,
 };
 
 #define MAX_DEPTH                                                    128
@@ -1770,6 +1774,92 @@ test28(void)
 	return PASS;
 }
 
+#define BULK_NB_ROUTES	64
+/* two groups of 32 for the vector path and a tail not a multiple of 16 */
+#define BULK_NB_IPS	(2 * 32 + 13)
+
+static int32_t
+bulk_compare(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t routes[BULK_NB_ROUTES][RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t ips[BULK_NB_IPS][RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t depths[BULK_NB_ROUTES];
+	int32_t next_hops[BULK_NB_IPS];
+	uint32_t next_hop;
+	unsigned int i, j, n, r;
+	int status;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* nested routes of all the levels, with distinct next hops */
+	for (i = 0; i < BULK_NB_ROUTES; i++) {
+		for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+			routes[i][j] = (j < 3) ? 0x20 : rte_rand();
+		depths[i] = 8 + i * (MAX_DEPTH - 8) / (BULK_NB_ROUTES - 1);
+		status = rte_lpm6_add(lpm, routes[i], depths[i], i + 1);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* addresses in the routes, some random ones missing */
+	for (i = 0; i < BULK_NB_IPS; i++) {
+		r = rte_rand_max(BULK_NB_ROUTES);
+		for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+			ips[i][j] = (j * 8 < depths[r] && i % 7 != 0) ?
+				routes[r][j] : rte_rand();
+	}
+
+	for (n = 1; n <= BULK_NB_IPS; n++) {
+		memset(next_hops, 0, sizeof(next_hops));
+		status = rte_lpm6_lookup_bulk_func(lpm, ips, next_hops, n);
+		TEST_LPM_ASSERT(status == 0);
+		for (i = 0; i < n; i++) {
+			status = rte_lpm6_lookup(lpm, ips[i], &next_hop);
+			if (status == 0)
+				TEST_LPM_ASSERT(next_hops[i] == (int32_t)next_hop);
+			else
+				TEST_LPM_ASSERT(next_hops[i] == -1);
+		}
+	}
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Check that the bulk lookup returns the next hops of the single lookup,
+ * for all the sizes up to a few groups of addresses and with the vector
+ * path if available.
+ */
+int32_t
+test29(void)
+{
+	static const uint16_t bitwidths[] = {
+		RTE_VECT_SIMD_DISABLED, RTE_VECT_SIMD_512,
+	};
+	uint16_t max_bitwidth = rte_vect_get_max_simd_bitwidth();
+	unsigned int i;
+	int32_t status;
+
+	status = bulk_compare();
+	for (i = 0; i < RTE_DIM(bitwidths) && status == PASS; i++) {
+		/* the bitwidth cannot be changed if set on command line */
+		if (rte_vect_set_max_simd_bitwidth(bitwidths[i]) != 0)
+			break;
+		status = bulk_compare();
+	}
+
+	rte_vect_set_max_simd_bitwidth(max_bitwidth);
+	return status;
+}
+
 /*
  * Do all unit tests.
  */
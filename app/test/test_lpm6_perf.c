@@ -25,6 +25,7 @@
 #define ITERATIONS (1 << 10)
 #define BATCH_SIZE 100000
 #define NUMBER_TBL8S                                           (1 << 16)
+#define BULK_SIZE 32u
 
 static void
 print_route_distribution(const struct rules_tbl_entry *table, uint32_t n)
@@ -139,6 +140,60 @@ test_lpm6_perf(void)
 			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
 			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
 
+	/* Bulk lookup must return the same next hops as single lookup */
+	for (j = 0; j < NUM_IPS_ENTRIES; j++) {
+		status = rte_lpm6_lookup(lpm, ip_batch[j], &next_hop_return);
+		TEST_LPM_ASSERT(next_hops[j] ==
+			(status == 0 ? (int32_t)next_hop_return : -1));
+	}
+
+	/* Measure bulk Lookup by bursts, in random order */
+	for (i = NUM_IPS_ENTRIES - 1; i > 0; i--) {
+		uint8_t tmp[16];
+
+		j = rte_rand_max(i + 1);
+		memcpy(tmp, ip_batch[i], 16);
+		memcpy(ip_batch[i], ip_batch[j], 16);
+		memcpy(ip_batch[j], tmp, 16);
+	}
+
+	total_time = 0;
+	count = 0;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		begin = rte_rdtsc();
+		for (j = 0; j < NUM_IPS_ENTRIES; j++) {
+			if (rte_lpm6_lookup(lpm, ip_batch[j],
+					&next_hop_return) != 0)
+				count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("Average LPM Lookup, random order: %.1f cycles "
+			"(fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	total_time = 0;
+	count = 0;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		begin = rte_rdtsc();
+		for (j = 0; j < NUM_IPS_ENTRIES; j += BULK_SIZE)
+			rte_lpm6_lookup_bulk_func(lpm, &ip_batch[j],
+				&next_hops[j],
+				RTE_MIN(BULK_SIZE, NUM_IPS_ENTRIES - j));
+		total_time += rte_rdtsc() - begin;
+
+		for (j = 0; j < NUM_IPS_ENTRIES; j++)
+			if (next_hops[j] < 0)
+				count++;
+	}
+	printf("BULK LPM Lookup, random order, %u per burst: %.1f cycles "
+			"(fails = %.1f%%)\n", BULK_SIZE,
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
 	/* Delete */
 	status = 0;
 	begin = rte_rdtsc();
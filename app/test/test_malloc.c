@@ -816,6 +816,62 @@ test_zero_aligned_alloc(void)
 	return -1;
 }
 
+#define N_SMALL_OBJS 64
+
+/*
+ * Free small objects after dirtying them and check that zmalloc of the same
+ * sizes still returns zeroed memory, whether the objects come back from the
+ * heap or from the per-lcore cache (--malloc-cache).
+ */
+static int
+test_zmalloc_reuse(void)
+{
+	static const size_t sizes[] = {1, 64, 100, 256, 1000, 2048};
+	char *objs[N_SMALL_OBJS];
+	unsigned int i, j, k;
+
+	for (i = 0; i < RTE_DIM(sizes); i++) {
+		for (j = 0; j < N_SMALL_OBJS; j++) {
+			objs[j] = rte_malloc(NULL, sizes[i], 0);
+			if (objs[j] == NULL) {
+				printf("rte_malloc(%zu) failed\n", sizes[i]);
+				goto err_return;
+			}
+			memset(objs[j], 0xa5, sizes[i]);
+		}
+		for (j = 0; j < N_SMALL_OBJS; j++)
+			rte_free(objs[j]);
+
+		for (j = 0; j < N_SMALL_OBJS; j++) {
+			objs[j] = rte_zmalloc(NULL, sizes[i], 0);
+			if (objs[j] == NULL) {
+				printf("rte_zmalloc(%zu) failed\n", sizes[i]);
+				goto err_return;
+			}
+			if (!rte_is_aligned(objs[j], RTE_CACHE_LINE_SIZE)) {
+				printf("rte_zmalloc(%zu) not aligned\n", sizes[i]);
+				j++;
+				goto err_return;
+			}
+			for (k = 0; k < sizes[i]; k++)
+				if (objs[j][k] != 0) {
+					printf("rte_zmalloc(%zu) not zeroed\n",
+							sizes[i]);
+					j++;
+					goto err_return;
+				}
+		}
+		for (j = 0; j < N_SMALL_OBJS; j++)
+			rte_free(objs[j]);
+	}
+	return 0;
+
+err_return:
+	while (j-- > 0)
+		rte_free(objs[j]);
+	return -1;
+}
+
 static int
 test_malloc_bad_params(void)
 {
@@ -997,6 +1053,12 @@ test_malloc(void)
 	}
 	else printf("test_zero_aligned_alloc() passed\n");
 
+	if (test_zmalloc_reuse() < 0) {
+		printf("test_zmalloc_reuse() failed\n");
+		return -1;
+	}
+	else printf("test_zmalloc_reuse() passed\n");
+
 	if (test_malloc_bad_params() < 0){
 		printf("test_malloc_bad_params() failed\n");
 		return -1;
@@ -1081,3 +1143,42 @@ test_malloc(void)
 }
 
 REGISTER_TEST_COMMAND(malloc_autotest, test_malloc);
+
+/*
+ * Run with --malloc-cache: objects freed twice must not be handed out twice
+ * by the per-lcore cache, and cached objects must come back zeroed.
+ */
+static int
+test_malloc_cache(void)
+{
+	void *obj, *obj2, *obj3;
+
+	obj = rte_malloc(NULL, 64, 0);
+	if (obj == NULL) {
+		printf("rte_malloc() failed\n");
+		return -1;
+	}
+	rte_free(obj);
+	/* rejected, the object is already cached */
+	rte_free(obj);
+
+	obj2 = rte_malloc(NULL, 64, 0);
+	obj3 = rte_malloc(NULL, 64, 0);
+	rte_free(obj3);
+	rte_free(obj2);
+	if (obj2 == NULL || obj3 == NULL || obj2 == obj3) {
+		printf("double free handed out %p twice\n", obj2);
+		return -1;
+	}
+	printf("test_malloc_cache() double free passed\n");
+
+	if (test_zmalloc_reuse() < 0) {
+		printf("test_zmalloc_reuse() failed\n");
+		return -1;
+	}
+	printf("test_zmalloc_reuse() passed\n");
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(malloc_cache_autotest, test_malloc_cache);
@@ -2,6 +2,7 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -266,6 +267,117 @@ perf_test_variable_unaligned(void)
 	}
 }
 
+/*
+ * The cache pollution tests read a working set which fits in the caches,
+ * copy POLLUTION_COPY_BYTES between random locations of the large buffers,
+ * and read the working set again. The time of this second read shows how
+ * much of the working set the copies evicted.
+ */
+#define HOT_SET_SIZE            (512 * 1024)
+#define POLLUTION_COPY_BYTES    (4 * 1024 * 1024)
+#define POLLUTION_ITERATIONS    100
+
+static size_t pollution_sizes[] = {
+	1024, 4096, 16384, 65536
+};
+
+/* Keeps the working set reads from being optimised out */
+static volatile uint64_t hot_set_sum;
+
+/* Read one word per cache line of the working set, return the ticks spent */
+static uint64_t
+hot_set_read(const uint8_t *hot)
+{
+	uint64_t start_time, sum = 0;
+	unsigned int i;
+
+	start_time = rte_rdtsc_precise();
+	for (i = 0; i < HOT_SET_SIZE; i += RTE_CACHE_LINE_SIZE)
+		sum += *(const uint64_t *)(const void *)(hot + i);
+	hot_set_sum = sum;
+
+	return rte_rdtsc_precise() - start_time;
+}
+
+/* Return the average ticks per copy, and per read of the working set */
+static void
+pollution_test(const uint8_t *hot, size_t size, int nt, double *copy_ticks,
+		double *read_ticks)
+{
+	uint64_t start_time, copy_time = 0, read_time = 0;
+	size_t dst_off, src_off;
+	unsigned int iter, t;
+
+	for (iter = 0; iter < POLLUTION_ITERATIONS; iter++) {
+		hot_set_read(hot);
+		for (t = 0; t < POLLUTION_COPY_BYTES / size; t++) {
+			dst_off = (rte_rand() % (LARGE_BUFFER_SIZE - size)) &
+				~(ALIGNMENT_UNIT - 1);
+			src_off = (rte_rand() % (LARGE_BUFFER_SIZE - size)) &
+				~(ALIGNMENT_UNIT - 1);
+			start_time = rte_rdtsc();
+			if (nt)
+				rte_memcpy_nt(large_buf_write + dst_off,
+					large_buf_read + src_off, size);
+			else
+				rte_memcpy(large_buf_write + dst_off,
+					large_buf_read + src_off, size);
+			copy_time += rte_rdtsc() - start_time;
+		}
+		read_time += hot_set_read(hot);
+	}
+
+	*copy_ticks = (double)copy_time /
+		(POLLUTION_ITERATIONS * (POLLUTION_COPY_BYTES / size));
+	*read_ticks = (double)read_time / POLLUTION_ITERATIONS;
+}
+
+/* Compare the cache pollution of rte_memcpy() and rte_memcpy_nt() */
+static int
+perf_test_cache_pollution(void)
+{
+	double copy_ticks, read_ticks, nt_copy_ticks, nt_read_ticks;
+	uint64_t read_time = 0;
+	uint8_t *hot;
+	unsigned int i;
+
+	hot = rte_malloc("memcpy", HOT_SET_SIZE, RTE_CACHE_LINE_SIZE);
+	if (hot == NULL) {
+		printf("ERROR: not enough memory\n");
+		return -1;
+	}
+	for (i = 0; i < HOT_SET_SIZE; i++)
+		hot[i] = rte_rand();
+
+	/* reference time of reading the working set from the caches */
+	hot_set_read(hot);
+	for (i = 0; i < POLLUTION_ITERATIONS; i++)
+		read_time += hot_set_read(hot);
+
+	printf("\n** rte_memcpy() - rte_memcpy_nt() cache pollution tests **\n"
+		   "%u KB copied between reads of a %u KB working set, read in %"PRIu64" ticks when cached\n"
+		   "======= ===================== =====================\n"
+		   "   Size      rte_memcpy()         rte_memcpy_nt()\n"
+		   "(bytes)       copy  hot read        copy  hot read\n"
+		   "              (ticks)               (ticks)\n"
+		   "------- --------------------- ---------------------",
+		   POLLUTION_COPY_BYTES / 1024, HOT_SET_SIZE / 1024,
+		   read_time / POLLUTION_ITERATIONS);
+	for (i = 0; i < RTE_DIM(pollution_sizes); i++) {
+		pollution_test(hot, pollution_sizes[i], 0, &copy_ticks,
+			&read_ticks);
+		pollution_test(hot, pollution_sizes[i], 1, &nt_copy_ticks,
+			&nt_read_ticks);
+		printf("\n%7zu %10.0f %10.0f %10.0f %10.0f", pollution_sizes[i],
+			copy_ticks, read_ticks, nt_copy_ticks, nt_read_ticks);
+	}
+	printf("\n======= ===================== =====================\n\n");
+
+	rte_free(hot);
+
+	return 0;
+}
+
 /* Run all memcpy tests */
 static int
 perf_test(void)
@@ -331,9 +443,11 @@ perf_test(void)
 	printf("Aligned constant copy size   = %8.3f\n", time_aligned_const);
 	printf("Unaligned variable copy size = %8.3f\n", time_unaligned);
 	printf("Unaligned constant copy size = %8.3f\n", time_unaligned_const);
+
+	ret = perf_test_cache_pollution();
 	free_buffers();
 
-	return 0;
+	return ret;
 }
 
 static int
@@ -834,6 +834,242 @@ test_mempool_flag_non_io_unset_by_default(void)
 	return ret;
 }
 
+static int
+test_mempool_cache_stats(void)
+{
+	struct rte_mempool_cache_stats stats;
+	struct rte_mempool *mp;
+	void *obj;
+	int ret;
+
+	mp = rte_mempool_create("test_cache_stats", MEMPOOL_SIZE,
+				MEMPOOL_ELT_SIZE, 32, 0, NULL, NULL, NULL, NULL,
+				SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+
+	/* first get fills the cache, next accesses are served by it */
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_get(mp, &obj), "Cannot get");
+	rte_mempool_put(mp, obj);
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_get(mp, &obj), "Cannot get");
+	rte_mempool_put(mp, obj);
+
+	ret = rte_mempool_cache_stats_get(mp, rte_lcore_id(), &stats);
+	RTE_TEST_ASSERT_SUCCESS(ret, "Cannot get cache stats");
+	RTE_TEST_ASSERT(stats.get_miss == 1 && stats.get_hit == 1 &&
+			stats.put_hit == 2 && stats.put_miss == 0,
+			"Unexpected cache stats");
+
+	rte_mempool_cache_stats_reset(mp);
+	ret = rte_mempool_cache_stats_get(mp, rte_lcore_id(), &stats);
+	RTE_TEST_ASSERT_SUCCESS(ret, "Cannot get cache stats");
+	RTE_TEST_ASSERT(stats.get_miss == 0 && stats.get_hit == 0 &&
+			stats.put_hit == 0 && stats.put_miss == 0,
+			"Cache stats not reset");
+
+	ret = rte_mempool_cache_stats_get(mp, RTE_MAX_LCORE, &stats);
+	RTE_TEST_ASSERT_EQUAL(ret, -EINVAL, "Invalid lcore accepted");
+	ret = TEST_SUCCESS;
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+static int
+test_mempool_adaptive_cache(void)
+{
+	struct rte_mempool_cache_stats stats;
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	void *objs[1024];
+	unsigned int i, j;
+	int ret;
+
+	mp = rte_mempool_create("test_adaptive_cache", 2 * RTE_DIM(objs),
+				MEMPOOL_ELT_SIZE, 256, 0, NULL, NULL, NULL,
+				NULL, SOCKET_ID_ANY, MEMPOOL_F_ADAPTIVE_CACHE);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	RTE_TEST_ASSERT_EQUAL(cache->size, 32U, "Unexpected initial size");
+
+	/* bursts of allocations then of releases keep on missing: grow */
+	for (i = 0; i < 100; i++) {
+		for (j = 0; j < RTE_DIM(objs); j += 16)
+			RTE_TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(mp,
+					&objs[j], 16), "Cannot get");
+		for (j = 0; j < RTE_DIM(objs); j += 16)
+			rte_mempool_put_bulk(mp, &objs[j], 16);
+	}
+	ret = rte_mempool_cache_stats_get(mp, rte_lcore_id(), &stats);
+	RTE_TEST_ASSERT_SUCCESS(ret, "Cannot get cache stats");
+	RTE_TEST_ASSERT_EQUAL(cache->size, 256U, "Cache did not grow");
+	RTE_TEST_ASSERT(stats.grow > 0, "Cache growth not accounted");
+
+	/* mostly balanced accesses seldom miss: shrink */
+	for (i = 0; i < 100; i++) {
+		for (j = 0; j < 2000; j++) {
+			RTE_TEST_ASSERT_SUCCESS(rte_mempool_get(mp, &objs[0]),
+					"Cannot get");
+			rte_mempool_put(mp, objs[0]);
+		}
+		RTE_TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(mp, objs, 256),
+				"Cannot get");
+		rte_mempool_put_bulk(mp, objs, 256);
+	}
+	ret = rte_mempool_cache_stats_get(mp, rte_lcore_id(), &stats);
+	RTE_TEST_ASSERT_SUCCESS(ret, "Cannot get cache stats");
+	RTE_TEST_ASSERT_EQUAL(cache->size, 32U, "Cache did not shrink");
+	RTE_TEST_ASSERT(stats.shrink > 0, "Cache shrink not accounted");
+
+	rte_mempool_dump(stdout, mp);
+	ret = TEST_SUCCESS;
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+static int
+test_mempool_cache_zc(void)
+{
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	void *objs[64];
+	void **zc;
+	unsigned int i;
+	int ret;
+
+	mp = rte_mempool_create("test_cache_zc", MEMPOOL_SIZE,
+				MEMPOOL_ELT_SIZE, 32, 0, NULL, NULL, NULL, NULL,
+				SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+
+	/* bigger than the cache: refilled from the common pool */
+	zc = rte_mempool_cache_zc_get_bulk_start(cache, mp, RTE_DIM(objs));
+	RTE_TEST_ASSERT_NOT_NULL(zc, "Cannot start zero-copy get");
+	for (i = 0; i < RTE_DIM(objs); i++) {
+		RTE_TEST_ASSERT(rte_mempool_from_obj(zc[i]) == mp,
+				"Invalid object from zero-copy get");
+		objs[i] = zc[i];
+	}
+	rte_mempool_cache_zc_get_finish(cache, mp, RTE_DIM(objs));
+	RTE_TEST_ASSERT_EQUAL(rte_mempool_in_use_count(mp), RTE_DIM(objs),
+			      "Unexpected in use count after get");
+
+	/* only half of the objects put */
+	zc = rte_mempool_cache_zc_put_bulk_start(cache, mp, RTE_DIM(objs));
+	RTE_TEST_ASSERT_NOT_NULL(zc, "Cannot start zero-copy put");
+	for (i = 0; i < RTE_DIM(objs) / 2; i++)
+		zc[i] = objs[i];
+	rte_mempool_cache_zc_put_finish(cache, mp, RTE_DIM(objs) / 2);
+	RTE_TEST_ASSERT_EQUAL(rte_mempool_in_use_count(mp), RTE_DIM(objs) / 2,
+			      "Unexpected in use count after partial put");
+	rte_mempool_put_bulk(mp, &objs[RTE_DIM(objs) / 2], RTE_DIM(objs) / 2);
+	RTE_TEST_ASSERT_EQUAL(rte_mempool_in_use_count(mp), 0,
+			      "Unexpected in use count after put");
+
+	/* cannot go through the cache */
+	zc = rte_mempool_cache_zc_get_bulk_start(cache, mp,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1);
+	RTE_TEST_ASSERT_NULL(zc, "Too big zero-copy get accepted");
+	zc = rte_mempool_cache_zc_put_bulk_start(NULL, mp, 1);
+	RTE_TEST_ASSERT_NULL(zc, "Zero-copy put without cache accepted");
+	ret = TEST_SUCCESS;
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+static int
+test_mempool_elastic(void)
+{
+	struct rte_mempool_elastic_conf conf = {
+		.chunk_size = 256,
+		.low_watermark = 128,
+		.high_watermark = 512,
+	};
+	struct rte_mempool *mp;
+	void *objs[1000];
+	unsigned int i;
+	int ret;
+
+	mp = rte_mempool_create_empty("test_elastic", 4096, MEMPOOL_ELT_SIZE,
+				      0, 0, SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_set_ops_byname(mp, "ring_mp_mc",
+				NULL), "Cannot set mempool ops");
+
+	conf.high_watermark = conf.low_watermark + 1;
+	ret = rte_mempool_populate_elastic(mp, &conf);
+	RTE_TEST_ASSERT_EQUAL(ret, -EINVAL, "Invalid watermarks accepted");
+	conf.high_watermark = 512;
+
+	/* populated with one chunk, above the low watermark */
+	ret = rte_mempool_populate_elastic(mp, &conf);
+	RTE_TEST_ASSERT_EQUAL(ret, 256, "Cannot populate elastic mempool");
+	RTE_TEST_ASSERT_EQUAL(rte_mempool_populate_default(mp), -EEXIST,
+			      "Elastic mempool populated twice");
+
+	/* grow on demand */
+	for (i = 0; i < RTE_DIM(objs); i++) {
+		if (rte_mempool_get(mp, &objs[i]) == 0)
+			continue;
+		RTE_TEST_ASSERT_SUCCESS(rte_mempool_elastic_adjust(mp),
+					"Cannot grow elastic mempool");
+		RTE_TEST_ASSERT_SUCCESS(rte_mempool_get(mp, &objs[i]),
+					"Cannot get from grown mempool");
+	}
+	RTE_TEST_ASSERT_EQUAL(mp->populated_size, 1024U,
+			      "Unexpected grown mempool size");
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_elastic_adjust(mp),
+				"Cannot adjust elastic mempool");
+	RTE_TEST_ASSERT(rte_mempool_ops_get_count(mp) >= conf.low_watermark,
+			"Mempool below its low watermark after adjustment");
+
+	/*
+	 * Objects are given back in their allocation order: the ring keeps
+	 * the last chunk, the others are released.
+	 */
+	rte_mempool_put_bulk(mp, objs, RTE_DIM(objs));
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_elastic_adjust(mp),
+				"Cannot shrink elastic mempool");
+	RTE_TEST_ASSERT_EQUAL(mp->populated_size, 256U,
+			      "Unexpected shrunk mempool size");
+	RTE_TEST_ASSERT_NULL(rte_memzone_lookup("MP_test_elastic_0"),
+			     "Memory of released chunk not freed");
+	RTE_TEST_ASSERT_EQUAL(rte_mempool_in_use_count(mp), 0,
+			      "Objects lost by the shrink");
+	RTE_TEST_ASSERT(rte_mempool_full(mp), "Shrunk mempool not full");
+	rte_mempool_audit(mp);
+	rte_mempool_free(mp);
+
+	/* periodic adjustment */
+	mp = rte_mempool_create_empty("test_elastic", 4096, MEMPOOL_ELT_SIZE,
+				      0, 0, SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+	/* adjusted from the alarm thread, which is not an EAL thread */
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_set_ops_byname(mp, "ring_mp_mc",
+				NULL), "Cannot set mempool ops");
+	conf.period_ms = 10;
+	ret = rte_mempool_populate_elastic(mp, &conf);
+	RTE_TEST_ASSERT_EQUAL(ret, 256, "Cannot populate elastic mempool");
+	RTE_TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(mp, objs, 200),
+				"Cannot get");
+	for (i = 0; i < 100 && mp->populated_size == 256; i++)
+		rte_delay_ms(10);
+	RTE_TEST_ASSERT_EQUAL(mp->populated_size, 512U,
+			      "Elastic mempool not grown periodically");
+	rte_mempool_put_bulk(mp, objs, 200);
+	ret = TEST_SUCCESS;
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 #pragma pop_macro("RTE_TEST_TRACE_FAILURE")
 
 static int
@@ -1029,6 +1265,18 @@ test_mempool(void)
 	if (test_mempool_flag_non_io_unset_when_populated_with_valid_iova() < 0)
 		GOTO_ERR(ret, err);
 
+	/* test cache statistics and adaptive cache sizing */
+	if (test_mempool_cache_stats() < 0)
+		GOTO_ERR(ret, err);
+	if (test_mempool_adaptive_cache() < 0)
+		GOTO_ERR(ret, err);
+	if (test_mempool_cache_zc() < 0)
+		GOTO_ERR(ret, err);
+
+	/* test elastic mempools */
+	if (test_mempool_elastic() < 0)
+		GOTO_ERR(ret, err);
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_random.h>
+
+#include "test.h"
+
+/* not a multiple of the lanes nor of the batches of the generator */
+#define RAND_TAIL_SIZE		101
+#define RAND_DIST_SIZE		100000
+#define RAND_DIST_BOUND		10
+#define RAND_SENTINEL		UINT64_MAX
+
+static uint64_t vals[RAND_DIST_SIZE];
+
+/* Check that nothing is written beyond the n first values */
+static int
+test_bulk_sizes(void)
+{
+	unsigned int n, i;
+
+	for (n = 0; n <= RAND_TAIL_SIZE; n++) {
+		for (i = 0; i <= RAND_TAIL_SIZE; i++)
+			vals[i] = RAND_SENTINEL;
+		rte_rand_max_bulk(vals, n, 1000);
+		for (i = 0; i < n; i++)
+			RTE_TEST_ASSERT(vals[i] < 1000,
+				"Value %"PRIu64" out of range for n %u\n",
+				vals[i], n);
+		for (; i <= RAND_TAIL_SIZE; i++)
+			RTE_TEST_ASSERT(vals[i] == RAND_SENTINEL,
+				"Value %u written for n %u\n", i, n);
+
+		for (i = 0; i <= RAND_TAIL_SIZE; i++)
+			vals[i] = RAND_SENTINEL;
+		rte_rand_bulk(vals, n);
+		for (i = n; i <= RAND_TAIL_SIZE; i++)
+			RTE_TEST_ASSERT(vals[i] == RAND_SENTINEL,
+				"Value %u written for n %u\n", i, n);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_bulk_range(void)
+{
+	static const uint64_t bounds[] = {
+		0, 1, 2, 3, 10, 1000, 1 << 20, (1 << 20) + 1,
+		(UINT64_C(1) << 63) + 1, UINT64_MAX
+	};
+	uint64_t bound;
+	unsigned int i, j;
+
+	for (i = 0; i < RTE_DIM(bounds); i++) {
+		bound = bounds[i];
+		rte_rand_max_bulk(vals, RAND_TAIL_SIZE, bound);
+		for (j = 0; j < RAND_TAIL_SIZE; j++) {
+			if (bound < 2)
+				RTE_TEST_ASSERT(vals[j] == 0,
+					"Value %"PRIu64" for bound %"PRIu64"\n",
+					vals[j], bound);
+			else
+				RTE_TEST_ASSERT(vals[j] < bound,
+					"Value %"PRIu64" for bound %"PRIu64"\n",
+					vals[j], bound);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+/* Every bit of the full range values takes both values */
+static int
+test_bulk_bits(void)
+{
+	uint64_t all_or = 0, all_and = UINT64_MAX;
+	unsigned int i;
+
+	rte_rand_bulk(vals, RAND_TAIL_SIZE);
+	for (i = 0; i < RAND_TAIL_SIZE; i++) {
+		all_or |= vals[i];
+		all_and &= vals[i];
+	}
+	RTE_TEST_ASSERT(all_or == UINT64_MAX && all_and == 0,
+		"Stuck bits, or 0x%"PRIx64" and 0x%"PRIx64"\n",
+		all_or, all_and);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * The bounded values are uniform: with 10000 expected values per bucket,
+ * the standard deviation is below 100, so a 5% margin is never hit by
+ * chance.
+ */
+static int
+test_bulk_distribution(void)
+{
+	static const uint64_t bounds[] = { RAND_DIST_BOUND, 8 };
+	unsigned int count[RAND_DIST_BOUND];
+	unsigned int expected, i, j;
+
+	for (i = 0; i < RTE_DIM(bounds); i++) {
+		memset(count, 0, sizeof(count));
+		rte_rand_max_bulk(vals, RAND_DIST_SIZE, bounds[i]);
+		for (j = 0; j < RAND_DIST_SIZE; j++)
+			count[vals[j]]++;
+
+		expected = RAND_DIST_SIZE / bounds[i];
+		for (j = 0; j < bounds[i]; j++)
+			RTE_TEST_ASSERT(count[j] > expected * 95 / 100 &&
+				count[j] < expected * 105 / 100,
+				"Value %u drawn %u times, expected %u\n",
+				j, count[j], expected);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite rand_tests = {
+	.suite_name = "rand autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_bulk_sizes),
+	TEST_CASE(test_bulk_range),
+	TEST_CASE(test_bulk_bits),
+	TEST_CASE(test_bulk_distribution),
+	TEST_CASES_END()
+	}
+};
+
+static int
+test_rand(void)
+{
+	rte_srand(42);
+
+	return unit_test_suite_runner(&rand_tests);
+}
+
+REGISTER_TEST_COMMAND(rand_autotest, test_rand);
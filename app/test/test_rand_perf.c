@@ -18,10 +18,15 @@ static volatile uint64_t vsum;
 #define BEST_CASE_BOUND (1<<16)
 #define WORST_CASE_BOUND (BEST_CASE_BOUND + 1)
 
+#define BULK_SIZE 64
+
 enum rand_type {
 	rand_type_64,
 	rand_type_bounded_best_case,
-	rand_type_bounded_worst_case
+	rand_type_bounded_worst_case,
+	rand_type_bulk_64,
+	rand_type_bulk_bounded_best_case,
+	rand_type_bulk_bounded_worst_case
 };
 
 static const char *
@@ -34,6 +39,12 @@ rand_type_desc(enum rand_type rand_type)
 		return "Bounded average best-case [rte_rand_max()]";
 	case rand_type_bounded_worst_case:
 		return "Bounded average worst-case [rte_rand_max()]";
+	case rand_type_bulk_64:
+		return "Full 64-bit [rte_rand_bulk()]";
+	case rand_type_bulk_bounded_best_case:
+		return "Bounded average best-case [rte_rand_max_bulk()]";
+	case rand_type_bulk_bounded_worst_case:
+		return "Bounded average worst-case [rte_rand_max_bulk()]";
 	default:
 		return NULL;
 	}
@@ -61,7 +72,50 @@ test_rand_perf_type(enum rand_type rand_type)
 		case rand_type_bounded_worst_case:
 			sum += rte_rand_max(WORST_CASE_BOUND);
 			break;
+		default:
+			break;
+		}
+	}
+
+	end = rte_rdtsc();
+
+	/* to avoid an optimizing compiler removing the whole loop */
+	vsum = sum;
+
+	op_latency = (end - start) / ITERATIONS;
+
+	printf("%s: %"PRId64" TSC cycles/op\n", rand_type_desc(rand_type),
+	       op_latency);
+}
+
+static __rte_always_inline void
+test_rand_perf_bulk_type(enum rand_type rand_type)
+{
+	uint64_t vals[BULK_SIZE];
+	uint64_t start;
+	uint32_t i, j;
+	uint64_t end;
+	uint64_t sum = 0;
+	uint64_t op_latency;
+
+	start = rte_rdtsc();
+
+	for (i = 0; i < ITERATIONS; i += BULK_SIZE) {
+		switch (rand_type) {
+		case rand_type_bulk_64:
+			rte_rand_bulk(vals, BULK_SIZE);
+			break;
+		case rand_type_bulk_bounded_best_case:
+			rte_rand_max_bulk(vals, BULK_SIZE, BEST_CASE_BOUND);
+			break;
+		case rand_type_bulk_bounded_worst_case:
+			rte_rand_max_bulk(vals, BULK_SIZE, WORST_CASE_BOUND);
+			break;
+		default:
+			break;
 		}
+		for (j = 0; j < BULK_SIZE; j++)
+			sum += vals[j];
 	}
 
 	end = rte_rdtsc();
@@ -85,6 +139,9 @@ test_rand_perf(void)
 	test_rand_perf_type(rand_type_64);
 	test_rand_perf_type(rand_type_bounded_best_case);
 	test_rand_perf_type(rand_type_bounded_worst_case);
+	test_rand_perf_bulk_type(rand_type_bulk_64);
+	test_rand_perf_bulk_type(rand_type_bulk_bounded_best_case);
+	test_rand_perf_bulk_type(rand_type_bulk_bounded_worst_case);
 
 	return 0;
 }
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 
 #include <rte_ip.h>
+#include <rte_random.h>
 #include <rte_rib6.h>
 
 #include "test.h"
@@ -21,9 +22,11 @@ static int32_t test_insert_invalid(void);
 static int32_t test_get_fn(void);
 static int32_t test_basic(void);
 static int32_t test_tree_traversal(void);
+static int32_t test_save_load(void);
 
 #define MAX_DEPTH 128
 #define MAX_RULES (1 << 22)
+#define SAVE_LOAD_ROUTES 1000
 
 /*
  * Check that rte_rib6_create fails gracefully for incorrect user input
@@ -328,6 +331,146 @@ test_tree_traversal(void)
 	return TEST_SUCCESS;
 }
 
+static void
+rand_ip6(uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	uint64_t r[2] = { rte_rand(), rte_rand() };
+
+	memcpy(ip, r, RTE_RIB6_IPV6_ADDR_SIZE);
+}
+
+/*
+ * Check that a RIB read back by rte_rib6_load() has the same nodes as the
+ * saved one, and that rte_rib6_load() rejects an unsuitable RIB
+ */
+int32_t
+test_save_load(void)
+{
+	struct rte_rib6 *rib = NULL, *rib2 = NULL;
+	struct rte_rib6_node *node, *node2;
+	struct rte_rib6_conf config;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t zero_ip[RTE_RIB6_IPV6_ADDR_SIZE] = { 0 };
+	uint64_t nh, nh2;
+	uint8_t depth;
+	unsigned int i, nb = 0;
+	FILE *f;
+	int ret;
+
+	config.max_nodes = MAX_RULES;
+	config.ext_sz = sizeof(uint64_t);
+
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+	rib2 = rte_rib6_create("test_save_load2", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib2 != NULL, "Failed to create RIB\n");
+
+	f = tmpfile();
+	RTE_TEST_ASSERT(f != NULL, "Failed to create a file\n");
+
+	/* an empty RIB */
+	ret = rte_rib6_save(rib, f);
+	RTE_TEST_ASSERT(ret == 0, "Failed to save RIB\n");
+	rewind(f);
+	ret = rte_rib6_load(rib2, f);
+	RTE_TEST_ASSERT(ret == 0, "Failed to load RIB\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup(rib2, zero_ip) == NULL,
+		"Empty RIB is not empty after load\n");
+
+	/* the default route, and routes making intermediate nodes */
+	node = rte_rib6_insert(rib, zero_ip, 0);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert rule\n");
+	rte_rib6_set_nh(node, 1);
+	*(uint64_t *)rte_rib6_get_ext(node) = 1;
+	for (i = 0; i < SAVE_LOAD_ROUTES; i++) {
+		rand_ip6(ip);
+		depth = rte_rand_max(MAX_DEPTH) + 1;
+		node = rte_rib6_insert(rib, ip, depth);
+		if (node == NULL)
+			continue;
+		rte_rib6_set_nh(node, i + 2);
+		*(uint64_t *)rte_rib6_get_ext(node) = ~(uint64_t)i;
+	}
+
+	rewind(f);
+	ret = rte_rib6_save(rib, f);
+	RTE_TEST_ASSERT(ret == 0, "Failed to save RIB\n");
+	rewind(f);
+	ret = rte_rib6_load(rib2, f);
+	RTE_TEST_ASSERT(ret == 0, "Failed to load RIB\n");
+
+	node = rte_rib6_lookup_exact(rib, zero_ip, 0);
+	do {
+		rte_rib6_get_ip(node, ip);
+		rte_rib6_get_depth(node, &depth);
+		rte_rib6_get_nh(node, &nh);
+		node2 = rte_rib6_lookup_exact(rib2, ip, depth);
+		RTE_TEST_ASSERT(node2 != NULL, "Route missing after load\n");
+		rte_rib6_get_nh(node2, &nh2);
+		RTE_TEST_ASSERT((nh == nh2) &&
+			(*(uint64_t *)rte_rib6_get_ext(node) ==
+			*(uint64_t *)rte_rib6_get_ext(node2)),
+			"Route differs after load\n");
+		nb++;
+		node = rte_rib6_get_nxt(rib, zero_ip, 0,
+			(nb == 1) ? NULL : node, RTE_RIB6_GET_NXT_ALL);
+	} while (node != NULL);
+
+	/* no extra route */
+	node2 = NULL;
+	while ((node2 = rte_rib6_get_nxt(rib2, zero_ip, 0, node2,
+			RTE_RIB6_GET_NXT_ALL)) != NULL)
+		nb--;
+	RTE_TEST_ASSERT(nb == 1, "Extra routes after load\n");
+
+	for (i = 0; i < SAVE_LOAD_ROUTES; i++) {
+		rand_ip6(ip);
+		node = rte_rib6_lookup(rib, ip);
+		node2 = rte_rib6_lookup(rib2, ip);
+		rte_rib6_get_ip(node, ip);
+		rte_rib6_get_ip(node2, ip2);
+		RTE_TEST_ASSERT(memcmp(ip, ip2, sizeof(ip)) == 0,
+			"Lookup differs after load\n");
+	}
+
+	/* a RIB which is not empty */
+	rewind(f);
+	ret = rte_rib6_load(rib2, f);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Loaded into a non empty RIB\n");
+	rte_rib6_free(rib2);
+
+	/* a RIB with another extension size */
+	config.ext_sz = 0;
+	rib2 = rte_rib6_create("test_save_load2", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib2 != NULL, "Failed to create RIB\n");
+	rewind(f);
+	ret = rte_rib6_load(rib2, f);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Loaded into a RIB with another extension size\n");
+	rte_rib6_free(rib2);
+
+	/* a RIB too small */
+	config.ext_sz = sizeof(uint64_t);
+	config.max_nodes = SAVE_LOAD_ROUTES / 2;
+	rib2 = rte_rib6_create("test_save_load2", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib2 != NULL, "Failed to create RIB\n");
+	rewind(f);
+	ret = rte_rib6_load(rib2, f);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Loaded into a too small RIB\n");
+	rte_rib6_free(rib2);
+
+	RTE_TEST_ASSERT(rte_rib6_save(NULL, f) == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_load(rib, NULL) == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	fclose(f);
+	rte_rib6_free(rib);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite rib6_tests = {
 	.suite_name = "rib6 autotest",
 	.setup = NULL,
@@ -339,6 +482,7 @@ static struct unit_test_suite rib6_tests = {
 		TEST_CASE(test_get_fn),
 		TEST_CASE(test_basic),
 		TEST_CASE(test_tree_traversal),
+		TEST_CASE(test_save_load),
 		TEST_CASES_END()
 	}
 };
@@ -10,7 +10,10 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <unistd.h>
 #include <sys/queue.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -1191,6 +1194,242 @@ test_ring_with_exact_size(void)
 	return -1;
 }
 
+/* per lcore statistics of the rings created with RING_F_STATS */
+static int
+test_ring_stats(void)
+{
+	static const unsigned int sync_flags[] = {
+		0,
+		RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ,
+		RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ,
+	};
+	struct rte_ring_stats stats;
+	void *objs[64] = { NULL };
+	struct rte_ring *r;
+	uint64_t samples;
+	unsigned int i, j;
+
+	r = rte_ring_create("test_ring_stats", 64, SOCKET_ID_ANY, 0);
+	if (r == NULL)
+		return -1;
+	TEST_RING_VERIFY(rte_ring_stats_get(r, &stats) == -ENOTSUP, r,
+		goto fail);
+	rte_ring_free(r);
+
+	for (i = 0; i < RTE_DIM(sync_flags); i++) {
+		r = rte_ring_create("test_ring_stats", 64, SOCKET_ID_ANY,
+			sync_flags[i] | RING_F_STATS);
+		if (r == NULL)
+			return -1;
+
+		/* success, failure and partial burst */
+		TEST_RING_VERIFY(rte_ring_enqueue_bulk(r, objs, 10,
+			NULL) == 10, r, goto fail);
+		TEST_RING_VERIFY(rte_ring_enqueue_bulk(r, objs, 60,
+			NULL) == 0, r, goto fail);
+		TEST_RING_VERIFY(rte_ring_enqueue_burst(r, objs, 60,
+			NULL) == 53, r, goto fail);
+		TEST_RING_VERIFY(rte_ring_dequeue_burst(r, objs, 64,
+			NULL) == 63, r, goto fail);
+		TEST_RING_VERIFY(rte_ring_dequeue_bulk(r, objs, 1,
+			NULL) == 0, r, goto fail);
+
+		TEST_RING_VERIFY(rte_ring_stats_get(r, &stats) == 0, r,
+			goto fail);
+		TEST_RING_VERIFY(stats.enq_success_bulk == 2 &&
+			stats.enq_success_objs == 63 &&
+			stats.enq_fail_bulk == 1 &&
+			stats.enq_fail_objs == 60 + 7, r, goto fail);
+		TEST_RING_VERIFY(stats.deq_success_bulk == 1 &&
+			stats.deq_success_objs == 63 &&
+			stats.deq_fail_bulk == 1 &&
+			stats.deq_fail_objs == 1 + 1, r, goto fail);
+		TEST_RING_VERIFY(stats.high_watermark == 63, r, goto fail);
+
+		/* sampled occupancy, always in the first bucket */
+		TEST_RING_VERIFY(rte_ring_stats_reset(r) == 0, r, goto fail);
+		for (j = 0; j < 4 * RTE_RING_STATS_SAMPLE_PERIOD; j++) {
+			rte_ring_enqueue(r, objs[0]);
+			rte_ring_dequeue(r, &objs[0]);
+		}
+		TEST_RING_VERIFY(rte_ring_stats_get(r, &stats) == 0, r,
+			goto fail);
+		samples = 0;
+		for (j = 0; j < RTE_RING_STATS_OCCUPANCY_BUCKETS; j++)
+			samples += stats.occupancy[j];
+		TEST_RING_VERIFY(samples == 4 && stats.occupancy[0] == 4, r,
+			goto fail);
+		TEST_RING_VERIFY(stats.high_watermark == 1 &&
+			stats.enq_fail_bulk == 0, r, goto fail);
+
+		rte_ring_free(r);
+	}
+
+	return 0;
+
+fail:
+	rte_ring_free(r);
+	return -1;
+}
+
+#define TELEMETRY_BUF_SIZE (16 * 1024)
+
+/* send a telemetry request and read its response */
+static int
+test_ring_telemetry_request(int sock, const char *req, char *buf)
+{
+	ssize_t bytes;
+
+	if (write(sock, req, strlen(req)) < 0)
+		return -1;
+	bytes = read(sock, buf, TELEMETRY_BUF_SIZE - 1);
+	if (bytes < 0)
+		return -1;
+	buf[bytes] = '\0';
+	printf("%s: %s\n", req, buf);
+
+	return 0;
+}
+
+/* the /ring/list and /ring/info telemetry commands */
+static int
+test_ring_telemetry(void)
+{
+	static char buf[TELEMETRY_BUF_SIZE];
+	struct sockaddr_un addr;
+	void *objs[3] = { NULL };
+	struct rte_ring *r;
+	int sock, ret = -1;
+
+	sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (sock < 0)
+		return -1;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path),
+		"%s/dpdk_telemetry.v2", rte_eal_get_runtime_dir());
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printf("Telemetry not available, skipping ring telemetry\n");
+		close(sock);
+		return 0;
+	}
+	/* welcome message */
+	if (read(sock, buf, sizeof(buf)) < 0) {
+		close(sock);
+		return -1;
+	}
+
+	r = rte_ring_create("test_ring_telem", 64, SOCKET_ID_ANY,
+		RING_F_SP_ENQ | RING_F_STATS);
+	if (r == NULL) {
+		close(sock);
+		return -1;
+	}
+	TEST_RING_VERIFY(rte_ring_enqueue_bulk(r, objs, 3, NULL) == 3, r,
+		goto exit);
+	TEST_RING_VERIFY(rte_ring_dequeue(r, &objs[0]) == 0, r, goto exit);
+
+	TEST_RING_VERIFY(test_ring_telemetry_request(sock, "/ring/list",
+		buf) == 0, r, goto exit);
+	TEST_RING_VERIFY(strstr(buf, "\"test_ring_telem\"") != NULL, r,
+		goto exit);
+
+	TEST_RING_VERIFY(test_ring_telemetry_request(sock,
+		"/ring/info,test_ring_telem", buf) == 0, r, goto exit);
+	TEST_RING_VERIFY(strstr(buf, "\"name\":\"test_ring_telem\"") != NULL &&
+		strstr(buf, "\"capacity\":63") != NULL &&
+		strstr(buf, "\"used_count\":2") != NULL &&
+		strstr(buf, "\"prod_sync_type\":\"ST\"") != NULL &&
+		strstr(buf, "\"cons_sync_type\":\"MT\"") != NULL, r,
+		goto exit);
+	TEST_RING_VERIFY(strstr(buf, "\"enq_success_objs\":3") != NULL &&
+		strstr(buf, "\"deq_success_objs\":1") != NULL &&
+		strstr(buf, "\"high_watermark\":3") != NULL &&
+		strstr(buf, "\"occupancy\":[") != NULL, r, goto exit);
+
+	/* unknown ring and missing parameter */
+	TEST_RING_VERIFY(test_ring_telemetry_request(sock,
+		"/ring/info,test_ring_none", buf) == 0, r, goto exit);
+	TEST_RING_VERIFY(strcmp(buf, "{\"/ring/info\":null}") == 0, r,
+		goto exit);
+	TEST_RING_VERIFY(test_ring_telemetry_request(sock, "/ring/info",
+		buf) == 0, r, goto exit);
+	TEST_RING_VERIFY(strcmp(buf, "{\"/ring/info\":null}") == 0, r,
+		goto exit);
+
+	ret = 0;
+exit:
+	rte_ring_free(r);
+	close(sock);
+	return ret;
+}
+
+static int
+test_ring_wait_producer(void *arg)
+{
+	struct rte_ring *r = arg;
+	void *obj = (void *)(uintptr_t)0x1234;
+
+	rte_delay_us_sleep(10 * 1000);
+	if (rte_ring_enqueue(r, obj) != 0)
+		return -1;
+	rte_ring_wake(r);
+
+	return 0;
+}
+
+/* consumers sleep on an empty ring until a producer wakes them up */
+static int
+test_ring_wait(void)
+{
+	struct rte_ring *r;
+	void *obj = NULL;
+	unsigned int lcore_id, nb_deq;
+	uint64_t start;
+	int ret = -1;
+
+	r = rte_ring_create("test_ring_wait", RING_SIZE, SOCKET_ID_ANY, 0);
+	if (r == NULL)
+		return -1;
+
+	TEST_RING_VERIFY(rte_ring_wait(r, RING_SIZE, 0) == -EINVAL, r,
+		goto exit);
+
+	/* empty ring: timeout */
+	start = rte_get_timer_cycles();
+	TEST_RING_VERIFY(rte_ring_wait(r, 1, 1000) == -ETIMEDOUT, r,
+		goto exit);
+	TEST_RING_VERIFY(rte_get_timer_cycles() - start >=
+		rte_get_timer_hz() / 1000, r, goto exit);
+	TEST_RING_VERIFY(rte_ring_dequeue_burst_wait(r, &obj, 1, NULL,
+		1000) == 0, r, goto exit);
+
+	/* available objects: no wait */
+	TEST_RING_VERIFY(rte_ring_enqueue(r, r) == 0, r, goto exit);
+	TEST_RING_VERIFY(rte_ring_wait(r, 1, 0) == 0, r, goto exit);
+	TEST_RING_VERIFY(rte_ring_dequeue_burst_wait(r, &obj, 1, NULL,
+		RTE_RING_WAIT_FOREVER) == 1 && obj == r, r, goto exit);
+
+	/* producer on another lcore */
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	if (lcore_id < RTE_MAX_LCORE) {
+		rte_eal_remote_launch(test_ring_wait_producer, r, lcore_id);
+		nb_deq = rte_ring_dequeue_burst_wait(r, &obj, 1, NULL,
+			RTE_RING_WAIT_FOREVER);
+		if (rte_eal_wait_lcore(lcore_id) != 0 || nb_deq != 1 ||
+				obj != (void *)(uintptr_t)0x1234) {
+			printf("Consumer not woken up: %u objects\n", nb_deq);
+			goto exit;
+		}
+		TEST_RING_VERIFY(r->nb_waiters == 0, r, goto exit);
+	}
+
+	ret = 0;
+exit:
+	rte_ring_free(r);
+	return ret;
+}
+
 static int
 test_ring(void)
 {
@@ -1232,6 +1471,15 @@ test_ring(void)
 			goto test_fail;
 	}
 
+	if (test_ring_stats() < 0)
+		goto test_fail;
+
+	if (test_ring_telemetry() < 0)
+		goto test_fail;
+
+	if (test_ring_wait() < 0)
+		goto test_fail;
+
 	/* dump the ring status */
 	rte_ring_list_dump(stdout);
 
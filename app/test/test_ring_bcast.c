@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_pause.h>
+#include <rte_ring_bcast.h>
+
+#include "test.h"
+
+#define RING_BCAST_SIZE 64
+#define RING_BCAST_NB_CONS 3
+#define RING_BCAST_MT_COUNT 100000
+
+static int
+test_ring_bcast_params(void)
+{
+	struct rte_ring_bcast *r;
+
+	r = rte_ring_bcast_create("test_bcast", 8, 63, 1, SOCKET_ID_ANY, 0);
+	TEST_ASSERT(r == NULL && rte_errno == EINVAL,
+		"Ring with invalid size created");
+	r = rte_ring_bcast_create("test_bcast", 8, 64, 0, SOCKET_ID_ANY, 0);
+	TEST_ASSERT(r == NULL && rte_errno == EINVAL,
+		"Ring without consumer created");
+
+	r = rte_ring_bcast_create("test_bcast", 8, 64, 1, SOCKET_ID_ANY, 0);
+	TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+	TEST_ASSERT(rte_ring_bcast_lookup("test_bcast") == r,
+		"Cannot lookup ring");
+	TEST_ASSERT_NULL(rte_ring_bcast_create("test_bcast", 8, 64, 1,
+		SOCKET_ID_ANY, 0), "Ring created twice");
+	rte_ring_bcast_free(r);
+	TEST_ASSERT_NULL(rte_ring_bcast_lookup("test_bcast"),
+		"Freed ring found");
+
+	return 0;
+}
+
+/* every consumer dequeues every element, the slowest one throttles */
+static int
+test_ring_bcast_blocking(void)
+{
+	uint64_t objs[RING_BCAST_SIZE], out[RING_BCAST_SIZE];
+	struct rte_ring_bcast *r;
+	unsigned int i, c, n, free_space;
+	int ret = -1;
+
+	r = rte_ring_bcast_create("test_bcast", sizeof(objs[0]),
+		RING_BCAST_SIZE, RING_BCAST_NB_CONS, SOCKET_ID_ANY, 0);
+	TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+
+	for (i = 0; i < RTE_DIM(objs); i++)
+		objs[i] = i;
+
+	n = rte_ring_bcast_enqueue_burst(r, objs, RTE_DIM(objs), &free_space);
+	if (n != RING_BCAST_SIZE - 1 || free_space != 0) {
+		printf("Enqueued %u elements in a ring of %u\n", n,
+			RING_BCAST_SIZE);
+		goto exit;
+	}
+
+	/* consumers 0 and 1 dequeue all, consumer 2 only half */
+	for (c = 0; c < RING_BCAST_NB_CONS; c++) {
+		n = rte_ring_bcast_dequeue_burst(r, c, out,
+			c == 2 ? RING_BCAST_SIZE / 2 : RTE_DIM(out), NULL);
+		for (i = 0; i < n; i++)
+			if (out[i] != i) {
+				printf("Consumer %u got %"PRIu64" at %u\n", c,
+					out[i], i);
+				goto exit;
+			}
+	}
+
+	/* only the room freed by the slowest consumer can be used */
+	n = rte_ring_bcast_enqueue_burst(r, objs, RTE_DIM(objs), NULL);
+	if (n != RING_BCAST_SIZE / 2) {
+		printf("Enqueued %u elements, slowest consumer ignored\n", n);
+		goto exit;
+	}
+	if (rte_ring_bcast_enqueue_bulk(r, objs, 1, NULL) != 0) {
+		printf("Enqueued in full ring\n");
+		goto exit;
+	}
+
+	/* elements wrapped in the ring are received in order */
+	n = rte_ring_bcast_dequeue_bulk(r, 0, out, RING_BCAST_SIZE / 2,
+		NULL);
+	for (i = 0; i < n; i++)
+		if (out[i] != i) {
+			printf("Wrapped element %"PRIu64" at %u\n", out[i], i);
+			goto exit;
+		}
+	if (n != RING_BCAST_SIZE / 2 ||
+			rte_ring_bcast_dequeue_bulk(r, 0, out, 1, NULL) != 0) {
+		printf("Wrong number of elements for consumer 0\n");
+		goto exit;
+	}
+
+	ret = 0;
+exit:
+	rte_ring_bcast_free(r);
+	return ret;
+}
+
+/* slow consumers lose the oldest elements and get the latest ones */
+static int
+test_ring_bcast_lossy(void)
+{
+	uint64_t objs[RING_BCAST_SIZE], out[RING_BCAST_SIZE];
+	struct rte_ring_bcast *r;
+	unsigned int i, n, available;
+	int ret = -1;
+
+	r = rte_ring_bcast_create("test_bcast", sizeof(objs[0]),
+		RING_BCAST_SIZE, 2, SOCKET_ID_ANY, RTE_RING_BCAST_F_LOSSY);
+	TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+
+	for (i = 0; i < RTE_DIM(objs); i++)
+		objs[i] = i;
+
+	/* three times the ring capacity */
+	for (i = 0; i < 3; i++)
+		if (rte_ring_bcast_enqueue_bulk(r, objs,
+				RING_BCAST_SIZE - 1, NULL) == 0) {
+			printf("Lossy producer blocked\n");
+			goto exit;
+		}
+
+	n = rte_ring_bcast_dequeue_burst(r, 0, out, RTE_DIM(out), &available);
+	if (n != RING_BCAST_SIZE - 1 || available != 0 ||
+			rte_ring_bcast_lost(r, 0) != 2 * (RING_BCAST_SIZE - 1)) {
+		printf("Dequeued %u elements, lost %"PRIu64"\n", n,
+			rte_ring_bcast_lost(r, 0));
+		goto exit;
+	}
+	for (i = 0; i < n; i++)
+		if (out[i] != i) {
+			printf("Wrong element %"PRIu64" at %u\n", out[i], i);
+			goto exit;
+		}
+	if (rte_ring_bcast_lost(r, 1) != 0) {
+		printf("Loss accounted to idle consumer\n");
+		goto exit;
+	}
+
+	ret = 0;
+exit:
+	rte_ring_bcast_free(r);
+	return ret;
+}
+
+static int
+ring_bcast_mt_consumer(void *arg)
+{
+	struct rte_ring_bcast *r = arg;
+	unsigned int cons_id = rte_lcore_index(rte_lcore_id()) - 1;
+	uint64_t out[32], next = 0;
+	unsigned int i, n;
+
+	while (next < RING_BCAST_MT_COUNT) {
+		n = rte_ring_bcast_dequeue_burst(r, cons_id, out, RTE_DIM(out),
+			NULL);
+		for (i = 0; i < n; i++)
+			if (out[i] != next++)
+				return -1;
+		if (n == 0)
+			rte_pause();
+	}
+
+	return 0;
+}
+
+/* the producer runs concurrently with one consumer per worker lcore */
+static int
+test_ring_bcast_mt(void)
+{
+	uint64_t objs[16];
+	struct rte_ring_bcast *r;
+	unsigned int lcore_id, i;
+	uint64_t seq = 0;
+	int ret = 0;
+
+	if (rte_lcore_count() < 2)
+		return 0;
+
+	r = rte_ring_bcast_create("test_bcast", sizeof(objs[0]),
+		RING_BCAST_SIZE, rte_lcore_count() - 1, SOCKET_ID_ANY, 0);
+	TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(ring_bcast_mt_consumer, r, lcore_id);
+
+	while (seq < RING_BCAST_MT_COUNT) {
+		for (i = 0; i < RTE_DIM(objs); i++)
+			objs[i] = seq + i;
+		seq += rte_ring_bcast_enqueue_burst(r, objs,
+			RTE_MIN(RTE_DIM(objs), RING_BCAST_MT_COUNT - seq), NULL);
+	}
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	rte_ring_bcast_free(r);
+
+	TEST_ASSERT_SUCCESS(ret, "Consumer got elements out of order");
+	return 0;
+}
+
+static int
+test_ring_bcast(void)
+{
+	if (test_ring_bcast_params() < 0)
+		return -1;
+	if (test_ring_bcast_blocking() < 0)
+		return -1;
+	if (test_ring_bcast_lossy() < 0)
+		return -1;
+	if (test_ring_bcast_mt() < 0)
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(ring_bcast_autotest, test_ring_bcast);
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_ring_msg.h>
+
+#include "test.h"
+
+#define RING_MSG_SIZE 64 /* elements */
+#define RING_MSG_MAX_LEN 256
+/* two records and a padding fit in the ring */
+#define RING_MSG_COPY_MAX_LEN 160
+#define RING_MSG_MT_COUNT 20000
+
+static const struct {
+	const char *name;
+	unsigned int flags;
+	bool mt;
+} ring_msg_modes[] = {
+	{ "SP/SC", RING_F_SP_ENQ | RING_F_SC_DEQ, false },
+	{ "MP/MC", 0, true },
+	{ "MP_RTS/MC_RTS", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ, true },
+	{ "MP_HTS/MC_HTS", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ, true },
+};
+
+static void
+ring_msg_fill(uint8_t *msg, uint32_t len, uint32_t seed)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		msg[i] = (uint8_t)(seed + i);
+}
+
+static int
+ring_msg_check(const uint8_t *msg, uint32_t len, uint32_t seed)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		if (msg[i] != (uint8_t)(seed + i))
+			return -1;
+	return 0;
+}
+
+/* enqueue and dequeue messages of all lengths, wrapping many times */
+static int
+test_ring_msg_copy(struct rte_ring *r)
+{
+	uint8_t msg[RING_MSG_MAX_LEN], buf[RING_MSG_MAX_LEN];
+	uint32_t len, i;
+	int ret;
+
+	for (i = 0; i < 1000; i++) {
+		len = (i * 7) % (RING_MSG_COPY_MAX_LEN + 1);
+		ring_msg_fill(msg, len, i);
+		TEST_ASSERT_SUCCESS(rte_ring_msg_enqueue(r, msg, len),
+			"Cannot enqueue message %u of %u bytes", i, len);
+		/* keep one message in the ring to test the padding */
+		if (i == 0)
+			continue;
+		ret = rte_ring_msg_dequeue(r, buf, sizeof(buf));
+		len = ((i - 1) * 7) % (RING_MSG_COPY_MAX_LEN + 1);
+		TEST_ASSERT_EQUAL(ret, (int)len, "Wrong length %d", ret);
+		TEST_ASSERT_SUCCESS(ring_msg_check(buf, len, i - 1),
+			"Wrong message %u", i - 1);
+	}
+	TEST_ASSERT(rte_ring_msg_dequeue(r, buf, sizeof(buf)) >= 0,
+		"Cannot dequeue last message");
+	TEST_ASSERT_EQUAL(rte_ring_msg_dequeue(r, buf, sizeof(buf)), -ENOENT,
+		"Dequeue from empty ring");
+	TEST_ASSERT(rte_ring_empty(r), "Ring not empty");
+
+	return 0;
+}
+
+static int
+test_ring_msg_limits(struct rte_ring *r)
+{
+	uint8_t msg[RING_MSG_MAX_LEN], buf[8];
+	uint32_t max_len = (RING_MSG_SIZE / 2 - 1) * RTE_RING_MSG_ALIGN;
+	unsigned int nb_msgs = 0;
+
+	TEST_ASSERT_EQUAL(rte_ring_msg_enqueue(r, msg, max_len + 1), -EINVAL,
+		"Too long message accepted");
+
+	/* the longest message fits whatever the position in the ring */
+	ring_msg_fill(msg, max_len, 0);
+	TEST_ASSERT_SUCCESS(rte_ring_msg_enqueue(r, msg, 8),
+		"Cannot enqueue message");
+	TEST_ASSERT(rte_ring_msg_dequeue(r, buf, sizeof(buf)) == 8,
+		"Cannot dequeue message");
+	TEST_ASSERT_SUCCESS(rte_ring_msg_enqueue(r, msg, max_len),
+		"Cannot enqueue longest message");
+
+	/* truncated message */
+	TEST_ASSERT_EQUAL(rte_ring_msg_dequeue(r, buf, sizeof(buf)),
+		(int)max_len, "Wrong length of truncated message");
+	TEST_ASSERT_SUCCESS(ring_msg_check(buf, sizeof(buf), 0),
+		"Wrong truncated message");
+
+	/* full ring */
+	while (rte_ring_msg_enqueue(r, msg, 16) == 0)
+		nb_msgs++;
+	/* records of 3 elements, and maybe a padding at the end of the ring */
+	TEST_ASSERT(nb_msgs >= (RING_MSG_SIZE - 1) / 3 - 1,
+		"Only %u messages in full ring", nb_msgs);
+	TEST_ASSERT_EQUAL(rte_ring_msg_enqueue(r, msg, 16), -ENOBUFS,
+		"Enqueue in full ring");
+	while (nb_msgs-- > 0)
+		TEST_ASSERT_EQUAL(rte_ring_msg_dequeue(r, buf, sizeof(buf)), 16,
+			"Cannot dequeue from full ring");
+	TEST_ASSERT(rte_ring_empty(r), "Ring not empty");
+
+	return 0;
+}
+
+static int
+test_ring_msg_zc(struct rte_ring *r)
+{
+	struct rte_ring_msg_zc zc;
+	uint32_t i;
+
+	for (i = 0; i < 100; i++) {
+		TEST_ASSERT_SUCCESS(rte_ring_msg_enqueue_reserve(r, 96, &zc),
+			"Cannot reserve message");
+		TEST_ASSERT(((uintptr_t)zc.msg % RTE_RING_MSG_ALIGN) == 0,
+			"Misaligned message");
+		/* shorter message than reserved */
+		ring_msg_fill(zc.msg, 40, i);
+		zc.len = 40;
+		rte_ring_msg_enqueue_commit(r, &zc);
+
+		TEST_ASSERT_SUCCESS(rte_ring_msg_dequeue_peek(r, &zc),
+			"Cannot peek message");
+		TEST_ASSERT_EQUAL(zc.len, 40U, "Wrong length %u", zc.len);
+		TEST_ASSERT(((uintptr_t)zc.msg % RTE_RING_MSG_ALIGN) == 0,
+			"Misaligned message");
+		TEST_ASSERT_SUCCESS(ring_msg_check(zc.msg, zc.len, i),
+			"Wrong message %u", i);
+		rte_ring_msg_dequeue_release(r, &zc);
+	}
+	TEST_ASSERT_EQUAL(rte_ring_msg_dequeue_peek(r, &zc), -ENOENT,
+		"Peek from empty ring");
+	TEST_ASSERT(rte_ring_empty(r), "Ring not empty");
+
+	return 0;
+}
+
+struct ring_msg_mt_msg {
+	uint32_t lcore_id;
+	uint32_t seq;
+	uint8_t data[];
+};
+
+static int
+ring_msg_mt_producer(void *arg)
+{
+	struct rte_ring *r = arg;
+	struct ring_msg_mt_msg *m;
+	struct rte_ring_msg_zc zc;
+	uint32_t seq, len;
+
+	for (seq = 0; seq < RING_MSG_MT_COUNT; seq++) {
+		len = sizeof(*m) + seq % 64;
+		while (rte_ring_msg_enqueue_reserve(r, len, &zc) != 0)
+			rte_pause();
+		m = zc.msg;
+		m->lcore_id = rte_lcore_id();
+		m->seq = seq;
+		ring_msg_fill(m->data, len - sizeof(*m), seq);
+		rte_ring_msg_enqueue_commit(r, &zc);
+	}
+
+	return 0;
+}
+
+/* messages of all the producers are received in order and intact */
+static int
+test_ring_msg_mt(struct rte_ring *r)
+{
+	uint32_t next_seq[RTE_MAX_LCORE] = { 0 };
+	uint8_t buf[RING_MSG_MAX_LEN];
+	struct ring_msg_mt_msg *m = (struct ring_msg_mt_msg *)buf;
+	unsigned int lcore_id, nb_workers = 0;
+	uint32_t total;
+	int len;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_eal_remote_launch(ring_msg_mt_producer, r, lcore_id);
+		nb_workers++;
+	}
+
+	for (total = 0; total < nb_workers * RING_MSG_MT_COUNT; total++) {
+		while ((len = rte_ring_msg_dequeue(r, buf, sizeof(buf))) < 0)
+			rte_pause();
+		TEST_ASSERT(m->lcore_id < RTE_MAX_LCORE &&
+			m->seq == next_seq[m->lcore_id],
+			"Unexpected message %u from lcore %u", m->seq,
+			m->lcore_id);
+		TEST_ASSERT_EQUAL(len, (int)(sizeof(*m) + m->seq % 64),
+			"Wrong length %d", len);
+		TEST_ASSERT_SUCCESS(ring_msg_check(m->data, len - sizeof(*m),
+			m->seq), "Wrong message %u from lcore %u", m->seq,
+			m->lcore_id);
+		next_seq[m->lcore_id]++;
+	}
+	rte_eal_mp_wait_lcore();
+	TEST_ASSERT(rte_ring_empty(r), "Ring not empty");
+
+	return 0;
+}
+
+static int
+test_ring_msg(void)
+{
+	struct rte_ring *r;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < RTE_DIM(ring_msg_modes) && ret == 0; i++) {
+		printf("Testing %s message ring\n", ring_msg_modes[i].name);
+		r = rte_ring_create_elem("test_ring_msg", RTE_RING_MSG_ALIGN,
+			RING_MSG_SIZE, SOCKET_ID_ANY, ring_msg_modes[i].flags);
+		TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+
+		ret = test_ring_msg_copy(r);
+		if (ret == 0)
+			ret = test_ring_msg_limits(r);
+		if (ret == 0)
+			ret = test_ring_msg_zc(r);
+		if (ret == 0 && ring_msg_modes[i].mt &&
+				rte_lcore_count() > 1)
+			ret = test_ring_msg_mt(r);
+		rte_ring_free(r);
+	}
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(ring_msg_autotest, test_ring_msg);
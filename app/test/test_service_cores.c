@@ -1002,6 +1002,139 @@ service_active_two_cores(void)
 	return unregister_all();
 }
 
+static int32_t
+balancer_busy_cb(void *args)
+{
+	RTE_SET_USED(args);
+	rte_delay_us(100);
+	return 0;
+}
+
+static int
+balancer_register(const char *name, uint32_t capabilities, uint32_t *id)
+{
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = balancer_busy_cb;
+	service.capabilities = capabilities;
+	snprintf(service.name, sizeof(service.name), "%s", name);
+
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, id),
+			"Failed to register valid service");
+	rte_service_component_runstate_set(*id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_set_stats_enable(*id, 1),
+			"Enabling stats on valid service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_set(*id, 1),
+			"Starting valid service failed");
+
+	return TEST_SUCCESS;
+}
+
+/* check the balancer moves and replicates services from a busy core */
+static int
+service_balancer(void)
+{
+	if (!rte_lcore_is_enabled(0) || !rte_lcore_is_enabled(1) ||
+	    !rte_lcore_is_enabled(2))
+		return TEST_SKIPPED;
+
+	uint32_t unsafe_a, unsafe_b, safe;
+	uint32_t lcore = rte_get_next_lcore(/* start core */ -1,
+					    /* skip main */ 1,
+					    /* wrap */ 0);
+	uint32_t lcore2 = rte_get_next_lcore(/* start core */ lcore,
+					     /* skip main */ 1,
+					     /* wrap */ 0);
+
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_balancer_enable(0),
+			"Invalid balancer period accepted");
+	TEST_ASSERT_EQUAL(0, rte_service_balancer_enable(10),
+			"Enabling the balancer failed");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_balancer_enable(10),
+			"Enabling the balancer twice did not fail");
+	TEST_ASSERT_EQUAL(0, rte_service_balancer_disable(),
+			"Disabling the balancer failed");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_balancer_disable(),
+			"Disabling the balancer twice did not fail");
+
+	TEST_ASSERT_EQUAL(TEST_SUCCESS,
+			balancer_register("balancer_unsafe_a", 0, &unsafe_a),
+			"Registering service failed");
+	TEST_ASSERT_EQUAL(TEST_SUCCESS,
+			balancer_register("balancer_unsafe_b", 0, &unsafe_b),
+			"Registering service failed");
+
+	/* both MT unsafe services on the first core, the second one idle */
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore),
+			"Add service core failed when not in use before");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore2),
+			"Add service core failed when not in use before");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(unsafe_a, lcore, 1),
+			"Enabling valid service on valid core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(unsafe_b, lcore, 1),
+			"Enabling valid service on valid core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore),
+			"Service core start after add failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore2),
+			"Service core start after add failed");
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_balance(),
+			"First balancer pass changed the mapping");
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_balance(),
+			"Balancer did not migrate a service");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore),
+			"Busy core still runs both services");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore2),
+			"Idle core did not get a service");
+
+	/* a busy MT safe service is replicated on the idle core */
+	rte_service_map_lcore_set(unsafe_a, lcore, 0);
+	rte_service_map_lcore_set(unsafe_a, lcore2, 0);
+	rte_service_map_lcore_set(unsafe_b, lcore, 0);
+	rte_service_map_lcore_set(unsafe_b, lcore2, 0);
+	TEST_ASSERT_EQUAL(TEST_SUCCESS,
+			balancer_register("balancer_safe",
+				RTE_SERVICE_CAP_MT_SAFE, &safe),
+			"Registering service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(safe, lcore, 1),
+			"Enabling valid service on valid core failed");
+
+	rte_service_lcore_balance();
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_balance(),
+			"Balancer did not replicate a service");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(safe, lcore),
+			"Replicated service unmapped from its core");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(safe, lcore2),
+			"Service not replicated on the idle core");
+
+	/* once idle, only the replica added by the balancer is removed */
+	rte_service_runstate_set(safe, 0);
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_balance(),
+			"Balancer did not remove the replica");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(safe, lcore),
+			"Balancer removed the application mapping");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_get(safe, lcore2),
+			"Replica still mapped on an idle core");
+
+	/* an idle service mapped on both cores by the application stays */
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(safe, lcore2, 1),
+			"Enabling valid service on valid core failed");
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_balance(),
+			"Balancer removed an application mapping");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(safe, lcore2),
+			"Balancer removed an application mapping");
+
+	rte_service_runstate_set(unsafe_a, 0);
+	rte_service_runstate_set(unsafe_b, 0);
+
+	return unregister_all();
+}
+
 static struct unit_test_suite service_tests  = {
 	.suite_name = "service core test suite",
 	.setup = testsuite_setup,
@@ -1024,6 +1157,7 @@ static struct unit_test_suite service_tests  = {
 		TEST_CASE_ST(dummy_register, NULL, service_app_lcore_mt_unsafe),
 		TEST_CASE_ST(dummy_register, NULL, service_may_be_active),
 		TEST_CASE_ST(dummy_register, NULL, service_active_two_cores),
+		TEST_CASE_ST(dummy_register, NULL, service_balancer),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
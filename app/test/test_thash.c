@@ -6,6 +6,7 @@
 #include <rte_eal.h>
 #include <rte_ip.h>
 #include <rte_random.h>
+#include <rte_vect.h>
 
 #include "test.h"
 
@@ -571,6 +572,75 @@ test_adjust_tuple(void)
 	return TEST_SUCCESS;
 }
 
+#define BULK_TUPLES	33
+#define BULK_TUPLE_MAX	(sizeof(default_rss_key) - 4)
+
+/* hash with rte_softrss() a tuple in network byte order padded with zeros */
+static uint32_t
+bulk_ref_hash(const uint8_t *tuple, uint32_t len)
+{
+	uint32_t words[RTE_ALIGN(BULK_TUPLE_MAX, 4) / 4] = { 0 };
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		words[i / 4] |= (uint32_t)tuple[i] << (24 - 8 * (i % 4));
+
+	return rte_softrss(words, RTE_ALIGN(len, 4) / 4, default_rss_key);
+}
+
+static int
+test_bulk_hash(void)
+{
+	uint8_t buf[BULK_TUPLES][BULK_TUPLE_MAX];
+	const uint8_t *tuples[BULK_TUPLES];
+	uint32_t hashes[BULK_TUPLES], len, i, j;
+	struct rte_thash_bulk *tb[2];
+	uint16_t simd_bitwidth;
+
+	RTE_TEST_ASSERT(rte_thash_bulk_create(default_rss_key, 4,
+		SOCKET_ID_ANY) == NULL, "Created with too short key\n");
+
+	/* vector implementation if supported and table driven one */
+	simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_512);
+	tb[0] = rte_thash_bulk_create(default_rss_key,
+		sizeof(default_rss_key), SOCKET_ID_ANY);
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_DISABLED);
+	tb[1] = rte_thash_bulk_create(default_rss_key,
+		sizeof(default_rss_key), SOCKET_ID_ANY);
+	rte_vect_set_max_simd_bitwidth(simd_bitwidth);
+	RTE_TEST_ASSERT(tb[0] != NULL && tb[1] != NULL,
+		"Can not create bulk thash\n");
+
+	for (i = 0; i < BULK_TUPLES; i++) {
+		for (j = 0; j < BULK_TUPLE_MAX; j++)
+			buf[i][j] = rte_rand();
+		tuples[i] = buf[i];
+	}
+
+	for (i = 0; i < RTE_DIM(tb); i++) {
+		RTE_TEST_ASSERT(rte_thash_bulk_hash(tb[i], tuples,
+			BULK_TUPLE_MAX + 1, hashes, BULK_TUPLES) == -EINVAL,
+			"Hashed too long tuples\n");
+		/* every length and an odd number of tuples */
+		for (len = 0; len <= BULK_TUPLE_MAX; len++) {
+			RTE_TEST_ASSERT(rte_thash_bulk_hash(tb[i], tuples, len,
+				hashes, BULK_TUPLES) == 0,
+				"Can not hash tuples\n");
+			for (j = 0; j < BULK_TUPLES; j++)
+				RTE_TEST_ASSERT(hashes[j] ==
+					bulk_ref_hash(tuples[j], len),
+					"Wrong hash of %u bytes tuple %u\n",
+					len, j);
+		}
+	}
+
+	rte_thash_bulk_free(tb[0]);
+	rte_thash_bulk_free(tb[1]);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite thash_tests = {
 	.suite_name = "thash autotest",
 	.setup = NULL,
@@ -587,6 +657,7 @@ static struct unit_test_suite thash_tests = {
 	TEST_CASE(test_predictable_rss_min_seq),
 	TEST_CASE(test_predictable_rss_multirange),
 	TEST_CASE(test_adjust_tuple),
+	TEST_CASE(test_bulk_hash),
 	TEST_CASES_END()
 	}
 };
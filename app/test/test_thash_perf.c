@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_thash.h>
+#include <rte_vect.h>
+
+#include "test.h"
+
+#define THASH_PERF_TUPLES	4096
+#define THASH_PERF_BURST	32
+#define THASH_PERF_ITERATIONS	256
+#define THASH_PERF_TUPLE_MAX	RTE_THASH_V6_L4_LEN
+
+static const uint8_t rss_key[] = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+static const struct {
+	const char *name;
+	uint32_t len; /* in 4-bytes chunks */
+} thash_perf_tuples[] = {
+	{ "IPv4 L3", RTE_THASH_V4_L3_LEN },
+	{ "IPv4 L4", RTE_THASH_V4_L4_LEN },
+	{ "IPv6 L3", RTE_THASH_V6_L3_LEN },
+	{ "IPv6 L4", RTE_THASH_V6_L4_LEN },
+};
+
+/* same tuples in host order for rte_softrss and network order for bulk */
+static uint32_t tuples_cpu[THASH_PERF_TUPLES][THASH_PERF_TUPLE_MAX];
+static uint32_t tuples_be[THASH_PERF_TUPLES][THASH_PERF_TUPLE_MAX];
+static const uint8_t *tuples_ptr[THASH_PERF_TUPLES];
+static uint32_t hashes[THASH_PERF_TUPLES];
+
+static double
+thash_perf_softrss(uint32_t len, const uint8_t *key, int be)
+{
+	uint64_t start, ticks;
+	uint32_t i, j;
+
+	start = rte_rdtsc();
+	for (i = 0; i < THASH_PERF_ITERATIONS; i++)
+		for (j = 0; j < THASH_PERF_TUPLES; j++)
+			hashes[j] = be ?
+				rte_softrss_be(tuples_cpu[j], len, key) :
+				rte_softrss(tuples_cpu[j], len, key);
+	ticks = rte_rdtsc() - start;
+
+	return (double)ticks / (THASH_PERF_ITERATIONS * THASH_PERF_TUPLES);
+}
+
+static double
+thash_perf_bulk(uint32_t len, const struct rte_thash_bulk *tb)
+{
+	uint64_t start, ticks;
+	uint32_t i, j;
+
+	start = rte_rdtsc();
+	for (i = 0; i < THASH_PERF_ITERATIONS; i++)
+		for (j = 0; j < THASH_PERF_TUPLES; j += THASH_PERF_BURST)
+			rte_thash_bulk_hash(tb, &tuples_ptr[j], len * 4,
+				&hashes[j], THASH_PERF_BURST);
+	ticks = rte_rdtsc() - start;
+
+	return (double)ticks / (THASH_PERF_ITERATIONS * THASH_PERF_TUPLES);
+}
+
+static int
+test_thash_perf(void)
+{
+	uint8_t rss_key_be[RTE_DIM(rss_key)];
+	struct rte_thash_bulk *tb, *tb_scalar;
+	uint16_t simd_bitwidth;
+	uint32_t i, j, len;
+
+	rte_convert_rss_key((const uint32_t *)rss_key,
+		(uint32_t *)rss_key_be, RTE_DIM(rss_key));
+
+	simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_512);
+	tb = rte_thash_bulk_create(rss_key, sizeof(rss_key), SOCKET_ID_ANY);
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_DISABLED);
+	tb_scalar = rte_thash_bulk_create(rss_key, sizeof(rss_key),
+		SOCKET_ID_ANY);
+	rte_vect_set_max_simd_bitwidth(simd_bitwidth);
+	if (tb == NULL || tb_scalar == NULL) {
+		printf("Can not create bulk thash\n");
+		rte_thash_bulk_free(tb);
+		rte_thash_bulk_free(tb_scalar);
+		return -1;
+	}
+
+	for (i = 0; i < THASH_PERF_TUPLES; i++) {
+		for (j = 0; j < THASH_PERF_TUPLE_MAX; j++) {
+			tuples_cpu[i][j] = rte_rand();
+			tuples_be[i][j] = rte_cpu_to_be_32(tuples_cpu[i][j]);
+		}
+		tuples_ptr[i] = (const uint8_t *)tuples_be[i];
+	}
+
+	printf(" *** Toeplitz hash performance test results ***\n");
+	printf("Bursts of %u tuples for bulk hash\n", THASH_PERF_BURST);
+	printf("Tuple  , softrss, softrss_be, bulk scalar, bulk vector "
+		"(cycles/tuple)\n");
+	for (i = 0; i < RTE_DIM(thash_perf_tuples); i++) {
+		len = thash_perf_tuples[i].len;
+		printf("%-7s, %7.2f, %10.2f, %11.2f, %11.2f\n",
+			thash_perf_tuples[i].name,
+			thash_perf_softrss(len, rss_key, 0),
+			thash_perf_softrss(len, rss_key_be, 1),
+			thash_perf_bulk(len, tb_scalar),
+			thash_perf_bulk(len, tb));
+	}
+
+	rte_thash_bulk_free(tb);
+	rte_thash_bulk_free(tb_scalar);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(thash_perf_autotest, test_thash_perf);
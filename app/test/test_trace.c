@@ -2,8 +2,14 @@
  * Copyright(C) 2020 Marvell International Ltd.
  */
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <rte_eal_trace.h>
 #include <rte_lcore.h>
+#include <rte_string_fns.h>
 #include <rte_trace.h>
 
 #include "test.h"
@@ -172,6 +178,112 @@ test_generic_trace_points(void)
 	return TEST_SUCCESS;
 }
 
+static int
+test_trace_recorder_dump(void)
+{
+	int rc;
+
+	rc = rte_trace_recorder_dump();
+	if (rc == -ENOTSUP)
+		return TEST_SKIPPED;
+
+	/* dumps are numbered in sequence */
+	TEST_ASSERT(rc >= 0, "recorder dump failed: %d", rc);
+	TEST_ASSERT_EQUAL(rte_trace_recorder_dump(), rc + 1,
+			"unexpected recorder dump index");
+
+	return TEST_SUCCESS;
+}
+
+/* get the trace directory, buffer length and buffer index of this thread */
+static int
+trace_recorder_info(char *dir, size_t size, uint32_t *len, uint32_t *id)
+{
+	char mem[32], line[PATH_MAX + 16];
+	char *buf = NULL;
+	size_t buf_len;
+	int found = 0;
+	FILE *f;
+
+	f = open_memstream(&buf, &buf_len);
+	if (f == NULL)
+		return -1;
+	rte_trace_dump(f);
+	fclose(f);
+
+	snprintf(mem, sizeof(mem), "mem=%p,", RTE_PER_LCORE(trace_mem));
+	f = fmemopen(buf, buf_len, "r");
+	if (f == NULL) {
+		free(buf);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strstr(line, mem) != NULL &&
+				sscanf(line, "\tid %" SCNu32 ",", id) == 1)
+			found |= 1;
+		else if (sscanf(line, "buffer len = %" SCNu32, len) == 1)
+			found |= 2;
+		else if (strncmp(line, "dir = ", 6) == 0) {
+			line[strcspn(line, "\n")] = '\0';
+			strlcpy(dir, line + 6, size);
+			found |= 4;
+		}
+	}
+	fclose(f);
+	free(buf);
+
+	return found == 7 ? 0 : -1;
+}
+
+/* a wrapped buffer is dumped whole, oldest events first */
+static int
+test_trace_recorder_wrap(void)
+{
+	struct {
+		uint64_t header;
+		uint64_t val;
+	} ev;
+	char dir[PATH_MAX], path[PATH_MAX + 32];
+	uint32_t len, id, nb_events, count;
+	uint64_t i, nb;
+	FILE *f;
+	int rc;
+
+	if (rte_trace_recorder_dump() == -ENOTSUP)
+		return TEST_SKIPPED;
+
+	/* 16B events, fill the buffer twice and wrap a third time */
+	rte_eal_trace_generic_u64(0);
+	TEST_ASSERT_SUCCESS(trace_recorder_info(dir, sizeof(dir), &len, &id),
+			"cannot get trace info");
+	nb_events = len / sizeof(ev) - 1;
+	nb = 2 * nb_events + nb_events / 3;
+	for (i = 1; i <= nb; i++)
+		rte_eal_trace_generic_u64(i);
+
+	rc = rte_trace_recorder_dump();
+	TEST_ASSERT(rc >= 0, "recorder dump failed: %d", rc);
+
+	snprintf(path, sizeof(path), "%s/dump-%d/channel0_%" PRIu32, dir, rc,
+			id);
+	f = fopen(path, "r");
+	TEST_ASSERT_NOT_NULL(f, "cannot open %s", path);
+	if (fseek(f, sizeof(struct __rte_trace_stream_header), SEEK_SET) != 0)
+		goto fail;
+	for (count = 0; fread(&ev, sizeof(ev), 1, f) == 1; count++)
+		if (ev.val != nb - nb_events + 1 + count)
+			goto fail;
+	fclose(f);
+
+	TEST_ASSERT_EQUAL(count, nb_events, "%" PRIu32 " events dumped",
+			count);
+
+	return TEST_SUCCESS;
+fail:
+	fclose(f);
+	return TEST_FAILED;
+}
+
 static struct unit_test_suite trace_tests = {
 	.suite_name = "trace autotest",
 	.setup = NULL,
@@ -196,6 +308,26 @@ test_trace(void)
 
 REGISTER_TEST_COMMAND(trace_autotest, test_trace);
 
+static struct unit_test_suite trace_recorder_tests = {
+	.suite_name = "trace recorder autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_trace_recorder_dump),
+		TEST_CASE(test_trace_recorder_wrap),
+		TEST_CASES_END()
+	}
+};
+
+/* run with --trace-recorder */
+static int
+test_trace_recorder(void)
+{
+	return unit_test_suite_runner(&trace_recorder_tests);
+}
+
+REGISTER_TEST_COMMAND(trace_recorder_autotest, test_trace_recorder);
+
 static int
 test_trace_dump(void)
 {
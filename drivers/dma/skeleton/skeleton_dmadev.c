@@ -78,7 +78,8 @@ cpucopy_thread(void *param)
 		}
 
 		hw->zero_req_count = 0;
-		rte_memcpy(desc->dst, desc->src, desc->len);
+		/* as a DMA engine, do not evict the caches of the cores */
+		rte_memcpy_nt(desc->dst, desc->src, desc->len);
 		__atomic_add_fetch(&hw->completed_count, 1, __ATOMIC_RELEASE);
 		(void)rte_ring_enqueue(hw->desc_completed, (void *)desc);
 	}
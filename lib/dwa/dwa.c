@@ -2,6 +2,210 @@
  * Copyright(C) 2021 Marvell.
  */
 
+#include <stdlib.h>
+#include <string.h>
 
 #include <rte_dwa.h>
+#include <rte_spinlock.h>
+#include <rte_string_fns.h>
+#include <rte_telemetry.h>
 
+/** Max number of statistics blocks exposed through telemetry. */
+#define DWA_STATS_REG_MAX 64
+/** Max number of attempts to read a consistent statistics block. */
+#define DWA_STATS_READ_TRIES 1024
+
+struct dwa_stats_reg {
+	char name[RTE_DWA_STATS_NAME_LEN];
+	const struct rte_dwa_stats_shm *shm;
+};
+
+static struct dwa_stats_reg dwa_stats_regs[DWA_STATS_REG_MAX];
+static rte_spinlock_t dwa_stats_lock = RTE_SPINLOCK_INITIALIZER;
+
+static struct dwa_stats_reg *
+dwa_stats_reg_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < DWA_STATS_REG_MAX; i++)
+		if (dwa_stats_regs[i].shm != NULL &&
+		    strcmp(dwa_stats_regs[i].name, name) == 0)
+			return &dwa_stats_regs[i];
+
+	return NULL;
+}
+
+int
+rte_dwa_stats_register(const char *name, const struct rte_dwa_stats_shm *shm)
+{
+	struct dwa_stats_reg *reg = NULL;
+	int i, rc = 0;
+
+	if (name == NULL || shm == NULL ||
+	    strnlen(name, RTE_DWA_STATS_NAME_LEN) == RTE_DWA_STATS_NAME_LEN)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dwa_stats_lock);
+	if (dwa_stats_reg_find(name) != NULL) {
+		rc = -EEXIST;
+		goto exit;
+	}
+
+	for (i = 0; i < DWA_STATS_REG_MAX; i++)
+		if (dwa_stats_regs[i].shm == NULL) {
+			reg = &dwa_stats_regs[i];
+			break;
+		}
+	if (reg == NULL) {
+		rc = -ENOSPC;
+		goto exit;
+	}
+
+	strlcpy(reg->name, name, sizeof(reg->name));
+	reg->shm = shm;
+exit:
+	rte_spinlock_unlock(&dwa_stats_lock);
+	return rc;
+}
+
+int
+rte_dwa_stats_unregister(const char *name)
+{
+	struct dwa_stats_reg *reg;
+	int rc = -ENOENT;
+
+	if (name == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dwa_stats_lock);
+	reg = dwa_stats_reg_find(name);
+	if (reg != NULL) {
+		memset(reg, 0, sizeof(*reg));
+		rc = 0;
+	}
+	rte_spinlock_unlock(&dwa_stats_lock);
+
+	return rc;
+}
+
+static int
+dwa_handle_stats_list(const char *cmd __rte_unused,
+		const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+	int i;
+
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+	rte_spinlock_lock(&dwa_stats_lock);
+	for (i = 0; i < DWA_STATS_REG_MAX; i++)
+		if (dwa_stats_regs[i].shm != NULL)
+			rte_tel_data_add_array_string(d, dwa_stats_regs[i].name);
+	rte_spinlock_unlock(&dwa_stats_lock);
+
+	return 0;
+}
+
+static void
+dwa_tel_add_port_stats(struct rte_tel_data *d,
+		       const struct rte_dwa_port_stats *stats)
+{
+	struct rte_tel_data *c = rte_tel_data_alloc();
+	char key[RTE_TEL_MAX_STRING_LEN];
+
+	if (c == NULL)
+		return;
+
+	rte_tel_data_start_dict(c);
+	rte_tel_data_add_dict_u64(c, "rx_pkts", stats->rx_pkts);
+	rte_tel_data_add_dict_u64(c, "rx_bytes", stats->rx_bytes);
+	rte_tel_data_add_dict_u64(c, "tx_pkts", stats->tx_pkts);
+	rte_tel_data_add_dict_u64(c, "tx_bytes", stats->tx_bytes);
+	rte_tel_data_add_dict_u64(c, "drops", stats->drops);
+
+	snprintf(key, sizeof(key), "port%u", stats->port_id);
+	rte_tel_data_add_dict_container(d, key, c, 0);
+}
+
+static void
+dwa_tel_add_profile_stats(struct rte_tel_data *d,
+			  const struct rte_dwa_profile_stats *stats)
+{
+	struct rte_tel_data *c = rte_tel_data_alloc();
+	char key[RTE_TEL_MAX_STRING_LEN];
+
+	if (c == NULL)
+		return;
+
+	rte_tel_data_start_dict(c);
+	rte_tel_data_add_dict_u64(c, "lookup_hits", stats->lookup_hits);
+	rte_tel_data_add_dict_u64(c, "lookup_misses", stats->lookup_misses);
+	rte_tel_data_add_dict_u64(c, "exceptions", stats->exceptions);
+
+	snprintf(key, sizeof(key), "profile%#x", stats->profile);
+	rte_tel_data_add_dict_container(d, key, c, 0);
+}
+
+/*
+ * Copy the statistics block, giving up if the DWA keeps updating it so
+ * that a stuck writer does not hold the registration lock forever.
+ */
+static int
+dwa_stats_snapshot(const struct rte_dwa_stats_shm *shm,
+		   struct rte_dwa_stats_shm *snap)
+{
+	uint32_t seq;
+	int i;
+
+	for (i = 0; i < DWA_STATS_READ_TRIES; i++) {
+		seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+		if ((seq & 1) == 0) {
+			memcpy(snap, shm, sizeof(*snap));
+			if (!rte_dwa_stats_read_retry(shm, seq))
+				return 0;
+		}
+		rte_pause();
+	}
+
+	return -EBUSY;
+}
+
+static int
+dwa_handle_stats(const char *cmd __rte_unused, const char *params,
+		 struct rte_tel_data *d)
+{
+	struct rte_dwa_stats_shm snap;
+	struct dwa_stats_reg *reg;
+	uint16_t i;
+	int rc;
+
+	if (params == NULL || strlen(params) == 0)
+		return -EINVAL;
+
+	/* the block may be freed once unregistered, copy it before
+	 * releasing the lock.
+	 */
+	rte_spinlock_lock(&dwa_stats_lock);
+	reg = dwa_stats_reg_find(params);
+	rc = (reg != NULL) ? dwa_stats_snapshot(reg->shm, &snap) : -ENOENT;
+	rte_spinlock_unlock(&dwa_stats_lock);
+	if (rc < 0)
+		return rc;
+
+	rte_tel_data_start_dict(d);
+	for (i = 0; i < RTE_MIN(snap.nb_ports, RTE_DWA_STATS_PORTS_MAX); i++)
+		dwa_tel_add_port_stats(d, &snap.ports[i]);
+	for (i = 0; i < RTE_MIN(snap.nb_profiles, RTE_DWA_STATS_PROFILES_MAX);
+	     i++)
+		dwa_tel_add_profile_stats(d, &snap.profiles[i]);
+
+	return 0;
+}
+
+RTE_INIT(dwa_init_telemetry)
+{
+	rte_telemetry_register_cmd("/dwa/stats/list", dwa_handle_stats_list,
+			"Returns list of DWA statistics blocks. Takes no parameters");
+	rte_telemetry_register_cmd("/dwa/stats", dwa_handle_stats,
+			"Returns DWA port and profile counters. Parameters: string name");
+}
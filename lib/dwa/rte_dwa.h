@@ -167,6 +167,9 @@ extern "C" {
 /* DWA Device */
 #include <rte_dwa_dev.h>
 
+/* Statistics */
+#include <rte_dwa_stats.h>
+
 /* DWA Ports */
 #include <rte_dwa_port_dwa_ethernet.h>
 
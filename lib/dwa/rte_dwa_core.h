@@ -80,6 +80,21 @@ struct rte_dwa_common_d2h_err {
 	char reason[RTE_DWA_ERROR_STR_LEN_MAX]; /**< Failure reason as string */
 } __rte_packed;
 
+struct rte_dwa_stats_shm;
+
+/**
+ * Payload of RTE_DWA_STAG_COMMON_D2H_STATS_SHM message.
+ */
+struct rte_dwa_common_d2h_stats_shm {
+	RTE_STD_C11
+	union {
+		struct rte_dwa_stats_shm *shm;
+		/**< Statistics block. @see rte_dwa_stats.h */
+		uint64_t shm_u64;
+		/**< uint64_t representation of statistics block */
+	};
+} __rte_packed;
+
 /**
  * Enumerates the stag list for RTE_DWA_TAG_COMMON tag.
  */
@@ -110,6 +125,35 @@ enum rte_dwa_stag_common {
 	 * D2H response for unsuccessful TLV action.
 	 */
 	RTE_DWA_STAG_COMMON_D2H_ERR,
+	/**
+	 * Attribute |  Value
+	 * ----------|--------
+	 * Tag       | RTE_DWA_TAG_COMMON
+	 * Stag      | RTE_DWA_STAG_COMMON_H2D_STATS_SHM
+	 * Direction | H2D
+	 * Type      | TYPE_ATTACHED
+	 * Payload   | NA
+	 * Pair TLV  | RTE_DWA_STAG_COMMON_D2H_STATS_SHM
+	 *
+	 * Request the shared memory statistics block of the DWA device.
+	 */
+	RTE_DWA_STAG_COMMON_H2D_STATS_SHM,
+	/**
+	 * Attribute |  Value
+	 * ----------|--------
+	 * Tag       | RTE_DWA_TAG_COMMON
+	 * Stag      | RTE_DWA_STAG_COMMON_D2H_STATS_SHM
+	 * Direction | D2H
+	 * Type      | TYPE_ATTACHED
+	 * Payload   | struct rte_dwa_common_d2h_stats_shm
+	 * Pair TLV  | RTE_DWA_STAG_COMMON_H2D_STATS_SHM
+	 *
+	 * Response for shared memory statistics block. The DWA keeps updating
+	 * the per DWA port and per profile counters in the block, the host reads
+	 * them directly without any further control plane operation.
+	 * @see rte_dwa_stats_port_read() rte_dwa_stats_profile_read()
+	 */
+	RTE_DWA_STAG_COMMON_D2H_STATS_SHM,
 	RTE_DWA_STAG_COMMON_MAX = UINT16_MAX, /**< Max stags for common tag.*/
 };
 
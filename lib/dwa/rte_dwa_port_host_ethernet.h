@@ -163,6 +163,9 @@ uint16_t rte_dwa_port_host_ethernet_tx(rte_dwa_obj_t obj, uint16_t queue_id,
  * @param nb_tlvs
  *   The maximum number of TLVs to received.
  *
+ * Implementations report each call with RTE_LCORE_POLL_BUSYNESS_TIMESTAMP()
+ * for the polling lcore busyness to be accounted.
+ *
  * @return
  * The number of TLVs actually received on the Rx queue. The return
  * value can be less than the value of the *nb_tlvs* parameter when the
@@ -0,0 +1,267 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell.
+ */
+
+#ifndef RTE_DWA_STATS_H
+#define RTE_DWA_STATS_H
+
+/**
+ * @file
+ *
+ * @warning
+ * @b EXPERIMENTAL:
+ * All functions in this file may be changed or removed without prior notice.
+ *
+ * RTE DWA shared memory statistics API
+ *
+ * The DWA publishes its per DWA port and per profile counters in a shared
+ * memory block of type struct rte_dwa_stats_shm. The host gets the address
+ * of the block once, using RTE_DWA_STAG_COMMON_H2D_STATS_SHM control
+ * message, and then reads the counters directly without going through the
+ * control port.
+ *
+ * The block is protected by a sequence lock. The DWA, being the only writer,
+ * makes the sequence number odd while it updates the counters and even once
+ * the update is complete. The host readers retry the read whenever the
+ * sequence number was odd or changed during the read.
+ *
+ * \code{.c}
+ *	struct rte_dwa_port_stats stats;
+ *	uint32_t seq;
+ *
+ *	do {
+ *		seq = rte_dwa_stats_read_begin(shm);
+ *		stats = shm->ports[idx];
+ *	} while (rte_dwa_stats_read_retry(shm, seq));
+ * \endcode
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rte_atomic.h>
+#include <rte_common.h>
+#include <rte_compat.h>
+#include <rte_pause.h>
+
+/** Max number of DWA ports in the statistics block. */
+#define RTE_DWA_STATS_PORTS_MAX 64
+/** Max number of profiles in the statistics block. */
+#define RTE_DWA_STATS_PROFILES_MAX 16
+/** Max length of the name used to register a statistics block. */
+#define RTE_DWA_STATS_NAME_LEN 64
+
+/** Per DWA port counters. */
+struct rte_dwa_port_stats {
+	uint16_t port_id; /**< DWA port id. */
+	uint16_t reserved[3]; /**< Reserved for future use. */
+	uint64_t rx_pkts; /**< Number of packets received. */
+	uint64_t rx_bytes; /**< Number of bytes received. */
+	uint64_t tx_pkts; /**< Number of packets transmitted. */
+	uint64_t tx_bytes; /**< Number of bytes transmitted. */
+	uint64_t drops; /**< Number of packets dropped. */
+};
+
+/** Per profile counters. */
+struct rte_dwa_profile_stats {
+	uint16_t profile;
+	/**< Profile of type enum rte_dwa_tag_profile. */
+	uint16_t reserved[3]; /**< Reserved for future use. */
+	uint64_t lookup_hits; /**< Number of successful lookups. */
+	uint64_t lookup_misses; /**< Number of failed lookups. */
+	uint64_t exceptions; /**< Number of packets sent to host as exception. */
+};
+
+/** Statistics block shared between the DWA and the host. */
+struct rte_dwa_stats_shm {
+	uint32_t seq;
+	/**< Sequence number, odd while the DWA is updating the block. */
+	uint16_t nb_ports; /**< Number of valid entries in ports. */
+	uint16_t nb_profiles; /**< Number of valid entries in profiles. */
+	struct rte_dwa_port_stats ports[RTE_DWA_STATS_PORTS_MAX];
+	/**< DWA port counters. */
+	struct rte_dwa_profile_stats profiles[RTE_DWA_STATS_PROFILES_MAX];
+	/**< Profile counters. */
+} __rte_cache_aligned;
+
+/**
+ * Start a read of the statistics block.
+ *
+ * Wait until the DWA is not updating the block and return the sequence
+ * number to pass to rte_dwa_stats_read_retry() once the counters are read.
+ *
+ * @param shm
+ *   Statistics block.
+ *
+ * @return
+ *   Sequence number of the read.
+ */
+static inline uint32_t
+rte_dwa_stats_read_begin(const struct rte_dwa_stats_shm *shm)
+{
+	uint32_t seq;
+
+	while ((seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE)) & 1)
+		rte_pause();
+
+	return seq;
+}
+
+/**
+ * Check whether a read of the statistics block must be retried.
+ *
+ * @param shm
+ *   Statistics block.
+ * @param seq
+ *   Sequence number returned by rte_dwa_stats_read_begin().
+ *
+ * @return
+ *   true if the DWA updated the block during the read, false otherwise.
+ */
+static inline bool
+rte_dwa_stats_read_retry(const struct rte_dwa_stats_shm *shm, uint32_t seq)
+{
+	rte_atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return __atomic_load_n(&shm->seq, __ATOMIC_RELAXED) != seq;
+}
+
+/**
+ * Start an update of the statistics block.
+ *
+ * Used by the DWA side (or a software DWA implementation) before updating
+ * the counters. There must be a single writer of the block.
+ *
+ * @param shm
+ *   Statistics block.
+ */
+static inline void
+rte_dwa_stats_write_begin(struct rte_dwa_stats_shm *shm)
+{
+	__atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELAXED);
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * Complete an update of the statistics block.
+ *
+ * @param shm
+ *   Statistics block.
+ */
+static inline void
+rte_dwa_stats_write_end(struct rte_dwa_stats_shm *shm)
+{
+	__atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Read the counters of a DWA port from the statistics block.
+ *
+ * @param shm
+ *   Statistics block.
+ * @param idx
+ *   Index of the port in the block, in the range [0 to nb_ports).
+ * @param [out] stats
+ *   Consistent snapshot of the port counters.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid arguments.
+ */
+static inline int
+rte_dwa_stats_port_read(const struct rte_dwa_stats_shm *shm, uint16_t idx,
+			struct rte_dwa_port_stats *stats)
+{
+	uint32_t seq;
+
+	if (shm == NULL || stats == NULL)
+		return -EINVAL;
+
+	do {
+		seq = rte_dwa_stats_read_begin(shm);
+		if (idx >= shm->nb_ports || idx >= RTE_DWA_STATS_PORTS_MAX)
+			return -EINVAL;
+		*stats = shm->ports[idx];
+	} while (rte_dwa_stats_read_retry(shm, seq));
+
+	return 0;
+}
+
+/**
+ * Read the counters of a profile from the statistics block.
+ *
+ * @param shm
+ *   Statistics block.
+ * @param idx
+ *   Index of the profile in the block, in the range [0 to nb_profiles).
+ * @param [out] stats
+ *   Consistent snapshot of the profile counters.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid arguments.
+ */
+static inline int
+rte_dwa_stats_profile_read(const struct rte_dwa_stats_shm *shm, uint16_t idx,
+			   struct rte_dwa_profile_stats *stats)
+{
+	uint32_t seq;
+
+	if (shm == NULL || stats == NULL)
+		return -EINVAL;
+
+	do {
+		seq = rte_dwa_stats_read_begin(shm);
+		if (idx >= shm->nb_profiles || idx >= RTE_DWA_STATS_PROFILES_MAX)
+			return -EINVAL;
+		*stats = shm->profiles[idx];
+	} while (rte_dwa_stats_read_retry(shm, seq));
+
+	return 0;
+}
+
+/**
+ * Register a statistics block to be exposed through telemetry.
+ *
+ * The block is listed by the `/dwa/stats/list` telemetry command and its
+ * counters are returned by the `/dwa/stats` command, which fails if the DWA
+ * keeps the block in an update.
+ *
+ * @param name
+ *   Unique name of the block, typically the name given to
+ *   rte_dwa_dev_attach().
+ * @param shm
+ *   Statistics block obtained with RTE_DWA_STAG_COMMON_H2D_STATS_SHM.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid arguments, -EEXIST if the name is
+ *   already registered, -ENOSPC if no more blocks can be registered.
+ */
+__rte_experimental
+int rte_dwa_stats_register(const char *name,
+			   const struct rte_dwa_stats_shm *shm);
+
+/**
+ * Unregister a statistics block from telemetry.
+ *
+ * The block is not read by telemetry anymore once this function returns,
+ * it can then be freed.
+ *
+ * @param name
+ *   Name given to rte_dwa_stats_register().
+ *
+ * @return
+ *   0 on success, -ENOENT if the name is not registered.
+ */
+__rte_experimental
+int rte_dwa_stats_unregister(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTE_DWA_STATS_H */
@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_memcpy.h>
+
+/* No non-temporal copy implemented, copy through the caches. */
+void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	return rte_memcpy(dst, src, n);
+}
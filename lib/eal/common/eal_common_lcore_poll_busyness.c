@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#ifndef RTE_EXEC_ENV_WINDOWS
+#include <rte_telemetry.h>
+#endif
+
+/* Length of the measurement interval, averaged into the reported value */
+#define LCORE_POLL_BUSYNESS_INTERVAL_MS 100
+/* Weight of the last interval in the rolling busyness, as a power of 2 */
+#define LCORE_POLL_BUSYNESS_EWMA_SHIFT 2
+/* Fixed point scale of the rolling busyness, so the average does not stall */
+#define LCORE_POLL_BUSYNESS_SCALE 256
+/* Polls with the same status not timestamped, to amortize TSC reads */
+#define LCORE_POLL_BUSYNESS_SKIP 32
+
+struct lcore_poll_busyness {
+	uint64_t interval_start; /* TSC at start of the current interval */
+	uint64_t idle_cycles; /* idle cycles in the current interval */
+	uint64_t last_poll; /* TSC of the last timestamped poll */
+	uint32_t reset_gen; /* generation of the last reset of this data */
+	uint32_t nb_skipped; /* polls skipped since the last timestamp */
+	bool last_empty; /* whether the last timestamped poll was empty */
+	bool dev_polls; /* whether device polls were reported */
+	int busyness; /* scaled rolling busyness, -1 until first interval ends */
+} __rte_cache_aligned;
+
+static struct lcore_poll_busyness poll_busyness[RTE_MAX_LCORE];
+static int poll_busyness_enabled = 1;
+static uint32_t poll_busyness_gen = 1;
+
+static inline void
+poll_busyness_timestamp(struct lcore_poll_busyness *pb, bool empty)
+{
+	uint64_t tsc, interval;
+	uint32_t gen;
+
+	if (pb->last_empty == empty &&
+			pb->nb_skipped++ < LCORE_POLL_BUSYNESS_SKIP)
+		return;
+	pb->nb_skipped = 0;
+
+	tsc = rte_rdtsc();
+	gen = __atomic_load_n(&poll_busyness_gen, __ATOMIC_RELAXED);
+	if (unlikely(pb->reset_gen != gen)) {
+		pb->interval_start = tsc;
+		pb->idle_cycles = 0;
+		pb->busyness = -1;
+		pb->reset_gen = gen;
+		goto out;
+	}
+
+	/* cycles since the last empty poll were spent waiting for work */
+	if (pb->last_empty)
+		pb->idle_cycles += tsc - pb->last_poll;
+
+	interval = rte_get_tsc_hz() / MS_PER_S * LCORE_POLL_BUSYNESS_INTERVAL_MS;
+	if (tsc - pb->interval_start >= interval) {
+		uint64_t cycles = tsc - pb->interval_start;
+		int busyness;
+
+		busyness = (cycles - RTE_MIN(pb->idle_cycles, cycles)) * 100 *
+				LCORE_POLL_BUSYNESS_SCALE / cycles;
+		if (pb->busyness < 0)
+			pb->busyness = busyness;
+		else
+			pb->busyness += (busyness - pb->busyness) /
+				(1 << LCORE_POLL_BUSYNESS_EWMA_SHIFT);
+		pb->interval_start = tsc;
+		pb->idle_cycles = 0;
+	}
+
+out:
+	pb->last_poll = tsc;
+	pb->last_empty = empty;
+}
+
+/* polling lcore data, NULL if the lcore is not accounted */
+static inline struct lcore_poll_busyness *
+poll_busyness_get(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(!__atomic_load_n(&poll_busyness_enabled,
+			__ATOMIC_RELAXED)))
+		return NULL;
+	/* unregistered non-EAL threads are not accounted */
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return NULL;
+
+	return &poll_busyness[lcore_id];
+}
+
+void
+__rte_lcore_poll_busyness_timestamp(uint16_t nb_rx)
+{
+	struct lcore_poll_busyness *pb = poll_busyness_get();
+
+	if (pb == NULL)
+		return;
+	if (unlikely(!pb->dev_polls))
+		pb->dev_polls = true;
+	poll_busyness_timestamp(pb, nb_rx == 0);
+}
+
+void
+__rte_lcore_poll_busyness_ring_timestamp(uint16_t nb_deq)
+{
+	struct lcore_poll_busyness *pb = poll_busyness_get();
+
+	/* rings polled behind a device poll would count it twice */
+	if (pb == NULL || pb->dev_polls)
+		return;
+	poll_busyness_timestamp(pb, nb_deq == 0);
+}
+
+int
+rte_lcore_poll_busyness(unsigned int lcore_id)
+{
+	struct lcore_poll_busyness *pb;
+	int busyness;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+	if (!rte_lcore_poll_busyness_enabled())
+		return -ENOTSUP;
+
+	pb = &poll_busyness[lcore_id];
+	if (__atomic_load_n(&pb->reset_gen, __ATOMIC_RELAXED) !=
+			__atomic_load_n(&poll_busyness_gen, __ATOMIC_RELAXED))
+		return -ENODATA;
+	busyness = __atomic_load_n(&pb->busyness, __ATOMIC_RELAXED);
+	if (busyness < 0)
+		return -ENODATA;
+
+	return (busyness + LCORE_POLL_BUSYNESS_SCALE / 2) /
+		LCORE_POLL_BUSYNESS_SCALE;
+}
+
+int
+rte_lcore_poll_busyness_enabled(void)
+{
+#ifdef RTE_LCORE_POLL_BUSYNESS
+	return __atomic_load_n(&poll_busyness_enabled, __ATOMIC_RELAXED);
+#else
+	return 0;
+#endif
+}
+
+void
+rte_lcore_poll_busyness_enabled_set(bool enable)
+{
+	int old = __atomic_exchange_n(&poll_busyness_enabled, enable,
+			__ATOMIC_RELAXED);
+
+	/* restart the accounting of all lcores, skipping the disabled time */
+	if (!old && enable)
+		__atomic_fetch_add(&poll_busyness_gen, 1, __ATOMIC_RELAXED);
+}
+
+#ifndef RTE_EXEC_ENV_WINDOWS
+static int
+lcore_poll_busyness_cb(unsigned int lcore_id, void *arg)
+{
+	struct rte_tel_data *d = arg;
+	char lcore[16];
+	int busyness;
+
+	busyness = rte_lcore_poll_busyness(lcore_id);
+	if (busyness < 0)
+		return 0;
+
+	snprintf(lcore, sizeof(lcore), "%u", lcore_id);
+	rte_tel_data_add_dict_int(d, lcore, busyness);
+
+	return 0;
+}
+
+static int
+handle_lcore_poll_busyness(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	if (!rte_lcore_poll_busyness_enabled())
+		return -ENOTSUP;
+
+	rte_tel_data_start_dict(d);
+	rte_lcore_iterate(lcore_poll_busyness_cb, d);
+
+	return 0;
+}
+
+static int
+handle_lcore_poll_busyness_set(const char *cmd, const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+#ifndef RTE_LCORE_POLL_BUSYNESS
+	RTE_SET_USED(cmd);
+	RTE_SET_USED(d);
+	return -ENOTSUP;
+#else
+	rte_lcore_poll_busyness_enabled_set(
+		strcmp(cmd, "/eal/lcore/poll_busyness_enable") == 0);
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "poll_busyness_enabled",
+		rte_lcore_poll_busyness_enabled());
+
+	return 0;
+#endif
+}
+
+RTE_INIT(lcore_poll_busyness_init_telemetry)
+{
+	rte_telemetry_register_cmd("/eal/lcore/poll_busyness",
+		handle_lcore_poll_busyness,
+		"Returns the poll busyness percentage of the lcores. Takes no parameters");
+	rte_telemetry_register_cmd("/eal/lcore/poll_busyness_enable",
+		handle_lcore_poll_busyness_set,
+		"Enables lcore poll busyness accounting. Takes no parameters");
+	rte_telemetry_register_cmd("/eal/lcore/poll_busyness_disable",
+		handle_lcore_poll_busyness_set,
+		"Disables lcore poll busyness accounting. Takes no parameters");
+}
+#endif
@@ -82,6 +82,7 @@ eal_long_options[] = {
 	{OPT_TRACE_DIR,         1, NULL, OPT_TRACE_DIR_NUM        },
 	{OPT_TRACE_BUF_SIZE,    1, NULL, OPT_TRACE_BUF_SIZE_NUM   },
 	{OPT_TRACE_MODE,        1, NULL, OPT_TRACE_MODE_NUM       },
+	{OPT_TRACE_RECORDER,    0, NULL, OPT_TRACE_RECORDER_NUM   },
 	{OPT_MAIN_LCORE,        1, NULL, OPT_MAIN_LCORE_NUM       },
 	{OPT_MBUF_POOL_OPS_NAME, 1, NULL, OPT_MBUF_POOL_OPS_NAME_NUM},
 	{OPT_NO_HPET,           0, NULL, OPT_NO_HPET_NUM          },
@@ -105,6 +106,8 @@ eal_long_options[] = {
 	{OPT_TELEMETRY,         0, NULL, OPT_TELEMETRY_NUM        },
 	{OPT_NO_TELEMETRY,      0, NULL, OPT_NO_TELEMETRY_NUM     },
 	{OPT_FORCE_MAX_SIMD_BITWIDTH, 1, NULL, OPT_FORCE_MAX_SIMD_BITWIDTH_NUM},
+	{OPT_MALLOC_CACHE,      0, NULL, OPT_MALLOC_CACHE_NUM     },
+	{OPT_HUGE_ALLOC_THREADS, 1, NULL, OPT_HUGE_ALLOC_THREADS_NUM},
 
 	{0,                     0, NULL, 0                        }
 };
@@ -326,6 +329,7 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
 	}
 	internal_cfg->base_virtaddr = 0;
+	internal_cfg->huge_alloc_threads = 1;
 
 #ifdef LOG_DAEMON
 	internal_cfg->syslog_facility = LOG_DAEMON;
@@ -1755,6 +1759,14 @@ eal_parse_common_option(int opt, const char *optarg,
 		}
 		break;
 	}
+
+	case OPT_TRACE_RECORDER_NUM:
+		if (eal_trace_recorder_args_save() < 0) {
+			RTE_LOG(ERR, EAL, "invalid parameters for --"
+				OPT_TRACE_RECORDER "\n");
+			return -1;
+		}
+		break;
 #endif /* !RTE_EXEC_ENV_WINDOWS */
 
 	case OPT_LCORES_NUM:
@@ -1806,6 +1818,9 @@ eal_parse_common_option(int opt, const char *optarg,
 			return -1;
 		}
 		break;
+	case OPT_MALLOC_CACHE_NUM:
+		conf->malloc_cache = 1;
+		break;
 
 	/* don't know what to do, leave this to caller */
 	default:
@@ -2100,6 +2115,11 @@ eal_common_usage(void)
 	       "                      reaches its maximum limit.\n"
 	       "                      Default mode is 'overwrite' and parameter\n"
 	       "                      must be specified once only.\n"
+	       "  --"OPT_TRACE_RECORDER"\n"
+	       "                      Enable trace flight recorder, dumped on\n"
+	       "                      crash, telemetry request or application\n"
+	       "                      trigger. All trace points are enabled\n"
+	       "                      unless some are selected with --"OPT_TRACE".\n"
 #endif /* !RTE_EXEC_ENV_WINDOWS */
 	       "  -v                  Display version information on startup\n"
 	       "  -h, --help          This help\n"
@@ -2109,6 +2129,7 @@ eal_common_usage(void)
 	       "  --"OPT_TELEMETRY"   Enable telemetry support (on by default)\n"
 	       "  --"OPT_NO_TELEMETRY"   Disable telemetry support\n"
 	       "  --"OPT_FORCE_MAX_SIMD_BITWIDTH" Force the max SIMD bitwidth\n"
+	       "  --"OPT_MALLOC_CACHE"      Enable per-lcore caches of small rte_malloc objects\n"
 	       "\nEAL options for DEBUG use only:\n"
 	       "  --"OPT_HUGE_UNLINK"       Unlink hugepage files after init\n"
 	       "  --"OPT_NO_HUGE"           Use malloc instead of hugetlbfs\n"
@@ -48,7 +48,14 @@ eal_trace_init(void)
 		goto fail;
 	}
 
-	if (!STAILQ_EMPTY(&trace.args))
+	/* Flight recorder keeps the latest events, not the first ones */
+	if (trace.recorder && trace.mode == RTE_TRACE_MODE_DISCARD) {
+		trace_err("--trace-recorder is not supported with discard mode");
+		rte_errno = EINVAL;
+		goto fail;
+	}
+
+	if (!STAILQ_EMPTY(&trace.args) || trace.recorder)
 		trace.status = true;
 
 	if (!rte_trace_is_enabled())
@@ -84,6 +91,12 @@ eal_trace_init(void)
 	STAILQ_FOREACH(arg, &trace.args, next)
 		trace_args_apply(arg->val);
 
+	/* Flight recorder keeps the latest events of all trace points, unless
+	 * some were selected.
+	 */
+	if (trace.recorder && STAILQ_EMPTY(&trace.args))
+		trace_args_apply(".*");
+
 	rte_trace_mode_set(trace.mode);
 
 	return 0;
@@ -100,6 +113,7 @@ eal_trace_fini(void)
 {
 	if (!rte_trace_is_enabled())
 		return;
+	trace_recorder_fini();
 	trace_mem_free();
 	trace_metadata_destroy();
 	eal_trace_args_free();
@@ -350,6 +364,8 @@ __rte_trace_mem_per_thread_alloc(void)
 
 	/* Initialize the trace header */
 found:
+	/* unused memory tells the flight recorder where the events stop */
+	memset(header->mem, 0, trace->buff_len);
 	header->offset = 0;
 	header->len = trace->buff_len;
 	header->stream_header.magic = TRACE_CTF_MAGIC;
@@ -352,18 +352,14 @@ meta_fixup(struct trace *trace, char *meta)
 	meta_fix_freq_offset(trace, meta);
 }
 
-int
-rte_trace_metadata_dump(FILE *f)
+const char *
+trace_metadata_get(void)
 {
 	struct trace *trace = trace_obj_get();
 	char *ctf_meta = trace->ctf_meta;
-	int rc;
-
-	if (!rte_trace_is_enabled())
-		return 0;
 
 	if (ctf_meta == NULL)
-		return -EINVAL;
+		return NULL;
 
 	if (!__atomic_load_n(&trace->ctf_fixup_done, __ATOMIC_SEQ_CST) &&
 				rte_get_timer_hz()) {
@@ -371,6 +367,22 @@ rte_trace_metadata_dump(FILE *f)
 		__atomic_store_n(&trace->ctf_fixup_done, 1, __ATOMIC_SEQ_CST);
 	}
 
+	return ctf_meta;
+}
+
+int
+rte_trace_metadata_dump(FILE *f)
+{
+	const char *ctf_meta;
+	int rc;
+
+	if (!rte_trace_is_enabled())
+		return 0;
+
+	ctf_meta = trace_metadata_get();
+	if (ctf_meta == NULL)
+		return -EINVAL;
+
 	rc = fprintf(f, "%s", ctf_meta);
 	return rc < 0 ? rc : 0;
 }
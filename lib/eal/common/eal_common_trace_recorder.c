@@ -0,0 +1,403 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_string_fns.h>
+#include <rte_telemetry.h>
+
+#include "eal_trace.h"
+
+/* Fatal signals on which the flight recorder is dumped */
+static const int recorder_signals[] = {
+	SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT,
+};
+static struct sigaction recorder_old_actions[RTE_DIM(recorder_signals)];
+static int recorder_crashed;
+/* Metadata with the clock fixed up, set when the signal handlers are set */
+static const char *recorder_meta;
+static size_t recorder_meta_len;
+/* Event size of each trace point, indexed by trace point ID */
+static uint16_t *recorder_event_sz;
+static uint32_t recorder_nb_events;
+static uint16_t recorder_max_event_sz;
+
+struct recorder_seg {
+	const void *buf;
+	size_t len;
+};
+
+/*
+ * The dump may be done from a signal handler, hence only async-signal-safe
+ * functions are used down to recorder_dump(), and the metadata is prepared
+ * by eal_trace_recorder_init().
+ */
+static void
+recorder_utoa(char *buf, size_t size, uint32_t val)
+{
+	char tmp[16];
+	size_t i = 0, j;
+
+	do {
+		tmp[i++] = '0' + val % 10;
+		val /= 10;
+	} while (val != 0);
+
+	for (j = 0; j < i && j < size - 1; j++)
+		buf[j] = tmp[i - j - 1];
+	buf[j] = '\0';
+}
+
+static int
+recorder_file_write(const char *dir, const char *name,
+		const struct recorder_seg *segs, unsigned int nb_segs)
+{
+	char path[PATH_MAX];
+	const void *buf;
+	unsigned int i;
+	size_t len;
+	ssize_t rc;
+	int fd;
+
+	strlcpy(path, dir, sizeof(path));
+	strlcat(path, "/", sizeof(path));
+	if (strlcat(path, name, sizeof(path)) >= sizeof(path))
+		return -ENAMETOOLONG;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+		return -errno;
+
+	for (i = 0; i < nb_segs; i++) {
+		buf = segs[i].buf;
+		len = segs[i].len;
+		while (len > 0) {
+			rc = write(fd, buf, len);
+			if (rc < 0) {
+				if (errno == EINTR)
+					continue;
+				rc = -errno;
+				close(fd);
+				return rc;
+			}
+			buf = RTE_PTR_ADD(buf, rc);
+			len -= rc;
+		}
+	}
+
+	return close(fd) < 0 ? -errno : 0;
+}
+
+/*
+ * End of the chain of events starting at pos, with increasing timestamps
+ * not newer than max_ts, or pos if there is no valid event at pos.
+ */
+static uint32_t
+recorder_events_end(const struct __rte_trace_header *header, uint32_t pos,
+		uint64_t max_ts)
+{
+	uint64_t ev, ts, last_ts = 0;
+	uint16_t id, sz;
+
+	while (pos + __RTE_TRACE_EVENT_HEADER_SZ <= header->len) {
+		ev = *(const uint64_t *)&header->mem[pos];
+		id = ev >> __RTE_TRACE_EVENT_HEADER_ID_SHIFT;
+		ts = ev & ~(0xffffULL << __RTE_TRACE_EVENT_HEADER_ID_SHIFT);
+		if (ev == 0 || id >= recorder_nb_events)
+			break;
+		sz = recorder_event_sz[id];
+		if (sz == 0 || pos + sz > header->len || ts < last_ts ||
+				ts > max_ts)
+			break;
+		last_ts = ts;
+		pos = RTE_ALIGN_CEIL(pos + sz, __RTE_TRACE_EVENT_HEADER_SZ);
+	}
+
+	return pos;
+}
+
+/*
+ * In overwrite mode, a thread goes back to the start of its buffer when an
+ * event does not fit at its end. After such a wrap, the events older than
+ * the ones in [0, offset) follow offset, the first of them being partly
+ * overwritten. As the event size is fixed per trace point, the older events
+ * are the longest chain of events with increasing timestamps, older than
+ * the first event of the buffer, starting within one event after offset.
+ * Returns the older events as [*start, *end), empty if the buffer has not
+ * wrapped.
+ */
+static void
+recorder_old_events(const struct __rte_trace_header *header, uint32_t offset,
+		uint32_t *start, uint32_t *end)
+{
+	uint64_t max_ts = UINT64_MAX;
+	uint32_t pos, last, e;
+
+	*start = *end = 0;
+	if (offset > 0)
+		max_ts = *(const uint64_t *)&header->mem[0] &
+			~(0xffffULL << __RTE_TRACE_EVENT_HEADER_ID_SHIFT);
+
+	pos = RTE_ALIGN_CEIL(offset, __RTE_TRACE_EVENT_HEADER_SZ);
+	last = RTE_MIN(pos + recorder_max_event_sz + __RTE_TRACE_EVENT_HEADER_SZ,
+			header->len);
+	for (; pos < last; pos += __RTE_TRACE_EVENT_HEADER_SZ) {
+		e = recorder_events_end(header, pos, max_ts);
+		if (e - pos > *end - *start) {
+			*start = pos;
+			*end = e;
+		}
+	}
+}
+
+/*
+ * Save the metadata and the per-thread buffers in a new "dump-<n>"
+ * sub-directory of the trace directory. Threads keep on tracing while the
+ * buffers are saved, the events emitted meanwhile may be missing.
+ * A wrapped buffer is saved whole, its older events first.
+ */
+static int
+recorder_dump(bool wait_lock, char *dir, size_t size)
+{
+	struct trace *trace = trace_obj_get();
+	struct __rte_trace_header *header;
+	char name[sizeof("channel0_") + 10];
+	uint32_t count, dump, offset, start, end;
+	struct recorder_seg segs[3];
+	bool locked;
+	int rc = 0;
+
+	if (recorder_meta == NULL)
+		return -EINVAL;
+
+	dump = __atomic_fetch_add(&trace->nb_dumps, 1, __ATOMIC_RELAXED);
+	recorder_utoa(name, sizeof(name), dump);
+	strlcpy(dir, trace->dir, size);
+	strlcat(dir, "/dump-", size);
+	if (strlcat(dir, name, size) >= size)
+		return -ENAMETOOLONG;
+	if (mkdir(dir, 0700) < 0)
+		return -errno;
+
+	segs[0].buf = recorder_meta;
+	segs[0].len = recorder_meta_len;
+	rc = recorder_file_write(dir, "metadata", segs, 1);
+	if (rc < 0)
+		return rc;
+
+	/* a crashed thread may hold the lock, do not wait for it then */
+	if (wait_lock) {
+		rte_spinlock_lock(&trace->lock);
+		locked = true;
+	} else {
+		locked = rte_spinlock_trylock(&trace->lock);
+	}
+
+	for (count = 0; count < trace->nb_trace_mem_list; count++) {
+		header = trace->lcore_meta[count].mem;
+		offset = __atomic_load_n(&header->offset, __ATOMIC_RELAXED);
+		recorder_old_events(header, offset, &start, &end);
+
+		/* older events first, then the ones since the last wrap */
+		segs[0].buf = &header->stream_header;
+		segs[0].len = sizeof(header->stream_header);
+		segs[1].buf = &header->mem[start];
+		segs[1].len = end - start;
+		segs[2].buf = &header->mem[0];
+		segs[2].len = offset;
+
+		strlcpy(name, "channel0_", sizeof(name));
+		recorder_utoa(name + strlen(name), sizeof(name) - strlen(name),
+				count);
+		rc = recorder_file_write(dir, name, segs, RTE_DIM(segs));
+		if (rc < 0)
+			break;
+	}
+
+	if (locked)
+		rte_spinlock_unlock(&trace->lock);
+
+	return rc < 0 ? rc : (int)dump;
+}
+
+static void
+recorder_signal_handler(int signo)
+{
+	static const char msg[] = "EAL: trace flight recorder dumped to ";
+	char dir[PATH_MAX];
+	unsigned int i;
+
+	/* dump once, even if several threads crash */
+	if (__atomic_exchange_n(&recorder_crashed, 1, __ATOMIC_ACQ_REL) == 0 &&
+			recorder_dump(false, dir, sizeof(dir)) >= 0) {
+		strlcat(dir, "\n", sizeof(dir));
+		if (write(STDERR_FILENO, msg, sizeof(msg) - 1) > 0 &&
+				write(STDERR_FILENO, dir, strlen(dir)) > 0)
+			fsync(STDERR_FILENO);
+	}
+
+	/* let the previous handler, or the default action, process the
+	 * signal once this handler returns.
+	 */
+	for (i = 0; i < RTE_DIM(recorder_signals); i++)
+		if (recorder_signals[i] == signo)
+			sigaction(signo, &recorder_old_actions[i], NULL);
+	raise(signo);
+}
+
+/* event sizes, to find the event boundaries of a wrapped buffer */
+static int
+recorder_event_sz_init(void)
+{
+	struct trace *trace = trace_obj_get();
+	struct trace_point *tp;
+	uint16_t id;
+
+	recorder_event_sz = calloc(trace->nb_trace_points,
+			sizeof(*recorder_event_sz));
+	if (recorder_event_sz == NULL)
+		return -ENOMEM;
+
+	STAILQ_FOREACH(tp, trace_list_head_get(), next) {
+		id = trace_id_get(tp->handle);
+		recorder_event_sz[id] =
+			*tp->handle & __RTE_TRACE_FIELD_SIZE_MASK;
+		recorder_max_event_sz = RTE_MAX(recorder_max_event_sz,
+				recorder_event_sz[id]);
+	}
+	recorder_nb_events = trace->nb_trace_points;
+
+	return 0;
+}
+
+static void
+recorder_event_sz_fini(void)
+{
+	free(recorder_event_sz);
+	recorder_event_sz = NULL;
+	recorder_nb_events = 0;
+	recorder_max_event_sz = 0;
+}
+
+int
+eal_trace_recorder_init(void)
+{
+	struct trace *trace = trace_obj_get();
+	struct sigaction action;
+	const char *meta;
+	unsigned int i;
+
+	if (!rte_trace_is_enabled() || !trace->recorder)
+		return 0;
+
+	if (recorder_event_sz_init() < 0) {
+		rte_errno = ENOMEM;
+		return -rte_errno;
+	}
+
+	/* the clock of the metadata is fixed up here, once the timer is
+	 * initialized, so that the signal handler only writes it.
+	 */
+	meta = trace_metadata_get();
+	if (meta == NULL) {
+		recorder_event_sz_fini();
+		rte_errno = EINVAL;
+		return -rte_errno;
+	}
+	recorder_meta_len = strlen(meta);
+	recorder_meta = meta;
+
+	memset(&action, 0, sizeof(action));
+	sigemptyset(&action.sa_mask);
+	action.sa_handler = recorder_signal_handler;
+
+	for (i = 0; i < RTE_DIM(recorder_signals); i++) {
+		if (sigaction(recorder_signals[i], &action,
+				&recorder_old_actions[i]) < 0) {
+			trace_err("cannot set handler of signal %d: %s",
+				recorder_signals[i], strerror(errno));
+			rte_errno = errno;
+			while (i-- > 0)
+				sigaction(recorder_signals[i],
+					&recorder_old_actions[i], NULL);
+			recorder_meta = NULL;
+			recorder_event_sz_fini();
+			return -rte_errno;
+		}
+	}
+
+	RTE_LOG(INFO, EAL, "Trace flight recorder enabled\n");
+	return 0;
+}
+
+void
+trace_recorder_fini(void)
+{
+	unsigned int i;
+
+	if (recorder_meta == NULL)
+		return;
+
+	for (i = 0; i < RTE_DIM(recorder_signals); i++)
+		sigaction(recorder_signals[i], &recorder_old_actions[i], NULL);
+	recorder_meta = NULL;
+	recorder_event_sz_fini();
+}
+
+int
+eal_trace_recorder_args_save(void)
+{
+	struct trace *trace = trace_obj_get();
+
+	trace->recorder = true;
+	return 0;
+}
+
+int
+rte_trace_recorder_dump(void)
+{
+	struct trace *trace = trace_obj_get();
+	char dir[PATH_MAX];
+
+	if (!rte_trace_is_enabled() || !trace->recorder)
+		return -ENOTSUP;
+
+	return recorder_dump(true, dir, sizeof(dir));
+}
+
+static int
+handle_trace_recorder_dump(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	struct trace *trace = trace_obj_get();
+	char dir[PATH_MAX];
+	int rc;
+
+	if (!rte_trace_is_enabled() || !trace->recorder)
+		return -ENOTSUP;
+
+	rc = recorder_dump(true, dir, sizeof(dir));
+	if (rc < 0)
+		return rc;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "dump", rc);
+	rte_tel_data_add_dict_string(d, "dir", dir);
+
+	return 0;
+}
+
+RTE_INIT(trace_recorder_init_telemetry)
+{
+	rte_telemetry_register_cmd("/eal/trace/dump",
+			handle_trace_recorder_dump,
+			"Dumps the trace flight recorder buffers. Takes no parameters");
+}
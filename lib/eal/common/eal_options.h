@@ -43,6 +43,8 @@ enum {
 	OPT_TRACE_BUF_SIZE_NUM,
 #define OPT_TRACE_MODE        "trace-mode"
 	OPT_TRACE_MODE_NUM,
+#define OPT_TRACE_RECORDER    "trace-recorder"
+	OPT_TRACE_RECORDER_NUM,
 #define OPT_MAIN_LCORE        "main-lcore"
 	OPT_MAIN_LCORE_NUM,
 #define OPT_MBUF_POOL_OPS_NAME "mbuf-pool-ops-name"
@@ -87,6 +89,10 @@ enum {
 	OPT_NO_TELEMETRY_NUM,
 #define OPT_FORCE_MAX_SIMD_BITWIDTH  "force-max-simd-bitwidth"
 	OPT_FORCE_MAX_SIMD_BITWIDTH_NUM,
+#define OPT_MALLOC_CACHE      "malloc-cache"
+	OPT_MALLOC_CACHE_NUM,
+#define OPT_HUGE_ALLOC_THREADS "huge-alloc-threads"
+	OPT_HUGE_ALLOC_THREADS_NUM,
 
 	OPT_LONG_MAX_NUM
 };
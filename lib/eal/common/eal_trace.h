@@ -55,6 +55,8 @@ struct trace {
 	int dir_offset;
 	int register_errno;
 	bool status;
+	bool recorder;
+	uint32_t nb_dumps;
 	enum rte_trace_mode mode;
 	rte_uuid_t uuid;
 	uint32_t buff_len;
@@ -104,11 +106,15 @@ void trace_uuid_generate(void);
 int trace_metadata_create(void);
 void trace_metadata_destroy(void);
 char *trace_metadata_fixup_field(const char *field);
+const char *trace_metadata_get(void);
 int trace_mkdir(void);
 int trace_epoch_time_save(void);
 void trace_mem_free(void);
 void trace_mem_per_thread_free(void);
 
+/* Flight recorder functions */
+void trace_recorder_fini(void);
+
 /* EAL interface */
 int eal_trace_init(void);
 void eal_trace_fini(void);
@@ -117,5 +123,7 @@ void eal_trace_args_free(void);
 int eal_trace_dir_args_save(const char *val);
 int eal_trace_mode_args_save(const char *val);
 int eal_trace_bufsz_args_save(const char *val);
+int eal_trace_recorder_args_save(void);
+int eal_trace_recorder_init(void);
 
 #endif /* __EAL_TRACE_H */
@@ -0,0 +1,278 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2021 Marvell International Ltd.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_eal_memconfig.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#ifndef RTE_EXEC_ENV_WINDOWS
+#include <rte_telemetry.h>
+#endif
+
+#include "eal_internal_cfg.h"
+#include "eal_memcfg.h"
+#include "eal_private.h"
+#include "malloc_cache.h"
+#include "malloc_elem.h"
+#include "malloc_heap.h"
+
+static struct malloc_cache malloc_caches[RTE_MAX_LCORE];
+
+static inline bool
+cache_enabled(void)
+{
+#ifdef RTE_MALLOC_DEBUG
+	/* freed memory must be poisoned and checked, bypass the cache */
+	return false;
+#else
+	const struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+
+	return internal_conf->malloc_cache != 0;
+#endif
+}
+
+/* get the calling lcore cache, bound to the heap of its socket */
+static struct malloc_cache *
+cache_get(void)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned int lcore_id = rte_lcore_id();
+	struct malloc_cache *cache;
+	int heap_id;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	cache = &malloc_caches[lcore_id];
+	if (likely(cache->heap != NULL &&
+			cache->heap->socket_id == malloc_get_numa_socket()))
+		return cache;
+
+	/* first use or the lcore moved to another socket */
+	malloc_cache_flush();
+	heap_id = malloc_socket_to_heap_id(malloc_get_numa_socket());
+	if (heap_id < 0)
+		return NULL;
+	cache->heap = &mcfg->malloc_heaps[heap_id];
+
+	return cache;
+}
+
+/* smallest class holding objects of at least size bytes */
+static inline unsigned int
+size_to_class(size_t size)
+{
+	size = RTE_MAX(size, (size_t)MALLOC_CACHE_MIN_SIZE);
+
+	return rte_log2_u32(size) - rte_log2_u32(MALLOC_CACHE_MIN_SIZE);
+}
+
+static inline size_t
+class_to_size(unsigned int cls)
+{
+	return (size_t)MALLOC_CACHE_MIN_SIZE << cls;
+}
+
+static void
+cache_class_flush(struct malloc_cache *cache, struct malloc_cache_class *cls,
+		unsigned int n)
+{
+	struct malloc_elem *elems[MALLOC_CACHE_CLASS_SIZE];
+	unsigned int i;
+
+	if (n == 0)
+		return;
+
+	/* release the oldest objects, they are the least likely in cache */
+	for (i = 0; i < n; i++) {
+		elems[i] = malloc_elem_from_data(cls->objs[i]);
+		elems[i]->state = ELEM_BUSY;
+	}
+	malloc_heap_free_bulk(cache->heap, elems, n);
+
+	cls->len -= n;
+	memmove(&cls->objs[0], &cls->objs[n], cls->len * sizeof(cls->objs[0]));
+	cache->stats.flushes++;
+}
+
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket)
+{
+	struct malloc_cache_class *cls;
+	struct malloc_cache *cache;
+	struct malloc_elem *elem;
+	unsigned int c, i;
+	void *addr;
+
+	if (!cache_enabled() || size > MALLOC_CACHE_MAX_SIZE ||
+			align > RTE_CACHE_LINE_SIZE)
+		return NULL;
+
+	if (socket != SOCKET_ID_ANY &&
+			socket != (int)malloc_get_numa_socket())
+		return NULL;
+
+	cache = cache_get();
+	if (cache == NULL)
+		return NULL;
+
+	c = size_to_class(size);
+	cls = &cache->classes[c];
+	if (unlikely(cls->len == 0)) {
+		cache->stats.misses++;
+		cls->len = malloc_heap_alloc_bulk(cache->heap, class_to_size(c),
+				cls->objs, MALLOC_CACHE_BULK_SIZE);
+		if (cls->len == 0)
+			return NULL;
+		for (i = 0; i < cls->len; i++)
+			malloc_elem_from_data(cls->objs[i])->state =
+					ELEM_CACHED;
+		cache->stats.refills++;
+	} else {
+		cache->stats.hits++;
+	}
+
+	addr = cls->objs[--cls->len];
+	elem = malloc_elem_from_data(addr);
+	elem->state = ELEM_BUSY;
+
+	return addr;
+}
+
+int
+malloc_cache_free(void *addr)
+{
+	struct malloc_cache_class *cls;
+	struct malloc_cache *cache;
+	struct malloc_elem *elem;
+	size_t data_len;
+	unsigned int c;
+
+	if (!cache_enabled())
+		return -1;
+
+	cache = cache_get();
+	if (cache == NULL)
+		return -1;
+
+	elem = malloc_elem_from_data(addr);
+	/* a cached element is not busy, the heap rejects a second free */
+	if (elem == NULL || elem->state != ELEM_BUSY ||
+			elem->heap != cache->heap)
+		return -1;
+
+	data_len = elem->size - elem->pad - MALLOC_ELEM_OVERHEAD;
+	if (data_len < MALLOC_CACHE_MIN_SIZE ||
+			data_len >= 2 * MALLOC_CACHE_MAX_SIZE)
+		return -1;
+
+	/* largest class the element can serve */
+	c = rte_fls_u64(data_len) - 1 - rte_log2_u32(MALLOC_CACHE_MIN_SIZE);
+	cls = &cache->classes[c];
+	if (cls->len == MALLOC_CACHE_CLASS_SIZE)
+		cache_class_flush(cache, cls, MALLOC_CACHE_BULK_SIZE);
+
+	/* heap memory is zeroed on free, rte_zmalloc() relies on it */
+	memset(addr, 0, data_len);
+	elem->state = ELEM_CACHED;
+	cls->objs[cls->len++] = addr;
+
+	return 0;
+}
+
+void
+malloc_cache_flush(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct malloc_cache *cache;
+	unsigned int c;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	cache = &malloc_caches[lcore_id];
+	if (cache->heap == NULL)
+		return;
+
+	for (c = 0; c < MALLOC_CACHE_NB_CLASSES; c++)
+		cache_class_flush(cache, &cache->classes[c],
+				cache->classes[c].len);
+}
+
+void
+malloc_cache_flush_all(void)
+{
+	struct malloc_cache *cache;
+	unsigned int lcore_id, c;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &malloc_caches[lcore_id];
+		if (cache->heap == NULL)
+			continue;
+		for (c = 0; c < MALLOC_CACHE_NB_CLASSES; c++)
+			cache_class_flush(cache, &cache->classes[c],
+					cache->classes[c].len);
+		cache->heap = NULL;
+	}
+}
+
+#ifndef RTE_EXEC_ENV_WINDOWS
+static int
+handle_malloc_cache_stats(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	struct malloc_cache_stats stats;
+	unsigned int lcore_id, first, last;
+	uint64_t total;
+	char *end_param;
+
+	if (params != NULL && strlen(params) != 0) {
+		if (!isdigit(*params))
+			return -1;
+		first = strtoul(params, &end_param, 0);
+		if (*end_param != '\0' || first >= RTE_MAX_LCORE)
+			return -1;
+		last = first;
+	} else {
+		first = 0;
+		last = RTE_MAX_LCORE - 1;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	for (lcore_id = first; lcore_id <= last; lcore_id++) {
+		const struct malloc_cache_stats *s =
+			&malloc_caches[lcore_id].stats;
+
+		stats.hits += s->hits;
+		stats.misses += s->misses;
+		stats.refills += s->refills;
+		stats.flushes += s->flushes;
+	}
+	total = stats.hits + stats.misses;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "enabled", cache_enabled());
+	rte_tel_data_add_dict_u64(d, "hits", stats.hits);
+	rte_tel_data_add_dict_u64(d, "misses", stats.misses);
+	rte_tel_data_add_dict_u64(d, "refills", stats.refills);
+	rte_tel_data_add_dict_u64(d, "flushes", stats.flushes);
+	rte_tel_data_add_dict_u64(d, "hit_rate",
+			total == 0 ? 0 : stats.hits * 100 / total);
+
+	return 0;
+}
+
+RTE_INIT(malloc_cache_init_telemetry)
+{
+	rte_telemetry_register_cmd("/eal/malloc_cache",
+			handle_malloc_cache_stats,
+			"Returns rte_malloc per-lcore cache statistics, summed over all lcores if no lcore is given. Parameters: int lcore_id (optional)");
+}
+#endif
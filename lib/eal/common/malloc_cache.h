@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2021 Marvell International Ltd.
+ */
+
+#ifndef MALLOC_CACHE_H_
+#define MALLOC_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+
+/* Smallest and largest object size served by the per-lcore caches. */
+#define MALLOC_CACHE_MIN_SIZE RTE_CACHE_LINE_SIZE
+#define MALLOC_CACHE_NB_CLASSES 6
+#define MALLOC_CACHE_MAX_SIZE \
+	(MALLOC_CACHE_MIN_SIZE << (MALLOC_CACHE_NB_CLASSES - 1))
+
+/* Number of objects a size class can hold, and moved at once to/from heap. */
+#define MALLOC_CACHE_CLASS_SIZE 32
+#define MALLOC_CACHE_BULK_SIZE (MALLOC_CACHE_CLASS_SIZE / 2)
+
+struct malloc_heap;
+
+/* Objects of one size class, used as a LIFO. */
+struct malloc_cache_class {
+	unsigned int len;
+	void *objs[MALLOC_CACHE_CLASS_SIZE];
+};
+
+/* Per-lcore cache statistics. */
+struct malloc_cache_stats {
+	uint64_t hits;     /* allocations served from the cache */
+	uint64_t misses;   /* allocations that had to refill from heap */
+	uint64_t refills;  /* bulk refills from heap */
+	uint64_t flushes;  /* bulk flushes to heap */
+};
+
+/* Per-lcore cache, only accessed by the owning lcore. */
+struct malloc_cache {
+	struct malloc_heap *heap; /* heap of the lcore socket */
+	struct malloc_cache_class classes[MALLOC_CACHE_NB_CLASSES];
+	struct malloc_cache_stats stats;
+} __rte_cache_aligned;
+
+/*
+ * Try to allocate from the calling lcore cache.
+ * Returns NULL if the request cannot be served through the cache, in which
+ * case the caller must fall back to the heap.
+ */
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket);
+
+/*
+ * Try to release an element to the calling lcore cache.
+ * Returns 0 if the element was cached, -1 if the caller must free it
+ * to the heap. Cached elements are marked ELEM_CACHED, so freeing one
+ * again falls back to the heap, which rejects it.
+ */
+int
+malloc_cache_free(void *addr);
+
+/* Release all objects held by the calling lcore cache to the heap. */
+void
+malloc_cache_flush(void);
+
+/*
+ * Release the objects held by the caches of all lcores to the heap.
+ * Only safe once no lcore allocates or frees anymore, e.g. at cleanup.
+ */
+void
+malloc_cache_flush_all(void);
+
+#endif /* MALLOC_CACHE_H_ */
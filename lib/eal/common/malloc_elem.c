@@ -677,6 +677,8 @@ elem_state_to_str(enum elem_state state)
 		return "BUSY";
 	case ELEM_FREE:
 		return "FREE";
+	case ELEM_CACHED:
+		return "CACHED";
 	}
 	return "ERROR";
 }
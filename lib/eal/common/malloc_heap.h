@@ -48,6 +48,10 @@ void *
 malloc_heap_alloc(const char *type, size_t size, int socket, unsigned int flags,
 		size_t align, size_t bound, bool contig);
 
+unsigned int
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size, void *objs[],
+		unsigned int n);
+
 void *
 malloc_heap_alloc_biggest(const char *type, int socket, unsigned int flags,
 		size_t align, bool contig);
@@ -80,6 +84,10 @@ malloc_heap_remove_external_memory(struct malloc_heap *heap, void *va_addr,
 int
 malloc_heap_free(struct malloc_elem *elem);
 
+int
+malloc_heap_free_bulk(struct malloc_heap *heap, struct malloc_elem *elems[],
+		unsigned int n);
+
 int
 malloc_heap_resize(struct malloc_elem *elem, size_t size);
 
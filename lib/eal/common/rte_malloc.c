@@ -24,6 +24,7 @@
 #include <rte_eal_trace.h>
 
 #include <rte_malloc.h>
+#include "malloc_cache.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 #include "eal_memalloc.h"
@@ -39,6 +40,8 @@ mem_free(void *addr, const bool trace_ena)
 		rte_eal_trace_mem_free(addr);
 
 	if (addr == NULL) return;
+	if (malloc_cache_free(addr) == 0)
+		return;
 	if (malloc_heap_free(malloc_elem_from_data(addr)) < 0)
 		RTE_LOG(ERR, EAL, "Error: Invalid memory\n");
 }
@@ -74,8 +77,10 @@ malloc_socket(const char *type, size_t size, unsigned int align,
 				!rte_eal_has_hugepages())
 		socket_arg = SOCKET_ID_ANY;
 
-	ptr = malloc_heap_alloc(type, size, socket_arg, 0,
-			align == 0 ? 1 : align, 0, false);
+	ptr = malloc_cache_alloc(size, align, socket_arg);
+	if (ptr == NULL)
+		ptr = malloc_heap_alloc(type, size, socket_arg, 0,
+				align == 0 ? 1 : align, 0, false);
 
 	if (trace_ena)
 		rte_eal_trace_mem_malloc(type, size, align, socket_arg, ptr);
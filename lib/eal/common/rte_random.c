@@ -6,14 +6,17 @@
 #include <x86intrin.h>
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <rte_branch_prediction.h>
+#include <rte_cpuflags.h>
 #include <rte_cycles.h>
 #include <rte_eal.h>
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_random.h>
+#include <rte_vect.h>
 
 struct rte_rand_state {
 	uint64_t z1;
@@ -25,6 +28,23 @@ struct rte_rand_state {
 
 static struct rte_rand_state rand_states[RTE_MAX_LCORE];
 
+/* Number of independent generators run in parallel by the bulk functions */
+#define RAND_BULK_LANES 8U
+
+typedef uint64_t rand_vec_t
+	__attribute__((vector_size(RAND_BULK_LANES * sizeof(uint64_t))));
+
+/* One generator per vector lane, stepped with vector instructions. */
+struct rte_rand_bulk_state {
+	rand_vec_t z1;
+	rand_vec_t z2;
+	rand_vec_t z3;
+	rand_vec_t z4;
+	rand_vec_t z5;
+} __rte_cache_aligned;
+
+static struct rte_rand_bulk_state rand_bulk_states[RTE_MAX_LCORE];
+
 static uint32_t
 __rte_rand_lcg32(uint32_t *seed)
 {
@@ -76,14 +96,34 @@ __rte_srand_lfsr258(uint64_t seed, struct rte_rand_state *state)
 	state->z5 = __rte_rand_lfsr258_gen_seed(&lcg_seed, 8388608UL);
 }
 
+static void
+__rte_srand_lfsr258_bulk(uint64_t seed, struct rte_rand_bulk_state *state)
+{
+	struct rte_rand_state lane;
+	unsigned int i;
+
+	/* seed each lane as a scalar generator not used by any lcore */
+	for (i = 0; i < RAND_BULK_LANES; i++) {
+		__rte_srand_lfsr258(seed + (i + 1) * RTE_MAX_LCORE, &lane);
+		state->z1[i] = lane.z1;
+		state->z2[i] = lane.z2;
+		state->z3[i] = lane.z3;
+		state->z4[i] = lane.z4;
+		state->z5[i] = lane.z5;
+	}
+}
+
 void
 rte_srand(uint64_t seed)
 {
 	unsigned int lcore_id;
 
 	/* add lcore_id to seed to avoid having the same sequence */
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
 		__rte_srand_lfsr258(seed + lcore_id, &rand_states[lcore_id]);
+		__rte_srand_lfsr258_bulk(seed + lcore_id,
+			&rand_bulk_states[lcore_id]);
+	}
 }
 
 static __rte_always_inline uint64_t
@@ -114,8 +154,8 @@ __rte_rand_lfsr258(struct rte_rand_state *state)
 	return state->z1 ^ state->z2 ^ state->z3 ^ state->z4 ^ state->z5;
 }
 
-static __rte_always_inline
-struct rte_rand_state *__rte_rand_get_state(void)
+static __rte_always_inline unsigned int
+__rte_rand_get_lcore(void)
 {
 	unsigned int lcore_id;
 
@@ -124,7 +164,13 @@ struct rte_rand_state *__rte_rand_get_state(void)
 	if (unlikely(lcore_id == LCORE_ID_ANY))
 		lcore_id = rte_get_main_lcore();
 
-	return &rand_states[lcore_id];
+	return lcore_id;
+}
+
+static __rte_always_inline
+struct rte_rand_state *__rte_rand_get_state(void)
+{
+	return &rand_states[__rte_rand_get_lcore()];
 }
 
 uint64_t
@@ -176,6 +222,155 @@ rte_rand_max(uint64_t upper_bound)
 	return res;
 }
 
+/*
+ * The scalar generator steps applied to all the lanes at once. The state
+ * is passed by pointer, passing vectors wider than the ones of the target
+ * by value would depend on the ABI of the vector extensions.
+ */
+static __rte_always_inline void
+__rte_rand_lfsr258_comp_vec(rand_vec_t *z, uint64_t a, uint64_t b, uint64_t c,
+			    uint64_t d)
+{
+	*z = ((*z & c) << d) ^ (((*z << a) ^ *z) >> b);
+}
+
+static __rte_always_inline void
+__rte_rand_lfsr258_bulk(struct rte_rand_bulk_state *state, uint64_t *vals,
+			unsigned int n)
+{
+	rand_vec_t z1 = state->z1;
+	rand_vec_t z2 = state->z2;
+	rand_vec_t z3 = state->z3;
+	rand_vec_t z4 = state->z4;
+	rand_vec_t z5 = state->z5;
+	rand_vec_t res;
+	unsigned int i;
+
+	for (i = 0; i < n; i += RAND_BULK_LANES) {
+		__rte_rand_lfsr258_comp_vec(&z1, 1UL, 53UL,
+					    18446744073709551614UL, 10UL);
+		__rte_rand_lfsr258_comp_vec(&z2, 24UL, 50UL,
+					    18446744073709551104UL, 5UL);
+		__rte_rand_lfsr258_comp_vec(&z3, 3UL, 23UL,
+					    18446744073709547520UL, 29UL);
+		__rte_rand_lfsr258_comp_vec(&z4, 5UL, 24UL,
+					    18446744073709420544UL, 23UL);
+		__rte_rand_lfsr258_comp_vec(&z5, 3UL, 33UL,
+					    18446744073701163008UL, 8UL);
+		res = z1 ^ z2 ^ z3 ^ z4 ^ z5;
+
+		/* the values of the lanes beyond n are dropped */
+		memcpy(&vals[i], &res,
+		       RTE_MIN(n - i, RAND_BULK_LANES) * sizeof(vals[0]));
+	}
+
+	state->z1 = z1;
+	state->z2 = z2;
+	state->z3 = z3;
+	state->z4 = z4;
+	state->z5 = z5;
+}
+
+/*
+ * The same generator is compiled for the vector extensions available at
+ * runtime, the lanes of rand_vec_t being split over narrower registers.
+ */
+static void
+rand_bulk_default(struct rte_rand_bulk_state *state, uint64_t *vals,
+		  unsigned int n)
+{
+	__rte_rand_lfsr258_bulk(state, vals, n);
+}
+
+#ifdef RTE_ARCH_X86
+static __attribute__((target("avx2"))) void
+rand_bulk_avx2(struct rte_rand_bulk_state *state, uint64_t *vals,
+	       unsigned int n)
+{
+	__rte_rand_lfsr258_bulk(state, vals, n);
+}
+
+#ifdef CC_AVX512_SUPPORT
+static __attribute__((target("avx512f"))) void
+rand_bulk_avx512(struct rte_rand_bulk_state *state, uint64_t *vals,
+		 unsigned int n)
+{
+	__rte_rand_lfsr258_bulk(state, vals, n);
+}
+#endif
+
+enum rand_bulk_isa {
+	RAND_BULK_DEFAULT,
+	RAND_BULK_AVX2,
+	RAND_BULK_AVX512,
+};
+
+static enum rand_bulk_isa rand_bulk_max_isa;
+#endif
+
+static void
+rand_bulk(uint64_t *vals, unsigned int n)
+{
+	struct rte_rand_bulk_state *state =
+		&rand_bulk_states[__rte_rand_get_lcore()];
+#ifdef RTE_ARCH_X86
+	uint16_t simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+
+#ifdef CC_AVX512_SUPPORT
+	if (rand_bulk_max_isa >= RAND_BULK_AVX512 &&
+			simd_bitwidth >= RTE_VECT_SIMD_512) {
+		rand_bulk_avx512(state, vals, n);
+		return;
+	}
+#endif
+	if (rand_bulk_max_isa >= RAND_BULK_AVX2 &&
+			simd_bitwidth >= RTE_VECT_SIMD_256) {
+		rand_bulk_avx2(state, vals, n);
+		return;
+	}
+#endif
+	rand_bulk_default(state, vals, n);
+}
+
+void
+rte_rand_bulk(uint64_t *vals, unsigned int n)
+{
+	rand_bulk(vals, n);
+}
+
+void
+rte_rand_max_bulk(uint64_t *vals, unsigned int n, uint64_t upper_bound)
+{
+	uint64_t batch[4 * RAND_BULK_LANES];
+	uint64_t mask, res;
+	unsigned int i, j;
+
+	if (unlikely(upper_bound < 2)) {
+		memset(vals, 0, n * sizeof(vals[0]));
+		return;
+	}
+
+	/* power-of-2 upper_bound has no bias issues */
+	if (__builtin_popcountll(upper_bound) == 1) {
+		rand_bulk(vals, n);
+		for (i = 0; i < n; i++)
+			vals[i] &= upper_bound - 1;
+		return;
+	}
+
+	/* same unbiased rejection of the masked values as rte_rand_max() */
+	mask = ~((uint64_t)0) >> __builtin_clzll(upper_bound);
+	i = 0;
+	while (i < n) {
+		rand_bulk(batch, RTE_DIM(batch));
+		for (j = 0; j < RTE_DIM(batch) && i < n; j++) {
+			res = batch[j] & mask;
+			if (res < upper_bound)
+				vals[i++] = res;
+		}
+	}
+}
+
 static uint64_t
 __rte_random_initial_seed(void)
 {
@@ -205,6 +400,16 @@ RTE_INIT(rte_rand_init)
 {
 	uint64_t seed;
 
+#ifdef RTE_ARCH_X86
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F))
+		rand_bulk_max_isa = RAND_BULK_AVX512;
+	else
+#endif
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		rand_bulk_max_isa = RAND_BULK_AVX2;
+#endif
+
 	seed = __rte_random_initial_seed();
 
 	rte_srand(seed);
@@ -3,6 +3,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -21,6 +22,10 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_spinlock.h>
+#include <rte_alarm.h>
+#ifndef RTE_EXEC_ENV_WINDOWS
+#include <rte_telemetry.h>
+#endif
 
 #include "eal_private.h"
 
@@ -70,8 +75,44 @@ struct core_state {
 	uint8_t service_active_on_lcore[RTE_SERVICE_NUM_MAX];
 	uint64_t loops;
 	uint64_t calls_per_service[RTE_SERVICE_NUM_MAX];
+	uint64_t cycles_per_service[RTE_SERVICE_NUM_MAX];
+	/* cycles_per_service at the last balancer pass */
+	uint64_t balancer_cycles[RTE_SERVICE_NUM_MAX];
 } __rte_cache_aligned;
 
+/* Balancer thresholds, in percent of the cycles of a service core. */
+#define BALANCER_IMBALANCE 20 /* load difference worth a remapping */
+#define BALANCER_HIGH_LOAD 80 /* load above which services are replicated */
+#define BALANCER_LOW_LOAD 30 /* load below which replicas are removed */
+
+#define BALANCER_PERIOD_US(ms) ((uint64_t)(ms) * US_PER_S / MS_PER_S)
+#define BALANCER_DECISIONS_MAX 8
+#define BALANCER_DECISION_LEN 96
+
+struct service_balancer {
+	rte_spinlock_t lock;
+	uint32_t enabled;
+	uint32_t period_ms;
+	uint64_t last_tsc; /* TSC of the last pass, 0 before the first one */
+	uint64_t passes;
+	uint64_t migrations;
+	uint64_t replications;
+	uint64_t reductions;
+	/* load of the running service cores at the last pass, -1 otherwise */
+	int16_t lcore_load[RTE_MAX_LCORE];
+	/* services mapped on each lcore by the balancer replication, the only
+	 * mappings it may remove.
+	 */
+	uint64_t replicas[RTE_MAX_LCORE];
+	/* last decisions, as a ring indexed by nb_decisions */
+	uint32_t nb_decisions;
+	char decisions[BALANCER_DECISIONS_MAX][BALANCER_DECISION_LEN];
+};
+
+static struct service_balancer balancer = {
+	.lock = RTE_SPINLOCK_INITIALIZER,
+};
+
 static uint32_t rte_service_count;
 static struct rte_service_spec_impl *rte_services;
 static struct core_state *lcore_states;
@@ -128,6 +169,7 @@ rte_service_finalize(void)
 	if (!rte_service_library_initialized)
 		return;
 
+	rte_service_balancer_disable();
 	rte_service_lcore_reset_all();
 	rte_eal_mp_wait_lcore();
 
@@ -370,6 +412,7 @@ service_runner_do_callback(struct rte_service_spec_impl *s,
 		s->spec.callback(userdata);
 		uint64_t end = rte_rdtsc();
 		s->cycles_spent += end - start;
+		cs->cycles_per_service[service_idx] += end - start;
 		cs->calls_per_service[service_idx]++;
 		s->calls++;
 	} else
@@ -622,6 +665,14 @@ int32_t
 rte_service_map_lcore_set(uint32_t id, uint32_t lcore, uint32_t enabled)
 {
 	uint32_t on = enabled > 0;
+
+	/* the application now owns this mapping */
+	if (id < RTE_SERVICE_NUM_MAX && lcore < RTE_MAX_LCORE) {
+		rte_spinlock_lock(&balancer.lock);
+		balancer.replicas[lcore] &= ~(UINT64_C(1) << id);
+		rte_spinlock_unlock(&balancer.lock);
+	}
+
 	return service_update(id, lcore, &on, 0);
 }
 
@@ -670,6 +721,12 @@ rte_service_lcore_reset_all(void)
 		__atomic_store_n(&rte_services[i].num_mapped_cores, 0,
 			__ATOMIC_RELAXED);
 
+	/* the next balancer pass takes a new reference of the statistics */
+	rte_spinlock_lock(&balancer.lock);
+	balancer.last_tsc = 0;
+	memset(balancer.replicas, 0, sizeof(balancer.replicas));
+	rte_spinlock_unlock(&balancer.lock);
+
 	return 0;
 }
 
@@ -922,3 +979,363 @@ rte_service_dump(FILE *f, uint32_t id)
 
 	return 0;
 }
+
+static void
+balancer_decision_log(const char *action, uint32_t sid, uint32_t from,
+		uint32_t to)
+{
+	char *d = balancer.decisions[balancer.nb_decisions++ %
+		BALANCER_DECISIONS_MAX];
+
+	if (from == RTE_MAX_LCORE)
+		snprintf(d, BALANCER_DECISION_LEN, "%s %s to lcore %u",
+			action, rte_services[sid].spec.name, to);
+	else if (to == RTE_MAX_LCORE)
+		snprintf(d, BALANCER_DECISION_LEN, "%s %s from lcore %u",
+			action, rte_services[sid].spec.name, from);
+	else
+		snprintf(d, BALANCER_DECISION_LEN, "%s %s from lcore %u to %u",
+			action, rte_services[sid].spec.name, from, to);
+	RTE_LOG(DEBUG, EAL, "service balancer: %s\n", d);
+}
+
+/* service ids the balancer may remap on the lcore */
+static uint64_t
+balancer_service_mask(uint32_t lcore)
+{
+	uint64_t mask = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		struct rte_service_spec_impl *s = &rte_services[i];
+
+		if (service_valid(i) && service_stats_enabled(s) &&
+				(lcore_states[lcore].service_mask &
+				 (UINT64_C(1) << i)))
+			mask |= UINT64_C(1) << i;
+	}
+
+	return mask;
+}
+
+/* Move the MT unsafe service the closest to half of the load difference. */
+static int
+balancer_migrate(uint32_t hot, uint32_t cold,
+		int16_t svc_load[][RTE_SERVICE_NUM_MAX])
+{
+	int diff = balancer.lcore_load[hot] - balancer.lcore_load[cold];
+	uint64_t mask = balancer_service_mask(hot);
+	int best = -1, best_dist = INT_MAX;
+	uint32_t i, on;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		int load = svc_load[hot][i];
+		int dist = abs(diff - 2 * load);
+
+		if (!(mask & (UINT64_C(1) << i)) ||
+				service_mt_safe(&rte_services[i]))
+			continue;
+		/* the move must lower the load of the hottest core */
+		if (load <= 0 || load >= diff || dist >= best_dist)
+			continue;
+		best = i;
+		best_dist = dist;
+	}
+	if (best < 0)
+		return 0;
+
+	/* while mapped on both cores, the execute lock keeps running the
+	 * service on a single core at a time.
+	 */
+	on = 1;
+	service_update(best, cold, &on, NULL);
+	on = 0;
+	service_update(best, hot, &on, NULL);
+	balancer.migrations++;
+	balancer_decision_log("migrate", best, hot, cold);
+
+	return 1;
+}
+
+/* Run the heaviest MT safe service of the hot core on the cold one too. */
+static int
+balancer_replicate(uint32_t hot, uint32_t cold,
+		int16_t svc_load[][RTE_SERVICE_NUM_MAX])
+{
+	uint64_t mask = balancer_service_mask(hot) &
+		~lcore_states[cold].service_mask;
+	int best = -1, best_load = 0;
+	uint32_t i, on = 1;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!(mask & (UINT64_C(1) << i)) ||
+				!service_mt_safe(&rte_services[i]))
+			continue;
+		if (svc_load[hot][i] > best_load) {
+			best = i;
+			best_load = svc_load[hot][i];
+		}
+	}
+	if (best < 0)
+		return 0;
+
+	service_update(best, cold, &on, NULL);
+	balancer.replicas[cold] |= UINT64_C(1) << best;
+	balancer.replications++;
+	balancer_decision_log("replicate", best, RTE_MAX_LCORE, cold);
+
+	return 1;
+}
+
+/* Unmap a replica of an MT safe service from its busiest core, once all the
+ * cores running the service are lightly loaded. Only the replicas added by
+ * the balancer are removed, never the mappings of the application.
+ */
+static int
+balancer_reduce(const uint32_t lcores[], uint32_t nb_lcores)
+{
+	uint32_t i, j, off = 0;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		uint32_t nb_mapped = 0, busiest = RTE_MAX_LCORE;
+		int max_load = -1, max_replica_load = -1;
+
+		if (!service_valid(i) || !service_mt_safe(&rte_services[i]) ||
+				!service_stats_enabled(&rte_services[i]))
+			continue;
+
+		for (j = 0; j < nb_lcores; j++) {
+			if (!(lcore_states[lcores[j]].service_mask &
+					(UINT64_C(1) << i)))
+				continue;
+			nb_mapped++;
+			max_load = RTE_MAX(max_load,
+				(int)balancer.lcore_load[lcores[j]]);
+			if ((balancer.replicas[lcores[j]] & (UINT64_C(1) << i)) &&
+					balancer.lcore_load[lcores[j]] >
+					max_replica_load) {
+				max_replica_load =
+					balancer.lcore_load[lcores[j]];
+				busiest = lcores[j];
+			}
+		}
+		if (nb_mapped < 2 || busiest == RTE_MAX_LCORE ||
+				max_load >= BALANCER_LOW_LOAD)
+			continue;
+
+		service_update(i, busiest, &off, NULL);
+		balancer.replicas[busiest] &= ~(UINT64_C(1) << i);
+		balancer.reductions++;
+		balancer_decision_log("reduce", i, busiest, RTE_MAX_LCORE);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int32_t
+balancer_pass(void)
+{
+	static int16_t svc_load[RTE_MAX_LCORE][RTE_SERVICE_NUM_MAX];
+	uint32_t lcores[RTE_MAX_LCORE];
+	uint32_t nb_lcores = 0, hot = 0, cold = 0;
+	uint64_t tsc, elapsed;
+	uint32_t lcore, i;
+
+	tsc = rte_rdtsc();
+	elapsed = tsc - balancer.last_tsc;
+
+	for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+		struct core_state *cs = &lcore_states[lcore];
+		uint64_t busy = 0;
+
+		balancer.lcore_load[lcore] = -1;
+		for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+			uint64_t cycles = __atomic_load_n(
+				&cs->cycles_per_service[i], __ATOMIC_RELAXED);
+
+			svc_load[lcore][i] = RTE_MIN(UINT64_C(100),
+				(cycles - cs->balancer_cycles[i]) * 100 /
+				RTE_MAX(elapsed, UINT64_C(1)));
+			busy += cycles - cs->balancer_cycles[i];
+			cs->balancer_cycles[i] = cycles;
+		}
+
+		if (!cs->is_service_core ||
+				__atomic_load_n(&cs->runstate,
+					__ATOMIC_ACQUIRE) != RUNSTATE_RUNNING)
+			continue;
+
+		balancer.lcore_load[lcore] = RTE_MIN(UINT64_C(100),
+			busy * 100 / RTE_MAX(elapsed, UINT64_C(1)));
+		lcores[nb_lcores++] = lcore;
+	}
+
+	/* the first pass only takes the reference of the statistics */
+	if (balancer.last_tsc == 0) {
+		balancer.last_tsc = tsc;
+		return 0;
+	}
+	balancer.last_tsc = tsc;
+	balancer.passes++;
+
+	if (nb_lcores < 2)
+		return 0;
+
+	for (i = 0; i < nb_lcores; i++) {
+		if (balancer.lcore_load[lcores[i]] >
+				balancer.lcore_load[lcores[hot]])
+			hot = i;
+		if (balancer.lcore_load[lcores[i]] <
+				balancer.lcore_load[lcores[cold]])
+			cold = i;
+	}
+	hot = lcores[hot];
+	cold = lcores[cold];
+
+	if (balancer.lcore_load[hot] - balancer.lcore_load[cold] >=
+			BALANCER_IMBALANCE) {
+		if (balancer_migrate(hot, cold, svc_load))
+			return 1;
+		if (balancer.lcore_load[hot] >= BALANCER_HIGH_LOAD &&
+				balancer_replicate(hot, cold, svc_load))
+			return 1;
+	}
+
+	return balancer_reduce(lcores, nb_lcores);
+}
+
+int32_t
+rte_service_lcore_balance(void)
+{
+	int32_t ret;
+
+	if (!rte_service_library_initialized)
+		return -ENOTSUP;
+
+	rte_spinlock_lock(&balancer.lock);
+	ret = balancer_pass();
+	rte_spinlock_unlock(&balancer.lock);
+
+	return ret;
+}
+
+static void
+balancer_alarm_cb(void *arg __rte_unused)
+{
+	rte_spinlock_lock(&balancer.lock);
+	if (balancer.enabled) {
+		balancer_pass();
+		if (rte_eal_alarm_set(BALANCER_PERIOD_US(balancer.period_ms),
+				balancer_alarm_cb, NULL) < 0) {
+			RTE_LOG(ERR, EAL,
+				"service balancer cannot be rearmed\n");
+			balancer.enabled = 0;
+		}
+	}
+	rte_spinlock_unlock(&balancer.lock);
+}
+
+int32_t
+rte_service_balancer_enable(uint32_t period_ms)
+{
+	int32_t ret = 0;
+
+	if (!rte_service_library_initialized)
+		return -ENOTSUP;
+	if (period_ms == 0)
+		return -EINVAL;
+
+	rte_spinlock_lock(&balancer.lock);
+	if (balancer.enabled) {
+		ret = -EALREADY;
+		goto unlock;
+	}
+
+	balancer.period_ms = period_ms;
+	ret = rte_eal_alarm_set(BALANCER_PERIOD_US(period_ms),
+		balancer_alarm_cb, NULL);
+	if (ret == 0)
+		balancer.enabled = 1;
+unlock:
+	rte_spinlock_unlock(&balancer.lock);
+	return ret;
+}
+
+int32_t
+rte_service_balancer_disable(void)
+{
+	rte_spinlock_lock(&balancer.lock);
+	if (!balancer.enabled) {
+		rte_spinlock_unlock(&balancer.lock);
+		return -EALREADY;
+	}
+	balancer.enabled = 0;
+	rte_spinlock_unlock(&balancer.lock);
+
+	/* a callback already running sees the balancer disabled */
+	rte_eal_alarm_cancel(balancer_alarm_cb, NULL);
+
+	return 0;
+}
+
+#ifndef RTE_EXEC_ENV_WINDOWS
+static int
+handle_service_balancer(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	struct rte_tel_data *loads, *decisions;
+	char lcore_str[16];
+	uint32_t i, first;
+
+	if (!rte_service_library_initialized)
+		return -ENOTSUP;
+
+	loads = rte_tel_data_alloc();
+	if (loads == NULL)
+		return -ENOMEM;
+	decisions = rte_tel_data_alloc();
+	if (decisions == NULL) {
+		rte_tel_data_free(loads);
+		return -ENOMEM;
+	}
+	rte_tel_data_start_dict(loads);
+	rte_tel_data_start_array(decisions, RTE_TEL_STRING_VAL);
+
+	rte_spinlock_lock(&balancer.lock);
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "enabled", balancer.enabled);
+	rte_tel_data_add_dict_int(d, "period_ms", balancer.period_ms);
+	rte_tel_data_add_dict_u64(d, "passes", balancer.passes);
+	rte_tel_data_add_dict_u64(d, "migrations", balancer.migrations);
+	rte_tel_data_add_dict_u64(d, "replications", balancer.replications);
+	rte_tel_data_add_dict_u64(d, "reductions", balancer.reductions);
+
+	for (i = 0; i < RTE_MAX_LCORE && balancer.passes != 0; i++) {
+		if (balancer.lcore_load[i] < 0)
+			continue;
+		snprintf(lcore_str, sizeof(lcore_str), "%u", i);
+		rte_tel_data_add_dict_int(loads, lcore_str,
+			balancer.lcore_load[i]);
+	}
+
+	first = balancer.nb_decisions > BALANCER_DECISIONS_MAX ?
+		balancer.nb_decisions - BALANCER_DECISIONS_MAX : 0;
+	for (i = first; i < balancer.nb_decisions; i++)
+		rte_tel_data_add_array_string(decisions,
+			balancer.decisions[i % BALANCER_DECISIONS_MAX]);
+	rte_spinlock_unlock(&balancer.lock);
+
+	rte_tel_data_add_dict_container(d, "lcore_load", loads, 0);
+	rte_tel_data_add_dict_container(d, "decisions", decisions, 0);
+
+	return 0;
+}
+
+RTE_INIT(service_balancer_init_telemetry)
+{
+	rte_telemetry_register_cmd("/eal/service/balancer",
+		handle_service_balancer,
+		"Returns the service core balancer state and last decisions. Takes no parameters");
+}
+#endif
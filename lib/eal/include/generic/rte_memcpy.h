@@ -11,6 +11,10 @@
  * Functions for vectorised implementation of memcpy().
  */
 
+#include <stddef.h>
+
+#include <rte_compat.h>
+
 /**
  * Copy 16 bytes from one location to another using optimised
  * instructions. The locations should not overlap.
@@ -87,6 +91,36 @@ rte_mov128(uint8_t *dst, const uint8_t *src);
 static inline void
 rte_mov256(uint8_t *dst, const uint8_t *src);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Copy bytes from one location to another, bypassing the caches where the
+ * architecture allows it. The locations must not overlap.
+ *
+ * Large copies done with rte_memcpy() go through the caches and evict the
+ * working set of the application. This function rather uses non-temporal
+ * stores for the cache lines fully covered by the destination, and is
+ * preferable when the destination is not read soon after the copy, or by
+ * another core. The stores are ordered before the function returns.
+ * Copies shorter than a few cache lines are done with rte_memcpy().
+ *
+ * The widest vector instructions allowed by the CPU and by
+ * rte_vect_get_max_simd_bitwidth() are selected at runtime.
+ *
+ * @param dst
+ *   Pointer to the destination of the data.
+ * @param src
+ *   Pointer to the source data.
+ * @param n
+ *   Number of bytes to copy.
+ * @return
+ *   Pointer to the destination data.
+ */
+__rte_experimental
+void *
+rte_memcpy_nt(void *dst, const void *src, size_t n);
+
 #ifdef __DOXYGEN__
 
 /**
@@ -99,6 +133,10 @@ rte_mov256(uint8_t *dst, const uint8_t *src);
  * -DRTE_MEMCPY_AVX512 macro in CFLAGS, or define the RTE_MEMCPY_AVX512 macro
  * explicitly in the source file before including the rte_memcpy header file.
  *
+ * @note For x86 platforms to copy with rte_memcpy_nt() when the size is at
+ * least a threshold, define the RTE_MEMCPY_NT_THRESHOLD macro to this number
+ * of bytes before including the rte_memcpy header file.
+ *
  * @param dst
  *   Pointer to the destination of the data.
  * @param src
@@ -402,6 +402,115 @@ __rte_experimental
 void
 rte_thread_unregister(void);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the poll busyness of an lcore.
+ *
+ * The poll busyness is the percentage of cycles an lcore spent handling
+ * work, as opposed to polling empty queues, averaged over about the last
+ * second. Empty polls are reported by the Rx burst and dequeue functions of
+ * the ethdev, eventdev and ring libraries when DPDK is built with the
+ * enable_lcore_poll_busyness option.
+ *
+ * @param lcore_id
+ *   The lcore id.
+ * @return
+ *   - The poll busyness, in the range [0, 100].
+ *   - -EINVAL: Invalid lcore id.
+ *   - -ENOTSUP: Poll busyness accounting is not enabled.
+ *   - -ENODATA: The lcore has not reported any poll yet.
+ */
+__rte_experimental
+int
+rte_lcore_poll_busyness(unsigned int lcore_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Check whether poll busyness accounting is enabled.
+ *
+ * @return
+ *   1 if enabled, 0 otherwise.
+ */
+__rte_experimental
+int
+rte_lcore_poll_busyness_enabled(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable or disable poll busyness accounting at runtime.
+ * Accounting is enabled by default when built in.
+ *
+ * @param enable
+ *   true to enable, false to disable.
+ */
+__rte_experimental
+void
+rte_lcore_poll_busyness_enabled_set(bool enable);
+
+/**
+ * @internal
+ * Account a device poll of the calling lcore, not to be called directly.
+ *
+ * @param nb_rx
+ *   Number of objects returned by the poll, 0 for an empty poll.
+ */
+__rte_experimental
+void
+__rte_lcore_poll_busyness_timestamp(uint16_t nb_rx);
+
+/**
+ * @internal
+ * Account a ring poll of the calling lcore, not to be called directly.
+ * It is ignored once the lcore reported a device poll, as ring dequeues
+ * are then mostly done behind the device polls.
+ *
+ * @param nb_deq
+ *   Number of objects returned by the poll, 0 for an empty poll.
+ */
+__rte_experimental
+void
+__rte_lcore_poll_busyness_ring_timestamp(uint16_t nb_deq);
+
+/**
+ * Report a poll of the calling lcore for busyness accounting.
+ *
+ * To be used by device Rx burst and dequeue functions, it is a no-op unless
+ * DPDK is built with the enable_lcore_poll_busyness option, and the caller
+ * with the experimental API allowed.
+ *
+ * @param nb_rx
+ *   Number of objects returned by the poll, 0 for an empty poll.
+ */
+#if defined(RTE_LCORE_POLL_BUSYNESS) && defined(ALLOW_EXPERIMENTAL_API)
+#define RTE_LCORE_POLL_BUSYNESS_TIMESTAMP(nb_rx) \
+	__rte_lcore_poll_busyness_timestamp(nb_rx)
+#else
+#define RTE_LCORE_POLL_BUSYNESS_TIMESTAMP(nb_rx) RTE_SET_USED(nb_rx)
+#endif
+
+/**
+ * Report a ring poll of the calling lcore for busyness accounting.
+ *
+ * Same as RTE_LCORE_POLL_BUSYNESS_TIMESTAMP(), for the ring dequeue
+ * functions, so that a ring dequeued behind a device poll is not counted
+ * as another poll.
+ *
+ * @param nb_deq
+ *   Number of objects returned by the poll, 0 for an empty poll.
+ */
+#if defined(RTE_LCORE_POLL_BUSYNESS) && defined(ALLOW_EXPERIMENTAL_API)
+#define RTE_LCORE_POLL_BUSYNESS_RING_TIMESTAMP(nb_deq) \
+	__rte_lcore_poll_busyness_ring_timestamp(nb_deq)
+#else
+#define RTE_LCORE_POLL_BUSYNESS_RING_TIMESTAMP(nb_deq) RTE_SET_USED(nb_deq)
+#endif
+
 /**
  * Create a control thread.
  *
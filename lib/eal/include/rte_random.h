@@ -65,6 +65,52 @@ rte_rand(void);
 uint64_t
 rte_rand_max(uint64_t upper_bound);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Fill an array with pseudo-random values.
+ *
+ * The values come from several instances of the generator behind
+ * rte_rand(), independently seeded and stepped together with the widest
+ * vector instructions available, so they have the same statistical quality
+ * at a lower cost per value.
+ *
+ * If called from lcore threads, this function is thread-safe.
+ *
+ * @param vals
+ *   Array of at least n entries, filled with pseudo-random values between
+ *   0 and (1<<64)-1.
+ * @param n
+ *   Number of values to generate.
+ */
+__rte_experimental
+void
+rte_rand_bulk(uint64_t *vals, unsigned int n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Fill an array with pseudo-random numbers with an upper bound.
+ *
+ * The numbers are uniformly distributed (unbiased), as with rte_rand_max(),
+ * and generated as with rte_rand_bulk().
+ *
+ * If called from lcore threads, this function is thread-safe.
+ *
+ * @param vals
+ *   Array of at least n entries, filled with pseudo-random values between
+ *   0 and (upper_bound-1).
+ * @param n
+ *   Number of values to generate.
+ * @param upper_bound
+ *   The upper bound of the generated numbers.
+ */
+__rte_experimental
+void
+rte_rand_max_bulk(uint64_t *vals, unsigned int n, uint64_t upper_bound);
+
 #ifdef __cplusplus
 }
 #endif
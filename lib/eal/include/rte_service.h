@@ -434,6 +434,64 @@ rte_service_lcore_attr_get(uint32_t lcore, uint32_t attr_id,
 int32_t
 rte_service_lcore_attr_reset_all(uint32_t lcore);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Run one pass of the service core balancer.
+ *
+ * The load of each running service core, and of each service on it, is
+ * computed from the cycles spent in the services since the previous pass.
+ * Only services with statistics enabled (see
+ * *rte_service_set_stats_enable*) are considered. When the busiest and the
+ * least busy service cores differ enough, the pass either migrates a MT unsafe
+ * service from the busiest to the least busy core, or, if the busiest core is
+ * saturated, maps a MT safe service on the least busy core too. Such a
+ * replica is unmapped again when all the cores running the service are
+ * lightly loaded; the mappings set by the application are never removed.
+ * A pass makes at most one mapping change.
+ *
+ * The application must not change the service mappings concurrently.
+ *
+ * @retval 1 A service mapping was changed.
+ * @retval 0 No change, or first pass, which only takes the reference of the
+ *         statistics.
+ * @retval -ENOTSUP The service library is not initialized.
+ */
+__rte_experimental
+int32_t rte_service_lcore_balance(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Run the service core balancer periodically, from an EAL alarm.
+ *
+ * @see rte_service_lcore_balance
+ *
+ * @param period_ms Period of the balancer passes, in milliseconds.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid period.
+ * @retval -EALREADY The balancer is already enabled.
+ * @retval -ENOTSUP The service library is not initialized.
+ * @retval <0 The alarm cannot be set.
+ */
+__rte_experimental
+int32_t rte_service_balancer_enable(uint32_t period_ms);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Stop the periodic service core balancer.
+ * The current service mappings are kept.
+ *
+ * @retval 0 Success
+ * @retval -EALREADY The balancer is not enabled.
+ */
+__rte_experimental
+int32_t rte_service_balancer_disable(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -113,6 +113,26 @@ int rte_trace_regexp(const char *regex, bool enable);
 __rte_experimental
 int rte_trace_save(void);
 
+/**
+ * Dump the trace flight recorder.
+ *
+ * When the flight recorder is enabled with --trace-recorder EAL parameter,
+ * save the current content of the per-thread trace buffers, along with the
+ * metadata, to a new "dump-<index>" sub-directory of the trace directory.
+ * Tracing is not stopped while the buffers are saved.
+ *
+ * It is meant to be called when an application-defined condition, like
+ * a latency spike, is detected. The flight recorder is also dumped on
+ * fatal signals and on "/eal/trace/dump" telemetry request.
+ *
+ * @return
+ *   - >=0: Index of the dump.
+ *   - -ENOTSUP: Flight recorder is not enabled.
+ *   - <0 : Failure.
+ */
+__rte_experimental
+int rte_trace_recorder_dump(void);
+
 /**
  * Dump the trace metadata to a file.
  *
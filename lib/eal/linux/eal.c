@@ -62,6 +62,7 @@
 #include "eal_options.h"
 #include "eal_vfio.h"
 #include "hotplug_mp.h"
+#include "malloc_cache.h"
 
 #define MEMSIZE_IF_NO_HUGE_PAGE (64ULL * 1024ULL * 1024ULL)
 
@@ -548,6 +549,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_LEGACY_MEM"        Legacy memory mode (no dynamic allocation, contiguous segments)\n"
 	       "  --"OPT_SINGLE_FILE_SEGMENTS" Put all hugepage memory in single files\n"
 	       "  --"OPT_MATCH_ALLOCATIONS" Free hugepages exactly as allocated\n"
+	       "  --"OPT_HUGE_ALLOC_THREADS" Number of threads mapping hugepages in parallel\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if (hook) {
@@ -639,6 +641,24 @@ eal_parse_vfio_vf_token(const char *vf_token)
 	return -1;
 }
 
+static int
+eal_parse_huge_alloc_threads(const char *arg)
+{
+	struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+	unsigned long nb_threads;
+	char *end;
+
+	errno = 0;
+	nb_threads = strtoul(arg, &end, 0);
+	if (errno != 0 || *arg == '\0' || *end != '\0' ||
+			nb_threads == 0 || nb_threads > RTE_MAX_LCORE)
+		return -1;
+
+	internal_conf->huge_alloc_threads = nb_threads;
+	return 0;
+}
+
 /* Parse the arguments for --log-level only */
 static void
 eal_log_level_parse(int argc, char **argv)
@@ -819,6 +839,16 @@ eal_parse_args(int argc, char **argv)
 			internal_conf->match_allocations = 1;
 			break;
 
+		case OPT_HUGE_ALLOC_THREADS_NUM:
+			if (eal_parse_huge_alloc_threads(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameters for --"
+						OPT_HUGE_ALLOC_THREADS "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -1219,6 +1249,12 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	if (eal_trace_recorder_init() < 0) {
+		rte_eal_init_alert("Cannot init trace flight recorder");
+		rte_errno = EFAULT;
+		return -1;
+	}
+
 	eal_check_mem_on_local_socket();
 
 	if (pthread_setaffinity_np(pthread_self(), sizeof(rte_cpuset_t),
@@ -1366,6 +1402,7 @@ rte_eal_cleanup(void)
 		rte_memseg_walk(mark_freeable, NULL);
 	rte_service_finalize();
 	rte_mp_channel_cleanup();
+	malloc_cache_flush_all();
 	/* after this point, any DPDK pointers will become dangling */
 	rte_eal_memory_detach();
 	rte_trace_save();
@@ -3,6 +3,7 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -38,6 +39,7 @@
 #include <rte_eal.h>
 #include <rte_errno.h>
 #include <rte_memory.h>
+#include <rte_per_lcore.h>
 #include <rte_spinlock.h>
 
 #include "eal_filesystem.h"
@@ -45,6 +47,7 @@
 #include "eal_memalloc.h"
 #include "eal_memcfg.h"
 #include "eal_private.h"
+#include "eal_thread.h"
 
 const int anonymous_hugepages_supported =
 #ifdef MAP_HUGE_SHIFT
@@ -105,11 +108,12 @@ static struct {
 /** local copy of a memory map, used to synchronize memory hotplug in MP */
 static struct rte_memseg_list local_memsegs[RTE_MAX_MEMSEG_LISTS];
 
-static sigjmp_buf huge_jmpenv;
+/* per thread, as pages may be faulted in by several threads in parallel */
+static RTE_DEFINE_PER_LCORE(sigjmp_buf, huge_jmpenv);
 
 static void __rte_unused huge_sigbus_handler(int signo __rte_unused)
 {
-	siglongjmp(huge_jmpenv, 1);
+	siglongjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /* Put setjmp into a wrap method to avoid compiling error. Any non-volatile,
@@ -118,7 +122,7 @@ static void __rte_unused huge_sigbus_handler(int signo __rte_unused)
  */
 static int __rte_unused huge_wrap_sigsetjmp(void)
 {
-	return sigsetjmp(huge_jmpenv, 1);
+	return sigsetjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 static struct sigaction huge_action_old;
@@ -778,6 +782,175 @@ struct alloc_walk_param {
 	int socket;
 	bool exact;
 };
+
+/* a range of segments of a memseg list, allocated by one thread */
+struct alloc_seg_job {
+	pthread_t tid;
+	struct rte_memseg_list *msl;
+	struct hugepage_info *hi;
+	const rte_cpuset_t *cpuset;
+	unsigned int msl_idx;
+	int socket;
+	int start_idx;
+	unsigned int n_segs;
+	unsigned int segs_allocated; /**< segments allocated before a failure */
+};
+
+static void *
+alloc_seg_thread(void *arg)
+{
+	struct alloc_seg_job *job = arg;
+	size_t page_sz = job->msl->page_sz;
+	unsigned int i;
+
+	if (CPU_COUNT(job->cpuset) != 0 &&
+			pthread_setaffinity_np(pthread_self(),
+				sizeof(*job->cpuset), job->cpuset) != 0)
+		RTE_LOG(DEBUG, EAL, "%s(): cannot set affinity to socket %d\n",
+			__func__, job->socket);
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	/* memory policy is per thread, the caller one is not inherited */
+	if (check_numa())
+		numa_set_preferred(job->socket);
+#endif
+
+	for (i = 0; i < job->n_segs; i++) {
+		int cur_idx = job->start_idx + i;
+		struct rte_memseg *cur;
+		void *map_addr;
+
+		cur = rte_fbarray_get(&job->msl->memseg_arr, cur_idx);
+		map_addr = RTE_PTR_ADD(job->msl->base_va, cur_idx * page_sz);
+		if (alloc_seg(cur, map_addr, job->socket, job->hi,
+				job->msl_idx, cur_idx))
+			break;
+	}
+	job->segs_allocated = i;
+
+	return NULL;
+}
+
+/* whether allocating n_segs pages is worth spreading over several threads */
+static bool
+alloc_seg_parallel_ok(unsigned int n_segs)
+{
+	const struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+
+	/* in single file segments mode, all pages share one fd and its
+	 * bookkeeping, so they have to be allocated one by one.
+	 */
+	return internal_conf->huge_alloc_threads > 1 && n_segs > 1 &&
+		!internal_conf->single_file_segments;
+}
+
+/*
+ * Allocate n_segs pages starting at start_idx using several threads, each one
+ * mapping and pre-faulting a contiguous part of the range. Threads are pinned
+ * to the CPUs of the socket the memory is allocated from, so that pages are
+ * zeroed by the kernel using the local memory bandwidth.
+ *
+ * Returns the number of pages allocated contiguously from start_idx, or -1 if
+ * exact number of pages was requested and could not be allocated.
+ */
+static int
+alloc_seg_parallel(struct alloc_walk_param *wa, struct rte_memseg_list *msl,
+		unsigned int msl_idx, int start_idx, unsigned int need)
+{
+	const struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+	struct alloc_seg_job jobs[RTE_MAX_LCORE];
+	unsigned int nb_jobs, per_job, i, j, allocated;
+	rte_cpuset_t cpuset;
+	bool contig = true;
+	int cur_idx;
+
+	CPU_ZERO(&cpuset);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		if (eal_cpu_detected(i) &&
+				eal_cpu_socket_id(i) == (unsigned int)wa->socket)
+			CPU_SET(i, &cpuset);
+
+	nb_jobs = RTE_MIN(internal_conf->huge_alloc_threads, need);
+	per_job = need / nb_jobs;
+	cur_idx = start_idx;
+	for (i = 0; i < nb_jobs; i++) {
+		struct alloc_seg_job *job = &jobs[i];
+
+		job->msl = msl;
+		job->hi = wa->hi;
+		job->cpuset = &cpuset;
+		job->msl_idx = msl_idx;
+		job->socket = wa->socket;
+		job->start_idx = cur_idx;
+		/* first jobs take the remainder */
+		job->n_segs = per_job + (i < need % nb_jobs);
+		job->segs_allocated = 0;
+		cur_idx += job->n_segs;
+
+		/* on failure to spawn a thread, do the job from this one */
+		if (pthread_create(&job->tid, NULL, alloc_seg_thread, job)) {
+			RTE_LOG(DEBUG, EAL, "%s(): cannot create thread\n",
+				__func__);
+			job->tid = pthread_self();
+			alloc_seg_thread(job);
+		}
+	}
+
+	allocated = 0;
+	for (i = 0; i < nb_jobs; i++) {
+		struct alloc_seg_job *job = &jobs[i];
+
+		if (!pthread_equal(job->tid, pthread_self()))
+			pthread_join(job->tid, NULL);
+		if (contig)
+			allocated += job->segs_allocated;
+		if (job->segs_allocated != job->n_segs)
+			contig = false;
+	}
+
+	if (allocated != need)
+		RTE_LOG(DEBUG, EAL, "attempted to allocate %i segments, but only %i were allocated\n",
+			need, allocated);
+
+	/* release the pages that were allocated after the first failure, or
+	 * all of them if exact number of pages was requested.
+	 */
+	if (allocated != need && wa->exact)
+		allocated = 0;
+	for (i = 0; i < nb_jobs; i++) {
+		struct alloc_seg_job *job = &jobs[i];
+
+		for (j = 0; j < job->segs_allocated; j++) {
+			cur_idx = job->start_idx + j;
+			if ((unsigned int)(cur_idx - start_idx) < allocated)
+				continue;
+			/* free_seg may attempt to create a file, which
+			 * may fail.
+			 */
+			if (free_seg(rte_fbarray_get(&msl->memseg_arr, cur_idx),
+					wa->hi, msl_idx, cur_idx))
+				RTE_LOG(DEBUG, EAL, "Cannot free page\n");
+		}
+	}
+
+	if (allocated == 0 && wa->exact) {
+		/* clear the list */
+		if (wa->ms)
+			memset(wa->ms, 0, sizeof(*wa->ms) * wa->n_segs);
+		return -1;
+	}
+
+	for (i = 0; i < allocated; i++) {
+		cur_idx = start_idx + i;
+		if (wa->ms)
+			wa->ms[i] = rte_fbarray_get(&msl->memseg_arr, cur_idx);
+		rte_fbarray_set_used(&msl->memseg_arr, cur_idx);
+	}
+
+	return allocated;
+}
+
 static int
 alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 {
@@ -785,7 +958,7 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 	struct alloc_walk_param *wa = arg;
 	struct rte_memseg_list *cur_msl;
 	size_t page_sz;
-	int cur_idx, start_idx, j, dir_fd = -1;
+	int cur_idx, start_idx, j, ret, dir_fd = -1;
 	unsigned int msl_idx, need, i;
 	const struct internal_config *internal_conf =
 		eal_get_internal_configuration();
@@ -854,6 +1027,17 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 		}
 	}
 
+	if (alloc_seg_parallel_ok(need)) {
+		ret = alloc_seg_parallel(wa, cur_msl, msl_idx, start_idx, need);
+		if (ret < 0) {
+			if (dir_fd >= 0)
+				close(dir_fd);
+			return -1;
+		}
+		i = ret;
+		goto out;
+	}
+
 	for (i = 0; i < need; i++, cur_idx++) {
 		struct rte_memseg *cur;
 		void *map_addr;
@@ -16,6 +16,7 @@
 #include <string.h>
 #include <rte_vect.h>
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_config.h>
 
 #ifdef __cplusplus
@@ -33,6 +34,9 @@ extern "C" {
  * @note This is implemented as a macro, so it's address should not be taken
  * and care is needed as parameter expressions may be evaluated multiple times.
  *
+ * @note Define the RTE_MEMCPY_NT_THRESHOLD macro to a number of bytes before
+ * including this file to copy at least that many bytes with rte_memcpy_nt().
+ *
  * @param dst
  *   Pointer to the destination of the data.
  * @param src
@@ -45,6 +49,11 @@ extern "C" {
 static __rte_always_inline void *
 rte_memcpy(void *dst, const void *src, size_t n);
 
+/* Non-temporal copy, documented in generic/rte_memcpy.h */
+__rte_experimental
+void *
+rte_memcpy_nt(void *dst, const void *src, size_t n);
+
 #if defined __AVX512F__ && defined RTE_MEMCPY_AVX512
 
 #define ALIGNMENT_MASK 0x3F
@@ -868,6 +877,10 @@ rte_memcpy_aligned(void *dst, const void *src, size_t n)
 static __rte_always_inline void *
 rte_memcpy(void *dst, const void *src, size_t n)
 {
+#ifdef RTE_MEMCPY_NT_THRESHOLD
+	if (n >= RTE_MEMCPY_NT_THRESHOLD)
+		return rte_memcpy_nt(dst, src, n);
+#endif
 	if (!(((uintptr_t)dst | (uintptr_t)src) & ALIGNMENT_MASK))
 		return rte_memcpy_aligned(dst, src, n);
 	else
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_vect.h>
+
+/* Below this size, the partial cache lines dominate: copy through cache. */
+#define MEMCPY_NT_MIN_SIZE 256
+
+/* Distance at which the source is prefetched, bypassing the caches. */
+#define MEMCPY_NT_PREFETCH_DIST 512
+
+enum memcpy_nt_isa {
+	MEMCPY_NT_SSE,
+	MEMCPY_NT_AVX2,
+	MEMCPY_NT_AVX512,
+};
+
+static enum memcpy_nt_isa memcpy_nt_max_isa;
+
+/*
+ * The copy functions below get the destination aligned on a cache line and
+ * a length that is a multiple of 64 bytes. They only store full cache lines
+ * with non-temporal stores, which avoid the read for ownership and the
+ * eviction of the working set from the caches.
+ */
+static void
+memcpy_nt_sse(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	__m128i x0, x1, x2, x3;
+
+	for (; n >= 64; n -= 64, src += 64, dst += 64) {
+		rte_prefetch_non_temporal(src + MEMCPY_NT_PREFETCH_DIST);
+		x0 = _mm_loadu_si128((const __m128i *)(const void *)src);
+		x1 = _mm_loadu_si128((const __m128i *)(const void *)(src + 16));
+		x2 = _mm_loadu_si128((const __m128i *)(const void *)(src + 32));
+		x3 = _mm_loadu_si128((const __m128i *)(const void *)(src + 48));
+		_mm_stream_si128((__m128i *)(void *)dst, x0);
+		_mm_stream_si128((__m128i *)(void *)(dst + 16), x1);
+		_mm_stream_si128((__m128i *)(void *)(dst + 32), x2);
+		_mm_stream_si128((__m128i *)(void *)(dst + 48), x3);
+	}
+}
+
+static __attribute__((target("avx2"))) void
+memcpy_nt_avx2(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	__m256i y0, y1;
+
+	for (; n >= 64; n -= 64, src += 64, dst += 64) {
+		rte_prefetch_non_temporal(src + MEMCPY_NT_PREFETCH_DIST);
+		y0 = _mm256_loadu_si256((const __m256i *)(const void *)src);
+		y1 = _mm256_loadu_si256(
+			(const __m256i *)(const void *)(src + 32));
+		_mm256_stream_si256((__m256i *)(void *)dst, y0);
+		_mm256_stream_si256((__m256i *)(void *)(dst + 32), y1);
+	}
+}
+
+#ifdef CC_AVX512_SUPPORT
+static __attribute__((target("avx512f"))) void
+memcpy_nt_avx512(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	__m512i z0;
+
+	for (; n >= 64; n -= 64, src += 64, dst += 64) {
+		rte_prefetch_non_temporal(src + MEMCPY_NT_PREFETCH_DIST);
+		z0 = _mm512_loadu_si512((const void *)src);
+		_mm512_stream_si512((void *)dst, z0);
+	}
+}
+#endif
+
+void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	uint16_t simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+	uint8_t *d = dst;
+	const uint8_t *s = src;
+	size_t head, body;
+
+	if (n < MEMCPY_NT_MIN_SIZE)
+		return rte_memcpy(dst, src, n);
+
+	/* copy up to the first cache line boundary of the destination */
+	head = RTE_PTR_DIFF(RTE_PTR_ALIGN_CEIL(d, RTE_CACHE_LINE_SIZE), d);
+	if (head != 0) {
+		rte_memcpy(d, s, head);
+		d += head;
+		s += head;
+		n -= head;
+	}
+
+	body = RTE_ALIGN_FLOOR(n, 64);
+#ifdef CC_AVX512_SUPPORT
+	if (memcpy_nt_max_isa >= MEMCPY_NT_AVX512 &&
+			simd_bitwidth >= RTE_VECT_SIMD_512)
+		memcpy_nt_avx512(d, s, body);
+	else
+#endif
+	if (memcpy_nt_max_isa >= MEMCPY_NT_AVX2 &&
+			simd_bitwidth >= RTE_VECT_SIMD_256)
+		memcpy_nt_avx2(d, s, body);
+	else
+		memcpy_nt_sse(d, s, body);
+
+	/* order the weakly ordered stores before any later store */
+	_mm_sfence();
+
+	if (n != body)
+		rte_memcpy(d + body, s + body, n - body);
+
+	return dst;
+}
+
+RTE_INIT(rte_memcpy_nt_init)
+{
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F)) {
+		memcpy_nt_max_isa = MEMCPY_NT_AVX512;
+		return;
+	}
+#endif
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		memcpy_nt_max_isa = MEMCPY_NT_AVX2;
+}
@@ -4957,6 +4957,7 @@ rte_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
 	}
 #endif
 
+	RTE_LCORE_POLL_BUSYNESS_TIMESTAMP(nb_rx);
 	rte_ethdev_trace_rx_burst(port_id, queue_id, (void **)rx_pkts, nb_rx);
 	return nb_rx;
 }
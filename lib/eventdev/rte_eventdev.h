@@ -1732,6 +1732,7 @@ rte_event_dequeue_burst(uint8_t dev_id, uint8_t port_id, struct rte_event ev[],
 			uint16_t nb_events, uint64_t timeout_ticks)
 {
 	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+	uint16_t nb_deq;
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	if (dev_id >= RTE_EVENT_MAX_DEVS || !rte_eventdevs[dev_id].attached) {
@@ -1750,12 +1751,15 @@ rte_event_dequeue_burst(uint8_t dev_id, uint8_t port_id, struct rte_event ev[],
 	 * requests nb_events as const one
 	 */
 	if (nb_events == 1)
-		return (*dev->dequeue)(
+		nb_deq = (*dev->dequeue)(
 			dev->data->ports[port_id], ev, timeout_ticks);
 	else
-		return (*dev->dequeue_burst)(
+		nb_deq = (*dev->dequeue_burst)(
 			dev->data->ports[port_id], ev, nb_events,
 				timeout_ticks);
+
+	RTE_LCORE_POLL_BUSYNESS_TIMESTAMP(nb_deq);
+	return nb_deq;
 }
 
 /**
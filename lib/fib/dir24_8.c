@@ -29,6 +29,11 @@
 
 #define ROUNDUP(x, y)	 RTE_ALIGN_CEIL(x, (1 << (32 - y)))
 
+/* Number of /8 ranges of a bulk build */
+#define BUILD_NB_RANGES		256
+/* Routes covering a child of a block: one per prefix length and the block */
+#define BUILD_MAX_COVERS	17
+
 static inline rte_fib_lookup_fn_t
 get_scalar_fn(enum rte_fib_dir24_8_nh_sz nh_sz)
 {
@@ -150,7 +155,7 @@ write_to_fib(void *ptr, uint64_t val, enum rte_fib_dir24_8_nh_sz size, int n)
 }
 
 static int
-tbl8_get_idx(struct dir24_8_tbl *dp)
+__tbl8_get_idx(struct dir24_8_tbl *dp)
 {
 	uint32_t i;
 	int bit_idx;
@@ -173,6 +178,40 @@ tbl8_free_idx(struct dir24_8_tbl *dp, int idx)
 		~(1ULL << (idx & BITMAP_SLAB_BITMASK));
 }
 
+static void
+tbl8_cleanup_and_free(void *p, uint64_t tbl8_idx)
+{
+	struct dir24_8_tbl *dp = p;
+	uint8_t *ptr = (uint8_t *)dp->tbl8 +
+		(((uint64_t)tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+
+	memset(ptr, 0, DIR24_8_TBL8_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_free_idx(dp, tbl8_idx);
+	dp->cur_tbl8s--;
+}
+
+static int
+tbl8_get_idx(struct dir24_8_tbl *dp)
+{
+	int tbl8_idx;
+
+	tbl8_idx = __tbl8_get_idx(dp);
+	if (tbl8_idx == -ENOSPC && fib_rcu_reclaim(&dp->rcu) == 0)
+		tbl8_idx = __tbl8_get_idx(dp);
+	return tbl8_idx;
+}
+
+/*
+ * The tbl8 has been unlinked from tbl24, it is cleaned up and freed
+ * once no reader can still be using it.
+ */
+static void
+tbl8_free(struct dir24_8_tbl *dp, uint64_t tbl8_idx)
+{
+	if (fib_rcu_defer(&dp->rcu, tbl8_idx) != 0)
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+}
+
 static int
 tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
 {
@@ -190,6 +229,8 @@ tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
 		DIR24_8_EXT_ENT, dp->nh_sz,
 		DIR24_8_TBL8_GRP_NUM_ENT);
 	dp->cur_tbl8s++;
+	/* tbl8 entries must be visible before the tbl24 entry linking it */
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
 	return tbl8_idx;
 }
 
@@ -214,8 +255,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint8_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr8[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_2B:
 		ptr16 = &((uint16_t *)dp->tbl8)[tbl8_idx *
@@ -227,8 +266,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint16_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr16[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_4B:
 		ptr32 = &((uint32_t *)dp->tbl8)[tbl8_idx *
@@ -240,8 +277,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint32_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr32[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_8B:
 		ptr64 = &((uint64_t *)dp->tbl8)[tbl8_idx *
@@ -253,12 +288,9 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint64_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr64[i] = 0;
 		break;
 	}
-	tbl8_free_idx(dp, tbl8_idx);
-	dp->cur_tbl8s--;
+	tbl8_free(dp, tbl8_idx);
 }
 
 static int
@@ -458,13 +490,14 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 		if (parent != NULL) {
 			rte_rib_get_nh(parent, &par_nh);
 			if (par_nh == next_hop)
-				return 0;
+				goto successfully_added;
 		}
 		ret = modify_fib(dp, rib, ip, depth, next_hop);
 		if (ret != 0) {
 			rte_rib_remove(rib, ip, depth);
 			return ret;
 		}
+successfully_added:
 		if ((depth > 24) && (tmp == NULL))
 			dp->rsvd_tbl8s++;
 		return 0;
@@ -567,7 +600,327 @@ dir24_8_free(void *p)
 {
 	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
 
+	fib_rcu_free(&dp->rcu);
+	rte_free(dp->build);
 	rte_free(dp->tbl8_idxes);
 	rte_free(dp->tbl8);
 	rte_free(dp);
 }
+
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (cfg->mode == RTE_FIB_QSBR_MODE_SYNC)
+		return fib_rcu_qsbr_add(&dp->rcu, cfg->v, NULL,
+			dp->number_tbl8s, tbl8_cleanup_and_free, dp);
+	if (cfg->mode != RTE_FIB_QSBR_MODE_DQ)
+		return -EINVAL;
+
+	/* Init QSBR defer queue. */
+	snprintf(rcu_dq_name, sizeof(rcu_dq_name), "FIB_RCU_%s", name);
+	params.name = rcu_dq_name;
+	params.size = cfg->dq_size;
+	params.trigger_reclaim_limit = cfg->reclaim_thd;
+	params.max_reclaim_size = cfg->reclaim_max;
+	if (params.max_reclaim_size == 0)
+		params.max_reclaim_size = RTE_FIB_RCU_DQ_RECLAIM_MAX;
+	return fib_rcu_qsbr_add(&dp->rcu, cfg->v, &params, dp->number_tbl8s,
+		tbl8_cleanup_and_free, dp);
+}
+
+void
+dir24_8_bulk_begin(struct dir24_8_tbl *dp)
+{
+	fib_rcu_bulk_begin(&dp->rcu);
+}
+
+void
+dir24_8_bulk_end(struct dir24_8_tbl *dp)
+{
+	fib_rcu_bulk_end(&dp->rcu);
+}
+
+/* Bulk build of an empty table, the routes are sorted by prefix */
+struct dir24_8_build {
+	const struct rte_fib_route *routes;
+	uint32_t	first[BUILD_NB_RANGES + 1];	/* first route of a /8 */
+	uint64_t	cover_nh[BUILD_NB_RANGES];	/* next hop of a /8 */
+	uint32_t	tbl8_base[BUILD_NB_RANGES + 1];	/* first tbl8 of a /8 */
+	uint32_t	tbl8_used[BUILD_NB_RANGES];	/* tbl8s used by a /8 */
+};
+
+static inline uint32_t
+build_child(uint32_t ip, uint8_t pfx, uint8_t bits)
+{
+	return (ip >> (32 - pfx - bits)) & ((1 << bits) - 1);
+}
+
+/* Set the entries of the children [from, to) of a block */
+static void
+build_set(struct dir24_8_tbl *dp, uint64_t *ent, uint32_t ip,
+	uint32_t from, uint32_t to, uint64_t val)
+{
+	if (from >= to)
+		return;
+	if (ent == NULL)
+		write_to_fib(get_tbl24_p(dp, ip | (from << 8), dp->nh_sz),
+			val, dp->nh_sz, to - from);
+	else
+		for (; from < to; from++)
+			ent[from] = val;
+}
+
+static uint64_t
+build_tbl8(struct dir24_8_tbl *dp, struct dir24_8_build *b,
+	uint32_t *tbl8_idx, uint32_t ip, uint32_t lo, uint32_t hi,
+	uint64_t nh);
+
+/*
+ * Fill the 1 << bits children of a block with a prefix length of pfx
+ * from the routes [lo, hi) inside it in one ordered pass: into the tbl24
+ * for a /8, into ent for a /24. The routes covering several children
+ * are stacked over the next hop covering the whole block, the longer
+ * ones of a child are in its tbl8.
+ */
+static void
+build_block(struct dir24_8_tbl *dp, struct dir24_8_build *b,
+	uint32_t *tbl8_idx, uint64_t *ent, uint32_t ip, uint8_t pfx,
+	uint8_t bits, uint32_t lo, uint32_t hi, uint64_t nh)
+{
+	const struct rte_fib_route *rt;
+	uint32_t end[BUILD_MAX_COVERS];
+	uint64_t val[BUILD_MAX_COVERS];
+	uint32_t i, j, c = 0, child;
+	int top = 0;
+
+	end[0] = 1 << bits;
+	val[0] = nh << 1;
+	for (i = lo; i < hi; ) {
+		rt = &b->routes[i];
+		/* the routes up to /8 are in the next hop covering a /8 */
+		if (rt->depth <= pfx) {
+			i++;
+			continue;
+		}
+		child = build_child(rt->ip, pfx, bits);
+		while (end[top] <= child) {
+			build_set(dp, ent, ip, c, end[top], val[top]);
+			c = end[top--];
+		}
+		build_set(dp, ent, ip, c, child, val[top]);
+		c = child;
+		if (rt->depth <= pfx + bits) {
+			top++;
+			end[top] = child + (1 << (pfx + bits - rt->depth));
+			val[top] = rt->next_hop << 1;
+			i++;
+			continue;
+		}
+		for (j = i + 1; (j < hi) &&
+				(build_child(b->routes[j].ip, pfx, bits) ==
+				child); j++)
+			;
+		build_set(dp, ent, ip, child, child + 1,
+			build_tbl8(dp, b, tbl8_idx,
+			rt->ip & DIR24_8_TBL24_MASK, i, j, val[top] >> 1));
+		c = child + 1;
+		i = j;
+	}
+	for (; top >= 0; top--) {
+		build_set(dp, ent, ip, c, end[top], val[top]);
+		c = end[top];
+	}
+}
+
+/* Fill a /24 with longer routes, return its tbl24 entry */
+static uint64_t
+build_tbl8(struct dir24_8_tbl *dp, struct dir24_8_build *b,
+	uint32_t *tbl8_idx, uint32_t ip, uint32_t lo, uint32_t hi,
+	uint64_t nh)
+{
+	uint64_t ent[DIR24_8_TBL8_GRP_NUM_ENT];
+	uint8_t *tbl8_ptr;
+	uint32_t i, idx;
+
+	build_block(dp, b, tbl8_idx, ent, ip, 24, 8, lo, hi, nh);
+	for (i = 1; (i < DIR24_8_TBL8_GRP_NUM_ENT) && (ent[i] == ent[0]); i++)
+		;
+	if (i == DIR24_8_TBL8_GRP_NUM_ENT)
+		return ent[0];
+
+	idx = (*tbl8_idx)++;
+	tbl8_ptr = (uint8_t *)dp->tbl8 +
+		((idx * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+	for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
+		write_to_fib(tbl8_ptr + (i << dp->nh_sz),
+			ent[i] | DIR24_8_EXT_ENT, dp->nh_sz, 1);
+	/* tbl8 entries must be visible before the tbl24 entry linking it */
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
+	return ((uint64_t)idx << 1) | DIR24_8_EXT_ENT;
+}
+
+int
+dir24_8_build_start(struct dir24_8_tbl *dp,
+	const struct rte_fib_route *routes, uint32_t n)
+{
+	struct dir24_8_build *b;
+	uint64_t prev_tbl24 = UINT64_MAX;
+	uint32_t i, r, nb;
+
+	/* deleted tbl8s may still be waiting for the readers */
+	while (fib_rcu_reclaim(&dp->rcu) == 0)
+		;
+	if (dp->cur_tbl8s != 0)
+		return -EBUSY;
+
+	b = rte_zmalloc(NULL, sizeof(*b), 0);
+	if (b == NULL)
+		return -ENOMEM;
+
+	for (r = 0; r < BUILD_NB_RANGES; r++)
+		b->cover_nh[r] = dp->def_nh;
+	for (i = 0; i < n; i++) {
+		if (routes[i].next_hop > get_max_nh(dp->nh_sz)) {
+			rte_free(b);
+			return -EINVAL;
+		}
+		r = routes[i].ip >> 24;
+		b->first[r + 1]++;
+		/* a covering route is sorted before the covered ones */
+		if (routes[i].depth <= 8)
+			for (nb = 0; nb < 1U << (8 - routes[i].depth); nb++)
+				b->cover_nh[r + nb] = routes[i].next_hop;
+		/* each /24 with longer routes may need a tbl8 */
+		if ((routes[i].depth > 24) &&
+				(prev_tbl24 != get_tbl24_idx(routes[i].ip))) {
+			prev_tbl24 = get_tbl24_idx(routes[i].ip);
+			b->tbl8_base[r + 1]++;
+		}
+	}
+	for (r = 0; r < BUILD_NB_RANGES; r++) {
+		b->first[r + 1] += b->first[r];
+		b->tbl8_base[r + 1] += b->tbl8_base[r];
+	}
+	if (b->tbl8_base[BUILD_NB_RANGES] > dp->number_tbl8s) {
+		rte_free(b);
+		return -ENOSPC;
+	}
+
+	b->routes = routes;
+	dp->build = b;
+	return 0;
+}
+
+void
+dir24_8_build_range(struct dir24_8_tbl *dp, uint8_t first, uint8_t last)
+{
+	struct dir24_8_build *b = dp->build;
+	uint32_t r, tbl8_idx;
+
+	/* each /8 has its own range of tbl8s */
+	for (r = first; r <= last; r++) {
+		tbl8_idx = b->tbl8_base[r];
+		build_block(dp, b, &tbl8_idx, NULL, r << 24, 8, 16,
+			b->first[r], b->first[r + 1], b->cover_nh[r]);
+		b->tbl8_used[r] = tbl8_idx - b->tbl8_base[r];
+	}
+}
+
+void
+dir24_8_build_finish(struct dir24_8_tbl *dp)
+{
+	struct dir24_8_build *b = dp->build;
+	uint32_t i, r;
+
+	for (r = 0; r < BUILD_NB_RANGES; r++) {
+		for (i = b->tbl8_base[r]; i < b->tbl8_base[r] +
+				b->tbl8_used[r]; i++)
+			dp->tbl8_idxes[i >> BITMAP_SLAB_BIT_SIZE_LOG2] |=
+				1ULL << (i & BITMAP_SLAB_BITMASK);
+		dp->cur_tbl8s += b->tbl8_used[r];
+	}
+	dp->rsvd_tbl8s = b->tbl8_base[BUILD_NB_RANGES];
+
+	rte_free(b);
+	dp->build = NULL;
+}
+
+/* Dataplane part of a file written by rte_fib_save() */
+struct dir24_8_file_hdr {
+	uint32_t	nb_tbl8s;	/* number of tbl8s in the file */
+	uint32_t	rsvd_tbl8s;
+	uint32_t	cur_tbl8s;
+};
+
+int
+dir24_8_save(struct dir24_8_tbl *dp, FILE *f)
+{
+	struct dir24_8_file_hdr hdr;
+	size_t sz;
+	int i;
+
+	/* deleted tbl8s may still be waiting for the readers */
+	while (fib_rcu_reclaim(&dp->rcu) == 0)
+		;
+
+	/* the tbl8s are saved up to the last one in use */
+	for (i = (RTE_ALIGN_CEIL(dp->number_tbl8s, BITMAP_SLAB_BIT_SIZE) >>
+			BITMAP_SLAB_BIT_SIZE_LOG2) - 1;
+			(i >= 0) && (dp->tbl8_idxes[i] == 0); i--)
+		;
+	memset(&hdr, 0, sizeof(hdr));
+	if (i >= 0)
+		hdr.nb_tbl8s = (i << BITMAP_SLAB_BIT_SIZE_LOG2) +
+			BITMAP_SLAB_BIT_SIZE -
+			__builtin_clzll(dp->tbl8_idxes[i]);
+	hdr.rsvd_tbl8s = dp->rsvd_tbl8s;
+	hdr.cur_tbl8s = dp->cur_tbl8s;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EIO;
+	sz = (size_t)DIR24_8_TBL24_NUM_ENT << dp->nh_sz;
+	if (fwrite(dp->tbl24, 1, sz, f) != sz)
+		return -EIO;
+	sz = ((size_t)hdr.nb_tbl8s * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz;
+	if (fwrite(dp->tbl8, 1, sz, f) != sz)
+		return -EIO;
+	sz = RTE_ALIGN_CEIL(dp->number_tbl8s, BITMAP_SLAB_BIT_SIZE) >> 3;
+	if (fwrite(dp->tbl8_idxes, 1, sz, f) != sz)
+		return -EIO;
+	return 0;
+}
+
+int
+dir24_8_load(struct dir24_8_tbl *dp, FILE *f)
+{
+	struct dir24_8_file_hdr hdr;
+	size_t sz;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EINVAL;
+	if ((hdr.nb_tbl8s > dp->number_tbl8s) ||
+			(hdr.cur_tbl8s > hdr.nb_tbl8s) ||
+			(hdr.rsvd_tbl8s > dp->number_tbl8s))
+		return -EINVAL;
+
+	/* the tables are not visible to the readers yet */
+	sz = (size_t)DIR24_8_TBL24_NUM_ENT << dp->nh_sz;
+	if (fread(dp->tbl24, 1, sz, f) != sz)
+		return -EINVAL;
+	sz = ((size_t)hdr.nb_tbl8s * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz;
+	if (fread(dp->tbl8, 1, sz, f) != sz)
+		return -EINVAL;
+	sz = RTE_ALIGN_CEIL(dp->number_tbl8s, BITMAP_SLAB_BIT_SIZE) >> 3;
+	if (fread(dp->tbl8_idxes, 1, sz, f) != sz)
+		return -EINVAL;
+	dp->rsvd_tbl8s = hdr.rsvd_tbl8s;
+	dp->cur_tbl8s = hdr.cur_tbl8s;
+	return 0;
+}
@@ -6,8 +6,13 @@
 #ifndef _DIR24_8_H_
 #define _DIR24_8_H_
 
+#include <stdio.h>
+
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_rcu_qsbr.h>
+
+#include "fib_rcu.h"
 
 /**
  * @file
@@ -31,6 +36,8 @@ struct dir24_8_tbl {
 	uint64_t	def_nh;		/**< Default next hop */
 	uint64_t	*tbl8;		/**< tbl8 table. */
 	uint64_t	*tbl8_idxes;	/**< bitmap containing free tbl8 idxes*/
+	struct fib_rcu	rcu;		/* RCU QSBR reclamation */
+	struct dir24_8_build	*build;	/* bulk build in progress */
 	/* tbl24 table. */
 	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
 };
@@ -248,4 +255,30 @@ int
 dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	uint64_t next_hop, int op);
 
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name);
+
+void
+dir24_8_bulk_begin(struct dir24_8_tbl *dp);
+
+void
+dir24_8_bulk_end(struct dir24_8_tbl *dp);
+
+int
+dir24_8_build_start(struct dir24_8_tbl *dp,
+	const struct rte_fib_route *routes, uint32_t n);
+
+void
+dir24_8_build_range(struct dir24_8_tbl *dp, uint8_t first, uint8_t last);
+
+void
+dir24_8_build_finish(struct dir24_8_tbl *dp);
+
+int
+dir24_8_save(struct dir24_8_tbl *dp, FILE *f);
+
+int
+dir24_8_load(struct dir24_8_tbl *dp, FILE *f);
+
 #endif /* _DIR24_8_H_ */
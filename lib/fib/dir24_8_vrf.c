@@ -0,0 +1,766 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_debug.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+
+#include <rte_rib.h>
+#include <rte_rib6.h>
+#include <rte_fib.h>
+#include <rte_fib_vrf.h>
+#include "dir24_8_vrf.h"
+
+#define DIR24_8_VRF_NAMESIZE	64
+
+/*
+ * The routes are kept in an IPv6 RIB shared by all the VRFs: the key of
+ * a route is the VRF id followed by the IPv4 prefix.
+ */
+#define VRF_KEY_DEPTH		16
+
+static void
+vrf_key(uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE], uint16_t vrf_id, uint32_t ip)
+{
+	memset(key, 0, RTE_RIB6_IPV6_ADDR_SIZE);
+	key[0] = vrf_id >> 8;
+	key[1] = vrf_id;
+	key[2] = ip >> 24;
+	key[3] = ip >> 16;
+	key[4] = ip >> 8;
+	key[5] = ip;
+}
+
+static uint32_t
+vrf_key_ip(const uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	return ((uint32_t)key[2] << 24) | ((uint32_t)key[3] << 16) |
+		((uint32_t)key[4] << 8) | key[5];
+}
+
+rte_fib_vrf_lookup_fn_t
+dir24_8_vrf_get_lookup_fn(void *p)
+{
+	struct dir24_8_vrf_tbl *dp = p;
+
+	if (dp == NULL)
+		return NULL;
+
+	switch (dp->nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_vrf_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_vrf_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_vrf_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_vrf_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static void
+write_to_fib(void *ptr, uint64_t val, enum rte_fib_dir24_8_nh_sz size, int n)
+{
+	int i;
+	uint8_t *ptr8 = (uint8_t *)ptr;
+	uint16_t *ptr16 = (uint16_t *)ptr;
+	uint32_t *ptr32 = (uint32_t *)ptr;
+	uint64_t *ptr64 = (uint64_t *)ptr;
+
+	switch (size) {
+	case RTE_FIB_DIR24_8_1B:
+		for (i = 0; i < n; i++)
+			ptr8[i] = (uint8_t)val;
+		break;
+	case RTE_FIB_DIR24_8_2B:
+		for (i = 0; i < n; i++)
+			ptr16[i] = (uint16_t)val;
+		break;
+	case RTE_FIB_DIR24_8_4B:
+		for (i = 0; i < n; i++)
+			ptr32[i] = (uint32_t)val;
+		break;
+	case RTE_FIB_DIR24_8_8B:
+		for (i = 0; i < n; i++)
+			ptr64[i] = (uint64_t)val;
+		break;
+	}
+}
+
+static inline uint64_t
+get_val(const void *p, enum rte_fib_dir24_8_nh_sz size)
+{
+	switch (size) {
+	case RTE_FIB_DIR24_8_1B:
+		return *(const uint8_t *)p;
+	case RTE_FIB_DIR24_8_2B:
+		return *(const uint16_t *)p;
+	case RTE_FIB_DIR24_8_4B:
+		return *(const uint32_t *)p;
+	case RTE_FIB_DIR24_8_8B:
+		return *(const uint64_t *)p;
+	}
+	return 0;
+}
+
+static inline void *
+get_tbl_p(void *tbl, uint64_t idx, uint8_t nh_sz)
+{
+	return (uint8_t *)tbl + (idx << nh_sz);
+}
+
+static inline void *
+get_tbl8_p(struct dir24_8_vrf_tbl *dp, uint64_t tbl8_idx)
+{
+	return get_tbl_p(dp->tbl8, tbl8_idx * VRF_GRP_NUM_ENT, dp->nh_sz);
+}
+
+static void
+tbl8_pool_init(struct dir24_8_vrf_tbl *dp)
+{
+	uint32_t i;
+
+	/* put entire range of indexes to the tbl8 pool */
+	for (i = 0; i < dp->number_tbl8s; i++)
+		dp->tbl8_pool[i] = i;
+
+	dp->tbl8_pool_pos = 0;
+}
+
+/*
+ * Get an index of a free tbl8 from the pool
+ */
+static inline int32_t
+tbl8_get(struct dir24_8_vrf_tbl *dp)
+{
+	if (dp->tbl8_pool_pos == dp->number_tbl8s)
+		/* no more free tbl8 */
+		return -ENOSPC;
+
+	/* next index */
+	return dp->tbl8_pool[dp->tbl8_pool_pos++];
+}
+
+/*
+ * Put an index of a free tbl8 back to the pool
+ */
+static inline void
+tbl8_put(struct dir24_8_vrf_tbl *dp, uint32_t tbl8_idx)
+{
+	dp->tbl8_pool[--dp->tbl8_pool_pos] = tbl8_idx;
+}
+
+static int
+tbl8_alloc(struct dir24_8_vrf_tbl *dp, uint64_t val)
+{
+	int32_t tbl8_idx;
+
+	tbl8_idx = tbl8_get(dp);
+	if (tbl8_idx == -ENOSPC && fib_rcu_reclaim(&dp->rcu) == 0)
+		tbl8_idx = tbl8_get(dp);
+	if (tbl8_idx < 0)
+		return tbl8_idx;
+	/* Init tbl8 entries with the value of the parent entry */
+	write_to_fib(get_tbl8_p(dp, tbl8_idx), val, dp->nh_sz,
+		VRF_GRP_NUM_ENT);
+	/* tbl8 entries must be visible before the entry linking it */
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
+	return tbl8_idx;
+}
+
+/*
+ * Free a tbl8 no reader can use any more, along with the tbl8s of
+ * the next levels.
+ */
+static void
+tbl8_cleanup_and_free(void *p, uint64_t tbl8_idx)
+{
+	struct dir24_8_vrf_tbl *dp = p;
+	uint8_t *ptr = get_tbl8_p(dp, tbl8_idx);
+	uint64_t val;
+	uint32_t i;
+
+	for (i = 0; i < VRF_GRP_NUM_ENT; i++) {
+		val = get_val(get_tbl_p(ptr, i, dp->nh_sz), dp->nh_sz);
+		if (val & VRF_EXT_ENT)
+			tbl8_cleanup_and_free(dp, val >> 1);
+	}
+	memset(ptr, 0, VRF_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_put(dp, tbl8_idx);
+}
+
+/*
+ * The tbl8 has been unlinked from its parent, it is freed along with
+ * the tbl8s of the next levels once no reader can still be using them.
+ */
+static void
+tbl8_free(struct dir24_8_vrf_tbl *dp, uint64_t tbl8_idx)
+{
+	if (fib_rcu_defer(&dp->rcu, tbl8_idx) != 0)
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+}
+
+/*
+ * Replace the tbl8 by the value of its entries in the parent entry
+ * if they are all the same.
+ */
+static void
+tbl8_recycle(struct dir24_8_vrf_tbl *dp, void *par, uint64_t tbl8_idx)
+{
+	uint8_t *ptr = get_tbl8_p(dp, tbl8_idx);
+	uint64_t val;
+	uint32_t i;
+
+	val = get_val(ptr, dp->nh_sz);
+	if (val & VRF_EXT_ENT)
+		return;
+	for (i = 1; i < VRF_GRP_NUM_ENT; i++) {
+		if (get_val(get_tbl_p(ptr, i, dp->nh_sz), dp->nh_sz) != val)
+			return;
+	}
+	write_to_fib(par, val, dp->nh_sz, 1);
+	tbl8_free(dp, tbl8_idx);
+}
+
+static int write_range(struct dir24_8_vrf_tbl *dp, void *tbl, uint64_t base,
+	uint32_t shift, uint64_t ledge, uint64_t redge, uint64_t val);
+
+/*
+ * Write val to the part [ledge, redge) of the addresses covered by
+ * the entry idx of the table tbl.
+ */
+static int
+write_entry_part(struct dir24_8_vrf_tbl *dp, void *tbl, uint64_t idx,
+	uint64_t base, uint32_t shift, uint64_t ledge, uint64_t redge,
+	uint64_t val)
+{
+	uint64_t ent, ent_ledge;
+	int32_t tbl8_idx;
+	void *p;
+	int ret;
+
+	p = get_tbl_p(tbl, idx, dp->nh_sz);
+	ent = get_val(p, dp->nh_sz);
+	ent_ledge = base + (idx << shift);
+	if ((ent & VRF_EXT_ENT) == 0) {
+		tbl8_idx = tbl8_alloc(dp, ent);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		ent = ((uint64_t)tbl8_idx << 1) | VRF_EXT_ENT;
+		write_to_fib(p, ent, dp->nh_sz, 1);
+	}
+	ret = write_range(dp, get_tbl8_p(dp, ent >> 1), ent_ledge, shift - 8,
+		RTE_MAX(ledge, ent_ledge),
+		RTE_MIN(redge, ent_ledge + (1ULL << shift)), val);
+	if (ret != 0)
+		return ret;
+	tbl8_recycle(dp, p, ent >> 1);
+	return 0;
+}
+
+/*
+ * Write val to the addresses [ledge, redge) of the table tbl, whose
+ * entries cover 2^shift addresses each from base.
+ */
+static int
+write_range(struct dir24_8_vrf_tbl *dp, void *tbl, uint64_t base,
+	uint32_t shift, uint64_t ledge, uint64_t redge, uint64_t val)
+{
+	uint64_t first, last, full_first, full_end, i, ent;
+	void *p;
+	int ret;
+
+	first = (ledge - base) >> shift;
+	last = (redge - 1 - base) >> shift;
+	/* entries fully covered, only the first and last can be partly */
+	full_first = (ledge - base + (1ULL << shift) - 1) >> shift;
+	full_end = (redge - base) >> shift;
+
+	if (first < full_first) {
+		ret = write_entry_part(dp, tbl, first, base, shift, ledge,
+			redge, val);
+		if ((ret != 0) || (first == last))
+			return ret;
+	}
+	if (full_first < full_end) {
+		p = get_tbl_p(tbl, full_first, dp->nh_sz);
+		/* unlink the tbl8s of the next levels before freeing them */
+		for (i = 0; i < full_end - full_first; i++) {
+			ent = get_val(get_tbl_p(p, i, dp->nh_sz), dp->nh_sz);
+			if (ent & VRF_EXT_ENT) {
+				write_to_fib(get_tbl_p(p, i, dp->nh_sz), val,
+					dp->nh_sz, 1);
+				tbl8_free(dp, ent >> 1);
+			}
+		}
+		write_to_fib(p, val, dp->nh_sz, full_end - full_first);
+	}
+	if (last >= full_end)
+		return write_entry_part(dp, tbl, last, base, shift, ledge,
+			redge, val);
+
+	return 0;
+}
+
+static uint32_t count_range(struct dir24_8_vrf_tbl *dp, void *tbl,
+	uint64_t base, uint32_t shift, uint64_t ledge, uint64_t redge);
+
+/*
+ * Count the tbl8s that writing to the part [ledge, redge) of the addresses
+ * covered by the entry idx of the table tbl may allocate. A NULL tbl is a
+ * table not allocated yet, whose entries are all next hops.
+ */
+static uint32_t
+count_entry_part(struct dir24_8_vrf_tbl *dp, void *tbl, uint64_t idx,
+	uint64_t base, uint32_t shift, uint64_t ledge, uint64_t redge)
+{
+	uint64_t ent, ent_ledge, l, r;
+
+	ent = (tbl != NULL) ? get_val(get_tbl_p(tbl, idx, dp->nh_sz),
+		dp->nh_sz) : 0;
+	ent_ledge = base + (idx << shift);
+	l = RTE_MAX(ledge, ent_ledge);
+	r = RTE_MIN(redge, ent_ledge + (1ULL << shift));
+	if (ent & VRF_EXT_ENT)
+		return count_range(dp, get_tbl8_p(dp, ent >> 1), ent_ledge,
+			shift - 8, l, r);
+
+	return 1 + count_range(dp, NULL, ent_ledge, shift - 8, l, r);
+}
+
+/*
+ * Count the tbl8s that write_range() may allocate. Only the entries at the
+ * edges of the range are split, and the tbl8s freed meanwhile are not
+ * deduced, so the count is an upper bound.
+ */
+static uint32_t
+count_range(struct dir24_8_vrf_tbl *dp, void *tbl, uint64_t base,
+	uint32_t shift, uint64_t ledge, uint64_t redge)
+{
+	uint64_t first, last, full_first, full_end;
+	uint32_t n = 0;
+
+	first = (ledge - base) >> shift;
+	last = (redge - 1 - base) >> shift;
+	full_first = (ledge - base + (1ULL << shift) - 1) >> shift;
+	full_end = (redge - base) >> shift;
+
+	if (first < full_first) {
+		n += count_entry_part(dp, tbl, first, base, shift, ledge,
+			redge);
+		if (first == last)
+			return n;
+	}
+	if (last >= full_end)
+		n += count_entry_part(dp, tbl, last, base, shift, ledge,
+			redge);
+
+	return n;
+}
+
+/*
+ * Write the next hop to the addresses [ledge, redge), or only add to need
+ * the number of tbl8s it may allocate if need is not NULL.
+ */
+static int
+install_to_fib(struct dir24_8_vrf_tbl *dp, uint64_t root, uint64_t ledge,
+	uint64_t redge, uint64_t next_hop, uint32_t *need)
+{
+	if (need != NULL) {
+		*need += count_range(dp, vrf_root_p(root), 0,
+			vrf_root_shift(root), ledge, redge);
+		return 0;
+	}
+
+	return write_range(dp, vrf_root_p(root), 0, vrf_root_shift(root),
+		ledge, redge, next_hop << 1);
+}
+
+/*
+ * Write the next hop to the addresses of the prefix which are not
+ * covered by a more specific route.
+ */
+static int
+modify_fib(struct dir24_8_vrf_tbl *dp, struct rte_rib6 *rib, uint64_t root,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth, uint64_t next_hop,
+	uint32_t *need)
+{
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t tmp_key[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib6_node *tmp = NULL;
+	uint64_t ledge, redge;
+	uint8_t tmp_depth;
+	int ret;
+
+	vrf_key(key, vrf_id, ip);
+	ledge = ip;
+	do {
+		tmp = rte_rib6_get_nxt(rib, key, VRF_KEY_DEPTH + depth, tmp,
+			RTE_RIB6_GET_NXT_COVER);
+		if (tmp != NULL) {
+			rte_rib6_get_depth(tmp, &tmp_depth);
+			if (tmp_depth == VRF_KEY_DEPTH + depth)
+				continue;
+			rte_rib6_get_ip(tmp, tmp_key);
+			redge = vrf_key_ip(tmp_key);
+			if (ledge != redge) {
+				ret = install_to_fib(dp, root, ledge, redge,
+					next_hop, need);
+				if (ret != 0)
+					return ret;
+			}
+			ledge = redge +
+				(1ULL << (32 - (tmp_depth - VRF_KEY_DEPTH)));
+		} else {
+			redge = ip + (1ULL << (32 - depth));
+			if (ledge == redge)
+				break;
+			ret = install_to_fib(dp, root, ledge, redge,
+				next_hop, need);
+			if (ret != 0)
+				return ret;
+		}
+	} while (tmp);
+
+	return 0;
+}
+
+static inline uint32_t
+vrf_free_tbl8s(const struct dir24_8_vrf_tbl *dp)
+{
+	return dp->number_tbl8s - dp->tbl8_pool_pos;
+}
+
+/*
+ * Check that enough tbl8s are free to write the next hop of a route,
+ * so that the FIB is never left partly modified.
+ */
+static int
+check_tbl8s(struct dir24_8_vrf_tbl *dp, struct rte_rib6 *rib, uint64_t root,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth)
+{
+	uint32_t need = 0;
+
+	modify_fib(dp, rib, root, vrf_id, ip, depth, 0, &need);
+	/* deleted tbl8s may still be waiting for the readers */
+	while (vrf_free_tbl8s(dp) < need && fib_rcu_reclaim(&dp->rcu) == 0)
+		;
+	return (vrf_free_tbl8s(dp) < need) ? -ENOSPC : 0;
+}
+
+/*
+ * Give a tbl24 to a VRF with many routes: build it from the routes of
+ * the VRF, each one covering the addresses it is the best match for,
+ * then switch the VRF to it and free the tbl8s of the small root.
+ * The small root is only reset once the readers are done with it, which
+ * costs a grace period to the writer once per promoted VRF.
+ */
+static void
+vrf_promote(struct dir24_8_vrf_tbl *dp, struct rte_rib6 *rib,
+	uint16_t vrf_id)
+{
+	char mem_name[DIR24_8_VRF_NAMESIZE];
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t node_key[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t *old_root;
+	struct rte_rib6_node *node = NULL;
+	uint64_t root, old, nh, val;
+	uint8_t depth;
+	void *tbl24;
+	uint32_t i;
+	int ret = 0;
+
+	snprintf(mem_name, sizeof(mem_name), "TBL24_%p_%u", dp, vrf_id);
+	tbl24 = rte_malloc_socket(mem_name, VRF_TBL24_NUM_ENT << dp->nh_sz,
+		RTE_CACHE_LINE_SIZE, dp->socket_id);
+	if (tbl24 == NULL) {
+		dp->promote_min_free[vrf_id] = vrf_free_tbl8s(dp) + 1;
+		return;
+	}
+	write_to_fib(tbl24, dp->def_nh << 1, dp->nh_sz, VRF_TBL24_NUM_ENT);
+	root = (uintptr_t)tbl24 | VRF_ROOT_TBL24;
+
+	vrf_key(key, vrf_id, 0);
+	node = rte_rib6_lookup_exact(rib, key, VRF_KEY_DEPTH);
+	if (node != NULL) {
+		rte_rib6_get_nh(node, &nh);
+		ret = modify_fib(dp, rib, root, vrf_id, 0, 0, nh, NULL);
+	}
+	node = NULL;
+	while ((ret == 0) && ((node = rte_rib6_get_nxt(rib, key,
+			VRF_KEY_DEPTH, node, RTE_RIB6_GET_NXT_ALL)) != NULL)) {
+		rte_rib6_get_depth(node, &depth);
+		if (depth == VRF_KEY_DEPTH)
+			continue;
+		rte_rib6_get_ip(node, node_key);
+		rte_rib6_get_nh(node, &nh);
+		ret = modify_fib(dp, rib, root, vrf_id, vrf_key_ip(node_key),
+			depth - VRF_KEY_DEPTH, nh, NULL);
+	}
+	if (ret != 0) {
+		/* not enough tbl8s, keep the small root until more are free */
+		for (i = 0; i < VRF_TBL24_NUM_ENT; i++) {
+			val = get_val(get_tbl_p(tbl24, i, dp->nh_sz),
+				dp->nh_sz);
+			if (val & VRF_EXT_ENT)
+				tbl8_cleanup_and_free(dp, val >> 1);
+		}
+		rte_free(tbl24);
+		dp->promote_min_free[vrf_id] = vrf_free_tbl8s(dp) + 1;
+		return;
+	}
+
+	old = dp->vrfs[vrf_id];
+	__atomic_store_n(&dp->vrfs[vrf_id], root, __ATOMIC_RELEASE);
+	dp->nb_large++;
+
+	if (dp->rcu.v != NULL)
+		rte_rcu_qsbr_synchronize(dp->rcu.v, RTE_QSBR_THRID_INVALID);
+	old_root = vrf_root_p(old);
+	for (i = 0; i < VRF_GRP_NUM_ENT; i++) {
+		val = get_val(get_tbl_p(old_root, i, dp->nh_sz), dp->nh_sz);
+		if (val & VRF_EXT_ENT) {
+			write_to_fib(get_tbl_p(old_root, i, dp->nh_sz),
+				dp->def_nh << 1, dp->nh_sz, 1);
+			tbl8_cleanup_and_free(dp, val >> 1);
+		}
+	}
+}
+
+int
+dir24_8_vrf_modify(struct dir24_8_vrf_tbl *dp, struct rte_rib6 *rib,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth, uint64_t next_hop,
+	int op)
+{
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib6_node *node;
+	struct rte_rib6_node *parent;
+	uint64_t root, par_nh, node_nh;
+	int ret = 0;
+
+	if ((dp == NULL) || (rib == NULL) || (vrf_id >= dp->max_vrfs) ||
+			(depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+
+	if (next_hop > vrf_get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+	vrf_key(key, vrf_id, ip);
+	root = dp->vrfs[vrf_id];
+
+	node = rte_rib6_lookup_exact(rib, key, VRF_KEY_DEPTH + depth);
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib6_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = check_tbl8s(dp, rib, root, vrf_id, ip, depth);
+			if (ret == 0)
+				ret = modify_fib(dp, rib, root, vrf_id, ip,
+					depth, next_hop, NULL);
+			if (ret == 0)
+				rte_rib6_set_nh(node, next_hop);
+			return ret;
+		}
+
+		node = rte_rib6_insert(rib, key, VRF_KEY_DEPTH + depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib6_set_nh(node, next_hop);
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib6_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != next_hop) {
+			ret = check_tbl8s(dp, rib, root, vrf_id, ip, depth);
+			if (ret == 0)
+				ret = modify_fib(dp, rib, root, vrf_id, ip,
+					depth, next_hop, NULL);
+			if (ret != 0) {
+				rte_rib6_remove(rib, key,
+					VRF_KEY_DEPTH + depth);
+				return ret;
+			}
+		}
+		dp->nb_routes[vrf_id]++;
+		if (((root & VRF_ROOT_TBL24) == 0) &&
+				(dp->large_routes != 0) &&
+				(dp->nb_routes[vrf_id] >= dp->large_routes) &&
+				(dp->nb_large < dp->max_large) &&
+				(vrf_free_tbl8s(dp) >=
+				dp->promote_min_free[vrf_id]))
+			vrf_promote(dp, rib, vrf_id);
+		return 0;
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib6_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		rte_rib6_get_nh(node, &node_nh);
+		if (par_nh != node_nh) {
+			ret = check_tbl8s(dp, rib, root, vrf_id, ip, depth);
+			if (ret == 0)
+				ret = modify_fib(dp, rib, root, vrf_id, ip,
+					depth, par_nh, NULL);
+		}
+		if (ret == 0) {
+			rte_rib6_remove(rib, key, VRF_KEY_DEPTH + depth);
+			dp->nb_routes[vrf_id]--;
+		}
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+int
+dir24_8_vrf_rcu_qsbr_add(struct dir24_8_vrf_tbl *dp,
+	struct rte_fib_rcu_config *cfg, const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (cfg->mode == RTE_FIB_QSBR_MODE_SYNC)
+		return fib_rcu_qsbr_add(&dp->rcu, cfg->v, NULL,
+			dp->number_tbl8s, tbl8_cleanup_and_free, dp);
+	if (cfg->mode != RTE_FIB_QSBR_MODE_DQ)
+		return -EINVAL;
+
+	/* Init QSBR defer queue. */
+	snprintf(rcu_dq_name, sizeof(rcu_dq_name), "FIB_VRF_RCU_%s", name);
+	params.name = rcu_dq_name;
+	params.size = cfg->dq_size;
+	params.trigger_reclaim_limit = cfg->reclaim_thd;
+	params.max_reclaim_size = cfg->reclaim_max;
+	if (params.max_reclaim_size == 0)
+		params.max_reclaim_size = RTE_FIB_RCU_DQ_RECLAIM_MAX;
+	return fib_rcu_qsbr_add(&dp->rcu, cfg->v, &params, dp->number_tbl8s,
+		tbl8_cleanup_and_free, dp);
+}
+
+void
+dir24_8_vrf_get_stats(struct dir24_8_vrf_tbl *dp,
+	struct rte_fib_vrf_stats *stats)
+{
+	uint32_t i;
+
+	stats->nb_routes = 0;
+	for (i = 0; i < dp->max_vrfs; i++)
+		stats->nb_routes += dp->nb_routes[i];
+	stats->nb_large_vrfs = dp->nb_large;
+	stats->used_tbl8s = dp->tbl8_pool_pos;
+}
+
+void *
+dir24_8_vrf_create(const char *name, int socket_id,
+	const struct rte_fib_vrf_conf *conf)
+{
+	char mem_name[DIR24_8_VRF_NAMESIZE];
+	struct dir24_8_vrf_tbl *dp;
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	uint32_t i;
+
+	if ((name == NULL) || (conf == NULL) ||
+			(conf->nh_sz < RTE_FIB_DIR24_8_1B) ||
+			(conf->nh_sz > RTE_FIB_DIR24_8_8B) ||
+			(conf->num_tbl8 > vrf_get_max_nh(conf->nh_sz)) ||
+			(conf->num_tbl8 == 0) ||
+			(conf->default_nh > vrf_get_max_nh(conf->nh_sz)) ||
+			(conf->max_vrfs == 0) ||
+			(conf->max_vrfs > RTE_FIB_VRF_MAX_VRFS) ||
+			(conf->max_large_vrfs > conf->max_vrfs)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	nh_sz = conf->nh_sz;
+
+	snprintf(mem_name, sizeof(mem_name), "DP_%s", name);
+	dp = rte_zmalloc_socket(mem_name, sizeof(struct dir24_8_vrf_tbl) +
+		sizeof(uint64_t) * conf->max_vrfs, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	dp->max_vrfs = conf->max_vrfs;
+	dp->number_tbl8s = conf->num_tbl8;
+	dp->max_large = conf->max_large_vrfs;
+	dp->large_routes = conf->large_vrf_routes;
+	dp->nh_sz = nh_sz;
+	dp->socket_id = socket_id;
+	dp->def_nh = conf->default_nh;
+
+	snprintf(mem_name, sizeof(mem_name), "ROOTS_%p", dp);
+	dp->roots = rte_malloc_socket(mem_name, ((uint64_t)conf->max_vrfs *
+		VRF_GRP_NUM_ENT) << nh_sz, RTE_CACHE_LINE_SIZE, socket_id);
+	snprintf(mem_name, sizeof(mem_name), "TBL8_%p", dp);
+	dp->tbl8 = rte_zmalloc_socket(mem_name, ((uint64_t)conf->num_tbl8 *
+		VRF_GRP_NUM_ENT) << nh_sz, RTE_CACHE_LINE_SIZE, socket_id);
+	snprintf(mem_name, sizeof(mem_name), "TBL8_pool_%p", dp);
+	dp->tbl8_pool = rte_malloc_socket(mem_name,
+		sizeof(uint32_t) * conf->num_tbl8, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	snprintf(mem_name, sizeof(mem_name), "VRF_routes_%p", dp);
+	dp->nb_routes = rte_zmalloc_socket(mem_name,
+		sizeof(uint32_t) * conf->max_vrfs, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	snprintf(mem_name, sizeof(mem_name), "VRF_promote_%p", dp);
+	dp->promote_min_free = rte_zmalloc_socket(mem_name,
+		sizeof(uint32_t) * conf->max_vrfs, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if ((dp->roots == NULL) || (dp->tbl8 == NULL) ||
+			(dp->tbl8_pool == NULL) || (dp->nb_routes == NULL) ||
+			(dp->promote_min_free == NULL)) {
+		dir24_8_vrf_free(dp);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* Init the roots with default value */
+	write_to_fib(dp->roots, dp->def_nh << 1, nh_sz,
+		conf->max_vrfs * VRF_GRP_NUM_ENT);
+	for (i = 0; i < conf->max_vrfs; i++)
+		dp->vrfs[i] = (uintptr_t)get_tbl_p(dp->roots,
+			(uint64_t)i * VRF_GRP_NUM_ENT, nh_sz);
+	tbl8_pool_init(dp);
+
+	return dp;
+}
+
+void
+dir24_8_vrf_free(void *p)
+{
+	struct dir24_8_vrf_tbl *dp = (struct dir24_8_vrf_tbl *)p;
+	uint32_t i;
+
+	fib_rcu_free(&dp->rcu);
+	for (i = 0; i < dp->max_vrfs; i++) {
+		if (dp->vrfs[i] & VRF_ROOT_TBL24)
+			rte_free(vrf_root_p(dp->vrfs[i]));
+	}
+	rte_free(dp->promote_min_free);
+	rte_free(dp->nb_routes);
+	rte_free(dp->tbl8_pool);
+	rte_free(dp->tbl8);
+	rte_free(dp->roots);
+	rte_free(dp);
+}
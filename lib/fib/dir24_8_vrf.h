@@ -0,0 +1,150 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _DIR24_8_VRF_H_
+#define _DIR24_8_VRF_H_
+
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+
+#include "fib_rcu.h"
+
+/**
+ * @file
+ * Multi-VRF DIR24_8 algorithm
+ *
+ * Each VRF has a root table: a 256 entries tbl8 indexed by the first
+ * byte of the address for the small VRFs, or its own tbl24 for the large
+ * ones. Below the root, every level is a tbl8 group indexed by the next
+ * byte of the address, taken from a pool shared by all the VRFs.
+ * An entry holds either the next hop shifted by one bit, or the index of
+ * the tbl8 group of the next level shifted by one bit, with the lowest
+ * bit set.
+ */
+
+#define VRF_TBL24_NUM_ENT	(1 << 24)
+#define VRF_GRP_NUM_ENT		256U
+#define VRF_EXT_ENT		1
+/* Flag of the root descriptor of a VRF using a tbl24 */
+#define VRF_ROOT_TBL24		1
+
+struct dir24_8_vrf_tbl {
+	uint32_t	max_vrfs;	/**< Number of VRFs */
+	uint32_t	number_tbl8s;	/**< Total number of shared tbl8s */
+	uint32_t	tbl8_pool_pos;	/**< Number of tbl8s in use */
+	uint32_t	max_large;	/**< Maximum number of tbl24 VRFs */
+	uint32_t	nb_large;	/**< Current number of tbl24 VRFs */
+	uint32_t	large_routes;	/**< Routes of a VRF to get a tbl24 */
+	enum rte_fib_dir24_8_nh_sz	nh_sz;	/**< Size of nexthop entry */
+	int		socket_id;	/**< Socket of the tables */
+	uint64_t	def_nh;		/**< Default next hop */
+	uint32_t	*nb_routes;	/**< Number of routes of each VRF */
+	/** Free tbl8s needed to try again to give a tbl24 to each VRF */
+	uint32_t	*promote_min_free;
+	uint32_t	*tbl8_pool;	/**< Stack of the tbl8 indexes */
+	uint64_t	*tbl8;		/**< Shared tbl8 table */
+	uint64_t	*roots;		/**< Root tbl8s of the small VRFs */
+	struct fib_rcu	rcu;		/**< Deferred free of the tbl8s */
+	/* Root table of each VRF, flagged with VRF_ROOT_TBL24 */
+	__extension__ uint64_t	vrfs[0] __rte_cache_aligned;
+};
+
+static inline void *
+vrf_root_p(uint64_t root)
+{
+	return (void *)(uintptr_t)(root & ~(uint64_t)VRF_ROOT_TBL24);
+}
+
+/* Number of address bits below the root level */
+static inline uint32_t
+vrf_root_shift(uint64_t root)
+{
+	return (root & VRF_ROOT_TBL24) ? 8 : 24;
+}
+
+static inline uint64_t
+vrf_get_max_nh(uint8_t nh_sz)
+{
+	return ((1ULL << ((8 << nh_sz) - 1)) - 1);
+}
+
+/*
+ * The root entries of the next addresses are prefetched, and their
+ * pointers kept in a ring so that the VRF root is only read again
+ * when the address needs a tbl8.
+ */
+#define VRF_PREFETCH_RING	16
+
+#define VRF_LOOKUP_ENT(type, i) do {					\
+	tmp = *ent[(i) % VRF_PREFETCH_RING];				\
+	if (unlikely(tmp & VRF_EXT_ENT)) {				\
+		shift = vrf_root_shift(dp->vrfs[vrf_ids[i]]);		\
+		do {							\
+			shift -= 8;					\
+			tmp = ((type *)dp->tbl8)[(uint8_t)(ips[i] >>	\
+				shift) + ((tmp >> 1) * VRF_GRP_NUM_ENT)]; \
+		} while (unlikely(tmp & VRF_EXT_ENT));			\
+	}								\
+	next_hops[i] = tmp >> 1;					\
+} while (0)
+
+#define VRF_PREFETCH_ENT(type, i) do {					\
+	root = dp->vrfs[vrf_ids[i]];					\
+	ent[(i) % VRF_PREFETCH_RING] = (type *)vrf_root_p(root) +	\
+		(ips[i] >> vrf_root_shift(root));			\
+	rte_prefetch0(ent[(i) % VRF_PREFETCH_RING]);			\
+} while (0)
+
+#define VRF_LOOKUP_FUNC(suffix, type, bulk_prefetch)			\
+static inline void							\
+dir24_8_vrf_lookup_bulk_##suffix(void *p, const uint16_t *vrf_ids,	\
+	const uint32_t *ips, uint64_t *next_hops, const unsigned int n)	\
+{									\
+	struct dir24_8_vrf_tbl *dp = (struct dir24_8_vrf_tbl *)p;	\
+	const type *ent[VRF_PREFETCH_RING];				\
+	uint64_t root, tmp;						\
+	uint32_t i, shift;						\
+	uint32_t prefetch_offset =					\
+		RTE_MIN((unsigned int)bulk_prefetch, n);		\
+									\
+	RTE_BUILD_BUG_ON(bulk_prefetch >= VRF_PREFETCH_RING);		\
+	for (i = 0; i < prefetch_offset; i++)				\
+		VRF_PREFETCH_ENT(type, i);				\
+	for (i = 0; i < (n - prefetch_offset); i++) {			\
+		VRF_PREFETCH_ENT(type, i + prefetch_offset);		\
+		VRF_LOOKUP_ENT(type, i);				\
+	}								\
+	for (; i < n; i++)						\
+		VRF_LOOKUP_ENT(type, i);				\
+}									\
+
+VRF_LOOKUP_FUNC(1b, uint8_t, 5)
+VRF_LOOKUP_FUNC(2b, uint16_t, 6)
+VRF_LOOKUP_FUNC(4b, uint32_t, 15)
+VRF_LOOKUP_FUNC(8b, uint64_t, 12)
+
+void *
+dir24_8_vrf_create(const char *name, int socket_id,
+	const struct rte_fib_vrf_conf *conf);
+
+void
+dir24_8_vrf_free(void *p);
+
+rte_fib_vrf_lookup_fn_t
+dir24_8_vrf_get_lookup_fn(void *p);
+
+int
+dir24_8_vrf_modify(struct dir24_8_vrf_tbl *dp, struct rte_rib6 *rib,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth, uint64_t next_hop,
+	int op);
+
+int
+dir24_8_vrf_rcu_qsbr_add(struct dir24_8_vrf_tbl *dp,
+	struct rte_fib_rcu_config *cfg, const char *name);
+
+void
+dir24_8_vrf_get_stats(struct dir24_8_vrf_tbl *dp,
+	struct rte_fib_vrf_stats *stats);
+
+#endif /* _DIR24_8_VRF_H_ */
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
+
+#include "fib_rcu.h"
+
+static void
+__rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	struct fib_rcu *rcu = p;
+
+	RTE_SET_USED(n);
+	rcu->free_fn(rcu->dp, *(uint64_t *)data);
+}
+
+int
+fib_rcu_qsbr_add(struct fib_rcu *rcu, struct rte_rcu_qsbr *v,
+	struct rte_rcu_qsbr_dq_parameters *dq_params, uint32_t max_pending,
+	fib_rcu_free_t free_fn, void *dp)
+{
+	char mem_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (rcu->v != NULL)
+		return -EEXIST;
+
+	rcu->free_fn = free_fn;
+	rcu->dp = dp;
+	if (dq_params == NULL) {
+		/* resources freed by a bulk update wait for one grace period */
+		snprintf(mem_name, sizeof(mem_name), "FIB_pending_%p", dp);
+		rcu->pending = rte_zmalloc(mem_name,
+			sizeof(uint64_t) * max_pending, RTE_CACHE_LINE_SIZE);
+		if (rcu->pending == NULL)
+			return -ENOMEM;
+	} else {
+		if (dq_params->size == 0)
+			dq_params->size = max_pending;
+		dq_params->esize = sizeof(uint64_t);
+		dq_params->free_fn = __rcu_qsbr_free_resource;
+		dq_params->p = rcu;
+		dq_params->v = v;
+		rcu->dq = rte_rcu_qsbr_dq_create(dq_params);
+		if (rcu->dq == NULL)
+			return -rte_errno;
+	}
+	rcu->v = v;
+
+	return 0;
+}
+
+void
+fib_rcu_free(struct fib_rcu *rcu)
+{
+	if (rcu->dq != NULL)
+		rte_rcu_qsbr_dq_delete(rcu->dq);
+	rte_free(rcu->pending);
+}
+
+int
+fib_rcu_defer(struct fib_rcu *rcu, uint64_t res)
+{
+	if (rcu->v == NULL)
+		return -ENOENT;
+	if (rcu->in_bulk) {
+		/* one grace period for all the resources of the bulk update */
+		rcu->pending[rcu->nb_pending++] = res;
+		return 0;
+	}
+	if (rcu->dq != NULL && rte_rcu_qsbr_dq_enqueue(rcu->dq, &res) == 0)
+		return 0;
+
+	/* blocking mode, or the defer queue is full */
+	rte_rcu_qsbr_synchronize(rcu->v, RTE_QSBR_THRID_INVALID);
+	return -ENOSPC;
+}
+
+int
+fib_rcu_reclaim(struct fib_rcu *rcu)
+{
+	unsigned int freed = 0, pending = 0;
+	uint32_t i;
+
+	if (rcu->nb_pending != 0) {
+		rte_rcu_qsbr_synchronize(rcu->v, RTE_QSBR_THRID_INVALID);
+		for (i = 0; i < rcu->nb_pending; i++)
+			rcu->free_fn(rcu->dp, rcu->pending[i]);
+		rcu->nb_pending = 0;
+		return 0;
+	}
+	if (rcu->dq == NULL)
+		return -ENOSPC;
+	if (rte_rcu_qsbr_dq_reclaim(rcu->dq, 1, &freed, &pending, NULL) == 0 &&
+			freed != 0)
+		return 0;
+	if (pending != 0) {
+		/* wait for the readers rather than failing the update */
+		rte_rcu_qsbr_synchronize(rcu->v, RTE_QSBR_THRID_INVALID);
+		if (rte_rcu_qsbr_dq_reclaim(rcu->dq, 1, &freed, NULL,
+				NULL) == 0 && freed != 0)
+			return 0;
+	}
+
+	return -ENOSPC;
+}
+
+void
+fib_rcu_bulk_begin(struct fib_rcu *rcu)
+{
+	/* the defer queue does not block the writer */
+	if (rcu->pending != NULL)
+		rcu->in_bulk = 1;
+}
+
+void
+fib_rcu_bulk_end(struct fib_rcu *rcu)
+{
+	rcu->in_bulk = 0;
+	if (rcu->nb_pending != 0)
+		fib_rcu_reclaim(rcu);
+}
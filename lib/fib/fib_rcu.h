@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _FIB_RCU_H_
+#define _FIB_RCU_H_
+
+/**
+ * @file
+ * RCU QSBR reclamation of the tbl8 groups of the DIR24_8 and TRIE tables,
+ * and of the node and leaf blocks of the POPTRIE table
+ */
+
+#include <stdint.h>
+
+#include <rte_rcu_qsbr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Clean up and free a resource no reader can use any more: a tbl8 group
+ * index, or a block encoded by the table.
+ */
+typedef void (*fib_rcu_free_t)(void *dp, uint64_t res);
+
+struct fib_rcu {
+	struct rte_rcu_qsbr *v;		/* RCU QSBR variable. */
+	struct rte_rcu_qsbr_dq *dq;	/* RCU QSBR defer queue. */
+	/* resources freed during a bulk update in blocking mode */
+	uint64_t	*pending;
+	uint32_t	nb_pending;
+	uint32_t	in_bulk;
+	fib_rcu_free_t	free_fn;
+	void		*dp;		/* table passed to free_fn */
+};
+
+/*
+ * Attach a QSBR variable, with a defer queue described by dq_params or,
+ * if it is NULL, in blocking mode.
+ */
+int
+fib_rcu_qsbr_add(struct fib_rcu *rcu, struct rte_rcu_qsbr *v,
+	struct rte_rcu_qsbr_dq_parameters *dq_params, uint32_t max_pending,
+	fib_rcu_free_t free_fn, void *dp);
+
+void
+fib_rcu_free(struct fib_rcu *rcu);
+
+/*
+ * Defer the free of a resource unlinked from the table. Returns 0 if it
+ * is queued, otherwise no reader can use it and the caller frees it.
+ */
+int
+fib_rcu_defer(struct fib_rcu *rcu, uint64_t res);
+
+/* Free the resources which readers could still use, 0 if any was freed */
+int
+fib_rcu_reclaim(struct fib_rcu *rcu);
+
+void
+fib_rcu_bulk_begin(struct fib_rcu *rcu);
+
+void
+fib_rcu_bulk_end(struct fib_rcu *rcu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FIB_RCU_H_ */
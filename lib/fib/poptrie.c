@@ -0,0 +1,1182 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_debug.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_vect.h>
+
+#include <rte_rib6.h>
+#include <rte_fib6.h>
+#include "poptrie.h"
+
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+
+#include "poptrie_avx512.h"
+
+#endif /* CC_POPTRIE_AVX512_SUPPORT */
+
+#define POPTRIE_NAMESIZE	64
+
+/* Invalid block index, the pool is exhausted */
+#define POPTRIE_NIL		UINT32_MAX
+
+/* Minimum number of entries of an update log */
+#define POPTRIE_LOG_MIN		64
+
+/* Route added or removed by an update */
+struct poptrie_chg {
+	const uint8_t	*ip;
+	int		depth;
+};
+
+static inline uint8_t
+bits_in_nh(uint8_t nh_sz)
+{
+	return 8 * (1 << nh_sz);
+}
+
+static inline uint64_t
+get_max_nh(uint8_t nh_sz)
+{
+	return ((1ULL << (bits_in_nh(nh_sz) - 1)) - 1);
+}
+
+static inline rte_fib6_lookup_fn_t
+get_scalar_fn(enum rte_fib_trie_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return rte_poptrie_lookup_bulk_2b;
+	case RTE_FIB6_TRIE_4B:
+		return rte_poptrie_lookup_bulk_4b;
+	case RTE_FIB6_TRIE_8B:
+		return rte_poptrie_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static inline rte_fib6_lookup_fn_t
+get_vector_fn(enum rte_fib_trie_nh_sz nh_sz)
+{
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+	if ((rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) <= 0) ||
+			(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) <= 0) ||
+			(rte_vect_get_max_simd_bitwidth() < RTE_VECT_SIMD_512))
+		return NULL;
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return rte_poptrie_vec_lookup_bulk_2b;
+	case RTE_FIB6_TRIE_4B:
+		return rte_poptrie_vec_lookup_bulk_4b;
+	case RTE_FIB6_TRIE_8B:
+		return rte_poptrie_vec_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+#else
+	RTE_SET_USED(nh_sz);
+#endif
+	return NULL;
+}
+
+rte_fib6_lookup_fn_t
+poptrie_get_lookup_fn(void *p, enum rte_fib6_lookup_type type)
+{
+	enum rte_fib_trie_nh_sz nh_sz;
+	rte_fib6_lookup_fn_t ret_fn;
+	struct rte_poptrie_tbl *dp = p;
+
+	if (dp == NULL)
+		return NULL;
+
+	nh_sz = dp->nh_sz;
+
+	switch (type) {
+	case RTE_FIB6_LOOKUP_POPTRIE_SCALAR:
+		return get_scalar_fn(nh_sz);
+	case RTE_FIB6_LOOKUP_POPTRIE_VECTOR_AVX512:
+		return get_vector_fn(nh_sz);
+	case RTE_FIB6_LOOKUP_DEFAULT:
+		ret_fn = get_vector_fn(nh_sz);
+		return (ret_fn != NULL) ? ret_fn : get_scalar_fn(nh_sz);
+	default:
+		return NULL;
+	}
+	return NULL;
+}
+
+static inline uint64_t
+get_dir(struct rte_poptrie_tbl *dp, uint32_t idx)
+{
+	switch (dp->nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return ((uint16_t *)dp->dir)[idx];
+	case RTE_FIB6_TRIE_4B:
+		return ((uint32_t *)dp->dir)[idx];
+	default:
+		return ((uint64_t *)dp->dir)[idx];
+	}
+}
+
+/* The nodes an entry points to must be visible before the entry */
+static inline void
+set_dir(struct rte_poptrie_tbl *dp, uint32_t idx, uint64_t val)
+{
+	switch (dp->nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		__atomic_store_n(&((uint16_t *)dp->dir)[idx], (uint16_t)val,
+			__ATOMIC_RELEASE);
+		break;
+	case RTE_FIB6_TRIE_4B:
+		__atomic_store_n(&((uint32_t *)dp->dir)[idx], (uint32_t)val,
+			__ATOMIC_RELEASE);
+		break;
+	default:
+		__atomic_store_n(&((uint64_t *)dp->dir)[idx], val,
+			__ATOMIC_RELEASE);
+		break;
+	}
+}
+
+static inline uint64_t
+get_leaf(struct rte_poptrie_tbl *dp, uint32_t idx)
+{
+	switch (dp->nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return ((uint16_t *)dp->leaves)[idx];
+	case RTE_FIB6_TRIE_4B:
+		return ((uint32_t *)dp->leaves)[idx];
+	default:
+		return ((uint64_t *)dp->leaves)[idx];
+	}
+}
+
+static inline void
+set_leaf(struct rte_poptrie_tbl *dp, uint32_t idx, uint64_t val)
+{
+	switch (dp->nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		((uint16_t *)dp->leaves)[idx] = (uint16_t)val;
+		break;
+	case RTE_FIB6_TRIE_4B:
+		((uint32_t *)dp->leaves)[idx] = (uint32_t)val;
+		break;
+	default:
+		((uint64_t *)dp->leaves)[idx] = val;
+		break;
+	}
+}
+
+static void
+pool_init(struct poptrie_pool *pool, void *mem, uint32_t elt_sz, uint32_t size)
+{
+	int i;
+
+	pool->mem = mem;
+	pool->elt_sz = elt_sz;
+	/* a free block holds the index of the next one */
+	pool->unit = (elt_sz < sizeof(uint32_t)) ?
+		sizeof(uint32_t) / elt_sz : 1;
+	pool->size = size;
+	pool->pos = 0;
+	pool->used = 0;
+	for (i = 0; i <= POPTRIE_BLK_MAX; i++)
+		pool->free_head[i] = POPTRIE_NIL;
+}
+
+static inline uint32_t
+pool_blk_size(const struct poptrie_pool *pool, uint32_t n)
+{
+	return RTE_ALIGN_CEIL(n, pool->unit);
+}
+
+static inline void
+pool_push(struct poptrie_pool *pool, uint32_t idx, uint32_t n)
+{
+	memcpy(pool->mem + (size_t)idx * pool->elt_sz, &pool->free_head[n],
+		sizeof(uint32_t));
+	pool->free_head[n] = idx;
+}
+
+static inline uint32_t
+pool_pop(struct poptrie_pool *pool, uint32_t n)
+{
+	uint32_t idx = pool->free_head[n];
+
+	if (idx != POPTRIE_NIL)
+		memcpy(&pool->free_head[n],
+			pool->mem + (size_t)idx * pool->elt_sz,
+			sizeof(uint32_t));
+	return idx;
+}
+
+static uint32_t
+pool_alloc(struct poptrie_pool *pool, uint32_t n)
+{
+	uint32_t idx, sz;
+
+	n = pool_blk_size(pool, n);
+	idx = pool_pop(pool, n);
+	if ((idx == POPTRIE_NIL) && (pool->size - pool->pos >= n)) {
+		idx = pool->pos;
+		pool->pos += n;
+	}
+	/* split the smallest larger free block */
+	for (sz = n + pool->unit; (idx == POPTRIE_NIL) &&
+			(sz <= POPTRIE_BLK_MAX); sz += pool->unit) {
+		idx = pool_pop(pool, sz);
+		if (idx != POPTRIE_NIL)
+			pool_push(pool, idx + n, sz - n);
+	}
+	if (idx != POPTRIE_NIL)
+		pool->used += n;
+	return idx;
+}
+
+static void
+pool_free(struct poptrie_pool *pool, uint32_t idx, uint32_t n)
+{
+	n = pool_blk_size(pool, n);
+	pool_push(pool, idx, n);
+	pool->used -= n;
+}
+
+/*
+ * Merge the adjacent free blocks, as the blocks are freed with other
+ * sizes than the ones allocated next. Returns 0 if a block was merged.
+ */
+static int
+pool_merge(struct poptrie_pool *pool)
+{
+	uint32_t i, idx, n, start, pos, nb_free = 0, nb_old = 0, nb_new = 0;
+	uint64_t *bmp;
+
+	bmp = rte_zmalloc(NULL, RTE_ALIGN_CEIL(pool->pos + 1, 64) / 8, 0);
+	if (bmp == NULL)
+		return -ENOMEM;
+
+	for (n = pool->unit; n <= POPTRIE_BLK_MAX; n += pool->unit) {
+		while ((idx = pool_pop(pool, n)) != POPTRIE_NIL) {
+			for (i = idx; i < idx + n; i++)
+				bmp[i / 64] |= 1ULL << (i % 64);
+			nb_old++;
+		}
+	}
+
+	pos = pool->pos;
+	for (i = 0; i <= pos; i++) {
+		if ((i < pos) && (bmp[i / 64] & (1ULL << (i % 64)))) {
+			nb_free++;
+			continue;
+		}
+		start = i - nb_free;
+		if (i == pos) {
+			/* back to the never allocated elements */
+			pool->pos = start;
+			break;
+		}
+		for (; nb_free != 0; nb_free -= n, start += n) {
+			n = RTE_MIN(nb_free, (uint32_t)POPTRIE_BLK_MAX);
+			pool_push(pool, start, n);
+			nb_new++;
+		}
+	}
+
+	rte_free(bmp);
+	return ((nb_new < nb_old) || (pool->pos < pos)) ? 0 : -ENOSPC;
+}
+
+static int
+log_add(struct poptrie_log *log, const void *ent, size_t sz)
+{
+	void *p;
+	uint32_t cap;
+
+	if (log->nb == log->cap) {
+		cap = RTE_MAX(log->cap * 2, (uint32_t)POPTRIE_LOG_MIN);
+		p = rte_realloc(log->ent, cap * sz, 0);
+		if (p == NULL)
+			return -ENOMEM;
+		log->ent = p;
+		log->cap = cap;
+	}
+	memcpy((uint8_t *)log->ent + log->nb * sz, ent, sz);
+	log->nb++;
+	return 0;
+}
+
+static inline struct poptrie_pool *
+get_pool(struct rte_poptrie_tbl *dp, int leaves)
+{
+	return leaves ? &dp->leaf_pool : &dp->node_pool;
+}
+
+/* A replaced block as a resource reclaimed through RCU */
+static inline uint64_t
+blk_to_res(const struct poptrie_blk *blk)
+{
+	return blk->idx | ((uint64_t)blk->size << 32) |
+		((uint64_t)blk->leaves << 40);
+}
+
+/* Free a replaced block no reader can walk any more */
+static void
+blk_put(void *p, uint64_t res)
+{
+	struct rte_poptrie_tbl *dp = p;
+
+	pool_free(get_pool(dp, res >> 40), (uint32_t)res,
+		(res >> 32) & UINT8_MAX);
+}
+
+/* Allocate a block, released again if the update fails */
+static uint32_t
+blk_alloc(struct rte_poptrie_tbl *dp, int leaves, uint32_t n)
+{
+	struct poptrie_blk blk;
+
+	/* the reclaimed blocks may be of other sizes */
+	blk.idx = pool_alloc(get_pool(dp, leaves), n);
+	while ((blk.idx == POPTRIE_NIL) && (fib_rcu_reclaim(&dp->rcu) == 0))
+		blk.idx = pool_alloc(get_pool(dp, leaves), n);
+	if ((blk.idx == POPTRIE_NIL) &&
+			(pool_merge(get_pool(dp, leaves)) == 0))
+		blk.idx = pool_alloc(get_pool(dp, leaves), n);
+	if (blk.idx == POPTRIE_NIL)
+		return POPTRIE_NIL;
+	blk.size = n;
+	blk.leaves = leaves;
+	if (log_add(&dp->alloc_log, &blk, sizeof(blk)) != 0) {
+		pool_free(get_pool(dp, leaves), blk.idx, n);
+		return POPTRIE_NIL;
+	}
+	return blk.idx;
+}
+
+/* Free a block once the update is published */
+static int
+blk_free(struct rte_poptrie_tbl *dp, int leaves, uint32_t idx, uint32_t n)
+{
+	struct poptrie_blk blk;
+
+	if (n == 0)
+		return 0;
+	blk.idx = idx;
+	blk.size = n;
+	blk.leaves = leaves;
+	return log_add(&dp->free_log, &blk, sizeof(blk));
+}
+
+/* Free the leaf block of a node, which starts with the miss leaf */
+static int
+free_leaves(struct rte_poptrie_tbl *dp, const struct poptrie_node *node)
+{
+	uint32_t miss = ((node->key & POPTRIE_SKIP_MSK) != 0);
+
+	return blk_free(dp, 1, node->base0 - miss,
+		__builtin_popcountll(node->leafvec) + miss);
+}
+
+static int
+free_subtree(struct rte_poptrie_tbl *dp, const struct poptrie_node *node)
+{
+	uint32_t i, nb_children;
+	int ret;
+
+	nb_children = __builtin_popcountll(node->vector);
+	for (i = 0; i < nb_children; i++) {
+		ret = free_subtree(dp, &dp->nodes[node->base1 + i]);
+		if (ret != 0)
+			return ret;
+	}
+	ret = blk_free(dp, 0, node->base1, nb_children);
+	if (ret != 0)
+		return ret;
+	return free_leaves(dp, node);
+}
+
+/* Next hop of the longest route of at most depth bits covering ip */
+static uint64_t
+get_lpm_nh(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t *ip, int depth, int *route_depth)
+{
+	struct rte_rib6_node *node;
+	uint64_t nh;
+	uint8_t d;
+
+	node = rte_rib6_lookup(rib, ip);
+	while (node != NULL) {
+		rte_rib6_get_depth(node, &d);
+		if (d <= depth) {
+			rte_rib6_get_nh(node, &nh);
+			*route_depth = d;
+			return nh;
+		}
+		node = rte_rib6_lookup_parent(node);
+	}
+	*route_depth = -1;
+	return dp->def_nh;
+}
+
+/* Whether a route longer than depth bits is inside ip/depth */
+static inline int
+has_longer(struct rte_rib6 *rib, const uint8_t *ip, int depth)
+{
+	return (depth < POPTRIE_MAX_DEPTH) && (rte_rib6_get_nxt(rib, ip,
+		depth, NULL, RTE_RIB6_GET_NXT_COVER) != NULL);
+}
+
+/* Number of leading bits two addresses have in common */
+static uint32_t
+common_depth(const uint8_t *a, const uint8_t *b)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
+		if (a[i] != b[i])
+			return i * 8 + __builtin_clz(a[i] ^ b[i]) - 24;
+	return POPTRIE_MAX_DEPTH;
+}
+
+/*
+ * Number of strides from off that all the routes inside ip/off have in
+ * common, each of them staying inside the node after the skipped bits.
+ * The address of one of the routes is written to key_ip.
+ */
+static uint32_t
+get_skip(struct rte_rib6 *rib, const uint8_t *ip, uint32_t off,
+	uint8_t *key_ip)
+{
+	struct rte_rib6_node *tmp = NULL;
+	uint8_t r_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint32_t end, nb = 0;
+	uint8_t d;
+
+	end = off + POPTRIE_SKIP_MAX * POPTRIE_STRIDE;
+	while ((tmp = rte_rib6_get_nxt(rib, ip, off, tmp,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_ip(tmp, r_ip);
+		rte_rib6_get_depth(tmp, &d);
+		if (nb++ == 0)
+			rte_rib6_copy_addr(key_ip, r_ip);
+		end = RTE_MIN(end, RTE_MIN((uint32_t)d - 1,
+			common_depth(key_ip, r_ip)));
+		if (end < off + POPTRIE_STRIDE)
+			return 0;
+	}
+	return (nb != 0) ? (end - off) / POPTRIE_STRIDE : 0;
+}
+
+/* Set the POPTRIE_STRIDE bits of the address from the bit off to v */
+static void
+set_node_idx(uint8_t *ip, uint32_t off, uint32_t v)
+{
+	uint32_t i, b;
+	uint8_t msk;
+
+	for (i = 0; i < POPTRIE_STRIDE; i++) {
+		b = off + i;
+		if (b >= POPTRIE_MAX_DEPTH)
+			break;
+		msk = 0x80 >> (b & 7);
+		if (v & (1 << (POPTRIE_STRIDE - 1 - i)))
+			ip[b >> 3] |= msk;
+		else
+			ip[b >> 3] &= ~msk;
+	}
+}
+
+/*
+ * Set the slots of the node at off covered by the routes inside ip/depth
+ * to the next hop of the longest of them, and mark as internal the slots
+ * with a longer route inside.
+ */
+static void
+paint_slots(struct rte_rib6 *rib, const uint8_t *ip, uint8_t depth,
+	uint32_t off, uint64_t *val, int *route_depth, uint64_t *vector)
+{
+	struct rte_rib6_node *tmp = NULL;
+	uint8_t r_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t nh;
+	uint32_t v, end;
+	uint8_t d;
+
+	while ((tmp = rte_rib6_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_ip(tmp, r_ip);
+		rte_rib6_get_depth(tmp, &d);
+		v = get_node_idx(r_ip, off);
+		if (d > off + POPTRIE_STRIDE) {
+			*vector |= 1ULL << v;
+			continue;
+		}
+		rte_rib6_get_nh(tmp, &nh);
+		for (end = v + (1 << (off + POPTRIE_STRIDE - d)); v < end;
+				v++) {
+			val[v] = nh;
+			route_depth[v] = d;
+		}
+		/* the routes inside override it */
+		paint_slots(rib, r_ip, d, off, val, route_depth, vector);
+	}
+}
+
+/*
+ * Build into *node the node of the prefix ip/off, under the route
+ * base_nh of base_depth bits.
+ * With an old node, only the slots the changed route overlaps are
+ * recomputed: the children and the leaves of the other slots are
+ * copied, so an update rebuilds a single path of the trie.
+ * The arrays of the old node are freed once the update is published.
+ * A node whose skipped bits change is built from scratch.
+ */
+static int
+build_node(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t *ip, uint32_t off, uint64_t base_nh, int base_depth,
+	const struct poptrie_node *old, const struct poptrie_chg *chg,
+	struct poptrie_node *node)
+{
+	uint64_t val[POPTRIE_NODE_NUM_ENT];
+	int route_depth[POPTRIE_NODE_NUM_ENT];
+	uint8_t sub_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t key_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	const struct poptrie_node *old_child;
+	uint64_t vector, leafvec, bit, key = 0, miss_nh = base_nh, hi, lo;
+	uint32_t first, last, v, k = 0, nb_leaves, leaf, child, skip;
+	int all, depth, ret;
+
+	skip = get_skip(rib, ip, off, key_ip);
+	if (skip != 0) {
+		get_addr(key_ip, &hi, &lo);
+		key = (get_bits(hi, lo, off) &
+			~(UINT64_MAX >> (skip * POPTRIE_STRIDE))) | skip;
+	}
+	if ((old != NULL) && (old->key != key)) {
+		ret = free_subtree(dp, old);
+		if (ret != 0)
+			return ret;
+		old = NULL;
+	}
+	/* the routes are all inside key_ip at the end of the skipped bits */
+	if (skip != 0) {
+		ip = key_ip;
+		off += skip * POPTRIE_STRIDE;
+	}
+
+	depth = RTE_MIN(off + POPTRIE_STRIDE, (uint32_t)POPTRIE_MAX_DEPTH);
+	all = (old == NULL) || (chg->depth <= (int)off);
+	if (all) {
+		first = 0;
+		last = POPTRIE_NODE_NUM_ENT - 1;
+	} else {
+		first = get_node_idx(chg->ip, off);
+		last = first;
+		if (chg->depth < depth)
+			last += (1 << (off + POPTRIE_STRIDE - chg->depth)) - 1;
+	}
+
+	vector = (old != NULL) ? old->vector : 0;
+	for (v = 0; v < POPTRIE_NODE_NUM_ENT; v++) {
+		if ((v >= first) && (v <= last))
+			continue;
+		if (!(vector & (1ULL << v)))
+			val[v] = get_leaf(dp, old->base0 +
+				__builtin_popcountll(old->leafvec &
+				get_msk_upto(v)) - 1);
+	}
+
+	rte_rib6_copy_addr(sub_ip, ip);
+	if (all || (chg->depth < depth)) {
+		/* the slots inside ip/off or inside the changed route */
+		if (!all)
+			base_nh = get_lpm_nh(dp, rib, chg->ip, chg->depth,
+				&base_depth);
+		for (v = first; v <= last; v++) {
+			val[v] = base_nh;
+			route_depth[v] = base_depth;
+			vector &= ~(1ULL << v);
+		}
+		if (all)
+			paint_slots(rib, ip, off, off, val, route_depth,
+				&vector);
+		else
+			paint_slots(rib, chg->ip, chg->depth, off, val,
+				route_depth, &vector);
+	} else {
+		/* a single slot */
+		set_node_idx(sub_ip, off, first);
+		val[first] = get_lpm_nh(dp, rib, sub_ip, depth,
+			&route_depth[first]);
+		if (has_longer(rib, sub_ip, depth))
+			vector |= 1ULL << first;
+		else
+			vector &= ~(1ULL << first);
+	}
+
+	/* one leaf per run of equal next hops */
+	leafvec = 0;
+	nb_leaves = 0;
+	for (v = 0; v < POPTRIE_NODE_NUM_ENT; v++) {
+		bit = 1ULL << v;
+		if (vector & bit)
+			continue;
+		if ((nb_leaves == 0) || (val[v] != val[k])) {
+			leafvec |= bit;
+			nb_leaves++;
+		}
+		k = v;
+	}
+
+	/* the miss leaf first */
+	leaf = 0;
+	if (skip != 0)
+		nb_leaves++;
+	if (nb_leaves != 0) {
+		leaf = blk_alloc(dp, 1, nb_leaves);
+		if (leaf == POPTRIE_NIL)
+			return -ENOSPC;
+		if (skip != 0)
+			set_leaf(dp, leaf++, miss_nh);
+		for (v = 0, k = leaf; v < POPTRIE_NODE_NUM_ENT; v++)
+			if (leafvec & (1ULL << v))
+				set_leaf(dp, k++, val[v]);
+	}
+	child = 0;
+	if (vector != 0) {
+		child = blk_alloc(dp, 0, __builtin_popcountll(vector));
+		if (child == POPTRIE_NIL)
+			return -ENOSPC;
+	}
+
+	for (v = 0, k = child; v < POPTRIE_NODE_NUM_ENT; v++) {
+		bit = 1ULL << v;
+		old_child = NULL;
+		if ((old != NULL) && (old->vector & bit))
+			old_child = &dp->nodes[old->base1 +
+				__builtin_popcountll(old->vector &
+				get_msk_upto(v)) - 1];
+		if (!(vector & bit)) {
+			if (old_child != NULL) {
+				ret = free_subtree(dp, old_child);
+				if (ret != 0)
+					return ret;
+			}
+			continue;
+		}
+		/* untouched, or under a longer route than the changed one */
+		if ((old_child != NULL) && ((v < first) || (v > last) ||
+				((chg->depth <= depth) &&
+				(route_depth[v] > chg->depth))))
+			dp->nodes[k] = *old_child;
+		else {
+			set_node_idx(sub_ip, off, v);
+			ret = build_node(dp, rib, sub_ip, off + POPTRIE_STRIDE,
+				val[v], route_depth[v], old_child, chg,
+				&dp->nodes[k]);
+			if (ret != 0)
+				return ret;
+		}
+		k++;
+	}
+
+	if (old != NULL) {
+		ret = free_leaves(dp, old);
+		if (ret != 0)
+			return ret;
+		ret = blk_free(dp, 0, old->base1,
+			__builtin_popcountll(old->vector));
+		if (ret != 0)
+			return ret;
+	}
+
+	node->vector = vector;
+	node->leafvec = leafvec;
+	node->base0 = leaf;
+	node->base1 = child;
+	node->key = key;
+	return 0;
+}
+
+/*
+ * Compute the new value of the direct table entry idx under the route nh
+ * of route_depth bits: the leaf nh, or a node if ext is set.
+ */
+static int
+update_dir_ent(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib,
+	uint32_t idx, const struct poptrie_chg *chg, uint64_t nh,
+	int route_depth, int ext)
+{
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	const struct poptrie_node *old = NULL;
+	struct poptrie_pub pub;
+	uint64_t ent;
+	uint32_t root;
+	int ret;
+
+	ip[0] = idx >> 8;
+	ip[1] = idx;
+	ent = get_dir(dp, idx);
+	if (ent & POPTRIE_EXT_ENT)
+		old = &dp->nodes[ent >> 1];
+
+	if (ext) {
+		root = blk_alloc(dp, 0, 1);
+		if (root == POPTRIE_NIL)
+			return -ENOSPC;
+		ret = build_node(dp, rib, ip, POPTRIE_DIR_BITS, nh,
+			route_depth, old, chg, &dp->nodes[root]);
+		if (ret != 0)
+			return ret;
+		pub.val = ((uint64_t)root << 1) | POPTRIE_EXT_ENT;
+	} else {
+		pub.val = nh << 1;
+		if (pub.val == ent)
+			return 0;
+		if (old != NULL) {
+			ret = free_subtree(dp, old);
+			if (ret != 0)
+				return ret;
+		}
+	}
+	if (old != NULL) {
+		ret = blk_free(dp, 0, ent >> 1, 1);
+		if (ret != 0)
+			return ret;
+	}
+
+	pub.idx = idx;
+	return log_add(&dp->pub_log, &pub, sizeof(pub));
+}
+
+static void
+update_begin(struct rte_poptrie_tbl *dp)
+{
+	dp->alloc_log.nb = 0;
+	dp->free_log.nb = 0;
+	dp->pub_log.nb = 0;
+}
+
+/*
+ * Publish the new direct table entries and release the replaced blocks.
+ * If the update failed, release the new blocks, leaving the table as is.
+ */
+static int
+update_end(struct rte_poptrie_tbl *dp, int ret)
+{
+	struct poptrie_blk *blk;
+	struct poptrie_pub *pub;
+	uint32_t i, in_bulk;
+
+	if (ret != 0) {
+		blk = dp->alloc_log.ent;
+		for (i = 0; i < dp->alloc_log.nb; i++)
+			pool_free(get_pool(dp, blk[i].leaves), blk[i].idx,
+				blk[i].size);
+		return ret;
+	}
+
+	pub = dp->pub_log.ent;
+	for (i = 0; i < dp->pub_log.nb; i++)
+		set_dir(dp, pub[i].idx, pub[i].val);
+
+	/*
+	 * Readers may still walk the replaced blocks: they are reused once
+	 * the readers are done with them, or right away without RCU. In
+	 * blocking mode, a single grace period covers all the blocks of
+	 * the update.
+	 */
+	in_bulk = dp->rcu.in_bulk;
+	if (!in_bulk)
+		fib_rcu_bulk_begin(&dp->rcu);
+	blk = dp->free_log.ent;
+	for (i = 0; i < dp->free_log.nb; i++)
+		if (fib_rcu_defer(&dp->rcu, blk_to_res(&blk[i])) != 0)
+			pool_free(get_pool(dp, blk[i].leaves), blk[i].idx,
+				blk[i].size);
+	if (!in_bulk)
+		fib_rcu_bulk_end(&dp->rcu);
+	return 0;
+}
+
+static int
+modify_dp(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	uint64_t skip[POPTRIE_DIR_NUM_ENT / 64];
+	uint8_t dir_ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	struct rte_rib6_node *tmp = NULL;
+	struct poptrie_chg chg;
+	uint32_t first, i, n;
+	uint64_t nh;
+	int route_depth, ret = 0;
+	uint8_t d;
+
+	chg.ip = ip;
+	chg.depth = depth;
+	first = get_dir_idx(ip);
+	update_begin(dp);
+
+	if (depth > POPTRIE_DIR_BITS) {
+		dir_ip[0] = ip[0];
+		dir_ip[1] = ip[1];
+		nh = get_lpm_nh(dp, rib, dir_ip, POPTRIE_DIR_BITS,
+			&route_depth);
+		ret = update_dir_ent(dp, rib, first, &chg, nh, route_depth,
+			has_longer(rib, dir_ip, POPTRIE_DIR_BITS));
+		return update_end(dp, ret);
+	}
+
+	/* the entries under a longer route keep their value */
+	n = 1 << (POPTRIE_DIR_BITS - depth);
+	memset(skip, 0, RTE_ALIGN_CEIL(n, 64) / 8);
+	while ((tmp = rte_rib6_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_depth(tmp, &d);
+		if (d > POPTRIE_DIR_BITS)
+			continue;
+		rte_rib6_get_ip(tmp, dir_ip);
+		for (i = get_dir_idx(dir_ip) - first; i < get_dir_idx(dir_ip) -
+				first + (1 << (POPTRIE_DIR_BITS - d)); i++)
+			skip[i / 64] |= 1ULL << (i % 64);
+	}
+
+	nh = get_lpm_nh(dp, rib, ip, depth, &route_depth);
+	for (i = 0; (i < n) && (ret == 0); i++) {
+		if (skip[i / 64] & (1ULL << (i % 64)))
+			continue;
+		ret = update_dir_ent(dp, rib, first + i, &chg, nh, route_depth,
+			get_dir(dp, first + i) & POPTRIE_EXT_ENT);
+	}
+	return update_end(dp, ret);
+}
+
+int
+poptrie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op)
+{
+	struct rte_poptrie_tbl *dp;
+	struct rte_rib6 *rib;
+	struct rte_rib6_node *node;
+	uint8_t	ip_masked[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t node_nh;
+	int i, ret;
+
+	if ((fib == NULL) || (ip == NULL) || (depth > RTE_FIB6_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib6_get_dp(fib);
+	RTE_ASSERT(dp);
+	rib = rte_fib6_get_rib(fib);
+	RTE_ASSERT(rib);
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
+		ip_masked[i] = ip[i] & get_msk_part(depth, i);
+
+	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
+	switch (op) {
+	case RTE_FIB6_ADD:
+		if (next_hop > get_max_nh(dp->nh_sz))
+			return -EINVAL;
+		if (node != NULL) {
+			rte_rib6_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			rte_rib6_set_nh(node, next_hop);
+			ret = modify_dp(dp, rib, ip_masked, depth);
+			if (ret != 0)
+				rte_rib6_set_nh(node, node_nh);
+			return ret;
+		}
+
+		node = rte_rib6_insert(rib, ip_masked, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib6_set_nh(node, next_hop);
+		ret = modify_dp(dp, rib, ip_masked, depth);
+		if (ret != 0)
+			rte_rib6_remove(rib, ip_masked, depth);
+		return ret;
+	case RTE_FIB6_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		rte_rib6_get_nh(node, &node_nh);
+		rte_rib6_remove(rib, ip_masked, depth);
+		ret = modify_dp(dp, rib, ip_masked, depth);
+		if (ret != 0) {
+			node = rte_rib6_insert(rib, ip_masked, depth);
+			if (node != NULL)
+				rte_rib6_set_nh(node, node_nh);
+		}
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+/*
+ * Fill the direct table entries of ip/depth, under the route nh of
+ * route_depth bits, from the routes inside it.
+ */
+static int
+build_dir(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t *ip, uint8_t depth, uint64_t nh, int route_depth,
+	const struct poptrie_chg *chg)
+{
+	struct rte_rib6_node *tmp = NULL;
+	uint8_t r_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint32_t cur, end, idx;
+	uint64_t r_nh;
+	uint8_t d;
+	int ret = 0;
+
+	cur = get_dir_idx(ip);
+	end = cur + (1 << (POPTRIE_DIR_BITS - depth));
+	while ((tmp = rte_rib6_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_ip(tmp, r_ip);
+		rte_rib6_get_depth(tmp, &d);
+		idx = get_dir_idx(r_ip);
+		/* several longer routes in the same entry */
+		if (idx < cur)
+			continue;
+		for (; (cur < idx) && (ret == 0); cur++)
+			ret = update_dir_ent(dp, rib, cur, chg, nh,
+				route_depth, 0);
+		if (ret != 0)
+			return ret;
+		if (d > POPTRIE_DIR_BITS) {
+			ret = update_dir_ent(dp, rib, cur++, chg, nh,
+				route_depth, 1);
+		} else {
+			rte_rib6_get_nh(tmp, &r_nh);
+			ret = build_dir(dp, rib, r_ip, d, r_nh, d, chg);
+			cur += 1 << (POPTRIE_DIR_BITS - d);
+		}
+		if (ret != 0)
+			return ret;
+	}
+	for (; (cur < end) && (ret == 0); cur++)
+		ret = update_dir_ent(dp, rib, cur, chg, nh, route_depth, 0);
+	return ret;
+}
+
+int
+poptrie_build(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib)
+{
+	/* deeper than any route: the nodes are built from scratch */
+	struct poptrie_chg chg = {
+		.ip = NULL,
+		.depth = POPTRIE_MAX_DEPTH + 1,
+	};
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	uint64_t nh;
+	int route_depth;
+
+	update_begin(dp);
+	nh = get_lpm_nh(dp, rib, ip, 0, &route_depth);
+	return update_end(dp, build_dir(dp, rib, ip, 0, nh, route_depth,
+		&chg));
+}
+
+void *
+poptrie_create(const char *name, int socket_id, struct rte_fib6_conf *conf)
+{
+	char mem_name[POPTRIE_NAMESIZE];
+	struct rte_poptrie_tbl *dp = NULL;
+	uint64_t	def_nh;
+	uint32_t	i, num_nodes, num_leaves;
+	enum rte_fib_trie_nh_sz	nh_sz;
+
+	if ((name == NULL) || (conf == NULL) ||
+			(conf->poptrie.nh_sz < RTE_FIB6_TRIE_2B) ||
+			(conf->poptrie.nh_sz > RTE_FIB6_TRIE_8B) ||
+			(conf->poptrie.num_nodes >
+			get_max_nh(conf->poptrie.nh_sz)) ||
+			(conf->poptrie.num_nodes == 0) ||
+			(conf->poptrie.num_leaves == 0) ||
+			(conf->poptrie.num_leaves > UINT32_MAX - 1) ||
+			(conf->default_nh >
+			get_max_nh(conf->poptrie.nh_sz))) {
+
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	def_nh = conf->default_nh;
+	nh_sz = conf->poptrie.nh_sz;
+	num_nodes = conf->poptrie.num_nodes;
+	num_leaves = conf->poptrie.num_leaves;
+
+	/* one more entry for the 32-bit gathers of the 2B vector lookup */
+	dp = rte_zmalloc_socket(name, sizeof(struct rte_poptrie_tbl) +
+		(POPTRIE_DIR_NUM_ENT + 1) * (1 << nh_sz), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return dp;
+	}
+	dp->def_nh = def_nh;
+	dp->nh_sz = nh_sz;
+	for (i = 0; i < POPTRIE_DIR_NUM_ENT; i++)
+		set_dir(dp, i, def_nh << 1);
+
+	snprintf(mem_name, sizeof(mem_name), "NODES_%p", dp);
+	dp->nodes = rte_zmalloc_socket(mem_name,
+		sizeof(struct poptrie_node) * num_nodes,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	/* and one more leaf */
+	snprintf(mem_name, sizeof(mem_name), "LEAVES_%p", dp);
+	dp->leaves = rte_zmalloc_socket(mem_name,
+		(size_t)(num_leaves + 1) << nh_sz,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if ((dp->nodes == NULL) || (dp->leaves == NULL)) {
+		rte_errno = ENOMEM;
+		rte_free(dp->leaves);
+		rte_free(dp->nodes);
+		rte_free(dp);
+		return NULL;
+	}
+
+	pool_init(&dp->node_pool, dp->nodes, sizeof(struct poptrie_node),
+		num_nodes);
+	pool_init(&dp->leaf_pool, dp->leaves, 1 << nh_sz, num_leaves);
+
+	return dp;
+}
+
+void
+poptrie_free(void *p)
+{
+	struct rte_poptrie_tbl *dp = (struct rte_poptrie_tbl *)p;
+
+	fib_rcu_free(&dp->rcu);
+	rte_free(dp->alloc_log.ent);
+	rte_free(dp->free_log.ent);
+	rte_free(dp->pub_log.ent);
+	rte_free(dp->leaves);
+	rte_free(dp->nodes);
+	rte_free(dp);
+}
+
+int
+poptrie_rcu_qsbr_add(struct rte_poptrie_tbl *dp,
+	struct rte_fib6_rcu_config *cfg, const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	uint64_t nb_blks;
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	/* at most one replaced block per unit of the pools */
+	nb_blks = RTE_MIN((uint64_t)dp->node_pool.size / dp->node_pool.unit +
+		dp->leaf_pool.size / dp->leaf_pool.unit, (uint64_t)UINT32_MAX);
+	if (cfg->mode == RTE_FIB6_QSBR_MODE_SYNC)
+		return fib_rcu_qsbr_add(&dp->rcu, cfg->v, NULL, nb_blks,
+			blk_put, dp);
+	if (cfg->mode != RTE_FIB6_QSBR_MODE_DQ)
+		return -EINVAL;
+
+	/* Init QSBR defer queue. */
+	snprintf(rcu_dq_name, sizeof(rcu_dq_name), "FIB6_RCU_%s", name);
+	params.name = rcu_dq_name;
+	params.size = cfg->dq_size;
+	params.trigger_reclaim_limit = cfg->reclaim_thd;
+	params.max_reclaim_size = cfg->reclaim_max;
+	if (params.max_reclaim_size == 0)
+		params.max_reclaim_size = RTE_FIB6_RCU_DQ_RECLAIM_MAX;
+	return fib_rcu_qsbr_add(&dp->rcu, cfg->v, &params, nb_blks,
+		blk_put, dp);
+}
+
+void
+poptrie_bulk_begin(struct rte_poptrie_tbl *dp)
+{
+	fib_rcu_bulk_begin(&dp->rcu);
+}
+
+void
+poptrie_bulk_end(struct rte_poptrie_tbl *dp)
+{
+	fib_rcu_bulk_end(&dp->rcu);
+}
+
+/* Dataplane part of a file written by rte_fib6_save() */
+struct poptrie_file_hdr {
+	uint32_t	pos[2];		/* node and leaf pools */
+	uint32_t	used[2];
+	uint32_t	free_head[2][POPTRIE_BLK_MAX + 1];
+};
+
+int
+poptrie_save(struct rte_poptrie_tbl *dp, FILE *f)
+{
+	struct poptrie_pool *pools[2] = { &dp->node_pool, &dp->leaf_pool };
+	struct poptrie_file_hdr hdr;
+	size_t sz;
+	int i;
+
+	memset(&hdr, 0, sizeof(hdr));
+	for (i = 0; i < 2; i++) {
+		hdr.pos[i] = pools[i]->pos;
+		hdr.used[i] = pools[i]->used;
+		memcpy(hdr.free_head[i], pools[i]->free_head,
+			sizeof(hdr.free_head[i]));
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EIO;
+	sz = (size_t)POPTRIE_DIR_NUM_ENT << dp->nh_sz;
+	if (fwrite(dp->dir, 1, sz, f) != sz)
+		return -EIO;
+	/* the free blocks are linked from inside, up to the pool position */
+	for (i = 0; i < 2; i++) {
+		sz = (size_t)pools[i]->pos * pools[i]->elt_sz;
+		if (fwrite(pools[i]->mem, 1, sz, f) != sz)
+			return -EIO;
+	}
+	return 0;
+}
+
+int
+poptrie_load(struct rte_poptrie_tbl *dp, FILE *f)
+{
+	struct poptrie_pool *pools[2] = { &dp->node_pool, &dp->leaf_pool };
+	struct poptrie_file_hdr hdr;
+	size_t sz;
+	int i;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EINVAL;
+	for (i = 0; i < 2; i++)
+		if ((hdr.pos[i] > pools[i]->size) ||
+				(hdr.used[i] > hdr.pos[i]))
+			return -EINVAL;
+
+	/* the tables are not visible to the readers yet */
+	sz = (size_t)POPTRIE_DIR_NUM_ENT << dp->nh_sz;
+	if (fread(dp->dir, 1, sz, f) != sz)
+		return -EINVAL;
+	for (i = 0; i < 2; i++) {
+		sz = (size_t)hdr.pos[i] * pools[i]->elt_sz;
+		if (fread(pools[i]->mem, 1, sz, f) != sz)
+			return -EINVAL;
+		pools[i]->pos = hdr.pos[i];
+		pools[i]->used = hdr.used[i];
+		memcpy(pools[i]->free_head, hdr.free_head[i],
+			sizeof(pools[i]->free_head));
+	}
+	return 0;
+}
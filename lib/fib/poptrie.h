@@ -0,0 +1,275 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _POPTRIE_H_
+#define _POPTRIE_H_
+
+/**
+ * @file
+ * RTE IPv6 Longest Prefix Match (LPM) with a compressed multibit trie
+ *
+ * The first POPTRIE_DIR_BITS bits of the address index a direct table.
+ * Below, each node covers POPTRIE_STRIDE bits with a bitmap of its internal
+ * children and a bitmap of the starts of the runs of equal leaves, the
+ * children and the leaves of a node being contiguous. The index of a child
+ * or a leaf is the popcount of the bitmap below its position.
+ * When all the routes below a node share their next bits, the node skips
+ * up to POPTRIE_SKIP_MAX strides of them: an address with other bits
+ * gets the miss leaf stored before the leaves of the node, so that
+ * sparse long prefixes take a few levels instead of one per stride.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+#include <rte_rcu_qsbr.h>
+
+#include "fib_rcu.h"
+
+/* @internal Number of address bits indexing the direct table. */
+#define POPTRIE_DIR_BITS	16
+/* @internal Total number of direct table entries. */
+#define POPTRIE_DIR_NUM_ENT	(1 << POPTRIE_DIR_BITS)
+/* @internal Number of address bits covered by a node. */
+#define POPTRIE_STRIDE		6
+/* @internal Number of children and leaves of a node. */
+#define POPTRIE_NODE_NUM_ENT	(1 << POPTRIE_STRIDE)
+/* @internal Maximum depth value possible for IPv6 LPM. */
+#define POPTRIE_MAX_DEPTH	128
+/* @internal Direct table entry pointing to a node. */
+#define POPTRIE_EXT_ENT		1
+/* @internal Number of addresses looked up together. */
+#define POPTRIE_LOOKUP_LANES	16
+/* @internal Number of strides skipped by a node, in its key. */
+#define POPTRIE_SKIP_MSK	0xf
+/* @internal Maximum number of strides skipped by a node. */
+#define POPTRIE_SKIP_MAX	10
+/* @internal Largest block: the leaves and the miss leaf, in pool units. */
+#define POPTRIE_BLK_MAX		(POPTRIE_NODE_NUM_ENT + 2)
+
+struct poptrie_node {
+	uint64_t	vector;		/**< internal children bitmap */
+	uint64_t	leafvec;	/**< leaf runs bitmap */
+	uint32_t	base0;		/**< index of the first leaf */
+	uint32_t	base1;		/**< index of the first child */
+	/** skipped address bits from the top, and number of strides */
+	uint64_t	key;
+};
+
+/* Pool of contiguous blocks of nodes or of leaves */
+struct poptrie_pool {
+	uint8_t		*mem;
+	uint32_t	elt_sz;		/**< size of an element */
+	uint32_t	unit;		/**< block sizes are multiples of unit */
+	uint32_t	size;		/**< number of elements */
+	uint32_t	pos;		/**< first never allocated element */
+	uint32_t	used;		/**< number of elements in use */
+	/** first free block of each size */
+	uint32_t	free_head[POPTRIE_BLK_MAX + 1];
+};
+
+/* Block allocated or freed during an update */
+struct poptrie_blk {
+	uint32_t	idx;
+	uint8_t		size;
+	uint8_t		leaves;
+};
+
+/* Direct table entry written by an update */
+struct poptrie_pub {
+	uint32_t	idx;
+	uint64_t	val;
+};
+
+/* Update log, grown on demand */
+struct poptrie_log {
+	void		*ent;
+	uint32_t	nb;
+	uint32_t	cap;
+};
+
+struct rte_poptrie_tbl {
+	uint64_t	def_nh;		/**< Default next hop */
+	enum rte_fib_trie_nh_sz	nh_sz;	/**< Size of nexthop entry */
+	struct poptrie_node	*nodes;	/**< node pool memory */
+	void		*leaves;	/**< leaf pool memory */
+	struct poptrie_pool	node_pool;
+	struct poptrie_pool	leaf_pool;
+	/* blocks allocated, blocks to free and entries to write */
+	struct poptrie_log	alloc_log;
+	struct poptrie_log	free_log;
+	struct poptrie_log	pub_log;
+	struct fib_rcu	rcu;		/**< RCU QSBR reclamation */
+	/* direct table. */
+	__extension__ uint64_t	dir[0] __rte_cache_aligned;
+};
+
+static inline uint32_t
+get_dir_idx(const uint8_t *ip)
+{
+	return ip[0] << 8 | ip[1];
+}
+
+/* POPTRIE_STRIDE bits of the address from the bit off, 0 past the end */
+static inline uint32_t
+get_node_idx(const uint8_t *ip, uint32_t off)
+{
+	uint32_t b = off >> 3;
+	uint32_t w;
+
+	w = ip[b] << 8;
+	if (b + 1 < RTE_FIB6_IPV6_ADDR_SIZE)
+		w |= ip[b + 1];
+	return (w >> (16 - POPTRIE_STRIDE - (off & 7))) &
+		(POPTRIE_NODE_NUM_ENT - 1);
+}
+
+/* The address as two host order halves */
+static inline void
+get_addr(const uint8_t *ip, uint64_t *hi, uint64_t *lo)
+{
+	memcpy(hi, ip, sizeof(*hi));
+	memcpy(lo, ip + sizeof(*hi), sizeof(*lo));
+	*hi = rte_be_to_cpu_64(*hi);
+	*lo = rte_be_to_cpu_64(*lo);
+}
+
+/* 64 bits of the address from the bit off, off being above 0 */
+static inline uint64_t
+get_bits(uint64_t hi, uint64_t lo, uint32_t off)
+{
+	if (off < 64)
+		return (hi << off) | (lo >> (64 - off));
+	return lo << (off - 64);
+}
+
+/*
+ * Whether the address misses the bits skipped by the node at the bit *off,
+ * otherwise *off moves past them.
+ */
+static inline int
+skip_bits(const struct poptrie_node *node, uint64_t hi, uint64_t lo,
+	uint32_t *off)
+{
+	uint32_t skip = (node->key & POPTRIE_SKIP_MSK) * POPTRIE_STRIDE;
+
+	if (skip == 0)
+		return 0;
+	if ((get_bits(hi, lo, *off) ^ node->key) >> (64 - skip))
+		return 1;
+	*off += skip;
+	return 0;
+}
+
+/* Bits of the bitmap up to and including the bit v */
+static inline uint64_t
+get_msk_upto(uint32_t v)
+{
+	return ((1ULL << v) << 1) - 1;
+}
+
+/*
+ * Looks up the addresses by groups of POPTRIE_LOOKUP_LANES, stepping all
+ * the addresses of a group through a level before going to the next one,
+ * so that their node reads overlap. The addresses of a group reach
+ * different bit offsets as the nodes skip bits.
+ */
+#define POPTRIE_LOOKUP_FUNC(suffix, type)				\
+static inline void rte_poptrie_lookup_bulk_##suffix(void *p,		\
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],				\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	struct rte_poptrie_tbl *dp = (struct rte_poptrie_tbl *)p;	\
+	const struct poptrie_node *node;				\
+	uint64_t tmp[POPTRIE_LOOKUP_LANES];				\
+	uint64_t addr[2][POPTRIE_LOOKUP_LANES];				\
+	uint32_t off[POPTRIE_LOOKUP_LANES];				\
+	uint64_t msk, vec;						\
+	uint32_t i, j, k, v, pending;					\
+									\
+	for (i = 0; i < n; i += k) {					\
+		k = RTE_MIN(n - i, (uint32_t)POPTRIE_LOOKUP_LANES);	\
+		for (j = 0; j < k; j++) {				\
+			get_addr(&ips[i + j][0], &addr[0][j],		\
+				&addr[1][j]);				\
+			tmp[j] = ((type *)dp->dir)[addr[0][j] >>	\
+				(64 - POPTRIE_DIR_BITS)];		\
+			off[j] = POPTRIE_DIR_BITS;			\
+		}							\
+		do {							\
+			pending = 0;					\
+			for (j = 0; j < k; j++) {			\
+				if (!(tmp[j] & POPTRIE_EXT_ENT))	\
+					continue;			\
+				node = &dp->nodes[tmp[j] >> 1];		\
+				if (skip_bits(node, addr[0][j],		\
+						addr[1][j], &off[j])) {	\
+					tmp[j] = (uint64_t)((type *)	\
+						dp->leaves)[node->base0 - \
+						1] << 1;		\
+					continue;			\
+				}					\
+				v = (addr[off[j] >> 6][j] <<		\
+					(off[j] & 63)) >>		\
+					(64 - POPTRIE_STRIDE);		\
+				off[j] += POPTRIE_STRIDE;		\
+				msk = get_msk_upto(v);			\
+				vec = node->vector;			\
+				if ((vec >> v) & 1) {			\
+					tmp[j] = ((uint64_t)(node->base1 + \
+						__builtin_popcountll(	\
+						vec & msk) - 1) << 1) |	\
+						POPTRIE_EXT_ENT;	\
+					pending = 1;			\
+				} else					\
+					tmp[j] = (uint64_t)((type *)	\
+						dp->leaves)[node->base0 + \
+						__builtin_popcountll(	\
+						node->leafvec & msk) - 1] \
+						<< 1;			\
+			}						\
+		} while (pending);					\
+		for (j = 0; j < k; j++)					\
+			next_hops[i + j] = tmp[j] >> 1;			\
+	}								\
+}
+POPTRIE_LOOKUP_FUNC(2b, uint16_t)
+POPTRIE_LOOKUP_FUNC(4b, uint32_t)
+POPTRIE_LOOKUP_FUNC(8b, uint64_t)
+
+void *
+poptrie_create(const char *name, int socket_id, struct rte_fib6_conf *conf);
+
+void
+poptrie_free(void *p);
+
+rte_fib6_lookup_fn_t
+poptrie_get_lookup_fn(void *p, enum rte_fib6_lookup_type type);
+
+int
+poptrie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op);
+
+int
+poptrie_build(struct rte_poptrie_tbl *dp, struct rte_rib6 *rib);
+
+int
+poptrie_rcu_qsbr_add(struct rte_poptrie_tbl *dp,
+	struct rte_fib6_rcu_config *cfg, const char *name);
+
+void
+poptrie_bulk_begin(struct rte_poptrie_tbl *dp);
+
+void
+poptrie_bulk_end(struct rte_poptrie_tbl *dp);
+
+int
+poptrie_save(struct rte_poptrie_tbl *dp, FILE *f);
+
+int
+poptrie_load(struct rte_poptrie_tbl *dp, FILE *f);
+
+#endif /* _POPTRIE_H_ */
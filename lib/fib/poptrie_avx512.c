@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_vect.h>
+#include <rte_fib6.h>
+
+#include "poptrie.h"
+#include "poptrie_avx512.h"
+
+/* Load 8 ips as their first and last 8 bytes in host order */
+static __rte_always_inline void
+load_x8(uint8_t ips[8][RTE_FIB6_IPV6_ADDR_SIZE],
+	__m512i *first, __m512i *second)
+{
+	__m512i tmp1, tmp2, tmp3, tmp4;
+	const __rte_x86_zmm_t perm_idxes = {
+		.u64 = { 0, 2, 4, 6, 1, 3, 5, 7
+		},
+	};
+	const __rte_x86_zmm_t bswap = {
+		.u8 = { 7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8,
+			7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8,
+			7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8,
+			7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8
+			},
+	};
+
+	tmp1 = _mm512_loadu_si512(&ips[0][0]);
+	tmp2 = _mm512_loadu_si512(&ips[4][0]);
+
+	tmp3 = _mm512_unpacklo_epi64(tmp1, tmp2);
+	tmp3 = _mm512_permutexvar_epi64(perm_idxes.z, tmp3);
+	*first = _mm512_shuffle_epi8(tmp3, bswap.z);
+	tmp4 = _mm512_unpackhi_epi64(tmp1, tmp2);
+	tmp4 = _mm512_permutexvar_epi64(perm_idxes.z, tmp4);
+	*second = _mm512_shuffle_epi8(tmp4, bswap.z);
+}
+
+/* Popcount of every epi64, from a nibble lookup table */
+static __rte_always_inline __m512i
+popcnt_x8(__m512i v)
+{
+	const __m512i lut = _mm512_set4_epi32(0x04030302, 0x03020201,
+		0x03020201, 0x02010100);
+	const __m512i nibble = _mm512_set1_epi8(0x0f);
+	__m512i lo, hi;
+
+	lo = _mm512_and_si512(v, nibble);
+	hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble);
+	lo = _mm512_add_epi8(_mm512_shuffle_epi8(lut, lo),
+		_mm512_shuffle_epi8(lut, hi));
+	return _mm512_sad_epu8(lo, _mm512_setzero_si512());
+}
+
+/* Gather the next hops at idxes of tbl, whose entries are size bytes */
+static __rte_always_inline __m512i
+gather_nh(__m512i idxes, __mmask8 msk, const void *tbl, int size)
+{
+	const __m512i res_msk = _mm512_set1_epi64(UINT16_MAX);
+	__m512i res;
+
+	if (size == sizeof(uint64_t))
+		return _mm512_mask_i64gather_epi64(_mm512_setzero_si512(),
+			msk, idxes, tbl, 8);
+	if (size == sizeof(uint32_t))
+		return _mm512_cvtepu32_epi64(_mm512_mask_i64gather_epi32(
+			_mm256_setzero_si256(), msk, idxes, tbl, 4));
+	res = _mm512_cvtepu32_epi64(_mm512_mask_i64gather_epi32(
+		_mm256_setzero_si256(), msk, idxes, tbl, 2));
+	return _mm512_and_si512(res, res_msk);
+}
+
+/*
+ * One node per lane for the lanes of msk_ext, the address bits being at
+ * off in first and second. Returns the lanes going down to a child.
+ */
+static __rte_always_inline __mmask8
+poptrie_vec_step(struct rte_poptrie_tbl *dp, __m512i first, __m512i second,
+	__m512i *off, __m512i *res, __mmask8 msk_ext, int size)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i one = _mm512_set1_epi64(1);
+	const __m512i lo32 = _mm512_set1_epi64(UINT32_MAX);
+	const __m512i bits64 = _mm512_set1_epi64(64);
+	__m512i idxes, vector, leafvec, bases, key, base, bit, msk, leaf;
+	__m512i skip, addr;
+	__mmask8 msk_int, msk_leaf, msk_miss;
+
+	/* struct poptrie_node is 4 epi64 */
+	idxes = _mm512_slli_epi64(_mm512_srli_epi64(*res, 1), 2);
+	vector = _mm512_mask_i64gather_epi64(zero, msk_ext, idxes,
+		(const void *)dp->nodes, 8);
+	leafvec = _mm512_mask_i64gather_epi64(zero, msk_ext,
+		_mm512_add_epi64(idxes, one), (const void *)dp->nodes, 8);
+	bases = _mm512_mask_i64gather_epi64(zero, msk_ext,
+		_mm512_add_epi64(idxes, _mm512_set1_epi64(2)),
+		(const void *)dp->nodes, 8);
+	key = _mm512_mask_i64gather_epi64(zero, msk_ext,
+		_mm512_add_epi64(idxes, _mm512_set1_epi64(3)),
+		(const void *)dp->nodes, 8);
+
+	/*
+	 * skip_bits(), the shifts by 64 bits or more giving 0: the lanes
+	 * not skipping any bit do not miss.
+	 */
+	skip = _mm512_and_si512(key, _mm512_set1_epi64(POPTRIE_SKIP_MSK));
+	skip = _mm512_add_epi64(_mm512_slli_epi64(skip, 2),
+		_mm512_slli_epi64(skip, 1));
+	addr = _mm512_or_si512(_mm512_sllv_epi64(first, *off),
+		_mm512_or_si512(_mm512_srlv_epi64(second,
+		_mm512_sub_epi64(bits64, *off)), _mm512_sllv_epi64(second,
+		_mm512_sub_epi64(*off, bits64))));
+	addr = _mm512_srlv_epi64(_mm512_xor_si512(addr, key),
+		_mm512_sub_epi64(bits64, skip));
+	msk_miss = _mm512_mask_test_epi64_mask(msk_ext, addr, addr);
+	*off = _mm512_add_epi64(*off, skip);
+
+	/* get_node_idx() and get_msk_upto() */
+	addr = _mm512_mask_blend_epi64(_mm512_cmplt_epu64_mask(*off, bits64),
+		second, first);
+	bit = _mm512_srli_epi64(_mm512_sllv_epi64(addr,
+		_mm512_and_si512(*off, _mm512_set1_epi64(63))),
+		64 - POPTRIE_STRIDE);
+	bit = _mm512_sllv_epi64(one, bit);
+	msk = _mm512_sub_epi64(_mm512_add_epi64(bit, bit), one);
+	*off = _mm512_add_epi64(*off, _mm512_set1_epi64(POPTRIE_STRIDE));
+
+	/* a single popcount on the bitmap of the child or of the leaf */
+	msk_int = _mm512_mask_test_epi64_mask(msk_ext & ~msk_miss, vector,
+		bit);
+	msk_leaf = msk_ext & ~msk_int;
+	msk = _mm512_and_si512(msk,
+		_mm512_mask_blend_epi64(msk_int, leafvec, vector));
+	base = _mm512_mask_blend_epi64(msk_int,
+		_mm512_and_si512(bases, lo32), _mm512_srli_epi64(bases, 32));
+	idxes = _mm512_sub_epi64(_mm512_add_epi64(base, popcnt_x8(msk)), one);
+	/* the miss leaf is before the first leaf */
+	idxes = _mm512_mask_sub_epi64(idxes, msk_miss, base, one);
+
+	leaf = gather_nh(idxes, msk_leaf, dp->leaves, size);
+	*res = _mm512_mask_mov_epi64(*res, msk_int,
+		_mm512_or_si512(_mm512_slli_epi64(idxes, 1), one));
+	*res = _mm512_mask_mov_epi64(*res, msk_leaf,
+		_mm512_slli_epi64(leaf, 1));
+	return msk_int;
+}
+
+static __rte_always_inline void
+poptrie_vec_lookup_x8x2(void *p, uint8_t ips[16][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, int size)
+{
+	struct rte_poptrie_tbl *dp = (struct rte_poptrie_tbl *)p;
+	const __m512i lsb = _mm512_set1_epi64(1);
+	/* IPv6 eight byte chunks */
+	__m512i first_1, second_1;
+	__m512i first_2, second_2;
+	__m512i res_1, res_2, off_1, off_2;
+	__mmask8 msk_ext_1, msk_ext_2;
+
+	load_x8(ips, &first_1, &second_1);
+	load_x8(ips + 8, &first_2, &second_2);
+
+	/* lookup in the direct table */
+	res_1 = gather_nh(_mm512_srli_epi64(first_1, 64 - POPTRIE_DIR_BITS),
+		UINT8_MAX, dp->dir, size);
+	res_2 = gather_nh(_mm512_srli_epi64(first_2, 64 - POPTRIE_DIR_BITS),
+		UINT8_MAX, dp->dir, size);
+	msk_ext_1 = _mm512_test_epi64_mask(res_1, lsb);
+	msk_ext_2 = _mm512_test_epi64_mask(res_2, lsb);
+
+	/* traverse down the trie, each lane at its own offset */
+	off_1 = _mm512_set1_epi64(POPTRIE_DIR_BITS);
+	off_2 = off_1;
+	while (msk_ext_1 || msk_ext_2) {
+		msk_ext_1 = poptrie_vec_step(dp, first_1, second_1, &off_1,
+			&res_1, msk_ext_1, size);
+		msk_ext_2 = poptrie_vec_step(dp, first_2, second_2, &off_2,
+			&res_2, msk_ext_2, size);
+	}
+
+	res_1 = _mm512_srli_epi64(res_1, 1);
+	res_2 = _mm512_srli_epi64(res_2, 1);
+	_mm512_storeu_si512(next_hops, res_1);
+	_mm512_storeu_si512(next_hops + 8, res_2);
+}
+
+void
+rte_poptrie_vec_lookup_bulk_2b(void *p,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n)
+{
+	uint32_t i;
+	for (i = 0; i < (n / 16); i++) {
+		poptrie_vec_lookup_x8x2(p, (uint8_t (*)[16])&ips[i * 16][0],
+				next_hops + i * 16, sizeof(uint16_t));
+	}
+	rte_poptrie_lookup_bulk_2b(p, (uint8_t (*)[16])&ips[i * 16][0],
+			next_hops + i * 16, n - i * 16);
+}
+
+void
+rte_poptrie_vec_lookup_bulk_4b(void *p,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n)
+{
+	uint32_t i;
+	for (i = 0; i < (n / 16); i++) {
+		poptrie_vec_lookup_x8x2(p, (uint8_t (*)[16])&ips[i * 16][0],
+				next_hops + i * 16, sizeof(uint32_t));
+	}
+	rte_poptrie_lookup_bulk_4b(p, (uint8_t (*)[16])&ips[i * 16][0],
+			next_hops + i * 16, n - i * 16);
+}
+
+void
+rte_poptrie_vec_lookup_bulk_8b(void *p,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n)
+{
+	uint32_t i;
+	for (i = 0; i < (n / 16); i++) {
+		poptrie_vec_lookup_x8x2(p, (uint8_t (*)[16])&ips[i * 16][0],
+				next_hops + i * 16, sizeof(uint64_t));
+	}
+	rte_poptrie_lookup_bulk_8b(p, (uint8_t (*)[16])&ips[i * 16][0],
+			next_hops + i * 16, n - i * 16);
+}
@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <rte_compat.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,6 +48,17 @@ enum rte_fib_op {
 	RTE_FIB_DEL,
 };
 
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_FIB_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_fib_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_FIB_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_FIB_QSBR_MODE_SYNC
+};
+
 /** Size of nexthop (1 << nh_sz) bits for DIR24_8 based FIB */
 enum rte_fib_dir24_8_nh_sz {
 	RTE_FIB_DIR24_8_1B,
@@ -88,6 +100,37 @@ struct rte_fib_conf {
 	};
 };
 
+/** FIB RCU QSBR configuration structure. */
+struct rte_fib_rcu_config {
+	struct rte_rcu_qsbr *v;	/* RCU QSBR variable. */
+	/* Mode of RCU QSBR. RTE_FIB_QSBR_MODE_xxx
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_fib_qsbr_mode mode;
+	uint32_t dq_size;	/* RCU defer queue size.
+				 * default: number of tbl8s.
+				 */
+	uint32_t reclaim_thd;	/* Threshold to trigger auto reclaim. */
+	uint32_t reclaim_max;	/* Max entries to reclaim in one go.
+				 * default: RTE_FIB_RCU_DQ_RECLAIM_MAX.
+				 */
+};
+
+/** Route update for rte_fib_update_bulk() */
+struct rte_fib_route_update {
+	uint32_t ip;		/**< IPv4 prefix address */
+	uint8_t depth;		/**< Prefix length */
+	uint8_t op;		/**< RTE_FIB_ADD or RTE_FIB_DEL */
+	uint64_t next_hop;	/**< Next hop, ignored on delete */
+};
+
+/** Route for the bulk build of a FIB */
+struct rte_fib_route {
+	uint32_t ip;		/**< IPv4 prefix address */
+	uint8_t depth;		/**< Prefix length */
+	uint64_t next_hop;	/**< Next hop */
+};
+
 /**
  * Create FIB
  *
@@ -160,6 +203,125 @@ rte_fib_add(struct rte_fib *fib, uint32_t ip, uint8_t depth, uint64_t next_hop);
 int
 rte_fib_delete(struct rte_fib *fib, uint32_t ip, uint8_t depth);
 
+/**
+ * Apply a batch of route updates to the FIB.
+ *
+ * With a blocking mode RCU QSBR variable associated, the tbl8 groups
+ * freed by the whole batch are reclaimed after a single grace period,
+ * or earlier if the batch runs out of tbl8 groups.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param upd
+ *   Array of route updates, applied in order
+ * @param n
+ *   Number of route updates
+ * @return
+ *   Number of route updates applied. Processing stops at the first
+ *   failed update, its error code is returned in rte_errno.
+ */
+__rte_experimental
+unsigned int
+rte_fib_update_bulk(struct rte_fib *fib,
+	const struct rte_fib_route_update *upd, unsigned int n);
+
+/**
+ * Start the bulk build of an empty FIB.
+ *
+ * The routes are sorted and inserted into the RIB, the dataplane
+ * struct is then filled in one ordered pass per /8 range by
+ * rte_fib_build_range(), which can run on several lcores in parallel
+ * for disjoint ranges. The build is completed by rte_fib_build_finish().
+ * The FIB must not be modified in between.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param routes
+ *   Array of routes, in any order. If a prefix is present more than
+ *   once, the last next hop is used.
+ * @param n
+ *   Number of routes
+ * @return
+ *   0 on success, negative value otherwise:
+ *   -EINVAL for incorrect arguments
+ *   -EEXIST if the FIB is not empty
+ *   -EBUSY if a build is already in progress
+ *   -ENOSPC if there is not enough RIB nodes or tbl8 groups
+ *   -ENOMEM if the memory allocation failed
+ */
+__rte_experimental
+int
+rte_fib_build_start(struct rte_fib *fib, const struct rte_fib_route *routes,
+	unsigned int n);
+
+/**
+ * Fill the dataplane struct of a FIB being built for a range of /8.
+ *
+ * Each /8 range must be filled exactly once before rte_fib_build_finish().
+ * Lookups in the range return the default next hop until it is filled.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param first
+ *   First /8 of the range, i.e. the first byte of its addresses
+ * @param last
+ *   Last /8 of the range
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments or if no build is
+ *   in progress
+ */
+__rte_experimental
+int
+rte_fib_build_range(struct rte_fib *fib, uint8_t first, uint8_t last);
+
+/**
+ * Complete the bulk build of a FIB, when all the /8 ranges are filled.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments or if no build is
+ *   in progress
+ */
+__rte_experimental
+int
+rte_fib_build_finish(struct rte_fib *fib);
+
+/**
+ * Build an empty FIB from a set of routes on the calling lcore.
+ *
+ * Same as rte_fib_build_start(), then rte_fib_build_range() for all
+ * the /8 ranges and rte_fib_build_finish().
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param routes
+ *   Array of routes, in any order
+ * @param n
+ *   Number of routes
+ * @return
+ *   0 on success, negative value otherwise, see rte_fib_build_start()
+ */
+__rte_experimental
+int
+rte_fib_build(struct rte_fib *fib, const struct rte_fib_route *routes,
+	unsigned int n);
+
 /**
  * Lookup multiple IP addresses in the FIB.
  *
@@ -219,6 +381,83 @@ rte_fib_get_rib(struct rte_fib *fib);
 int
 rte_fib_select_lookup(struct rte_fib *fib, enum rte_fib_lookup_type type);
 
+/**
+ * Associate RCU QSBR variable with a FIB object.
+ *
+ * The tbl8 groups released by route updates are then only reused once
+ * the lookup threads reporting quiescent state on the variable
+ * cannot use them anymore.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EEXIST if a variable is already associated,
+ *   -ENOTSUP if the FIB type does not use tbl8 groups,
+ *   other negative values on defer queue creation failure.
+ */
+__rte_experimental
+int
+rte_fib_rcu_qsbr_add(struct rte_fib *fib, struct rte_fib_rcu_config *cfg);
+
+/**
+ * Save a FIB to a file.
+ *
+ * The file holds the configuration of the FIB, its built dataplane
+ * tables and its RIB, so that rte_fib_load() restores it without
+ * rebuilding the tables. It can only be loaded by the same DPDK version
+ * on the same architecture. The FIB must not be updated meanwhile.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param path
+ *   Path of the file to write
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EBUSY if a bulk build is in progress,
+ *   other negative errno values if the file cannot be written.
+ */
+__rte_experimental
+int
+rte_fib_save(struct rte_fib *fib, const char *path);
+
+/**
+ * Create a FIB from a file written by rte_fib_save().
+ *
+ * The dataplane tables are read straight into the tables of the new FIB,
+ * then the RIB nodes are relinked in the order they were saved.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param name
+ *   FIB name
+ * @param socket_id
+ *   NUMA socket ID for FIB table memory allocation
+ * @param path
+ *   Path of the file to read
+ * @return
+ *   Handle to the FIB object on success
+ *   NULL otherwise with rte_errno set to an appropriate values:
+ *   - EINVAL - invalid argument or file
+ *   - EEXIST - a FIB with the same name already exists
+ *   - ENOMEM - not enough memory
+ *   - other errno values if the file cannot be read
+ */
+__rte_experimental
+struct rte_fib *
+rte_fib_load(const char *name, int socket_id, const char *path);
+
 #ifdef __cplusplus
 }
 #endif
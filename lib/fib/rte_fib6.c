@@ -3,7 +3,9 @@
  * Copyright(c) 2019 Intel Corporation
  */
 
+#include <errno.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <rte_eal.h>
@@ -18,6 +20,7 @@
 #include <rte_fib6.h>
 
 #include "trie.h"
+#include "poptrie.h"
 
 TAILQ_HEAD(rte_fib6_list, rte_tailq_entry);
 static struct rte_tailq_elem rte_fib6_tailq = {
@@ -45,6 +48,23 @@ struct rte_fib6 {
 	rte_fib6_lookup_fn_t	lookup;	/**< fib lookup function */
 	rte_fib6_modify_fn_t	modify; /**< modify fib datastruct */
 	uint64_t		def_nh;
+	struct rte_fib6_conf	conf;	/**< creation parameters */
+	/** sorted routes of a bulk build in progress */
+	struct rte_fib6_route	*build_routes;
+	int			in_build;
+};
+
+/* Bytes of the sort key of a route: the prefix length and the address */
+#define BUILD_SORT_DIGITS	(RTE_FIB6_IPV6_ADDR_SIZE + 1)
+
+/* File written by rte_fib6_save(): header, dataplane tables and RIB */
+#define FIB6_FILE_MAGIC		0x36424946	/* "FIB6" */
+#define FIB6_FILE_VERSION	1
+
+struct fib6_file_hdr {
+	uint32_t		magic;
+	uint32_t		version;
+	struct rte_fib6_conf	conf;
 };
 
 static void
@@ -110,6 +130,14 @@ init_dataplane(struct rte_fib6 *fib, __rte_unused int socket_id,
 		fib->lookup = trie_get_lookup_fn(fib->dp, RTE_FIB6_LOOKUP_DEFAULT);
 		fib->modify = trie_modify;
 		return 0;
+	case RTE_FIB6_POPTRIE:
+		fib->dp = poptrie_create(dp_name, socket_id, conf);
+		if (fib->dp == NULL)
+			return -rte_errno;
+		fib->lookup = poptrie_get_lookup_fn(fib->dp,
+			RTE_FIB6_LOOKUP_DEFAULT);
+		fib->modify = poptrie_modify;
+		return 0;
 	default:
 		return -EINVAL;
 	}
@@ -136,6 +164,216 @@ rte_fib6_delete(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	return fib->modify(fib, ip, depth, 0, RTE_FIB6_DEL);
 }
 
+unsigned int
+rte_fib6_update_bulk(struct rte_fib6 *fib,
+	const struct rte_fib6_route_update *upd, unsigned int n)
+{
+	unsigned int i;
+	int ret = 0;
+
+	if ((fib == NULL) || (fib->modify == NULL) ||
+			((upd == NULL) && (n != 0))) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	if (fib->type == RTE_FIB6_TRIE)
+		trie_bulk_begin(fib->dp);
+	else if (fib->type == RTE_FIB6_POPTRIE)
+		poptrie_bulk_begin(fib->dp);
+	for (i = 0; i < n; i++) {
+		ret = fib->modify(fib, upd[i].ip, upd[i].depth,
+			upd[i].next_hop, upd[i].op);
+		if (ret != 0)
+			break;
+	}
+	if (fib->type == RTE_FIB6_TRIE)
+		trie_bulk_end(fib->dp);
+	else if (fib->type == RTE_FIB6_POPTRIE)
+		poptrie_bulk_end(fib->dp);
+
+	if (ret != 0)
+		rte_errno = -ret;
+	return i;
+}
+
+static inline uint8_t
+build_sort_digit(const struct rte_fib6_route *rt, int d)
+{
+	return (d == 0) ? rt->depth : rt->ip[RTE_FIB6_IPV6_ADDR_SIZE - d];
+}
+
+/*
+ * Sort the routes by prefix with a stable LSD radix sort, so the routes
+ * with the same prefix stay in the input order. A byte with the same
+ * value in all the routes is skipped. Return the sorted buffer.
+ */
+static struct rte_fib6_route *
+build_sort(struct rte_fib6_route *routes, struct rte_fib6_route *tmp,
+	unsigned int n)
+{
+	uint32_t cnt[BUILD_SORT_DIGITS][UINT8_MAX + 1];
+	struct rte_fib6_route *swap;
+	uint32_t i, pos, sum;
+	int d;
+
+	memset(cnt, 0, sizeof(cnt));
+	for (i = 0; i < n; i++)
+		for (d = 0; d < BUILD_SORT_DIGITS; d++)
+			cnt[d][build_sort_digit(&routes[i], d)]++;
+
+	for (d = 0; d < BUILD_SORT_DIGITS; d++) {
+		if ((n == 0) ||
+				(cnt[d][build_sort_digit(&routes[0], d)] == n))
+			continue;
+		for (i = 0, sum = 0; i <= UINT8_MAX; i++) {
+			pos = sum;
+			sum += cnt[d][i];
+			cnt[d][i] = pos;
+		}
+		for (i = 0; i < n; i++)
+			tmp[cnt[d][build_sort_digit(&routes[i], d)]++] =
+				routes[i];
+		swap = routes;
+		routes = tmp;
+		tmp = swap;
+	}
+	return routes;
+}
+
+static void
+build_rib_remove(struct rte_fib6 *fib, const struct rte_fib6_route *routes,
+	unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		rte_rib6_remove(fib->rib, routes[i].ip, routes[i].depth);
+}
+
+int
+rte_fib6_build_start(struct rte_fib6 *fib,
+	const struct rte_fib6_route *routes, unsigned int n)
+{
+	static const uint8_t zero_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	struct rte_fib6_route *buf, *tmp, *sorted;
+	struct rte_rib6_node *node;
+	unsigned int i, j, nb = 0;
+	int ret = 0;
+
+	if ((fib == NULL) || ((routes == NULL) && (n != 0)))
+		return -EINVAL;
+	if (fib->in_build)
+		return -EBUSY;
+	if ((rte_rib6_lookup_exact(fib->rib, zero_ip, 0) != NULL) ||
+			(rte_rib6_get_nxt(fib->rib, zero_ip, 0, NULL,
+			RTE_RIB6_GET_NXT_ALL) != NULL))
+		return -EEXIST;
+
+	buf = rte_malloc(NULL, sizeof(*buf) * RTE_MAX(n, 1U), 0);
+	tmp = rte_malloc(NULL, sizeof(*tmp) * RTE_MAX(n, 1U), 0);
+	if ((buf == NULL) || (tmp == NULL)) {
+		ret = -ENOMEM;
+		goto free;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (routes[i].depth > RTE_FIB6_MAXDEPTH) {
+			ret = -EINVAL;
+			goto free;
+		}
+		buf[i] = routes[i];
+		for (j = 0; j < RTE_FIB6_IPV6_ADDR_SIZE; j++)
+			buf[i].ip[j] &= get_msk_part(routes[i].depth, j);
+	}
+	sorted = build_sort(buf, tmp, n);
+	if (sorted != buf) {
+		tmp = buf;
+		buf = sorted;
+	}
+	/* the last next hop of a prefix wins as with rte_fib6_add() */
+	for (i = 0; i < n; i++) {
+		if ((i + 1 < n) && (buf[i].depth == buf[i + 1].depth) &&
+				rte_rib6_is_equal(buf[i].ip, buf[i + 1].ip))
+			continue;
+		buf[nb++] = buf[i];
+	}
+
+	for (i = 0; i < nb; i++) {
+		node = rte_rib6_insert(fib->rib, buf[i].ip,
+			buf[i].depth);
+		if (node == NULL) {
+			ret = -rte_errno;
+			build_rib_remove(fib, buf, i);
+			goto free;
+		}
+		rte_rib6_set_nh(node, buf[i].next_hop);
+	}
+
+	if (fib->type == RTE_FIB6_TRIE) {
+		ret = trie_build_start(fib->dp, buf, nb);
+		if (ret != 0) {
+			build_rib_remove(fib, buf, nb);
+			goto free;
+		}
+	} else if (fib->type == RTE_FIB6_POPTRIE) {
+		/* single threaded, the ranges have nothing left to fill */
+		ret = poptrie_build(fib->dp, fib->rib);
+		if (ret != 0) {
+			build_rib_remove(fib, buf, nb);
+			goto free;
+		}
+	}
+
+	rte_free(tmp);
+	fib->build_routes = buf;
+	fib->in_build = 1;
+	return 0;
+
+free:
+	rte_free(buf);
+	rte_free(tmp);
+	return ret;
+}
+
+int
+rte_fib6_build_range(struct rte_fib6 *fib, uint8_t first, uint8_t last)
+{
+	if ((fib == NULL) || (!fib->in_build) || (first > last))
+		return -EINVAL;
+
+	if (fib->type == RTE_FIB6_TRIE)
+		trie_build_range(fib->dp, first, last);
+	return 0;
+}
+
+int
+rte_fib6_build_finish(struct rte_fib6 *fib)
+{
+	if ((fib == NULL) || (!fib->in_build))
+		return -EINVAL;
+
+	if (fib->type == RTE_FIB6_TRIE)
+		trie_build_finish(fib->dp);
+	rte_free(fib->build_routes);
+	fib->build_routes = NULL;
+	fib->in_build = 0;
+	return 0;
+}
+
+int
+rte_fib6_build(struct rte_fib6 *fib, const struct rte_fib6_route *routes,
+	unsigned int n)
+{
+	int ret;
+
+	ret = rte_fib6_build_start(fib, routes, n);
+	if (ret != 0)
+		return ret;
+	rte_fib6_build_range(fib, 0, UINT8_MAX);
+	return rte_fib6_build_finish(fib);
+}
+
 int
 rte_fib6_lookup_bulk(struct rte_fib6 *fib,
 	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
@@ -160,7 +398,7 @@ rte_fib6_create(const char *name, int socket_id, struct rte_fib6_conf *conf)
 
 	/* Check user arguments. */
 	if ((name == NULL) || (conf == NULL) || (conf->max_routes < 0) ||
-			(conf->type > RTE_FIB6_TRIE)) {
+			(conf->type > RTE_FIB6_POPTRIE)) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
@@ -214,6 +452,7 @@ rte_fib6_create(const char *name, int socket_id, struct rte_fib6_conf *conf)
 	fib->rib = rib;
 	fib->type = conf->type;
 	fib->def_nh = conf->default_nh;
+	fib->conf = *conf;
 	ret = init_dataplane(fib, socket_id, conf);
 	if (ret < 0) {
 		RTE_LOG(ERR, LPM,
@@ -274,6 +513,10 @@ free_dataplane(struct rte_fib6 *fib)
 		return;
 	case RTE_FIB6_TRIE:
 		trie_free(fib->dp);
+		return;
+	case RTE_FIB6_POPTRIE:
+		poptrie_free(fib->dp);
+		return;
 	default:
 		return;
 	}
@@ -303,6 +546,7 @@ rte_fib6_free(struct rte_fib6 *fib)
 	rte_mcfg_tailq_write_unlock();
 
 	free_dataplane(fib);
+	rte_free(fib->build_routes);
 	rte_rib6_free(fib->rib);
 	rte_free(fib);
 	rte_free(te);
@@ -333,7 +577,146 @@ rte_fib6_select_lookup(struct rte_fib6 *fib,
 			return -EINVAL;
 		fib->lookup = fn;
 		return 0;
+	case RTE_FIB6_POPTRIE:
+		fn = poptrie_get_lookup_fn(fib->dp, type);
+		if (fn == NULL)
+			return -EINVAL;
+		fib->lookup = fn;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+int
+rte_fib6_rcu_qsbr_add(struct rte_fib6 *fib, struct rte_fib6_rcu_config *cfg)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	case RTE_FIB6_POPTRIE:
+		return poptrie_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static int
+save_dataplane(struct rte_fib6 *fib, FILE *f)
+{
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_save(fib->dp, f);
+	case RTE_FIB6_POPTRIE:
+		return poptrie_save(fib->dp, f);
+	default:
+		return 0;
+	}
+}
+
+static int
+load_dataplane(struct rte_fib6 *fib, FILE *f)
+{
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_load(fib->dp, f);
+	case RTE_FIB6_POPTRIE:
+		return poptrie_load(fib->dp, f);
 	default:
+		return 0;
+	}
+}
+
+int
+rte_fib6_save(struct rte_fib6 *fib, const char *path)
+{
+	struct fib6_file_hdr hdr;
+	FILE *f;
+	int ret;
+
+	if ((fib == NULL) || (path == NULL))
 		return -EINVAL;
+	if (fib->in_build)
+		return -EBUSY;
+
+	f = fopen(path, "wb");
+	if (f == NULL)
+		return -errno;
+
+	/* the header is written last, so that a partial file is invalid */
+	memset(&hdr, 0, sizeof(hdr));
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+		ret = -EIO;
+		goto exit;
+	}
+	ret = save_dataplane(fib, f);
+	if (ret != 0)
+		goto exit;
+
+	ret = rte_rib6_save(fib->rib, f);
+	if (ret != 0)
+		goto exit;
+
+	hdr.magic = FIB6_FILE_MAGIC;
+	hdr.version = FIB6_FILE_VERSION;
+	hdr.conf = fib->conf;
+	if ((fseek(f, 0, SEEK_SET) != 0) ||
+			(fwrite(&hdr, sizeof(hdr), 1, f) != 1))
+		ret = -EIO;
+exit:
+	if ((fclose(f) != 0) && (ret == 0))
+		ret = -EIO;
+	if (ret != 0)
+		remove(path);
+	return ret;
+}
+
+struct rte_fib6 *
+rte_fib6_load(const char *name, int socket_id, const char *path)
+{
+	struct fib6_file_hdr hdr;
+	struct rte_fib6 *fib = NULL;
+	int ret = 0;
+	FILE *f;
+
+	if ((name == NULL) || (path == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		rte_errno = errno;
+		return NULL;
 	}
+	if ((fread(&hdr, sizeof(hdr), 1, f) != 1) ||
+			(hdr.magic != FIB6_FILE_MAGIC) ||
+			(hdr.version != FIB6_FILE_VERSION)) {
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	fib = rte_fib6_create(name, socket_id, &hdr.conf);
+	if (fib == NULL) {
+		ret = -rte_errno;
+		goto exit;
+	}
+	/* lookups are right once the tables are read */
+	ret = load_dataplane(fib, f);
+	if (ret != 0)
+		goto exit;
+
+	ret = rte_rib6_load(fib->rib, f);
+
+exit:
+	fclose(f);
+	if (ret != 0) {
+		rte_fib6_free(fib);
+		rte_errno = -ret;
+		return NULL;
+	}
+	return fib;
 }
@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <rte_compat.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,7 +34,13 @@ struct rte_rib6;
 /** Type of FIB struct */
 enum rte_fib6_type {
 	RTE_FIB6_DUMMY,		/**< RIB6 tree based FIB */
-	RTE_FIB6_TRIE		/**< TRIE based fib  */
+	RTE_FIB6_TRIE,		/**< TRIE based fib  */
+	/**
+	 * Compressed TRIE based fib, a few hundred bytes per route instead
+	 * of the large tables of RTE_FIB6_TRIE, at the cost of a lookup
+	 * about twice as slow for long prefixes, which take more levels.
+	 */
+	RTE_FIB6_POPTRIE
 };
 
 /** Modify FIB function */
@@ -50,7 +57,18 @@ enum rte_fib6_op {
 	RTE_FIB6_DEL,
 };
 
-/** Size of nexthop (1 << nh_sz) bits for TRIE based FIB */
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_FIB6_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_fib6_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_FIB6_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_FIB6_QSBR_MODE_SYNC
+};
+
+/** Size of nexthop (1 << nh_sz) bits for TRIE and POPTRIE based FIB */
 enum rte_fib_trie_nh_sz {
 	RTE_FIB6_TRIE_2B = 1,
 	RTE_FIB6_TRIE_4B,
@@ -62,7 +80,11 @@ enum rte_fib6_lookup_type {
 	RTE_FIB6_LOOKUP_DEFAULT,
 	/**< Selects the best implementation based on the max simd bitwidth */
 	RTE_FIB6_LOOKUP_TRIE_SCALAR, /**< Scalar lookup function implementation*/
-	RTE_FIB6_LOOKUP_TRIE_VECTOR_AVX512 /**< Vector implementation using AVX512 */
+	RTE_FIB6_LOOKUP_TRIE_VECTOR_AVX512, /**< Vector implementation using AVX512 */
+	/** Scalar POPTRIE lookup function implementation */
+	RTE_FIB6_LOOKUP_POPTRIE_SCALAR,
+	/** Vector POPTRIE implementation using AVX512 */
+	RTE_FIB6_LOOKUP_POPTRIE_VECTOR_AVX512
 };
 
 /** FIB configuration structure */
@@ -76,9 +98,47 @@ struct rte_fib6_conf {
 			enum rte_fib_trie_nh_sz nh_sz;
 			uint32_t	num_tbl8;
 		} trie;
+		struct {
+			enum rte_fib_trie_nh_sz nh_sz;
+			/** Number of trie nodes */
+			uint32_t	num_nodes;
+			/** Number of leaves, each holding a next hop */
+			uint32_t	num_leaves;
+		} poptrie;
 	};
 };
 
+/** FIB RCU QSBR configuration structure. */
+struct rte_fib6_rcu_config {
+	struct rte_rcu_qsbr *v;	/* RCU QSBR variable. */
+	/* Mode of RCU QSBR. RTE_FIB6_QSBR_MODE_xxx
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_fib6_qsbr_mode mode;
+	uint32_t dq_size;	/* RCU defer queue size.
+				 * default: number of tbl8s.
+				 */
+	uint32_t reclaim_thd;	/* Threshold to trigger auto reclaim. */
+	uint32_t reclaim_max;	/* Max entries to reclaim in one go.
+				 * default: RTE_FIB6_RCU_DQ_RECLAIM_MAX.
+				 */
+};
+
+/** Route update for rte_fib6_update_bulk() */
+struct rte_fib6_route_update {
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE];	/**< IPv6 prefix address */
+	uint8_t depth;		/**< Prefix length */
+	uint8_t op;		/**< RTE_FIB6_ADD or RTE_FIB6_DEL */
+	uint64_t next_hop;	/**< Next hop, ignored on delete */
+};
+
+/** Route for the bulk build of a FIB */
+struct rte_fib6_route {
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE];	/**< IPv6 prefix address */
+	uint8_t depth;		/**< Prefix length */
+	uint64_t next_hop;	/**< Next hop */
+};
+
 /**
  * Create FIB
  *
@@ -153,6 +213,126 @@ int
 rte_fib6_delete(struct rte_fib6 *fib,
 	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth);
 
+/**
+ * Apply a batch of route updates to the FIB.
+ *
+ * With a blocking mode RCU QSBR variable associated, the tbl8 groups
+ * freed by the whole batch are reclaimed after a single grace period,
+ * or earlier if the batch runs out of tbl8 groups.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param upd
+ *   Array of route updates, applied in order
+ * @param n
+ *   Number of route updates
+ * @return
+ *   Number of route updates applied. Processing stops at the first
+ *   failed update, its error code is returned in rte_errno.
+ */
+__rte_experimental
+unsigned int
+rte_fib6_update_bulk(struct rte_fib6 *fib,
+	const struct rte_fib6_route_update *upd, unsigned int n);
+
+/**
+ * Start the bulk build of an empty FIB.
+ *
+ * The routes are sorted and inserted into the RIB, the dataplane
+ * struct is then filled in one ordered pass per /8 range by
+ * rte_fib6_build_range(), which can run on several lcores in parallel
+ * for disjoint ranges. The build is completed by rte_fib6_build_finish().
+ * The FIB must not be modified in between. A RTE_FIB6_POPTRIE FIB is
+ * entirely built by rte_fib6_build_start().
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param routes
+ *   Array of routes, in any order. If a prefix is present more than
+ *   once, the last next hop is used.
+ * @param n
+ *   Number of routes
+ * @return
+ *   0 on success, negative value otherwise:
+ *   -EINVAL for incorrect arguments
+ *   -EEXIST if the FIB is not empty
+ *   -EBUSY if a build is already in progress
+ *   -ENOSPC if there is not enough RIB nodes or tbl8 groups
+ *   -ENOMEM if the memory allocation failed
+ */
+__rte_experimental
+int
+rte_fib6_build_start(struct rte_fib6 *fib,
+	const struct rte_fib6_route *routes, unsigned int n);
+
+/**
+ * Fill the dataplane struct of a FIB being built for a range of /8.
+ *
+ * Each /8 range must be filled exactly once before rte_fib6_build_finish().
+ * Lookups in the range return the default next hop until it is filled.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param first
+ *   First /8 of the range, i.e. the first byte of its addresses
+ * @param last
+ *   Last /8 of the range
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments or if no build is
+ *   in progress
+ */
+__rte_experimental
+int
+rte_fib6_build_range(struct rte_fib6 *fib, uint8_t first, uint8_t last);
+
+/**
+ * Complete the bulk build of a FIB, when all the /8 ranges are filled.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments or if no build is
+ *   in progress
+ */
+__rte_experimental
+int
+rte_fib6_build_finish(struct rte_fib6 *fib);
+
+/**
+ * Build an empty FIB from a set of routes on the calling lcore.
+ *
+ * Same as rte_fib6_build_start(), then rte_fib6_build_range() for all
+ * the /8 ranges and rte_fib6_build_finish().
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param routes
+ *   Array of routes, in any order
+ * @param n
+ *   Number of routes
+ * @return
+ *   0 on success, negative value otherwise, see rte_fib6_build_start()
+ */
+__rte_experimental
+int
+rte_fib6_build(struct rte_fib6 *fib, const struct rte_fib6_route *routes,
+	unsigned int n);
+
 /**
  * Lookup multiple IP addresses in the FIB.
  *
@@ -214,6 +394,83 @@ rte_fib6_get_rib(struct rte_fib6 *fib);
 int
 rte_fib6_select_lookup(struct rte_fib6 *fib, enum rte_fib6_lookup_type type);
 
+/**
+ * Associate RCU QSBR variable with a FIB object.
+ *
+ * The tbl8 groups, or the POPTRIE nodes and leaves, released by route
+ * updates are then only reused once the lookup threads reporting
+ * quiescent state on the variable cannot use them anymore.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EEXIST if a variable is already associated,
+ *   -ENOTSUP for the dummy FIB type,
+ *   other negative values on defer queue creation failure.
+ */
+__rte_experimental
+int
+rte_fib6_rcu_qsbr_add(struct rte_fib6 *fib, struct rte_fib6_rcu_config *cfg);
+
+/**
+ * Save a FIB to a file.
+ *
+ * The file holds the configuration of the FIB, its built dataplane
+ * tables and its RIB, so that rte_fib6_load() restores it without
+ * rebuilding the tables. It can only be loaded by the same DPDK version
+ * on the same architecture. The FIB must not be updated meanwhile.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param path
+ *   Path of the file to write
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EBUSY if a bulk build is in progress,
+ *   other negative errno values if the file cannot be written.
+ */
+__rte_experimental
+int
+rte_fib6_save(struct rte_fib6 *fib, const char *path);
+
+/**
+ * Create a FIB from a file written by rte_fib6_save().
+ *
+ * The dataplane tables are read straight into the tables of the new FIB,
+ * then the RIB nodes are relinked in the order they were saved.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param name
+ *   FIB name
+ * @param socket_id
+ *   NUMA socket ID for FIB table memory allocation
+ * @param path
+ *   Path of the file to read
+ * @return
+ *   Handle to the FIB object on success
+ *   NULL otherwise with rte_errno set to an appropriate values:
+ *   - EINVAL - invalid argument or file
+ *   - EEXIST - a FIB with the same name already exists
+ *   - ENOMEM - not enough memory
+ *   - other errno values if the file cannot be read
+ */
+__rte_experimental
+struct rte_fib6 *
+rte_fib6_load(const char *name, int socket_id, const char *path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,244 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_rwlock.h>
+#include <rte_string_fns.h>
+#include <rte_tailq.h>
+
+#include <rte_rib6.h>
+#include <rte_fib.h>
+#include <rte_fib_vrf.h>
+
+#include "dir24_8_vrf.h"
+
+TAILQ_HEAD(rte_fib_vrf_list, rte_tailq_entry);
+static struct rte_tailq_elem rte_fib_vrf_tailq = {
+	.name = "RTE_FIB_VRF",
+};
+EAL_REGISTER_TAILQ(rte_fib_vrf_tailq)
+
+/* Maximum length of a multi-VRF FIB name. */
+#define FIB_VRF_NAMESIZE	64
+
+#if defined(RTE_LIBRTE_FIB_DEBUG)
+#define FIB_RETURN_IF_TRUE(cond, retval) do {		\
+	if (cond)					\
+		return retval;				\
+} while (0)
+#else
+#define FIB_RETURN_IF_TRUE(cond, retval)
+#endif
+
+struct rte_fib_vrf {
+	char			name[FIB_VRF_NAMESIZE];
+	struct rte_rib6		*rib;	/**< routes of all the VRFs */
+	void			*dp;	/**< pointer to the dataplane struct*/
+	rte_fib_vrf_lookup_fn_t	lookup;	/**< fib lookup function */
+};
+
+int
+rte_fib_vrf_add(struct rte_fib_vrf *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+	return dir24_8_vrf_modify(fib->dp, fib->rib, vrf_id, ip, depth,
+		next_hop, RTE_FIB_ADD);
+}
+
+int
+rte_fib_vrf_delete(struct rte_fib_vrf *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth)
+{
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+	return dir24_8_vrf_modify(fib->dp, fib->rib, vrf_id, ip, depth, 0,
+		RTE_FIB_DEL);
+}
+
+int
+rte_fib_vrf_lookup_bulk(struct rte_fib_vrf *fib, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, int n)
+{
+	FIB_RETURN_IF_TRUE(((fib == NULL) || (vrf_ids == NULL) ||
+		(ips == NULL) || (next_hops == NULL) ||
+		(fib->lookup == NULL)), -EINVAL);
+
+	fib->lookup(fib->dp, vrf_ids, ips, next_hops, n);
+	return 0;
+}
+
+int
+rte_fib_vrf_rcu_qsbr_add(struct rte_fib_vrf *fib,
+	struct rte_fib_rcu_config *cfg)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	return dir24_8_vrf_rcu_qsbr_add(fib->dp, cfg, fib->name);
+}
+
+int
+rte_fib_vrf_get_stats(struct rte_fib_vrf *fib,
+	struct rte_fib_vrf_stats *stats)
+{
+	if ((fib == NULL) || (stats == NULL))
+		return -EINVAL;
+
+	dir24_8_vrf_get_stats(fib->dp, stats);
+	return 0;
+}
+
+struct rte_fib_vrf *
+rte_fib_vrf_create(const char *name, int socket_id,
+	const struct rte_fib_vrf_conf *conf)
+{
+	char mem_name[FIB_VRF_NAMESIZE];
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_rib6 *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_fib_vrf_list *fib_list;
+	struct rte_rib6_conf rib_conf;
+
+	/* Check user arguments. */
+	if ((name == NULL) || (conf == NULL) || (conf->max_routes == 0) ||
+			(conf->max_routes > INT32_MAX / 2)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	rib_conf.ext_sz = 0;
+	rib_conf.max_nodes = conf->max_routes * 2;
+
+	rib = rte_rib6_create(name, socket_id, &rib_conf);
+	if (rib == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate RIB %s\n", name);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "FIB_VRF_%s", name);
+	fib_list = RTE_TAILQ_CAST(rte_fib_vrf_tailq.head, rte_fib_vrf_list);
+
+	rte_mcfg_tailq_write_lock();
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, fib_list, next) {
+		fib = (struct rte_fib_vrf *)te->data;
+		if (strncmp(name, fib->name, FIB_VRF_NAMESIZE) == 0)
+			break;
+	}
+	fib = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("FIB_VRF_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate tailq entry for FIB %s\n", name);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	/* Allocate memory to store the FIB data structures. */
+	fib = rte_zmalloc_socket(mem_name,
+		sizeof(struct rte_fib_vrf), RTE_CACHE_LINE_SIZE, socket_id);
+	if (fib == NULL) {
+		RTE_LOG(ERR, LPM, "FIB %s memory allocation failed\n", name);
+		rte_errno = ENOMEM;
+		goto free_te;
+	}
+
+	rte_strlcpy(fib->name, name, sizeof(fib->name));
+	fib->rib = rib;
+	fib->dp = dir24_8_vrf_create(name, socket_id, conf);
+	if (fib->dp == NULL) {
+		RTE_LOG(ERR, LPM,
+			"FIB dataplane struct %s memory allocation failed "
+			"with err %d\n", name, rte_errno);
+		goto free_fib;
+	}
+	fib->lookup = dir24_8_vrf_get_lookup_fn(fib->dp);
+
+	te->data = (void *)fib;
+	TAILQ_INSERT_TAIL(fib_list, te, next);
+
+	rte_mcfg_tailq_write_unlock();
+
+	return fib;
+
+free_fib:
+	rte_free(fib);
+free_te:
+	rte_free(te);
+exit:
+	rte_mcfg_tailq_write_unlock();
+	rte_rib6_free(rib);
+
+	return NULL;
+}
+
+struct rte_fib_vrf *
+rte_fib_vrf_find_existing(const char *name)
+{
+	struct rte_fib_vrf *fib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_fib_vrf_list *fib_list;
+
+	fib_list = RTE_TAILQ_CAST(rte_fib_vrf_tailq.head, rte_fib_vrf_list);
+
+	rte_mcfg_tailq_read_lock();
+	TAILQ_FOREACH(te, fib_list, next) {
+		fib = (struct rte_fib_vrf *) te->data;
+		if (strncmp(name, fib->name, FIB_VRF_NAMESIZE) == 0)
+			break;
+	}
+	rte_mcfg_tailq_read_unlock();
+
+	if (te == NULL) {
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
+	return fib;
+}
+
+void
+rte_fib_vrf_free(struct rte_fib_vrf *fib)
+{
+	struct rte_tailq_entry *te;
+	struct rte_fib_vrf_list *fib_list;
+
+	if (fib == NULL)
+		return;
+
+	fib_list = RTE_TAILQ_CAST(rte_fib_vrf_tailq.head, rte_fib_vrf_list);
+
+	rte_mcfg_tailq_write_lock();
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, fib_list, next) {
+		if (te->data == (void *)fib)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(fib_list, te, next);
+
+	rte_mcfg_tailq_write_unlock();
+
+	dir24_8_vrf_free(fib->dp);
+	rte_rib6_free(fib->rib);
+	rte_free(fib);
+	rte_free(te);
+}
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _RTE_FIB_VRF_H_
+#define _RTE_FIB_VRF_H_
+
+/**
+ * @file
+ *
+ * RTE multi-VRF FIB
+ *
+ * IPv4 Longest Prefix Match for many VRFs (Virtual Routing and
+ * Forwarding instances) in a single object. A small VRF only takes a 256
+ * entries root table, a VRF reaching a number of routes gets its own
+ * DIR24_8 tbl24. The tbl8 groups of all the VRFs come from one pool.
+ *
+ * @warning
+ * @b EXPERIMENTAL:
+ * All functions in this file may be changed or removed without prior notice.
+ */
+
+#include <stdint.h>
+
+#include <rte_compat.h>
+#include <rte_fib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rte_fib_vrf;
+
+/** Maximum number of VRFs of a multi-VRF FIB. */
+#define RTE_FIB_VRF_MAX_VRFS	(UINT16_MAX + 1)
+
+/** Multi-VRF FIB bulk lookup function */
+typedef void (*rte_fib_vrf_lookup_fn_t)(void *dp, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, const unsigned int n);
+
+/** Multi-VRF FIB configuration structure */
+struct rte_fib_vrf_conf {
+	/** Size of the next hop entries */
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	/** Default value returned on lookup if there is no route */
+	uint64_t default_nh;
+	/** Number of VRFs, the VRF ids go from 0 to max_vrfs - 1 */
+	uint32_t max_vrfs;
+	/** Maximum number of routes of all the VRFs */
+	uint32_t max_routes;
+	/** Number of tbl8 groups shared by all the VRFs */
+	uint32_t num_tbl8;
+	/** Maximum number of VRFs with their own tbl24 */
+	uint32_t max_large_vrfs;
+	/**
+	 * Number of routes from which a VRF gets its own tbl24,
+	 * 0 to keep all the VRFs small
+	 */
+	uint32_t large_vrf_routes;
+};
+
+/** Multi-VRF FIB usage */
+struct rte_fib_vrf_stats {
+	uint32_t nb_routes;	/**< Number of routes of all the VRFs */
+	uint32_t nb_large_vrfs;	/**< Number of VRFs with their own tbl24 */
+	uint32_t used_tbl8s;	/**< Number of shared tbl8 groups in use */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a multi-VRF FIB
+ *
+ * @param name
+ *  FIB name
+ * @param socket_id
+ *  NUMA socket ID for FIB table memory allocation
+ * @param conf
+ *  Structure containing the configuration
+ * @return
+ *  Handle to the FIB object on success
+ *  NULL otherwise with rte_errno set to an appropriate values.
+ */
+__rte_experimental
+struct rte_fib_vrf *
+rte_fib_vrf_create(const char *name, int socket_id,
+	const struct rte_fib_vrf_conf *conf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find an existing multi-VRF FIB object and return a pointer to it.
+ *
+ * @param name
+ *  Name of the FIB object as passed to rte_fib_vrf_create()
+ * @return
+ *  Pointer to FIB object or NULL if object not found with rte_errno
+ *  set appropriately. Possible rte_errno values include:
+ *   - ENOENT - required entry not available to return.
+ */
+__rte_experimental
+struct rte_fib_vrf *
+rte_fib_vrf_find_existing(const char *name);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free a multi-VRF FIB object.
+ *
+ * @param fib
+ *   FIB object handle
+ */
+__rte_experimental
+void
+rte_fib_vrf_free(struct rte_fib_vrf *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add a route to a VRF of the FIB.
+ *
+ * A small VRF gets its own tbl24 when its number of routes reaches
+ * large_vrf_routes, if less than max_large_vrfs VRFs have one.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_id
+ *   VRF of the route
+ * @param ip
+ *   IPv4 prefix address to be added to the FIB
+ * @param depth
+ *   Prefix length
+ * @param next_hop
+ *   Next hop to be added to the FIB
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_vrf_add(struct rte_fib_vrf *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth, uint64_t next_hop);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete a route from a VRF of the FIB.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_id
+ *   VRF of the route
+ * @param ip
+ *   IPv4 prefix address to be deleted from the FIB
+ * @param depth
+ *   Prefix length
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_vrf_delete(struct rte_fib_vrf *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Lookup multiple IP addresses, each in its own VRF.
+ *
+ * The VRF ids are not checked, they must be lower than the max_vrfs
+ * of the FIB configuration.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_ids
+ *   Array of VRF ids, one per IP address
+ * @param ips
+ *   Array of IPs to be looked up in the FIB
+ * @param next_hops
+ *   Next hop of the most specific rule found for IP.
+ *   This is an array of eight byte values.
+ *   If the lookup for the given IP failed, then corresponding element would
+ *   contain default nexthop value configured for a FIB.
+ * @param n
+ *   Number of elements in ips (and next_hops) array to lookup.
+ *  @return
+ *   -EINVAL for incorrect arguments, otherwise 0
+ */
+__rte_experimental
+int
+rte_fib_vrf_lookup_bulk(struct rte_fib_vrf *fib, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, int n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Associate RCU QSBR variable with a multi-VRF FIB.
+ *
+ * The tbl8 groups released by route updates are then only reused once
+ * the lookup threads reporting quiescent state on the variable
+ * cannot use them anymore. Giving a tbl24 to a VRF also waits for
+ * a grace period before the small root of the VRF is reset.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EEXIST if a variable is already associated,
+ *   other negative values on defer queue creation failure.
+ */
+__rte_experimental
+int
+rte_fib_vrf_rcu_qsbr_add(struct rte_fib_vrf *fib,
+	struct rte_fib_rcu_config *cfg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the usage of a multi-VRF FIB.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param stats
+ *   Filled with the FIB usage
+ * @return
+ *   -EINVAL for incorrect arguments, otherwise 0
+ */
+__rte_experimental
+int
+rte_fib_vrf_get_stats(struct rte_fib_vrf *fib,
+	struct rte_fib_vrf_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_FIB_VRF_H_ */
@@ -27,6 +27,11 @@
 
 #define TRIE_NAMESIZE		64
 
+/* Number of /8 ranges of a bulk build */
+#define BUILD_NB_RANGES		256
+/* Routes covering a child of a block: one per prefix length and the block */
+#define BUILD_MAX_COVERS	17
+
 enum edge {
 	LEDGE,
 	REDGE
@@ -155,6 +160,28 @@ tbl8_put(struct rte_trie_tbl *dp, uint32_t tbl8_ind)
 	dp->tbl8_pool[--dp->tbl8_pool_pos] = tbl8_ind;
 }
 
+static void
+tbl8_cleanup_and_free(void *p, uint64_t tbl8_idx)
+{
+	struct rte_trie_tbl *dp = p;
+	uint8_t *ptr = get_tbl_p_by_idx(dp->tbl8,
+		(uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT, dp->nh_sz);
+
+	memset(ptr, 0, TRIE_TBL8_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_put(dp, tbl8_idx);
+}
+
+/*
+ * The tbl8 has been unlinked from its parent, it is cleaned up and freed
+ * once no reader can still be using it.
+ */
+static void
+tbl8_free(struct rte_trie_tbl *dp, uint64_t tbl8_idx)
+{
+	if (fib_rcu_defer(&dp->rcu, tbl8_idx) != 0)
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+}
+
 static int
 tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
 {
@@ -162,6 +189,8 @@ tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
 	uint8_t		*tbl8_ptr;
 
 	tbl8_idx = tbl8_get(dp);
+	if (tbl8_idx == -ENOSPC && fib_rcu_reclaim(&dp->rcu) == 0)
+		tbl8_idx = tbl8_get(dp);
 	if (tbl8_idx < 0)
 		return tbl8_idx;
 	tbl8_ptr = get_tbl_p_by_idx(dp->tbl8,
@@ -169,6 +198,8 @@ tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
 	/*Init tbl8 entries with nexthop from tbl24*/
 	write_to_dp((void *)tbl8_ptr, nh, dp->nh_sz,
 		TRIE_TBL8_GRP_NUM_ENT);
+	/* tbl8 entries must be visible before the entry linking it */
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
 	return tbl8_idx;
 }
 
@@ -193,8 +224,6 @@ tbl8_recycle(struct rte_trie_tbl *dp, void *par, uint64_t tbl8_idx)
 				return;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr16[i] = 0;
 		break;
 	case RTE_FIB6_TRIE_4B:
 		ptr32 = &((uint32_t *)dp->tbl8)[tbl8_idx *
@@ -207,8 +236,6 @@ tbl8_recycle(struct rte_trie_tbl *dp, void *par, uint64_t tbl8_idx)
 				return;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr32[i] = 0;
 		break;
 	case RTE_FIB6_TRIE_8B:
 		ptr64 = &((uint64_t *)dp->tbl8)[tbl8_idx *
@@ -221,11 +248,9 @@ tbl8_recycle(struct rte_trie_tbl *dp, void *par, uint64_t tbl8_idx)
 				return;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr64[i] = 0;
 		break;
 	}
-	tbl8_put(dp, tbl8_idx);
+	tbl8_free(dp, tbl8_idx);
 }
 
 #define BYTE_SIZE	8
@@ -529,12 +554,15 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
 		ip_masked[i] = ip[i] & get_msk_part(depth, i);
 
+	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
 	if (depth > 24) {
 		tmp = rte_rib6_get_nxt(rib, ip_masked,
 			RTE_ALIGN_FLOOR(depth, 8), NULL,
 			RTE_RIB6_GET_NXT_COVER);
 		if (tmp == NULL) {
-			tmp = rte_rib6_lookup(rib, ip);
+			/* on delete the lookup would find the route itself */
+			tmp = (node != NULL) ? rte_rib6_lookup_parent(node) :
+				rte_rib6_lookup(rib, ip);
 			if (tmp != NULL) {
 				rte_rib6_get_depth(tmp, &tmp_depth);
 				parent_depth = RTE_MAX(tmp_depth, 24);
@@ -544,7 +572,6 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 			depth_diff = depth_diff >> 3;
 		}
 	}
-	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
 	switch (op) {
 	case RTE_FIB6_ADD:
 		if (node != NULL) {
@@ -569,14 +596,14 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 		if (parent != NULL) {
 			rte_rib6_get_nh(parent, &par_nh);
 			if (par_nh == next_hop)
-				return 0;
+				goto successfully_added;
 		}
 		ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
 		if (ret != 0) {
 			rte_rib6_remove(rib, ip_masked, depth);
 			return ret;
 		}
-
+successfully_added:
 		dp->rsvd_tbl8s += depth_diff;
 		return 0;
 	case RTE_FIB6_DEL:
@@ -677,7 +704,341 @@ trie_free(void *p)
 {
 	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
 
+	fib_rcu_free(&dp->rcu);
+	rte_free(dp->build);
 	rte_free(dp->tbl8_pool);
 	rte_free(dp->tbl8);
 	rte_free(dp);
 }
+
+int
+trie_rcu_qsbr_add(struct rte_trie_tbl *dp, struct rte_fib6_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (cfg->mode == RTE_FIB6_QSBR_MODE_SYNC)
+		return fib_rcu_qsbr_add(&dp->rcu, cfg->v, NULL,
+			dp->number_tbl8s, tbl8_cleanup_and_free, dp);
+	if (cfg->mode != RTE_FIB6_QSBR_MODE_DQ)
+		return -EINVAL;
+
+	/* Init QSBR defer queue. */
+	snprintf(rcu_dq_name, sizeof(rcu_dq_name), "FIB6_RCU_%s", name);
+	params.name = rcu_dq_name;
+	params.size = cfg->dq_size;
+	params.trigger_reclaim_limit = cfg->reclaim_thd;
+	params.max_reclaim_size = cfg->reclaim_max;
+	if (params.max_reclaim_size == 0)
+		params.max_reclaim_size = RTE_FIB6_RCU_DQ_RECLAIM_MAX;
+	return fib_rcu_qsbr_add(&dp->rcu, cfg->v, &params, dp->number_tbl8s,
+		tbl8_cleanup_and_free, dp);
+}
+
+void
+trie_bulk_begin(struct rte_trie_tbl *dp)
+{
+	fib_rcu_bulk_begin(&dp->rcu);
+}
+
+void
+trie_bulk_end(struct rte_trie_tbl *dp)
+{
+	fib_rcu_bulk_end(&dp->rcu);
+}
+
+/* Bulk build of an empty table, the routes are sorted by prefix */
+struct trie_build {
+	const struct rte_fib6_route *routes;
+	uint32_t	first[BUILD_NB_RANGES + 1];	/* first route of a /8 */
+	uint64_t	cover_nh[BUILD_NB_RANGES];	/* next hop of a /8 */
+	uint32_t	tbl8_base[BUILD_NB_RANGES + 1];	/* first tbl8 of a /8 */
+	uint32_t	tbl8_used[BUILD_NB_RANGES];	/* tbl8s used by a /8 */
+};
+
+static inline uint32_t
+build_child(const uint8_t *ip, uint8_t pfx, uint8_t bits)
+{
+	const uint8_t *p = &ip[pfx / BYTE_SIZE];
+
+	return (bits == 16) ? (p[0] << 8 | p[1]) : p[0];
+}
+
+/* Set the entries of the children [from, to) of a block */
+static void
+build_set(struct rte_trie_tbl *dp, uint64_t *ent, uint32_t tbl24_idx,
+	uint32_t from, uint32_t to, uint64_t val)
+{
+	if (from >= to)
+		return;
+	if (ent == NULL)
+		write_to_dp(get_tbl_p_by_idx(dp->tbl24, tbl24_idx + from,
+			dp->nh_sz), val, dp->nh_sz, to - from);
+	else
+		for (; from < to; from++)
+			ent[from] = val;
+}
+
+static uint64_t
+build_tbl8(struct rte_trie_tbl *dp, struct trie_build *b,
+	uint32_t *tbl8_idx, uint8_t pfx, uint32_t lo, uint32_t hi,
+	uint64_t nh);
+
+/*
+ * Fill the 1 << bits children of a block with a prefix length of pfx
+ * from the routes [lo, hi) inside it in one ordered pass: into the tbl24
+ * for a /8, into ent for a tbl8. The routes covering several children
+ * are stacked over the next hop covering the whole block, the longer
+ * ones of a child are in its tbl8.
+ */
+static void
+build_block(struct rte_trie_tbl *dp, struct trie_build *b,
+	uint32_t *tbl8_idx, uint64_t *ent, uint32_t tbl24_idx, uint8_t pfx,
+	uint8_t bits, uint32_t lo, uint32_t hi, uint64_t nh)
+{
+	const struct rte_fib6_route *rt;
+	uint32_t end[BUILD_MAX_COVERS];
+	uint64_t val[BUILD_MAX_COVERS];
+	uint32_t i, j, c = 0, child;
+	int top = 0;
+
+	end[0] = 1 << bits;
+	val[0] = nh << 1;
+	for (i = lo; i < hi; ) {
+		rt = &b->routes[i];
+		/* the routes up to /8 are in the next hop covering a /8 */
+		if (rt->depth <= pfx) {
+			i++;
+			continue;
+		}
+		child = build_child(rt->ip, pfx, bits);
+		while (end[top] <= child) {
+			build_set(dp, ent, tbl24_idx, c, end[top], val[top]);
+			c = end[top--];
+		}
+		build_set(dp, ent, tbl24_idx, c, child, val[top]);
+		c = child;
+		if (rt->depth <= pfx + bits) {
+			top++;
+			end[top] = child + (1 << (pfx + bits - rt->depth));
+			val[top] = rt->next_hop << 1;
+			i++;
+			continue;
+		}
+		for (j = i + 1; (j < hi) &&
+				(build_child(b->routes[j].ip, pfx, bits) ==
+				child); j++)
+			;
+		build_set(dp, ent, tbl24_idx, child, child + 1,
+			build_tbl8(dp, b, tbl8_idx, pfx + bits, i, j,
+			val[top] >> 1));
+		c = child + 1;
+		i = j;
+	}
+	for (; top >= 0; top--) {
+		build_set(dp, ent, tbl24_idx, c, end[top], val[top]);
+		c = end[top];
+	}
+}
+
+/* Fill a block with longer routes, return the entry of its parent */
+static uint64_t
+build_tbl8(struct rte_trie_tbl *dp, struct trie_build *b,
+	uint32_t *tbl8_idx, uint8_t pfx, uint32_t lo, uint32_t hi,
+	uint64_t nh)
+{
+	uint64_t ent[TRIE_TBL8_GRP_NUM_ENT];
+	uint32_t i, idx;
+
+	build_block(dp, b, tbl8_idx, ent, 0, pfx, BYTE_SIZE, lo, hi, nh);
+	for (i = 1; (i < TRIE_TBL8_GRP_NUM_ENT) && (ent[i] == ent[0]); i++)
+		;
+	if (i == TRIE_TBL8_GRP_NUM_ENT)
+		return ent[0];
+
+	idx = (*tbl8_idx)++;
+	for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
+		write_to_dp(get_tbl_p_by_idx(dp->tbl8,
+			idx * TRIE_TBL8_GRP_NUM_ENT + i, dp->nh_sz),
+			ent[i], dp->nh_sz, 1);
+	/* tbl8 entries must be visible before the entry linking it */
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
+	return ((uint64_t)idx << 1) | TRIE_EXT_ENT;
+}
+
+int
+trie_build_start(struct rte_trie_tbl *dp,
+	const struct rte_fib6_route *routes, uint32_t n)
+{
+	const uint8_t *prev[RTE_FIB6_IPV6_ADDR_SIZE] = { NULL };
+	struct trie_build *b;
+	uint32_t i, k, r, nb;
+
+	/* deleted tbl8s may still be waiting for the readers */
+	while (fib_rcu_reclaim(&dp->rcu) == 0)
+		;
+	if (dp->tbl8_pool_pos != 0)
+		return -EBUSY;
+
+	b = rte_zmalloc(NULL, sizeof(*b), 0);
+	if (b == NULL)
+		return -ENOMEM;
+
+	for (r = 0; r < BUILD_NB_RANGES; r++)
+		b->cover_nh[r] = dp->def_nh;
+	for (i = 0; i < n; i++) {
+		if (routes[i].next_hop > get_max_nh(dp->nh_sz)) {
+			rte_free(b);
+			return -EINVAL;
+		}
+		r = routes[i].ip[0];
+		b->first[r + 1]++;
+		/* a covering route is sorted before the covered ones */
+		if (routes[i].depth <= 8)
+			for (nb = 0; nb < 1U << (8 - routes[i].depth); nb++)
+				b->cover_nh[r + nb] = routes[i].next_hop;
+		/* each prefix of k bytes with longer routes may need a tbl8 */
+		for (k = 3; k * BYTE_SIZE < routes[i].depth; k++) {
+			if ((prev[k] != NULL) &&
+					(memcmp(prev[k], routes[i].ip, k) == 0))
+				continue;
+			prev[k] = routes[i].ip;
+			b->tbl8_base[r + 1]++;
+		}
+	}
+	for (r = 0; r < BUILD_NB_RANGES; r++) {
+		b->first[r + 1] += b->first[r];
+		b->tbl8_base[r + 1] += b->tbl8_base[r];
+	}
+	if (b->tbl8_base[BUILD_NB_RANGES] > dp->number_tbl8s) {
+		rte_free(b);
+		return -ENOSPC;
+	}
+
+	b->routes = routes;
+	dp->build = b;
+	return 0;
+}
+
+void
+trie_build_range(struct rte_trie_tbl *dp, uint8_t first, uint8_t last)
+{
+	struct trie_build *b = dp->build;
+	uint32_t r, tbl8_idx;
+
+	/* each /8 has its own range of tbl8s */
+	for (r = first; r <= last; r++) {
+		tbl8_idx = b->tbl8_base[r];
+		build_block(dp, b, &tbl8_idx, NULL, r << 16, 8, 16,
+			b->first[r], b->first[r + 1], b->cover_nh[r]);
+		b->tbl8_used[r] = tbl8_idx - b->tbl8_base[r];
+	}
+}
+
+void
+trie_build_finish(struct rte_trie_tbl *dp)
+{
+	struct trie_build *b = dp->build;
+	uint32_t i, r, pos = 0;
+
+	/* the used tbl8s are out of the pool, the others follow */
+	for (r = 0; r < BUILD_NB_RANGES; r++)
+		for (i = b->tbl8_base[r]; i < b->tbl8_base[r] +
+				b->tbl8_used[r]; i++)
+			dp->tbl8_pool[pos++] = i;
+	dp->tbl8_pool_pos = pos;
+	for (r = 0; r < BUILD_NB_RANGES; r++)
+		for (i = b->tbl8_base[r] + b->tbl8_used[r];
+				i < b->tbl8_base[r + 1]; i++)
+			dp->tbl8_pool[pos++] = i;
+	for (i = b->tbl8_base[BUILD_NB_RANGES]; i < dp->number_tbl8s; i++)
+		dp->tbl8_pool[pos++] = i;
+	dp->rsvd_tbl8s = b->tbl8_base[BUILD_NB_RANGES];
+
+	rte_free(b);
+	dp->build = NULL;
+}
+
+/* Dataplane part of a file written by rte_fib6_save() */
+struct trie_file_hdr {
+	uint32_t	nb_tbl8s;	/* number of tbl8s in the file */
+	uint32_t	rsvd_tbl8s;
+	uint32_t	tbl8_pool_pos;
+};
+
+int
+trie_save(struct rte_trie_tbl *dp, FILE *f)
+{
+	struct trie_file_hdr hdr;
+	uint64_t *free_msk;
+	size_t sz;
+	uint32_t i;
+
+	/* deleted tbl8s may still be waiting for the readers */
+	while (fib_rcu_reclaim(&dp->rcu) == 0)
+		;
+
+	/* the tbl8s are saved up to the last one out of the pool */
+	free_msk = rte_zmalloc(NULL, RTE_ALIGN_CEIL(dp->number_tbl8s,
+		BITMAP_SLAB_BIT_SIZE) >> 3, 0);
+	if (free_msk == NULL)
+		return -ENOMEM;
+	for (i = dp->tbl8_pool_pos; i < dp->number_tbl8s; i++)
+		free_msk[dp->tbl8_pool[i] >> BITMAP_SLAB_BIT_SIZE_LOG2] |=
+			1ULL << (dp->tbl8_pool[i] & BITMAP_SLAB_BITMASK);
+	for (i = dp->number_tbl8s; (i > 0) &&
+			(free_msk[(i - 1) >> BITMAP_SLAB_BIT_SIZE_LOG2] &
+			(1ULL << ((i - 1) & BITMAP_SLAB_BITMASK))); i--)
+		;
+	rte_free(free_msk);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.nb_tbl8s = i;
+	hdr.rsvd_tbl8s = dp->rsvd_tbl8s;
+	hdr.tbl8_pool_pos = dp->tbl8_pool_pos;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EIO;
+	sz = (size_t)TRIE_TBL24_NUM_ENT << dp->nh_sz;
+	if (fwrite(dp->tbl24, 1, sz, f) != sz)
+		return -EIO;
+	sz = ((size_t)hdr.nb_tbl8s * TRIE_TBL8_GRP_NUM_ENT) << dp->nh_sz;
+	if (fwrite(dp->tbl8, 1, sz, f) != sz)
+		return -EIO;
+	sz = sizeof(uint32_t) * dp->number_tbl8s;
+	if (fwrite(dp->tbl8_pool, 1, sz, f) != sz)
+		return -EIO;
+	return 0;
+}
+
+int
+trie_load(struct rte_trie_tbl *dp, FILE *f)
+{
+	struct trie_file_hdr hdr;
+	size_t sz;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EINVAL;
+	if ((hdr.nb_tbl8s > dp->number_tbl8s) ||
+			(hdr.tbl8_pool_pos > hdr.nb_tbl8s) ||
+			(hdr.rsvd_tbl8s > dp->number_tbl8s))
+		return -EINVAL;
+
+	/* the tables are not visible to the readers yet */
+	sz = (size_t)TRIE_TBL24_NUM_ENT << dp->nh_sz;
+	if (fread(dp->tbl24, 1, sz, f) != sz)
+		return -EINVAL;
+	sz = ((size_t)hdr.nb_tbl8s * TRIE_TBL8_GRP_NUM_ENT) << dp->nh_sz;
+	if (fread(dp->tbl8, 1, sz, f) != sz)
+		return -EINVAL;
+	sz = sizeof(uint32_t) * dp->number_tbl8s;
+	if (fread(dp->tbl8_pool, 1, sz, f) != sz)
+		return -EINVAL;
+	dp->rsvd_tbl8s = hdr.rsvd_tbl8s;
+	dp->tbl8_pool_pos = hdr.tbl8_pool_pos;
+	return 0;
+}
@@ -10,8 +10,13 @@
  * @file
  * RTE IPv6 Longest Prefix Match (LPM)
  */
+#include <stdio.h>
+
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_rcu_qsbr.h>
+
+#include "fib_rcu.h"
 
 /* @internal Total number of tbl24 entries. */
 #define TRIE_TBL24_NUM_ENT	(1 << 24)
@@ -37,6 +42,8 @@ struct rte_trie_tbl {
 	uint64_t	*tbl8;		/**< tbl8 table. */
 	uint32_t	*tbl8_pool;	/**< bitmap containing free tbl8 idxes*/
 	uint32_t	tbl8_pool_pos;
+	struct fib_rcu	rcu;		/* RCU QSBR reclamation */
+	struct trie_build	*build;	/* bulk build in progress */
 	/* tbl24 table. */
 	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
 };
@@ -141,4 +148,30 @@ int
 trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	uint8_t depth, uint64_t next_hop, int op);
 
+int
+trie_rcu_qsbr_add(struct rte_trie_tbl *dp, struct rte_fib6_rcu_config *cfg,
+	const char *name);
+
+void
+trie_bulk_begin(struct rte_trie_tbl *dp);
+
+void
+trie_bulk_end(struct rte_trie_tbl *dp);
+
+int
+trie_build_start(struct rte_trie_tbl *dp,
+	const struct rte_fib6_route *routes, uint32_t n);
+
+void
+trie_build_range(struct rte_trie_tbl *dp, uint8_t first, uint8_t last);
+
+void
+trie_build_finish(struct rte_trie_tbl *dp);
+
+int
+trie_save(struct rte_trie_tbl *dp, FILE *f);
+
+int
+trie_load(struct rte_trie_tbl *dp, FILE *f);
+
 #endif /* _TRIE_H_ */
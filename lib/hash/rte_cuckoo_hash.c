@@ -22,6 +22,7 @@
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_cpuflags.h>
+#include <rte_cycles.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 #include <rte_ring_elem.h>
@@ -31,6 +32,38 @@
 
 #include "rte_hash.h"
 #include "rte_cuckoo_hash.h"
+#if defined(RTE_ARCH_X86)
+#include "rte_cmp_x86.h"
+#include "rte_cuckoo_hash_x86.h"
+#endif
+
+#if defined(RTE_ARCH_ARM64)
+#include "rte_cmp_arm64.h"
+#endif
+
+/*
+ * Table storing all different key compare functions
+ * (multi-process supported)
+ */
+#if defined(RTE_ARCH_X86) || defined(RTE_ARCH_ARM64)
+static const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
+	NULL,
+	rte_hash_k16_cmp_eq,
+	rte_hash_k32_cmp_eq,
+	rte_hash_k48_cmp_eq,
+	rte_hash_k64_cmp_eq,
+	rte_hash_k80_cmp_eq,
+	rte_hash_k96_cmp_eq,
+	rte_hash_k112_cmp_eq,
+	rte_hash_k128_cmp_eq,
+	memcmp
+};
+#else
+static const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
+	NULL,
+	memcmp
+};
+#endif
 
 /* Mask of all flags supported by this version */
 #define RTE_HASH_EXTRA_FLAGS_MASK (RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT | \
@@ -38,7 +71,9 @@
 				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY | \
 				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE |	\
 				   RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL | \
-				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF | \
+				   RTE_HASH_EXTRA_FLAGS_RESIZE | \
+				   RTE_HASH_EXTRA_FLAGS_AGING)
 
 #define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
 	for (CURRENT_BKT = START_BUCKET;                                      \
@@ -134,6 +169,57 @@ get_alt_bucket_index(const struct rte_hash *h,
 	return (cur_bkt_idx ^ sig) & h->bucket_bitmask;
 }
 
+/* Timestamp of an entry of a table with aging */
+static inline uint64_t *
+get_key_timestamp(const struct rte_hash *h, const struct rte_hash_key *k)
+{
+	return RTE_PTR_ADD(k, h->ts_offset);
+}
+
+/* Signature of an entry of a table with resize, whatever the key is hashed
+ * with, as keys may be added with their own signature.
+ */
+static inline hash_sig_t *
+get_key_sig(const struct rte_hash *h, const struct rte_hash_key *k)
+{
+	return RTE_PTR_ADD(k, h->sig_offset);
+}
+
+/* Load the bucket array and its bitmask for a reader. A resize publishes
+ * the bigger array before its bitmask, so the bitmask never indexes past
+ * the end of the array.
+ */
+static inline struct rte_hash_bucket *
+get_buckets(const struct rte_hash *h, uint32_t *bitmask)
+{
+	*bitmask = __atomic_load_n(&h->bucket_bitmask, __ATOMIC_ACQUIRE);
+	return __atomic_load_n(&h->buckets, __ATOMIC_ACQUIRE);
+}
+
+static void
+hash_resize_free_table(struct rte_hash_old_table *old)
+{
+	rte_free(old->buckets);
+	rte_free(old->key_store);
+	rte_ring_free(old->free_slots);
+	rte_free(old);
+}
+
+/* Free the tables replaced by resizes, and the old one of a resize in
+ * progress, which no reader uses anymore.
+ */
+static void
+hash_resize_free_retired(struct rte_hash *h)
+{
+	if (h->old_tbl != NULL) {
+		hash_resize_free_table(h->old_tbl);
+		h->old_tbl = NULL;
+		h->resize_pos = 0;
+	}
+	while (h->nb_retired > 0)
+		hash_resize_free_table(h->retired[--h->nb_retired]);
+}
+
 struct rte_hash *
 rte_hash_create(const struct rte_hash_parameters *params)
 {
@@ -158,6 +244,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	uint32_t *tbl_chng_cnt = NULL;
 	struct lcore_cache *local_free_slots = NULL;
 	unsigned int readwrite_concur_lf_support = 0;
+	unsigned int resize_support = 0;
 	uint32_t i;
 
 	rte_hash_function default_hash_func = (rte_hash_function)rte_jhash;
@@ -222,6 +309,20 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		no_free_on_del = 1;
 	}
 
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZE) {
+		/* Keys are migrated by a single writer and cannot be chained
+		 * in extendable buckets, which are indexed by the table size.
+		 */
+		if (params->extra_flag & (RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD |
+				RTE_HASH_EXTRA_FLAGS_EXT_TABLE)) {
+			rte_errno = EINVAL;
+			RTE_LOG(ERR, HASH, "rte_hash_create: resize is not "
+				"supported with multi writer or ext table\n");
+			return NULL;
+		}
+		resize_support = 1;
+	}
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (use_local_cache)
 		/*
@@ -331,9 +432,19 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		}
 	}
 
-	const uint32_t key_entry_size =
+	/* The timestamp of an entry follows its key */
+	const uint32_t ts_offset =
+		(params->extra_flag & RTE_HASH_EXTRA_FLAGS_AGING) ?
 		RTE_ALIGN(sizeof(struct rte_hash_key) + params->key_len,
-			  KEY_ALIGNMENT);
+			  sizeof(uint64_t)) : 0;
+	const uint32_t key_end = ts_offset ? ts_offset + sizeof(uint64_t) :
+		sizeof(struct rte_hash_key) + params->key_len;
+	/* Then the signature a resize migrates the entry with */
+	const uint32_t sig_offset = resize_support ?
+		RTE_ALIGN(key_end, sizeof(hash_sig_t)) : 0;
+	const uint32_t key_entry_size = sig_offset ?
+		RTE_ALIGN(sig_offset + sizeof(hash_sig_t), KEY_ALIGNMENT) :
+		RTE_ALIGN(key_end, KEY_ALIGNMENT);
 	const uint64_t key_tbl_size = (uint64_t) key_entry_size * num_key_slots;
 
 	k = rte_zmalloc_socket(NULL, key_tbl_size,
@@ -413,6 +524,8 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->entries = params->entries;
 	h->key_len = params->key_len;
 	h->key_entry_size = key_entry_size;
+	h->ts_offset = ts_offset;
+	h->sig_offset = sig_offset;
 	h->hash_func_init_val = params->hash_func_init_val;
 
 	h->num_buckets = num_buckets;
@@ -435,8 +548,23 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->writer_takes_lock = writer_takes_lock;
 	h->no_free_on_del = no_free_on_del;
 	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->resize_support = resize_support;
+	h->socket_id = params->socket_id;
 
 #if defined(RTE_ARCH_X86)
+#if defined(CC_AVX512_SUPPORT)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512)
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX512;
+	else
+#endif
+#if defined(CC_AVX2_SUPPORT)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX2;
+	else
+#endif
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
 		h->sig_cmp_fn = RTE_HASH_COMPARE_SSE;
 	else
@@ -527,6 +655,7 @@ rte_hash_free(struct rte_hash *h)
 	rte_free(h->buckets_ext);
 	rte_free(h->tbl_chng_cnt);
 	rte_free(h->ext_bkt_to_free);
+	hash_resize_free_retired(h);
 	rte_free(h);
 	rte_free(te);
 }
@@ -557,7 +686,7 @@ int32_t
 rte_hash_count(const struct rte_hash *h)
 {
 	uint32_t tot_ring_cnt, cached_cnt = 0;
-	uint32_t i, ret;
+	uint32_t i, ret, gen;
 
 	if (h == NULL)
 		return -EINVAL;
@@ -570,6 +699,19 @@ rte_hash_count(const struct rte_hash *h)
 
 		ret = tot_ring_cnt - rte_ring_count(h->free_slots) -
 								cached_cnt;
+	} else if (h->resize_support) {
+		/* The size and the free slots ring are replaced by a resize,
+		 * read them again if one happened meanwhile.
+		 */
+		do {
+			gen = __atomic_load_n(&h->resize_gen, __ATOMIC_ACQUIRE);
+			tot_ring_cnt = __atomic_load_n(&h->entries,
+						       __ATOMIC_RELAXED);
+			ret = tot_ring_cnt - rte_ring_count(__atomic_load_n(
+				&h->free_slots, __ATOMIC_RELAXED));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		} while ((gen & 1) != 0 || gen != __atomic_load_n(
+				&h->resize_gen, __ATOMIC_RELAXED));
 	} else {
 		tot_ring_cnt = h->entries;
 		ret = tot_ring_cnt - rte_ring_count(h->free_slots);
@@ -632,6 +774,11 @@ rte_hash_reset(struct rte_hash *h)
 			RTE_LOG(ERR, HASH, "RCU reclaim all resources failed\n");
 	}
 
+	/* Readers are not referencing the table, drop the old one of a
+	 * resize in progress and the ones kept for the readers.
+	 */
+	hash_resize_free_retired(h);
+
 	memset(h->buckets, 0, h->num_buckets * sizeof(struct rte_hash_bucket));
 	memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
 	*h->tbl_chng_cnt = 0;
@@ -1004,8 +1151,235 @@ alloc_slot(const struct rte_hash *h, struct lcore_cache *cached_free_slots)
 	return slot_id;
 }
 
+/* Move the entry @i of an old bucket to the current table.
+ * Writer is expected to not hold the lock while calling this function.
+ */
+static int
+hash_resize_move_entry(struct rte_hash *h, struct rte_hash_bucket *old_bkt,
+		unsigned int i)
+{
+	uint32_t key_idx = old_bkt->key_idx[i];
+	struct rte_hash_key *k = RTE_PTR_ADD(h->key_store,
+					key_idx * h->key_entry_size);
+	hash_sig_t sig = *get_key_sig(h, k);
+	uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx = get_prim_bucket_index(h, sig);
+	uint32_t sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+					short_sig);
+	struct rte_hash_bucket *prim_bkt = &h->buckets[prim_bucket_idx];
+	struct rte_hash_bucket *sec_bkt = &h->buckets[sec_bucket_idx];
+	int32_t ret_val;
+	int ret;
+
+	/* The key keeps its index in the key store */
+	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt,
+			(const void *)k->key, k->pdata, short_sig, key_idx,
+			&ret_val);
+	if (ret < 0)
+		ret = rte_hash_cuckoo_make_space_mw(h, prim_bkt, sec_bkt,
+				(const void *)k->key, k->pdata, short_sig,
+				prim_bucket_idx, key_idx, &ret_val);
+	if (ret < 0)
+		ret = rte_hash_cuckoo_make_space_mw(h, sec_bkt, prim_bkt,
+				(const void *)k->key, k->pdata, short_sig,
+				sec_bucket_idx, key_idx, &ret_val);
+	if (ret < 0) {
+		RTE_LOG(ERR, HASH, "%s: could not migrate key %u\n",
+			__func__, key_idx - 1);
+		return -ENOSPC;
+	}
+
+	__hash_rw_writer_lock(h);
+	if (h->readwrite_concur_lf_support) {
+		/* Inform the readers that the table has changed, as the
+		 * entry is now present in both the old and the current
+		 * table. Since there is one writer, load acquire on
+		 * tbl_chng_cnt is not required.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt,
+				 *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		/* The store to sig_current should not
+		 * move above the store to tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	old_bkt->sig_current[i] = NULL_SIGNATURE;
+	__atomic_store_n(&old_bkt->key_idx[i], EMPTY_SLOT, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	return 0;
+}
+
+static int
+hash_resize_migrate_bucket(struct rte_hash *h, uint32_t bkt_idx)
+{
+	struct rte_hash_bucket *old_bkt = &h->old_tbl->buckets[bkt_idx];
+	unsigned int i;
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		if (old_bkt->key_idx[i] != EMPTY_SLOT &&
+				hash_resize_move_entry(h, old_bkt, i) < 0)
+			return -ENOSPC;
+	}
+
+	return 0;
+}
+
+/* All the keys are in the current table, the old one can be released
+ * once the readers do not use it anymore.
+ */
+static void
+hash_resize_complete(struct rte_hash *h)
+{
+	__hash_rw_writer_lock(h);
+	h->retired[h->nb_retired++] = h->old_tbl;
+	__atomic_store_n(&h->old_tbl, NULL, __ATOMIC_RELEASE);
+	__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+			 __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	if (h->hash_rcu_cfg != NULL) {
+		/* Wait for the readers to leave the retired tables */
+		rte_rcu_qsbr_synchronize(h->hash_rcu_cfg->v,
+					 RTE_QSBR_THRID_INVALID);
+		hash_resize_free_retired(h);
+	} else if (!h->readwrite_concur_support &&
+			!h->readwrite_concur_lf_support) {
+		hash_resize_free_retired(h);
+	}
+	/* Otherwise the retired tables are freed with the hash table */
+}
+
+/* Migrate the old buckets of a key, so that the key is only looked for
+ * in the current table by the writer, and a few more old buckets to
+ * complete the resize progressively.
+ */
+static int
+hash_resize_migrate(struct rte_hash *h, hash_sig_t sig)
+{
+	const struct rte_hash_old_table *old = h->old_tbl;
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	unsigned int i;
+
+	if (old == NULL)
+		return 0;
+
+	prim_bucket_idx = sig & old->bucket_bitmask;
+	sec_bucket_idx = (prim_bucket_idx ^ get_short_sig(sig)) &
+						old->bucket_bitmask;
+	if (hash_resize_migrate_bucket(h, prim_bucket_idx) < 0 ||
+			hash_resize_migrate_bucket(h, sec_bucket_idx) < 0)
+		return -ENOSPC;
+
+	for (i = 0; i < RTE_HASH_RESIZE_STEP &&
+			h->resize_pos < old->num_buckets; i++) {
+		if (hash_resize_migrate_bucket(h, h->resize_pos) < 0)
+			return -ENOSPC;
+		h->resize_pos++;
+	}
+
+	if (h->resize_pos == old->num_buckets)
+		hash_resize_complete(h);
+
+	return 0;
+}
+
+/* Double the table. Keys are migrated to the new buckets afterwards by
+ * hash_resize_migrate(), readers look for them in both tables meanwhile.
+ */
+static int
+hash_resize_start(struct rte_hash *h)
+{
+	char ring_name[RTE_RING_NAMESIZE];
+	struct rte_hash_old_table *old;
+	struct rte_hash_bucket *buckets;
+	struct rte_ring *r;
+	uint32_t num_buckets, entries, slot_id;
+	void *k;
+
+	/* Complete the previous resize first */
+	while (h->old_tbl != NULL) {
+		if (hash_resize_migrate_bucket(h, h->resize_pos) < 0)
+			return -ENOSPC;
+		if (++h->resize_pos == h->old_tbl->num_buckets)
+			hash_resize_complete(h);
+	}
+
+	if (h->entries > RTE_HASH_ENTRIES_MAX / 2 ||
+			h->nb_retired == RTE_HASH_RESIZE_MAX_RETIRED)
+		return -ENOSPC;
+
+	entries = h->entries * 2;
+	num_buckets = h->num_buckets * 2;
+
+	buckets = rte_zmalloc_socket(NULL,
+				num_buckets * sizeof(struct rte_hash_bucket),
+				RTE_CACHE_LINE_SIZE, h->socket_id);
+	k = rte_zmalloc_socket(NULL,
+				(uint64_t)h->key_entry_size * (entries + 1),
+				RTE_CACHE_LINE_SIZE, h->socket_id);
+	old = rte_zmalloc_socket(NULL, sizeof(*old), 0, h->socket_id);
+	snprintf(ring_name, sizeof(ring_name), "HT%u_%s",
+		 h->resize_gen / 2 + 1, h->name);
+	r = rte_ring_create_elem(ring_name, sizeof(uint32_t),
+			rte_align32pow2(entries + 1), h->socket_id, 0);
+	if (buckets == NULL || k == NULL || old == NULL || r == NULL) {
+		RTE_LOG(ERR, HASH, "resize memory allocation failed\n");
+		rte_free(buckets);
+		rte_free(k);
+		rte_free(old);
+		rte_ring_free(r);
+		return -ENOSPC;
+	}
+
+	/* rte_hash_count() retries while the free slots move */
+	__atomic_store_n(&h->resize_gen, h->resize_gen + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	/* Keys keep their index: copy the key store and add the new slots
+	 * to the free ones.
+	 */
+	memcpy(k, h->key_store, (uint64_t)h->key_entry_size * (h->entries + 1));
+	while (rte_ring_sc_dequeue_elem(h->free_slots, &slot_id,
+					sizeof(uint32_t)) == 0)
+		rte_ring_sp_enqueue_elem(r, &slot_id, sizeof(uint32_t));
+	for (slot_id = h->entries + 1; slot_id <= entries; slot_id++)
+		rte_ring_sp_enqueue_elem(r, &slot_id, sizeof(uint32_t));
+
+	/* The old key store and free slots ring are freed with the old
+	 * buckets, once the readers cannot use them.
+	 */
+	old->buckets = h->buckets;
+	old->bucket_bitmask = h->bucket_bitmask;
+	old->num_buckets = h->num_buckets;
+	old->key_store = h->key_store;
+	old->free_slots = h->free_slots;
+
+	__hash_rw_writer_lock(h);
+	/* The new key store is published before the index of any new slot */
+	__atomic_store_n(&h->key_store, k, __ATOMIC_RELEASE);
+	/* Readers seeing the new buckets also see the old ones, and the new
+	 * bitmask is only published with the bigger array.
+	 */
+	__atomic_store_n(&h->old_tbl, old, __ATOMIC_RELEASE);
+	__atomic_store_n(&h->buckets, buckets, __ATOMIC_RELEASE);
+	__atomic_store_n(&h->bucket_bitmask, num_buckets - 1,
+			 __ATOMIC_RELEASE);
+	__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+			 __ATOMIC_RELEASE);
+	h->num_buckets = num_buckets;
+	__atomic_store_n(&h->entries, entries, __ATOMIC_RELAXED);
+	__atomic_store_n(&h->free_slots, r, __ATOMIC_RELAXED);
+	h->resize_pos = 0;
+	__atomic_store_n(&h->resize_gen, h->resize_gen + 1, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	return 0;
+}
+
 static inline int32_t
-__rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
+__hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig, void *data)
 {
 	uint16_t short_sig;
@@ -1078,6 +1452,12 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		__ATOMIC_RELEASE);
 	/* Copy key */
 	memcpy(new_k->key, key, h->key_len);
+	if (h->ts_offset != 0)
+		__atomic_store_n(get_key_timestamp(h, new_k),
+				 rte_get_tsc_cycles(), __ATOMIC_RELAXED);
+	/* Only read by the writer */
+	if (h->sig_offset != 0)
+		*get_key_sig(h, new_k) = sig;
 
 	/* Find an empty slot and insert */
 	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt, key, data,
@@ -1197,6 +1577,30 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 
 }
 
+static inline int32_t
+__rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
+						hash_sig_t sig, void *data)
+{
+	struct rte_hash *rh;
+	int32_t ret;
+
+	if (likely(!h->resize_support))
+		return __hash_add_key_with_hash(h, key, sig, data);
+
+	/* The writer owns the layout of a resizable table */
+	rh = (struct rte_hash *)((uintptr_t)h);
+	if (hash_resize_migrate(rh, sig) < 0)
+		return -ENOSPC;
+
+	ret = __hash_add_key_with_hash(h, key, sig, data);
+	if (ret != -ENOSPC || hash_resize_start(rh) < 0)
+		return ret;
+
+	if (hash_resize_migrate(rh, sig) < 0)
+		return -ENOSPC;
+	return __hash_add_key_with_hash(h, key, sig, data);
+}
+
 int32_t
 rte_hash_add_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
@@ -1276,7 +1680,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 {
 	int i;
 	uint32_t key_idx;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Signature comparison is done before the acquire-load
@@ -1290,7 +1694,12 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 			key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 			if (key_idx != EMPTY_SLOT) {
-				k = (struct rte_hash_key *) ((char *)keys +
+				/* The key store is loaded after the key
+				 * index, as a resize publishes the bigger
+				 * key store before the new key indexes.
+				 */
+				k = (struct rte_hash_key *) (
+						(char *)h->key_store +
 						key_idx * h->key_entry_size);
 
 				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
@@ -1311,6 +1720,32 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 	return -1;
 }
 
+/* Search the old buckets of a resize in progress */
+static inline int32_t
+search_old_buckets(const struct rte_hash *h, const void *key, hash_sig_t sig,
+			void **data)
+{
+	const struct rte_hash_old_table *old;
+	uint32_t bitmask, prim_bucket_idx;
+	uint16_t short_sig;
+	int32_t ret;
+
+	old = __atomic_load_n(&h->old_tbl, __ATOMIC_ACQUIRE);
+	if (old == NULL)
+		return -1;
+
+	short_sig = get_short_sig(sig);
+	bitmask = old->bucket_bitmask;
+	prim_bucket_idx = sig & bitmask;
+	ret = search_one_bucket_lf(h, key, short_sig, data,
+				   &old->buckets[prim_bucket_idx]);
+	if (ret != -1)
+		return ret;
+
+	return search_one_bucket_lf(h, key, short_sig, data,
+			&old->buckets[(prim_bucket_idx ^ short_sig) & bitmask]);
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash_l(const struct rte_hash *h, const void *key,
 				hash_sig_t sig, void **data)
@@ -1321,13 +1756,14 @@ __rte_hash_lookup_with_hash_l(const struct rte_hash *h, const void *key,
 	uint16_t short_sig;
 
 	short_sig = get_short_sig(sig);
+
+	__hash_rw_reader_lock(h);
+
 	prim_bucket_idx = get_prim_bucket_index(h, sig);
 	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
 
 	bkt = &h->buckets[prim_bucket_idx];
 
-	__hash_rw_reader_lock(h);
-
 	/* Check if key is in primary location */
 	ret = search_one_bucket_l(h, key, short_sig, data, bkt);
 	if (ret != -1) {
@@ -1347,6 +1783,15 @@ __rte_hash_lookup_with_hash_l(const struct rte_hash *h, const void *key,
 		}
 	}
 
+	/* Check if key is not migrated yet by a resize */
+	if (unlikely(h->resize_support)) {
+		ret = search_old_buckets(h, key, sig, data);
+		if (ret != -1) {
+			__hash_rw_reader_unlock(h);
+			return ret;
+		}
+	}
+
 	__hash_rw_reader_unlock(h);
 
 	return -ENOENT;
@@ -1357,14 +1802,13 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
 	uint32_t prim_bucket_idx, sec_bucket_idx;
-	struct rte_hash_bucket *bkt, *cur_bkt;
+	struct rte_hash_bucket *buckets, *bkt, *cur_bkt;
 	uint32_t cnt_b, cnt_a;
+	uint32_t bitmask;
 	int ret;
 	uint16_t short_sig;
 
 	short_sig = get_short_sig(sig);
-	prim_bucket_idx = get_prim_bucket_index(h, sig);
-	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
 
 	do {
 		/* Load the table change counter before the lookup
@@ -1374,13 +1818,18 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 		cnt_b = __atomic_load_n(h->tbl_chng_cnt,
 				__ATOMIC_ACQUIRE);
 
+		/* The buckets are reloaded as a resize changes them */
+		buckets = get_buckets(h, &bitmask);
+		prim_bucket_idx = sig & bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) & bitmask;
+
 		/* Check if key is in primary location */
-		bkt = &h->buckets[prim_bucket_idx];
+		bkt = &buckets[prim_bucket_idx];
 		ret = search_one_bucket_lf(h, key, short_sig, data, bkt);
 		if (ret != -1)
 			return ret;
 		/* Calculate secondary hash */
-		bkt = &h->buckets[sec_bucket_idx];
+		bkt = &buckets[sec_bucket_idx];
 
 		/* Check if key is in secondary location */
 		FOR_EACH_BUCKET(cur_bkt, bkt) {
@@ -1390,6 +1839,13 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 				return ret;
 		}
 
+		/* Check if key is not migrated yet by a resize */
+		if (unlikely(h->resize_support)) {
+			ret = search_old_buckets(h, key, sig, data);
+			if (ret != -1)
+				return ret;
+		}
+
 		/* The loads of sig_current in search_one_bucket
 		 * should not move below the load from tbl_chng_cnt.
 		 */
@@ -1677,7 +2133,7 @@ search_and_remove(const struct rte_hash *h, const void *key,
 }
 
 static inline int32_t
-__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
+__hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig)
 {
 	uint32_t prim_bucket_idx, sec_bucket_idx;
@@ -1772,15 +2228,44 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 						 RTE_QSBR_THRID_INVALID);
 			__hash_rcu_qsbr_free_resource((void *)((uintptr_t)h),
 						      &rcu_dq_entry, 1);
-		} else if (h->dq)
+		} else if (h->dq) {
 			/* Push into QSBR FIFO if using RTE_HASH_QSBR_MODE_DQ */
-			if (rte_rcu_qsbr_dq_enqueue(h->dq, &rcu_dq_entry) != 0)
-				RTE_LOG(ERR, HASH, "Failed to push QSBR FIFO\n");
+			if (rte_rcu_qsbr_dq_enqueue(h->dq, &rcu_dq_entry) != 0) {
+				if (!h->resize_support) {
+					RTE_LOG(ERR, HASH,
+						"Failed to push QSBR FIFO\n");
+				} else {
+					/* The FIFO is sized for the table
+					 * before its resizes, wait for the
+					 * readers instead.
+					 */
+					rte_rcu_qsbr_synchronize(
+						h->hash_rcu_cfg->v,
+						RTE_QSBR_THRID_INVALID);
+					__hash_rcu_qsbr_free_resource(
+						(void *)((uintptr_t)h),
+						&rcu_dq_entry, 1);
+				}
+			}
+		}
 	}
 	__hash_rw_writer_unlock(h);
 	return ret;
 }
 
+static inline int32_t
+__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
+						hash_sig_t sig)
+{
+	/* The writer owns the layout of a resizable table */
+	if (unlikely(h->resize_support) &&
+			hash_resize_migrate((struct rte_hash *)((uintptr_t)h),
+					    sig) < 0)
+		return -ENOSPC;
+
+	return __hash_del_key_with_hash(h, key, sig);
+}
+
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
@@ -1900,6 +2385,40 @@ compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 	}
 }
 
+/* Compare the signatures of all the keys of a bulk */
+static inline void
+compare_signatures_bulk(uint32_t *prim_hash_matches,
+			uint32_t *sec_hash_matches,
+			const struct rte_hash_bucket **primary_bkt,
+			const struct rte_hash_bucket **secondary_bkt,
+			const uint16_t *sig, int32_t num_keys,
+			enum rte_hash_sig_compare_function sig_cmp_fn)
+{
+	int32_t i;
+
+	switch (sig_cmp_fn) {
+#if defined(CC_AVX512_SUPPORT)
+	case RTE_HASH_COMPARE_AVX512:
+		rte_hash_compare_signatures_avx512(prim_hash_matches,
+			sec_hash_matches, primary_bkt, secondary_bkt, sig,
+			num_keys);
+		break;
+#endif
+#if defined(CC_AVX2_SUPPORT)
+	case RTE_HASH_COMPARE_AVX2:
+		rte_hash_compare_signatures_avx2(prim_hash_matches,
+			sec_hash_matches, primary_bkt, secondary_bkt, sig,
+			num_keys);
+		break;
+#endif
+	default:
+		for (i = 0; i < num_keys; i++)
+			compare_signatures(&prim_hash_matches[i],
+				&sec_hash_matches[i], primary_bkt[i],
+				secondary_bkt[i], sig[i], sig_cmp_fn);
+	}
+}
+
 static inline void
 __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 		const struct rte_hash_bucket **primary_bkt,
@@ -1917,11 +2436,9 @@ __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 	__hash_rw_reader_lock(h);
 
 	/* Compare signatures and prefetch key slot of first hit */
+	compare_signatures_bulk(prim_hitmask, sec_hitmask, primary_bkt,
+		secondary_bkt, sig, num_keys, h->sig_cmp_fn);
 	for (i = 0; i < num_keys; i++) {
-		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-			primary_bkt[i], secondary_bkt[i],
-			sig[i], h->sig_cmp_fn);
-
 		if (prim_hitmask[i]) {
 			uint32_t first_hit =
 					__builtin_ctzl(prim_hitmask[i])
@@ -2074,11 +2591,10 @@ __bulk_lookup_lf(const struct rte_hash *h, const void **keys,
 					__ATOMIC_ACQUIRE);
 
 		/* Compare signatures and prefetch key slot of first hit */
+		compare_signatures_bulk(prim_hitmask, sec_hitmask,
+			primary_bkt, secondary_bkt, sig, num_keys,
+			h->sig_cmp_fn);
 		for (i = 0; i < num_keys; i++) {
-			compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-				primary_bkt[i], secondary_bkt[i],
-				sig[i], h->sig_cmp_fn);
-
 			if (prim_hitmask[i]) {
 				uint32_t first_hit =
 						__builtin_ctzl(prim_hitmask[i])
@@ -2238,6 +2754,10 @@ __bulk_lookup_prefetching_loop(const struct rte_hash *h,
 	uint32_t prim_hash[RTE_HASH_LOOKUP_BULK_MAX];
 	uint32_t prim_index[RTE_HASH_LOOKUP_BULK_MAX];
 	uint32_t sec_index[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash_bucket *buckets;
+	uint32_t bitmask;
+
+	buckets = get_buckets(h, &bitmask);
 
 	/* Prefetch first keys */
 	for (i = 0; i < PREFETCH_OFFSET && i < num_keys; i++)
@@ -2253,11 +2773,11 @@ __bulk_lookup_prefetching_loop(const struct rte_hash *h,
 		prim_hash[i] = rte_hash_hash(h, keys[i]);
 
 		sig[i] = get_short_sig(prim_hash[i]);
-		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
-		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+		prim_index[i] = prim_hash[i] & bitmask;
+		sec_index[i] = (prim_index[i] ^ sig[i]) & bitmask;
 
-		primary_bkt[i] = &h->buckets[prim_index[i]];
-		secondary_bkt[i] = &h->buckets[sec_index[i]];
+		primary_bkt[i] = &buckets[prim_index[i]];
+		secondary_bkt[i] = &buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
@@ -2268,11 +2788,11 @@ __bulk_lookup_prefetching_loop(const struct rte_hash *h,
 		prim_hash[i] = rte_hash_hash(h, keys[i]);
 
 		sig[i] = get_short_sig(prim_hash[i]);
-		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
-		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+		prim_index[i] = prim_hash[i] & bitmask;
+		sec_index[i] = (prim_index[i] ^ sig[i]) & bitmask;
 
-		primary_bkt[i] = &h->buckets[prim_index[i]];
-		secondary_bkt[i] = &h->buckets[sec_index[i]];
+		primary_bkt[i] = &buckets[prim_index[i]];
+		secondary_bkt[i] = &buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
@@ -2312,17 +2832,74 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 		positions, hit_mask, data);
 }
 
+/* Look up one by one the keys missed by a bulk lookup, when some keys
+ * may not be migrated yet by a resize or when a resize started during
+ * the bulk lookup.
+ */
+static inline void
+__bulk_lookup_resize(const struct rte_hash *h, const void **keys,
+		hash_sig_t *prim_hash, int32_t num_keys, int32_t *positions,
+		uint64_t *hit_mask, void *data[])
+{
+	hash_sig_t sig;
+	int32_t i;
+
+	for (i = 0; i < num_keys; i++) {
+		if (positions[i] >= 0)
+			continue;
+		sig = (prim_hash != NULL) ? prim_hash[i] :
+						rte_hash_hash(h, keys[i]);
+		positions[i] = __rte_hash_lookup_with_hash(h, keys[i], sig,
+					(data != NULL) ? &data[i] : NULL);
+		if (positions[i] >= 0 && hit_mask != NULL)
+			*hit_mask |= 1ULL << i;
+	}
+}
+
+/* Sample the resize state before a bulk lookup */
+static inline uint32_t
+__bulk_lookup_resize_begin(const struct rte_hash *h, bool *resizing)
+{
+	*resizing = __atomic_load_n(&h->old_tbl, __ATOMIC_ACQUIRE) != NULL;
+	return __atomic_load_n(h->tbl_chng_cnt, __ATOMIC_ACQUIRE);
+}
+
+/* Check if the bulk lookup may have missed keys because of a resize */
+static inline bool
+__bulk_lookup_resize_end(const struct rte_hash *h, bool resizing,
+		uint32_t cnt_b)
+{
+	if (resizing)
+		return true;
+	/* The loads of the bulk lookup should not move below the
+	 * load from tbl_chng_cnt.
+	 */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(h->tbl_chng_cnt, __ATOMIC_ACQUIRE) != cnt_b;
+}
+
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			int32_t num_keys, int32_t *positions,
 			uint64_t *hit_mask, void *data[])
 {
+	bool resizing = false;
+	uint32_t cnt_b = 0;
+
+	if (unlikely(h->resize_support))
+		cnt_b = __bulk_lookup_resize_begin(h, &resizing);
+
 	if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_bulk_lf(h, keys, num_keys, positions,
 					  hit_mask, data);
 	else
 		__rte_hash_lookup_bulk_l(h, keys, num_keys, positions,
 					 hit_mask, data);
+
+	if (unlikely(h->resize_support) &&
+			__bulk_lookup_resize_end(h, resizing, cnt_b))
+		__bulk_lookup_resize(h, keys, NULL, num_keys, positions,
+				     hit_mask, data);
 }
 
 int
@@ -2366,6 +2943,10 @@ __rte_hash_lookup_with_hash_bulk_l(const struct rte_hash *h,
 	uint16_t sig[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *primary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *secondary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash_bucket *buckets;
+	uint32_t bitmask;
+
+	buckets = get_buckets(h, &bitmask);
 
 	/*
 	 * Prefetch keys, calculate primary and
@@ -2375,11 +2956,11 @@ __rte_hash_lookup_with_hash_bulk_l(const struct rte_hash *h,
 		rte_prefetch0(keys[i]);
 
 		sig[i] = get_short_sig(prim_hash[i]);
-		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
-		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+		prim_index[i] = prim_hash[i] & bitmask;
+		sec_index[i] = (prim_index[i] ^ sig[i]) & bitmask;
 
-		primary_bkt[i] = &h->buckets[prim_index[i]];
-		secondary_bkt[i] = &h->buckets[sec_index[i]];
+		primary_bkt[i] = &buckets[prim_index[i]];
+		secondary_bkt[i] = &buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
@@ -2401,6 +2982,10 @@ __rte_hash_lookup_with_hash_bulk_lf(const struct rte_hash *h,
 	uint16_t sig[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *primary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *secondary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash_bucket *buckets;
+	uint32_t bitmask;
+
+	buckets = get_buckets(h, &bitmask);
 
 	/*
 	 * Prefetch keys, calculate primary and
@@ -2410,11 +2995,11 @@ __rte_hash_lookup_with_hash_bulk_lf(const struct rte_hash *h,
 		rte_prefetch0(keys[i]);
 
 		sig[i] = get_short_sig(prim_hash[i]);
-		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
-		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+		prim_index[i] = prim_hash[i] & bitmask;
+		sec_index[i] = (prim_index[i] ^ sig[i]) & bitmask;
 
-		primary_bkt[i] = &h->buckets[prim_index[i]];
-		secondary_bkt[i] = &h->buckets[sec_index[i]];
+		primary_bkt[i] = &buckets[prim_index[i]];
+		secondary_bkt[i] = &buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
@@ -2429,12 +3014,23 @@ __rte_hash_lookup_with_hash_bulk(const struct rte_hash *h, const void **keys,
 			hash_sig_t *prim_hash, int32_t num_keys,
 			int32_t *positions, uint64_t *hit_mask, void *data[])
 {
+	bool resizing = false;
+	uint32_t cnt_b = 0;
+
+	if (unlikely(h->resize_support))
+		cnt_b = __bulk_lookup_resize_begin(h, &resizing);
+
 	if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_with_hash_bulk_lf(h, keys, prim_hash,
 				num_keys, positions, hit_mask, data);
 	else
 		__rte_hash_lookup_with_hash_bulk_l(h, keys, prim_hash,
 				num_keys, positions, hit_mask, data);
+
+	if (unlikely(h->resize_support) &&
+			__bulk_lookup_resize_end(h, resizing, cnt_b))
+		__bulk_lookup_resize(h, keys, prim_hash, num_keys, positions,
+				     hit_mask, data);
 }
 
 int
@@ -2470,17 +3066,56 @@ rte_hash_lookup_with_hash_bulk_data(const struct rte_hash *h,
 	return __builtin_popcountl(*hit_mask);
 }
 
+int
+rte_hash_lookup_touch_bulk_data(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, uint64_t now, uint64_t *hit_mask,
+		void *data[])
+{
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
+			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
+			(hit_mask == NULL)), -EINVAL);
+
+	int32_t positions[num_keys];
+	struct rte_hash_key *k;
+	uint64_t *ts, hits;
+	uint32_t i;
+
+	__rte_hash_lookup_bulk(h, keys, num_keys, positions, hit_mask, data);
+
+	if (h->ts_offset == 0)
+		return __builtin_popcountl(*hit_mask);
+
+	/* The key slots of the hits are still in cache from the compare.
+	 * The timestamp is only written when it changes, so that lookups
+	 * of the same time do not keep dirtying the cache lines.
+	 */
+	for (hits = *hit_mask; hits != 0; hits &= hits - 1) {
+		i = __builtin_ctzll(hits);
+		k = (struct rte_hash_key *)((char *)h->key_store +
+				(positions[i] + 1) * h->key_entry_size);
+		ts = get_key_timestamp(h, k);
+		if (__atomic_load_n(ts, __ATOMIC_RELAXED) != now)
+			__atomic_store_n(ts, now, __ATOMIC_RELAXED);
+	}
+
+	/* Return number of hits */
+	return __builtin_popcountl(*hit_mask);
+}
+
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next)
 {
 	uint32_t bucket_idx, idx, position;
+	uint32_t bitmask, total_entries;
+	const struct rte_hash_old_table *old;
+	struct rte_hash_bucket *buckets;
 	struct rte_hash_key *next_key;
 
 	RETURN_IF_TRUE(((h == NULL) || (next == NULL)), -EINVAL);
 
-	const uint32_t total_entries_main = h->num_buckets *
+	buckets = get_buckets(h, &bitmask);
+	const uint32_t total_entries_main = (bitmask + 1) *
 							RTE_HASH_BUCKET_ENTRIES;
-	const uint32_t total_entries = total_entries_main << 1;
 
 	/* Out of bounds of all buckets (both main table and ext table) */
 	if (*next >= total_entries_main)
@@ -2491,7 +3126,7 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	idx = *next % RTE_HASH_BUCKET_ENTRIES;
 
 	/* If current position is empty, go to the next one */
-	while ((position = __atomic_load_n(&h->buckets[bucket_idx].key_idx[idx],
+	while ((position = __atomic_load_n(&buckets[bucket_idx].key_idx[idx],
 					__ATOMIC_ACQUIRE)) == EMPTY_SLOT) {
 		(*next)++;
 		/* End of table */
@@ -2515,16 +3150,29 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 
 	return position - 1;
 
-/* Begin to iterate extendable buckets */
+/* Begin to iterate extendable buckets, or the old buckets of a resize */
 extend_table:
+	if (h->resize_support) {
+		old = __atomic_load_n(&h->old_tbl, __ATOMIC_ACQUIRE);
+		if (old == NULL)
+			return -ENOENT;
+		buckets = old->buckets;
+		total_entries = total_entries_main + old->num_buckets *
+							RTE_HASH_BUCKET_ENTRIES;
+	} else {
+		buckets = h->buckets_ext;
+		total_entries = total_entries_main << 1;
+	}
+
 	/* Out of total bound or if ext bucket feature is not enabled */
-	if (*next >= total_entries || !h->ext_table_support)
+	if (*next >= total_entries || buckets == NULL)
 		return -ENOENT;
 
 	bucket_idx = (*next - total_entries_main) / RTE_HASH_BUCKET_ENTRIES;
 	idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
 
-	while ((position = h->buckets_ext[bucket_idx].key_idx[idx]) == EMPTY_SLOT) {
+	while ((position = __atomic_load_n(&buckets[bucket_idx].key_idx[idx],
+					__ATOMIC_ACQUIRE)) == EMPTY_SLOT) {
 		(*next)++;
 		if (*next == total_entries)
 			return -ENOENT;
@@ -2545,3 +3193,89 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	(*next)++;
 	return position - 1;
 }
+
+int
+rte_hash_expire(const struct rte_hash *h,
+		struct rte_hash_expire_cursor *cursor, uint32_t nb_buckets,
+		uint64_t expiry, const void *keys[], void *data[],
+		uint32_t max_expired)
+{
+	uint32_t bitmask, nb_parts, part_buckets, bucket_idx, idx, key_idx;
+	uint32_t nb_extra = 0, part_extra = 0;
+	const struct rte_hash_old_table *old;
+	struct rte_hash_bucket *buckets, *extra = NULL, *bkt;
+	struct rte_hash_key *k;
+	uint32_t nb_expired = 0;
+
+	if (h == NULL || cursor == NULL || keys == NULL)
+		return -EINVAL;
+	if (h->ts_offset == 0)
+		return -ENOTSUP;
+
+	nb_parts = (cursor->nb_parts != 0) ? cursor->nb_parts : 1;
+	if (cursor->part >= nb_parts)
+		return -EINVAL;
+
+	__hash_rw_reader_lock(h);
+
+	/* The part is made of the buckets whose index modulo the number of
+	 * parts is the part index, it stays the same when the table is
+	 * resized. The main buckets of the part are followed by its
+	 * extendable buckets, or by its old buckets during a resize.
+	 */
+	buckets = get_buckets(h, &bitmask);
+	part_buckets = (bitmask + nb_parts - cursor->part) / nb_parts;
+	if (h->ext_table_support) {
+		extra = h->buckets_ext;
+		nb_extra = bitmask + 1;
+	} else if (h->resize_support) {
+		old = __atomic_load_n(&h->old_tbl, __ATOMIC_ACQUIRE);
+		if (old != NULL) {
+			extra = old->buckets;
+			nb_extra = old->num_buckets;
+		}
+	}
+	if (nb_extra > cursor->part)
+		part_extra = (nb_extra - 1 + nb_parts - cursor->part) /
+				nb_parts;
+
+	while (nb_buckets > 0 && nb_expired < max_expired &&
+			part_buckets != 0) {
+		bucket_idx = cursor->next / RTE_HASH_BUCKET_ENTRIES;
+		idx = cursor->next % RTE_HASH_BUCKET_ENTRIES;
+		/* Start again at the end of the part */
+		if (bucket_idx >= part_buckets + part_extra) {
+			cursor->next = 0;
+			bucket_idx = 0;
+			idx = 0;
+		}
+
+		if (bucket_idx < part_buckets)
+			bkt = &buckets[bucket_idx * nb_parts + cursor->part];
+		else
+			bkt = &extra[(bucket_idx - part_buckets) * nb_parts +
+					cursor->part];
+		key_idx = __atomic_load_n(&bkt->key_idx[idx],
+					__ATOMIC_ACQUIRE);
+		if (key_idx != EMPTY_SLOT) {
+			k = (struct rte_hash_key *)((char *)h->key_store +
+					key_idx * h->key_entry_size);
+			if (__atomic_load_n(get_key_timestamp(h, k),
+					__ATOMIC_RELAXED) < expiry) {
+				keys[nb_expired] = k->key;
+				if (data != NULL)
+					data[nb_expired] = __atomic_load_n(
+						&k->pdata, __ATOMIC_ACQUIRE);
+				nb_expired++;
+			}
+		}
+
+		cursor->next++;
+		if (cursor->next % RTE_HASH_BUCKET_ENTRIES == 0)
+			nb_buckets--;
+	}
+
+	__hash_rw_reader_unlock(h);
+
+	return nb_expired;
+}
@@ -11,14 +11,6 @@
 #ifndef _RTE_CUCKOO_HASH_H_
 #define _RTE_CUCKOO_HASH_H_
 
-#if defined(RTE_ARCH_X86)
-#include "rte_cmp_x86.h"
-#endif
-
-#if defined(RTE_ARCH_ARM64)
-#include "rte_cmp_arm64.h"
-#endif
-
 /* Macro to enable/disable run-time checking of function parameters */
 #if defined(RTE_LIBRTE_HASH_DEBUG)
 #define RETURN_IF_TRUE(cond, retval) do { \
@@ -61,23 +53,6 @@ enum cmp_jump_table_case {
 	KEY_OTHER_BYTES,
 	NUM_KEY_CMP_CASES,
 };
-
-/*
- * Table storing all different key compare functions
- * (multi-process supported)
- */
-const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
-	NULL,
-	rte_hash_k16_cmp_eq,
-	rte_hash_k32_cmp_eq,
-	rte_hash_k48_cmp_eq,
-	rte_hash_k64_cmp_eq,
-	rte_hash_k80_cmp_eq,
-	rte_hash_k96_cmp_eq,
-	rte_hash_k112_cmp_eq,
-	rte_hash_k128_cmp_eq,
-	memcmp
-};
 #else
 /*
  * All different options to select a key compare function,
@@ -89,15 +64,6 @@ enum cmp_jump_table_case {
 	NUM_KEY_CMP_CASES,
 };
 
-/*
- * Table storing all different key compare functions
- * (multi-process supported)
- */
-const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
-	NULL,
-	memcmp
-};
-
 #endif
 
 
@@ -122,6 +88,24 @@ const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
 
 #define RTE_HASH_TSX_MAX_RETRY  10
 
+/* Number of old buckets migrated by each add or delete during a resize */
+#define RTE_HASH_RESIZE_STEP		4
+
+/* Maximum number of tables replaced by resizes and not yet freed */
+#define RTE_HASH_RESIZE_MAX_RETIRED	64
+
+/* Table replaced by a resize. The readers get its buckets and their
+ * bitmask at once, and its key store and free slots ring are kept as long
+ * as the buckets as readers may still use them.
+ */
+struct rte_hash_old_table {
+	struct rte_hash_bucket *buckets;
+	uint32_t bucket_bitmask;
+	uint32_t num_buckets;
+	void *key_store;
+	struct rte_ring *free_slots;
+};
+
 struct lcore_cache {
 	unsigned len; /**< Cache len */
 	uint32_t objs[LCORE_CACHE_SIZE]; /**< Cache objects */
@@ -142,6 +126,8 @@ enum rte_hash_sig_compare_function {
 	RTE_HASH_COMPARE_SCALAR = 0,
 	RTE_HASH_COMPARE_SSE,
 	RTE_HASH_COMPARE_NEON,
+	RTE_HASH_COMPARE_AVX2,
+	RTE_HASH_COMPARE_AVX512,
 	RTE_HASH_COMPARE_NUM
 };
 
@@ -196,6 +182,8 @@ struct rte_hash {
 	/**< If read-write concurrency lock free support is enabled */
 	uint8_t writer_takes_lock;
 	/**< Indicates if the writer threads need to take lock */
+	uint8_t resize_support;
+	/**< If the table grows when it is full */
 	rte_hash_function hash_func;    /**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;    /**< Init value used by hash_func. */
 	rte_hash_cmp_eq_t rte_hash_custom_cmp_eq;
@@ -207,6 +195,10 @@ struct rte_hash {
 	uint32_t bucket_bitmask;
 	/**< Bitmask for getting bucket index from hash signature. */
 	uint32_t key_entry_size;         /**< Size of each key entry. */
+	uint32_t ts_offset;
+	/**< Offset of the timestamp in a key entry, 0 without aging. */
+	uint32_t sig_offset;
+	/**< Offset of the signature in a key entry, 0 without resize. */
 
 	void *key_store;                /**< Table storing all keys and data */
 	struct rte_hash_bucket *buckets;
@@ -225,6 +217,17 @@ struct rte_hash {
 	uint32_t *ext_bkt_to_free;
 	uint32_t *tbl_chng_cnt;
 	/**< Indicates if the hash table changed from last read. */
+
+	/* Fields used in resize */
+	int socket_id;                  /**< Socket of the table memory. */
+	struct rte_hash_old_table *old_tbl;
+	/**< Table being migrated to the current one by a resize. */
+	uint32_t resize_pos;            /**< Next old bucket to migrate. */
+	uint32_t resize_gen;
+	/**< Twice the number of resizes, odd while the free slots move. */
+	uint32_t nb_retired;            /**< Number of retired tables. */
+	struct rte_hash_old_table *retired[RTE_HASH_RESIZE_MAX_RETIRED];
+	/**< Tables replaced by a resize, kept until no reader can use them. */
 } __rte_cache_aligned;
 
 struct queue_node {
@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_common.h>
+#include <rte_vect.h>
+
+#include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
+#include "rte_cuckoo_hash_x86.h"
+
+/* the two buckets of a key are compared in one 256-bit register */
+static __rte_always_inline uint32_t
+compare_signatures_x2(const struct rte_hash_bucket *prim_bkt,
+	const struct rte_hash_bucket *sec_bkt, uint16_t sig)
+{
+	__m256i bkts;
+
+	bkts = _mm256_inserti128_si256(_mm256_castsi128_si256(
+			_mm_load_si128((__m128i const *)prim_bkt->sig_current)),
+		_mm_load_si128((__m128i const *)sec_bkt->sig_current), 1);
+
+	return _mm256_movemask_epi8(_mm256_cmpeq_epi16(bkts,
+		_mm256_set1_epi16(sig)));
+}
+
+void
+rte_hash_compare_signatures_avx2(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt,
+	const uint16_t *sig, int32_t num_keys)
+{
+	uint32_t hits;
+	int32_t i;
+
+	RTE_BUILD_BUG_ON(RTE_HASH_BUCKET_ENTRIES * sizeof(uint16_t) !=
+		sizeof(__m128i));
+
+	for (i = 0; i < num_keys; i++) {
+		hits = compare_signatures_x2(primary_bkt[i], secondary_bkt[i],
+			sig[i]);
+		prim_hash_matches[i] = hits & UINT16_MAX;
+		sec_hash_matches[i] = hits >> 16;
+	}
+}
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_common.h>
+#include <rte_vect.h>
+
+#include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
+#include "rte_cuckoo_hash_x86.h"
+
+/*
+ * The primary and secondary buckets of two keys are compared in one 512-bit
+ * register. The mask of the matching 16-bit signatures is widened to one
+ * bit per byte, the two bits per entry of the hit masks.
+ */
+static __rte_always_inline uint64_t
+compare_signatures_x4(const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt, const uint16_t *sig)
+{
+	__m512i bkts, sigs;
+	__mmask32 match;
+
+	bkts = _mm512_castsi128_si512(
+		_mm_load_si128((__m128i const *)primary_bkt[0]->sig_current));
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)secondary_bkt[0]->sig_current),
+		1);
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)primary_bkt[1]->sig_current),
+		2);
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)secondary_bkt[1]->sig_current),
+		3);
+	sigs = _mm512_inserti64x4(_mm512_castsi256_si512(
+			_mm256_set1_epi16(sig[0])),
+		_mm256_set1_epi16(sig[1]), 1);
+
+	match = _mm512_cmpeq_epi16_mask(bkts, sigs);
+	return _mm512_movepi8_mask(_mm512_movm_epi16(match));
+}
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt,
+	const uint16_t *sig, int32_t num_keys)
+{
+	uint64_t hits;
+	uint32_t hits_x2;
+	int32_t i;
+
+	RTE_BUILD_BUG_ON(RTE_HASH_BUCKET_ENTRIES * sizeof(uint16_t) !=
+		sizeof(__m128i));
+
+	for (i = 0; i + 1 < num_keys; i += 2) {
+		hits = compare_signatures_x4(&primary_bkt[i],
+			&secondary_bkt[i], &sig[i]);
+		prim_hash_matches[i] = hits & UINT16_MAX;
+		sec_hash_matches[i] = (hits >> 16) & UINT16_MAX;
+		prim_hash_matches[i + 1] = (hits >> 32) & UINT16_MAX;
+		sec_hash_matches[i + 1] = hits >> 48;
+	}
+
+	/* last key of an odd bulk */
+	if (i < num_keys) {
+		hits_x2 = _mm256_movemask_epi8(_mm256_cmpeq_epi16(
+			_mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_load_si128((__m128i const *)
+					primary_bkt[i]->sig_current)),
+				_mm_load_si128((__m128i const *)
+					secondary_bkt[i]->sig_current), 1),
+			_mm256_set1_epi16(sig[i])));
+		prim_hash_matches[i] = hits_x2 & UINT16_MAX;
+		sec_hash_matches[i] = hits_x2 >> 16;
+	}
+}
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _RTE_CUCKOO_HASH_X86_H_
+#define _RTE_CUCKOO_HASH_X86_H_
+
+/*
+ * Signature compare functions of the bulk lookup, setting for each key
+ * the hit masks of its primary and secondary buckets with two bits per
+ * entry, the format of compare_signatures().
+ */
+
+void
+rte_hash_compare_signatures_avx2(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt,
+	const uint16_t *sig, int32_t num_keys);
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt,
+	const uint16_t *sig, int32_t num_keys);
+
+#endif /* _RTE_CUCKOO_HASH_X86_H_ */
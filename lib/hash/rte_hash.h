@@ -56,6 +56,21 @@ extern "C" {
  */
 #define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
 
+/** Flag to let the table grow when it is full. The table is doubled and
+ * its keys are migrated incrementally by the following add and delete
+ * operations, so readers never wait for a resize. Writes must be
+ * serialized, so it cannot be combined with
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD nor with
+ * RTE_HASH_EXTRA_FLAGS_EXT_TABLE.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RESIZE 0x40
+
+/** Flag to keep a timestamp per entry, set when the entry is added and
+ * by rte_hash_lookup_touch_bulk_data(), to find the idle entries with
+ * rte_hash_expire().
+ */
+#define RTE_HASH_EXTRA_FLAGS_AGING 0x80
+
 /**
  * The type of hash value of a key.
  * It should be a value of at least 32bit with fully random pattern.
@@ -69,6 +84,17 @@ typedef uint32_t (*rte_hash_function)(const void *key, uint32_t key_len,
 /** Type of function used to compare the hash key. */
 typedef int (*rte_hash_cmp_eq_t)(const void *key1, const void *key2, size_t key_len);
 
+/**
+ * Cursor of an expiry sweep, see rte_hash_expire().
+ * The table buckets can be split in several parts swept independently,
+ * for instance by different lcores.
+ */
+struct rte_hash_expire_cursor {
+	uint32_t next;     /**< Next entry to visit, 0 to start. */
+	uint16_t part;     /**< Part of the table to sweep. */
+	uint16_t nb_parts; /**< Number of parts, 0 for the whole table. */
+};
+
 /**
  * Type of function used to free data stored in the key.
  * Required when using internal RCU to allow application to free key-data once
@@ -210,6 +236,7 @@ rte_hash_count(const struct rte_hash *h);
  *
  * Return the maximum key value ID that could possibly be returned by
  * rte_hash_add_key function.
+ * With RTE_HASH_EXTRA_FLAGS_RESIZE, it grows when the table is resized.
  *
  * @param h
  *  Hash table to query from
@@ -671,6 +698,80 @@ rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find multiple keys in the hash table and refresh the timestamp of the
+ * keys found, in a table created with RTE_HASH_EXTRA_FLAGS_AGING.
+ * This operation is multi-thread safe with regarding to other lookup threads.
+ * Read-write concurrency can be enabled by setting flag during
+ * table creation.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list (less than RTE_HASH_LOOKUP_BULK_MAX).
+ * @param now
+ *   Timestamp of the keys found, in TSC cycles as returned by
+ *   rte_get_tsc_cycles().
+ * @param hit_mask
+ *   Output containing a bitmask with all successful lookups.
+ * @param data
+ *   Output containing array of data returned from all the successful lookups.
+ * @return
+ *   -EINVAL if there's an error, otherwise number of successful lookups.
+ */
+__rte_experimental
+int
+rte_hash_lookup_touch_bulk_data(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, uint64_t now, uint64_t *hit_mask,
+		void *data[]);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find the entries not refreshed since a timestamp, in a table created
+ * with RTE_HASH_EXTRA_FLAGS_AGING. The work is bounded: a few buckets are
+ * visited from the cursor, which is advanced for the next call and wraps
+ * around at the end of the table. The expired entries are not deleted,
+ * the caller deletes them with rte_hash_del_key().
+ * The extendable buckets are visited after the main buckets, and so are
+ * the old buckets while the table is resized: an entry moved by the
+ * resize during a sweep may be returned twice.
+ * This operation is multi-thread safe with regarding to lookup threads,
+ * and several threads can sweep different parts of the table.
+ *
+ * @param h
+ *   Hash table to sweep.
+ * @param cursor
+ *   Cursor of the sweep, to be zeroed for the first call except the part
+ *   of the table to sweep.
+ * @param nb_buckets
+ *   Maximum number of buckets to visit.
+ * @param expiry
+ *   Entries with an older timestamp are expired, in TSC cycles.
+ * @param keys
+ *   Output containing the keys of the expired entries.
+ * @param data
+ *   Output containing the data of the expired entries, can be NULL.
+ * @param max_expired
+ *   Size of the keys and data arrays. The sweep stops when they are full.
+ * @return
+ *   Number of expired entries if successful.
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the table is not created with RTE_HASH_EXTRA_FLAGS_AGING.
+ */
+__rte_experimental
+int
+rte_hash_expire(const struct rte_hash *h,
+		struct rte_hash_expire_cursor *cursor, uint32_t nb_buckets,
+		uint64_t expiry, const void *keys[], void *data[],
+		uint32_t max_expired);
+
 /**
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
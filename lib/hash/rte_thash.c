@@ -13,6 +13,10 @@
 #include <rte_eal_memconfig.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_cpuflags.h>
+#include <rte_vect.h>
+
+#include "rte_thash_bulk.h"
 
 #define THASH_NAME_LEN		64
 #define TOEPLITZ_HASH_LEN	32
@@ -761,3 +765,113 @@ rte_thash_adjust_tuple(struct rte_thash_ctx *ctx,
 
 	return ret;
 }
+
+/* 32 bits of the key starting at bit pos */
+static inline uint32_t
+thash_key_window(const uint8_t *key, uint32_t pos)
+{
+	const uint8_t *k = &key[pos / CHAR_BIT];
+	uint64_t w;
+
+	w = (uint64_t)k[0] << 32 | (uint64_t)k[1] << 24 |
+		(uint64_t)k[2] << 16 | (uint64_t)k[3] << 8 | k[4];
+	return (uint32_t)(w >> (CHAR_BIT - pos % CHAR_BIT));
+}
+
+static void
+thash_bulk_scalar(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num)
+{
+	const uint8_t *t;
+	uint32_t i, j, hash;
+
+	for (i = 0; i < num; i++) {
+		t = tuples[i];
+		hash = 0;
+		for (j = 0; j < tuple_len; j++)
+			hash ^= tb->lut[2 * j][t[j] >> 4] ^
+				tb->lut[2 * j + 1][t[j] & 0xf];
+		hashes[i] = hash;
+	}
+}
+
+struct rte_thash_bulk *
+rte_thash_bulk_create(const uint8_t *rss_key, uint32_t key_len,
+	int socket_id)
+{
+	struct rte_thash_bulk *tb;
+	uint32_t i, j, v, max_len, nb_mtrx;
+	size_t lut_sz;
+	uint8_t k0, k1;
+
+	if (rss_key == NULL || key_len <= RTE_THASH_BULK_KEY_TAIL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	max_len = key_len - RTE_THASH_BULK_KEY_TAIL;
+	/* the vector path reads 8 matrices at a time up to byte max_len + 3 */
+	nb_mtrx = RTE_ALIGN(max_len + 3, 8);
+	lut_sz = RTE_ALIGN(sizeof(*tb) + 2 * max_len * sizeof(tb->lut[0]),
+		RTE_CACHE_LINE_SIZE);
+
+	tb = rte_zmalloc_socket("THASH_BULK",
+		lut_sz + nb_mtrx * sizeof(tb->mtrx[0]),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (tb == NULL) {
+		RTE_LOG(ERR, HASH, "thash bulk memory allocation failed\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	tb->max_len = max_len;
+	tb->mtrx = RTE_PTR_ADD(tb, lut_sz);
+
+	for (i = 0; i < 2 * max_len; i++)
+		for (v = 0; v < 16; v++)
+			for (j = 0; j < 4; j++)
+				if (v & (0x8 >> j))
+					tb->lut[i][v] ^= thash_key_window(
+						rss_key, 4 * i + j);
+
+	for (i = 0; i < nb_mtrx; i++) {
+		k0 = (i < key_len) ? rss_key[i] : 0;
+		k1 = (i + 1 < key_len) ? rss_key[i + 1] : 0;
+		for (j = 0; j < CHAR_BIT; j++)
+			tb->mtrx[i] |= (uint64_t)(uint8_t)(
+				(k0 << j) | (k1 >> (CHAR_BIT - j))) <<
+				(j * CHAR_BIT);
+	}
+
+	tb->hash_fn = thash_bulk_scalar;
+#if defined(RTE_ARCH_X86) && defined(CC_GFNI_SUPPORT)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_GFNI) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512VL) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512VBMI) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512)
+		tb->hash_fn = rte_thash_bulk_gfni;
+#endif
+
+	return tb;
+}
+
+void
+rte_thash_bulk_free(struct rte_thash_bulk *tb)
+{
+	rte_free(tb);
+}
+
+int
+rte_thash_bulk_hash(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num)
+{
+	if (tb == NULL || tuples == NULL || hashes == NULL ||
+			tuple_len > tb->max_len)
+		return -EINVAL;
+
+	tb->hash_fn(tb, tuples, tuple_len, hashes, num);
+	return 0;
+}
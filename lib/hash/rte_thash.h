@@ -445,6 +445,80 @@ rte_thash_adjust_tuple(struct rte_thash_ctx *ctx,
 	uint32_t desired_value, unsigned int attempts,
 	rte_thash_check_tuple_t fn, void *userdata);
 
+/** @internal Bulk Toeplitz hash structure. */
+struct rte_thash_bulk;
+
+/**
+ * Create the tables used to calculate the Toeplitz hash of bursts of tuples
+ * with a given RSS key.
+ * The vector implementation (GFNI and AVX512) is selected if supported by
+ * the CPU and allowed by the maximum SIMD bitwidth, the table driven scalar
+ * implementation otherwise.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param rss_key
+ *  Pointer to the RSS hash key, as installed on the NIC.
+ * @param key_len
+ *  Length of the RSS hash key in bytes. Tuples up to key_len - 4 bytes
+ *  can be hashed.
+ * @param socket_id
+ *  NUMA socket to allocate memory on.
+ * @return
+ *  A pointer to the created structure on success,
+ *  NULL otherwise with rte_errno set appropriately:
+ *   - EINVAL - invalid parameter
+ *   - ENOMEM - no appropriate memory available
+ */
+__rte_experimental
+struct rte_thash_bulk *
+rte_thash_bulk_create(const uint8_t *rss_key, uint32_t key_len,
+	int socket_id);
+
+/**
+ * Free a bulk Toeplitz hash structure.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param tb
+ *  Bulk Toeplitz hash structure, can be NULL.
+ */
+__rte_experimental
+void
+rte_thash_bulk_free(struct rte_thash_bulk *tb);
+
+/**
+ * Calculate the Toeplitz hash of a burst of tuples of the same length.
+ * Unlike rte_softrss(), the tuples are in network byte order,
+ * as extracted from the packets, and their length is not required
+ * to be a multiple of 4.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param tb
+ *  Bulk Toeplitz hash structure.
+ * @param tuples
+ *  Array of pointers to the tuples.
+ * @param tuple_len
+ *  Length of each tuple in bytes.
+ * @param hashes
+ *  Output array of the calculated hash values.
+ * @param num
+ *  Number of tuples.
+ * @return
+ *  0 on success,
+ *  -EINVAL if a parameter is invalid or the tuples are longer
+ *  than supported by the RSS key.
+ */
+__rte_experimental
+int
+rte_thash_bulk_hash(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num);
+
 #ifdef __cplusplus
 }
 #endif
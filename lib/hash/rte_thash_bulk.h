@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _RTE_THASH_BULK_H_
+#define _RTE_THASH_BULK_H_
+
+#include <stdint.h>
+
+#include "rte_thash.h"
+
+/* Number of key bytes not usable as first byte of a 32-bit hash window */
+#define RTE_THASH_BULK_KEY_TAIL	4
+
+typedef void (*rte_thash_bulk_fn)(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num);
+
+struct rte_thash_bulk {
+	rte_thash_bulk_fn hash_fn;	/**< Implementation of the bulk hash */
+	uint32_t max_len;		/**< Longest tuple in bytes */
+	/**
+	 * GFNI affine matrix of each key byte: byte t of mtrx[q] is
+	 * the 8-bit window of the key starting at bit 8 * q + t.
+	 */
+	uint64_t *mtrx;
+	/**
+	 * Hash of each value of each nibble of the tuple: lut[2 * i] for
+	 * the high nibble of byte i, lut[2 * i + 1] for the low one.
+	 */
+	uint32_t lut[][16];
+};
+
+#if defined(RTE_ARCH_X86) && defined(CC_GFNI_SUPPORT)
+void
+rte_thash_bulk_gfni(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num);
+#endif
+
+#endif /* _RTE_THASH_BULK_H_ */
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_vect.h>
+
+#include "rte_thash_bulk.h"
+
+/*
+ * Byte o of the hash is the XOR for all q of the affine transformation
+ * by mtrx[q] of byte q - o of the tuple. Each 64-bit lane j of a chunk
+ * handles q = base + j: its bytes 0-3 hold the tuple bytes q - 0 .. q - 3
+ * of the first tuple and its bytes 4-7 the same ones of the second tuple.
+ * The source holds the previous and current 8 bytes of both tuples.
+ */
+#define GFNI_IDX(j, o)	((o) < 4 ? 8 + (j) - (o) : 24 + (j) - ((o) - 4))
+#define GFNI_LANE_IDX(j)	\
+	GFNI_IDX(j, 0), GFNI_IDX(j, 1), GFNI_IDX(j, 2), GFNI_IDX(j, 3), \
+	GFNI_IDX(j, 4), GFNI_IDX(j, 5), GFNI_IDX(j, 6), GFNI_IDX(j, 7)
+
+static const uint8_t gfni_permute_idx[64] __rte_aligned(64) = {
+	GFNI_LANE_IDX(0), GFNI_LANE_IDX(1), GFNI_LANE_IDX(2), GFNI_LANE_IDX(3),
+	GFNI_LANE_IDX(4), GFNI_LANE_IDX(5), GFNI_LANE_IDX(6), GFNI_LANE_IDX(7),
+};
+
+static __rte_always_inline uint64_t
+thash_gfni_x2(const struct rte_thash_bulk *tb, const uint8_t *t0,
+	const uint8_t *t1, uint32_t len)
+{
+	const __m512i idx = _mm512_load_si512(gfni_permute_idx);
+	__m128i prev0, prev1, cur0, cur1;
+	__m512i src, acc;
+	__m256i acc256;
+	__m128i acc128;
+	__mmask16 mask;
+	uint32_t base;
+
+	acc = _mm512_setzero_si512();
+	prev0 = _mm_setzero_si128();
+	prev1 = _mm_setzero_si128();
+
+	/* the last tuple byte contributes to the matrices up to len + 2 */
+	for (base = 0; base < len + 3; base += 8) {
+		if (base < len) {
+			mask = (len - base >= 8) ? 0xff :
+				(1 << (len - base)) - 1;
+			cur0 = _mm_maskz_loadu_epi8(mask, t0 + base);
+			cur1 = _mm_maskz_loadu_epi8(mask, t1 + base);
+		} else {
+			cur0 = _mm_setzero_si128();
+			cur1 = _mm_setzero_si128();
+		}
+
+		src = _mm512_castsi128_si512(_mm_unpacklo_epi64(prev0, cur0));
+		src = _mm512_inserti32x4(src, _mm_unpacklo_epi64(prev1, cur1),
+			1);
+		src = _mm512_permutexvar_epi8(idx, src);
+		acc = _mm512_xor_si512(acc, _mm512_gf2p8affine_epi64_epi8(src,
+			_mm512_loadu_si512(&tb->mtrx[base]), 0));
+
+		prev0 = cur0;
+		prev1 = cur1;
+	}
+
+	acc256 = _mm256_xor_si256(_mm512_castsi512_si256(acc),
+		_mm512_extracti64x4_epi64(acc, 1));
+	acc128 = _mm_xor_si128(_mm256_castsi256_si128(acc256),
+		_mm256_extracti128_si256(acc256, 1));
+
+	return (uint64_t)_mm_cvtsi128_si64(acc128) ^
+		(uint64_t)_mm_extract_epi64(acc128, 1);
+}
+
+void
+rte_thash_bulk_gfni(const struct rte_thash_bulk *tb,
+	const uint8_t * const tuples[], uint32_t tuple_len,
+	uint32_t hashes[], uint32_t num)
+{
+	uint64_t r;
+	uint32_t i;
+
+	/* byte 0 of each half is the most significant byte of the hash */
+	for (i = 0; i + 1 < num; i += 2) {
+		r = thash_gfni_x2(tb, tuples[i], tuples[i + 1], tuple_len);
+		hashes[i] = rte_bswap32((uint32_t)r);
+		hashes[i + 1] = rte_bswap32((uint32_t)(r >> 32));
+	}
+	if (i < num) {
+		r = thash_gfni_x2(tb, tuples[i], tuples[i], tuple_len);
+		hashes[i] = rte_bswap32((uint32_t)r);
+	}
+}
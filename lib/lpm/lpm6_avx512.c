@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <rte_vect.h>
+#include <rte_lpm6.h>
+
+#include "lpm6_avx512.h"
+
+/* Table entry bits, see struct rte_lpm6_tbl_entry */
+#define LPM6_VALID_EXT_ENTRY_BITMASK	0xA0000000
+#define LPM6_LOOKUP_SUCCESS		0x20000000
+#define LPM6_TBL8_BITMASK		0x001FFFFF
+
+/* Index of the first address byte looked up in tbl8 */
+#define LPM6_TBL8_FIRST_BYTE		3
+
+static __rte_always_inline void
+transpose_x16(uint8_t ips[16][RTE_LPM6_IPV6_ADDR_SIZE], __m512i chunks[4])
+{
+	__m512i tmp1, tmp2, tmp3, tmp4;
+	__m512i tmp5, tmp6, tmp7, tmp8;
+	const __rte_x86_zmm_t perm_idxes = {
+		.u32 = { 0, 4, 8, 12, 2, 6, 10, 14,
+			1, 5, 9, 13, 3, 7, 11, 15
+		},
+	};
+
+	/* load all ip addresses */
+	tmp1 = _mm512_loadu_si512(&ips[0][0]);
+	tmp2 = _mm512_loadu_si512(&ips[4][0]);
+	tmp3 = _mm512_loadu_si512(&ips[8][0]);
+	tmp4 = _mm512_loadu_si512(&ips[12][0]);
+
+	/* transpose 4 byte chunks of 16 ips */
+	tmp5 = _mm512_unpacklo_epi32(tmp1, tmp2);
+	tmp7 = _mm512_unpackhi_epi32(tmp1, tmp2);
+	tmp6 = _mm512_unpacklo_epi32(tmp3, tmp4);
+	tmp8 = _mm512_unpackhi_epi32(tmp3, tmp4);
+
+	tmp1 = _mm512_unpacklo_epi32(tmp5, tmp6);
+	tmp3 = _mm512_unpackhi_epi32(tmp5, tmp6);
+	tmp2 = _mm512_unpacklo_epi32(tmp7, tmp8);
+	tmp4 = _mm512_unpackhi_epi32(tmp7, tmp8);
+
+	chunks[0] = _mm512_permutexvar_epi32(perm_idxes.z, tmp1);
+	chunks[1] = _mm512_permutexvar_epi32(perm_idxes.z, tmp3);
+	chunks[2] = _mm512_permutexvar_epi32(perm_idxes.z, tmp2);
+	chunks[3] = _mm512_permutexvar_epi32(perm_idxes.z, tmp4);
+}
+
+static __rte_always_inline void
+lpm6_vec_lookup_x16x2(const uint32_t *tbl24, const uint32_t *tbl8,
+	uint8_t ips[32][RTE_LPM6_IPV6_ADDR_SIZE], int32_t *next_hops)
+{
+	const __m512i ext_msk = _mm512_set1_epi32(LPM6_VALID_EXT_ENTRY_BITMASK);
+	const __m512i success = _mm512_set1_epi32(LPM6_LOOKUP_SUCCESS);
+	const __m512i tbl8_msk = _mm512_set1_epi32(LPM6_TBL8_BITMASK);
+	const __m512i byte_msk = _mm512_set1_epi32(UINT8_MAX);
+	const __m512i miss = _mm512_set1_epi32(-1);
+	const __rte_x86_zmm_t bswap = {
+		.u8 = { 2, 1, 0, 255, 6, 5, 4, 255,
+			10, 9, 8, 255, 14, 13, 12, 255,
+			2, 1, 0, 255, 6, 5, 4, 255,
+			10, 9, 8, 255, 14, 13, 12, 255,
+			2, 1, 0, 255, 6, 5, 4, 255,
+			10, 9, 8, 255, 14, 13, 12, 255,
+			2, 1, 0, 255, 6, 5, 4, 255,
+			10, 9, 8, 255, 14, 13, 12, 255
+			},
+	};
+	/* IPv6 four byte chunks */
+	__m512i chunks_1[4], chunks_2[4];
+	__m512i idxes_1, res_1, bytes_1;
+	__m512i idxes_2, res_2, bytes_2;
+	__mmask16 msk_ext_1, msk_hit_1;
+	__mmask16 msk_ext_2, msk_hit_2;
+	__m128i shift;
+	int i;
+
+	transpose_x16(ips, chunks_1);
+	transpose_x16(ips + 16, chunks_2);
+
+	/* tbl24 index from the first three bytes */
+	idxes_1 = _mm512_shuffle_epi8(chunks_1[0], bswap.z);
+	idxes_2 = _mm512_shuffle_epi8(chunks_2[0], bswap.z);
+	res_1 = _mm512_i32gather_epi32(idxes_1, (const int *)tbl24, 4);
+	res_2 = _mm512_i32gather_epi32(idxes_2, (const int *)tbl24, 4);
+
+	/* follow the tbl8 chains, one address byte per step */
+	for (i = LPM6_TBL8_FIRST_BYTE; i < RTE_LPM6_IPV6_ADDR_SIZE; i++) {
+		msk_ext_1 = _mm512_cmpeq_epi32_mask(
+			_mm512_and_epi32(res_1, ext_msk), ext_msk);
+		msk_ext_2 = _mm512_cmpeq_epi32_mask(
+			_mm512_and_epi32(res_2, ext_msk), ext_msk);
+		if ((msk_ext_1 | msk_ext_2) == 0)
+			break;
+
+		shift = _mm_cvtsi32_si128((i % 4) * 8);
+		bytes_1 = _mm512_and_epi32(
+			_mm512_srl_epi32(chunks_1[i / 4], shift), byte_msk);
+		bytes_2 = _mm512_and_epi32(
+			_mm512_srl_epi32(chunks_2[i / 4], shift), byte_msk);
+		idxes_1 = _mm512_slli_epi32(
+			_mm512_and_epi32(res_1, tbl8_msk), 8);
+		idxes_2 = _mm512_slli_epi32(
+			_mm512_and_epi32(res_2, tbl8_msk), 8);
+		idxes_1 = _mm512_add_epi32(idxes_1, bytes_1);
+		idxes_2 = _mm512_add_epi32(idxes_2, bytes_2);
+		res_1 = _mm512_mask_i32gather_epi32(res_1, msk_ext_1, idxes_1,
+			(const int *)tbl8, 4);
+		res_2 = _mm512_mask_i32gather_epi32(res_2, msk_ext_2, idxes_2,
+			(const int *)tbl8, 4);
+	}
+
+	msk_hit_1 = _mm512_test_epi32_mask(res_1, success);
+	msk_hit_2 = _mm512_test_epi32_mask(res_2, success);
+	res_1 = _mm512_mask_and_epi32(miss, msk_hit_1, res_1, tbl8_msk);
+	res_2 = _mm512_mask_and_epi32(miss, msk_hit_2, res_2, tbl8_msk);
+	_mm512_storeu_si512(next_hops, res_1);
+	_mm512_storeu_si512(next_hops + 16, res_2);
+}
+
+void
+rte_lpm6_vec_lookup_bulk(const uint32_t *tbl24, const uint32_t *tbl8,
+	uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE], int32_t *next_hops,
+	const unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n / 32; i++)
+		lpm6_vec_lookup_x16x2(tbl24, tbl8, ips + i * 32,
+			next_hops + i * 32);
+}
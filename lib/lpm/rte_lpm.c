@@ -52,6 +52,21 @@ struct rte_lpm_rule_info {
 	uint32_t first_rule; /**< Indexes the first rule of a given depth. */
 };
 
+/** @internal Header of a file written by rte_lpm_save(). */
+struct rte_lpm_file_hdr {
+	uint32_t magic; /**< LPM_FILE_MAGIC once completely written. */
+	uint32_t version; /**< LPM_FILE_VERSION. */
+	uint32_t max_rules; /**< Max. balanced rules per lpm. */
+	uint32_t number_tbl8s; /**< Number of tbl8s. */
+	uint32_t nb_rules; /**< Rules in the file. */
+	uint32_t nb_tbl8s; /**< tbl8 groups in the file. */
+	/**< Rule info table. */
+	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH];
+};
+
+#define LPM_FILE_MAGIC 0x344d504c /* "LPM4" */
+#define LPM_FILE_VERSION 1
+
 /** @internal LPM structure. */
 struct __rte_lpm {
 	/* Exposed LPM data. */
@@ -1223,3 +1238,155 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	/* Delete all rules form the rules table. */
 	memset(i_lpm->rules_tbl, 0, sizeof(i_lpm->rules_tbl[0]) * i_lpm->max_rules);
 }
+
+/*
+ * Saves the rules and the tables of an LPM to a file.
+ */
+int
+rte_lpm_save(struct rte_lpm *lpm, const char *path)
+{
+	struct rte_lpm_file_hdr hdr;
+	struct __rte_lpm *i_lpm;
+	uint32_t i;
+	size_t sz;
+	FILE *f;
+	int ret = 0;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (path == NULL))
+		return -EINVAL;
+	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	/* Free the tbl8 groups still waiting for the readers. */
+	if (i_lpm->dq != NULL) {
+		rte_rcu_qsbr_synchronize(i_lpm->v, RTE_QSBR_THRID_INVALID);
+		rte_rcu_qsbr_dq_reclaim(i_lpm->dq, i_lpm->number_tbl8s,
+			NULL, NULL, NULL);
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.max_rules = i_lpm->max_rules;
+	hdr.number_tbl8s = i_lpm->number_tbl8s;
+	memcpy(hdr.rule_info, i_lpm->rule_info, sizeof(hdr.rule_info));
+	/* Rules of all depths are packed at the start of the table. */
+	for (i = 0; i < RTE_LPM_MAX_DEPTH; i++)
+		if (i_lpm->rule_info[i].used_rules > 0)
+			hdr.nb_rules = i_lpm->rule_info[i].first_rule +
+				i_lpm->rule_info[i].used_rules;
+	/* tbl8 groups are saved up to the last valid one. */
+	for (i = 0; i < i_lpm->number_tbl8s; i++)
+		if (lpm->tbl8[i * RTE_LPM_TBL8_GROUP_NUM_ENTRIES].valid_group)
+			hdr.nb_tbl8s = i + 1;
+
+	f = fopen(path, "wb");
+	if (f == NULL)
+		return -errno;
+
+	/* The magic is written last, so that a partial file is invalid. */
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+		ret = -EIO;
+		goto exit;
+	}
+	sz = sizeof(i_lpm->rules_tbl[0]) * hdr.nb_rules;
+	if (fwrite(i_lpm->rules_tbl, 1, sz, f) != sz) {
+		ret = -EIO;
+		goto exit;
+	}
+	if (fwrite(lpm->tbl24, sizeof(lpm->tbl24), 1, f) != 1) {
+		ret = -EIO;
+		goto exit;
+	}
+	sz = sizeof(lpm->tbl8[0]) * RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+		hdr.nb_tbl8s;
+	if (fwrite(lpm->tbl8, 1, sz, f) != sz) {
+		ret = -EIO;
+		goto exit;
+	}
+
+	hdr.magic = LPM_FILE_MAGIC;
+	hdr.version = LPM_FILE_VERSION;
+	if ((fseek(f, 0, SEEK_SET) != 0) ||
+			(fwrite(&hdr, sizeof(hdr), 1, f) != 1))
+		ret = -EIO;
+exit:
+	if ((fclose(f) != 0) && (ret == 0))
+		ret = -EIO;
+	if (ret != 0)
+		remove(path);
+	return ret;
+}
+
+/*
+ * Creates an LPM from a file written by rte_lpm_save().
+ */
+struct rte_lpm *
+rte_lpm_load(const char *name, int socket_id, const char *path)
+{
+	struct rte_lpm_config config;
+	struct rte_lpm_file_hdr hdr;
+	struct __rte_lpm *i_lpm;
+	struct rte_lpm *lpm = NULL;
+	uint32_t i;
+	size_t sz;
+	FILE *f;
+	int ret = 0;
+
+	/* Check user arguments. */
+	if ((name == NULL) || (path == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		rte_errno = errno;
+		return NULL;
+	}
+	if ((fread(&hdr, sizeof(hdr), 1, f) != 1) ||
+			(hdr.magic != LPM_FILE_MAGIC) ||
+			(hdr.version != LPM_FILE_VERSION) ||
+			(hdr.nb_rules > hdr.max_rules) ||
+			(hdr.nb_tbl8s > hdr.number_tbl8s)) {
+		ret = -EINVAL;
+		goto exit;
+	}
+	for (i = 0; i < RTE_LPM_MAX_DEPTH; i++) {
+		if ((hdr.rule_info[i].used_rules > 0) &&
+				((uint64_t)hdr.rule_info[i].first_rule +
+				hdr.rule_info[i].used_rules > hdr.nb_rules)) {
+			ret = -EINVAL;
+			goto exit;
+		}
+	}
+
+	config.max_rules = hdr.max_rules;
+	config.number_tbl8s = hdr.number_tbl8s;
+	config.flags = 0;
+	lpm = rte_lpm_create(name, socket_id, &config);
+	if (lpm == NULL) {
+		ret = -rte_errno;
+		goto exit;
+	}
+	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	/* The tables are not visible to the readers yet. */
+	memcpy(i_lpm->rule_info, hdr.rule_info, sizeof(i_lpm->rule_info));
+	sz = sizeof(i_lpm->rules_tbl[0]) * hdr.nb_rules;
+	if ((fread(i_lpm->rules_tbl, 1, sz, f) != sz) ||
+			(fread(lpm->tbl24, sizeof(lpm->tbl24), 1, f) != 1)) {
+		ret = -EINVAL;
+		goto exit;
+	}
+	sz = sizeof(lpm->tbl8[0]) * RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+		hdr.nb_tbl8s;
+	if (fread(lpm->tbl8, 1, sz, f) != sz)
+		ret = -EINVAL;
+exit:
+	fclose(f);
+	if (ret != 0) {
+		rte_lpm_free(lpm);
+		rte_errno = -ret;
+		return NULL;
+	}
+	return lpm;
+}
@@ -210,6 +210,52 @@ rte_lpm_free(struct rte_lpm *lpm);
 __rte_experimental
 int rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, struct rte_lpm_rcu_config *cfg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Save the rules and the tables of an LPM object to a file, so that
+ * rte_lpm_load() restores it without adding the rules again.
+ * The file can only be loaded by the same DPDK version on the same
+ * architecture. The LPM object must not be updated meanwhile.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param path
+ *   Path of the file to write
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid parameter passed to function
+ *   - other negative errno values if the file cannot be written
+ */
+__rte_experimental
+int rte_lpm_save(struct rte_lpm *lpm, const char *path);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create an LPM object from a file written by rte_lpm_save().
+ * The tables are read straight into the memory of the new object.
+ *
+ * @param name
+ *   LPM object name
+ * @param socket_id
+ *   NUMA socket ID for LPM table memory allocation
+ * @param path
+ *   Path of the file to read
+ * @return
+ *   Handle to LPM object on success, NULL otherwise with rte_errno set
+ *   to an appropriate values. Possible rte_errno values include:
+ *    - EINVAL - invalid parameter passed to function or invalid file
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - other errno values if the file cannot be read
+ */
+__rte_experimental
+struct rte_lpm *
+rte_lpm_load(const char *name, int socket_id, const char *path);
+
 /**
  * Add a rule to the LPM table.
  *
@@ -25,9 +25,14 @@
 #include <assert.h>
 #include <rte_jhash.h>
 #include <rte_tailq.h>
+#include <rte_vect.h>
 
 #include "rte_lpm6.h"
 
+#ifdef CC_LPM6_AVX512_SUPPORT
+#include "lpm6_avx512.h"
+#endif
+
 #define RTE_LPM6_TBL24_NUM_ENTRIES        (1 << 24)
 #define RTE_LPM6_TBL8_GROUP_NUM_ENTRIES         256
 #define RTE_LPM6_TBL8_MAX_NUM_GROUPS      (1 << 21)
@@ -41,6 +46,9 @@
 #define BYTE_SIZE                                 8
 #define BYTES2_SIZE                              16
 
+#define LOOKUP_BULK_LANES                        16
+#define LOOKUP_BULK_VEC_LANES                    32
+
 #define RULE_HASH_TABLE_EXTRA_SPACE              64
 #define TBL24_IND                        UINT32_MAX
 
@@ -101,6 +109,7 @@ struct rte_lpm6 {
 	uint32_t max_rules;              /**< Max number of rules. */
 	uint32_t used_rules;             /**< Used rules so far. */
 	uint32_t number_tbl8s;           /**< Number of tbl8s to allocate. */
+	uint8_t vec_lookup;              /**< Bulk lookup with AVX512. */
 
 	/* LPM Tables. */
 	struct rte_hash *rules_tbl; /**< LPM rules. */
@@ -357,6 +366,11 @@ rte_lpm6_create(const char *name, int socket_id,
 	lpm->rules_tbl = rules_tbl;
 	lpm->tbl8_pool = tbl8_pool;
 	lpm->tbl8_hdrs = tbl8_hdrs;
+#ifdef CC_LPM6_AVX512_SUPPORT
+	lpm->vec_lookup = (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0) &&
+		(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0) &&
+		(rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512);
+#endif
 
 	/* init the stack */
 	tbl8_pool_init(lpm);
@@ -971,6 +985,63 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, const uint8_t *ip,
 	return status;
 }
 
+/*
+ * Looks up the addresses by groups of LOOKUP_BULK_LANES, stepping all the
+ * addresses of a group through a level before going to the next one, so
+ * that their table reads overlap.
+ */
+static void
+lookup_bulk_interleaved(const struct rte_lpm6 *lpm,
+		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
+		int32_t *next_hops, unsigned int n)
+{
+	uint32_t tbl_entries[LOOKUP_BULK_LANES];
+	const struct rte_lpm6_tbl_entry *tbl;
+	uint32_t tbl24_index, tbl8_index;
+	unsigned int i, j, k, pending;
+	uint8_t byte;
+
+	for (i = 0; i < n; i += k) {
+		k = RTE_MIN(n - i, (unsigned int)LOOKUP_BULK_LANES);
+
+		for (j = 0; j < k; j++) {
+			tbl24_index = (ips[i + j][0] << BYTES2_SIZE) |
+					(ips[i + j][1] << BYTE_SIZE) |
+					ips[i + j][2];
+			tbl = &lpm->tbl24[tbl24_index];
+			tbl_entries[j] = *(const uint32_t *)tbl;
+		}
+
+		/* Continue inspecting following levels for all the group */
+		byte = LOOKUP_FIRST_BYTE - 1;
+		do {
+			pending = 0;
+			for (j = 0; j < k; j++) {
+				if ((tbl_entries[j] &
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK) !=
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK)
+					continue;
+
+				tbl8_index = ips[i + j][byte] +
+					((tbl_entries[j] & RTE_LPM6_TBL8_BITMASK) *
+					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES);
+				tbl = &lpm->tbl8[tbl8_index];
+				tbl_entries[j] = *(const uint32_t *)tbl;
+				pending = 1;
+			}
+			byte++;
+		} while (pending && byte < RTE_LPM6_IPV6_ADDR_SIZE);
+
+		for (j = 0; j < k; j++) {
+			if (tbl_entries[j] & RTE_LPM6_LOOKUP_SUCCESS)
+				next_hops[i + j] = (int32_t)(tbl_entries[j] &
+					RTE_LPM6_TBL8_BITMASK);
+			else
+				next_hops[i + j] = -1;
+		}
+	}
+}
+
 /*
  * Looks up a group of IP addresses
  */
@@ -979,39 +1050,20 @@ rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
 		int32_t *next_hops, unsigned int n)
 {
-	unsigned int i;
-	const struct rte_lpm6_tbl_entry *tbl;
-	const struct rte_lpm6_tbl_entry *tbl_next = NULL;
-	uint32_t tbl24_index, next_hop;
-	uint8_t first_byte;
-	int status;
+	unsigned int done = 0;
 
 	/* DEBUG: Check user input arguments. */
 	if ((lpm == NULL) || (ips == NULL) || (next_hops == NULL))
 		return -EINVAL;
 
-	for (i = 0; i < n; i++) {
-		first_byte = LOOKUP_FIRST_BYTE;
-		tbl24_index = (ips[i][0] << BYTES2_SIZE) |
-				(ips[i][1] << BYTE_SIZE) | ips[i][2];
-
-		/* Calculate pointer to the first entry to be inspected */
-		tbl = &lpm->tbl24[tbl24_index];
-
-		do {
-			/* Continue inspecting following levels
-			 * until success or failure
-			 */
-			status = lookup_step(lpm, tbl, &tbl_next, ips[i],
-					first_byte++, &next_hop);
-			tbl = tbl_next;
-		} while (status == 1);
-
-		if (status < 0)
-			next_hops[i] = -1;
-		else
-			next_hops[i] = (int32_t)next_hop;
+#ifdef CC_LPM6_AVX512_SUPPORT
+	if (lpm->vec_lookup && n >= LOOKUP_BULK_VEC_LANES) {
+		done = RTE_ALIGN_FLOOR(n, LOOKUP_BULK_VEC_LANES);
+		rte_lpm6_vec_lookup_bulk((const uint32_t *)lpm->tbl24,
+			(const uint32_t *)lpm->tbl8, ips, next_hops, done);
 	}
+#endif
+	lookup_bulk_interleaved(lpm, ips + done, next_hops + done, n - done);
 
 	return 0;
 }
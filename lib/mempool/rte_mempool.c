@@ -31,6 +31,9 @@
 #include <rte_spinlock.h>
 #include <rte_tailq.h>
 #include <rte_eal_paging.h>
+#include <rte_alarm.h>
+#include <rte_cycles.h>
+#include <rte_telemetry.h>
 
 #include "rte_mempool.h"
 #include "rte_mempool_trace.h"
@@ -718,6 +721,365 @@ rte_mempool_populate_anon(struct rte_mempool *mp)
 	return 0;
 }
 
+/* A memory chunk reserved by an elastic mempool */
+struct mempool_elastic_chunk {
+	const struct rte_memzone *mz;
+	uint32_t nb_objs; /* objects populated in the chunk */
+	uint32_t nb_free; /* objects of the chunk held by the shrink */
+};
+
+struct rte_mempool_elastic {
+	struct rte_mempool_elastic_conf conf;
+	rte_spinlock_t lock; /* serializes the adjustments */
+	uint32_t mz_id; /* identifier of the next memzone */
+	uint32_t nb_chunks;
+	uint32_t max_chunks;
+	struct mempool_elastic_chunk *chunks; /* sorted by address */
+	uint64_t nb_grow;
+	uint64_t nb_shrink;
+};
+
+/* Number of objects dequeued at once when shrinking an elastic mempool */
+#define MEMPOOL_ELASTIC_SHRINK_BURST 64U
+
+/* Free the chunks of an elastic mempool, once its objects are removed */
+static void
+mempool_elastic_free(struct rte_mempool *mp)
+{
+	struct rte_mempool_elastic *el = mp->elastic;
+	uint32_t i;
+
+	if (el == NULL)
+		return;
+
+	for (i = 0; i < el->nb_chunks; i++)
+		rte_memzone_free(el->chunks[i].mz);
+	rte_free(el->chunks);
+	rte_free(el);
+	mp->elastic = NULL;
+}
+
+/* Reserve a memory chunk and add its objects to an elastic mempool */
+static int
+mempool_elastic_grow(struct rte_mempool *mp)
+{
+	struct rte_mempool_elastic *el = mp->elastic;
+	unsigned int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	struct mempool_elastic_chunk *chunk;
+	const struct rte_memzone *mz;
+	size_t align, pg_sz, pg_shift = 0;
+	size_t min_chunk_size;
+	ssize_t mem_size;
+	uint32_t n, i;
+	int ret;
+
+	n = RTE_MIN(el->conf.chunk_size, mp->size - mp->populated_size);
+	if (n == 0)
+		return -ENOSPC;
+
+	if (el->nb_chunks == el->max_chunks) {
+		uint32_t max_chunks = RTE_MAX(el->max_chunks * 2, 8U);
+
+		chunk = rte_realloc(el->chunks, sizeof(*chunk) * max_chunks, 0);
+		if (chunk == NULL)
+			return -ENOMEM;
+		el->chunks = chunk;
+		el->max_chunks = max_chunks;
+	}
+
+	ret = rte_mempool_get_page_size(mp, &pg_sz);
+	if (ret < 0)
+		return ret;
+	if (pg_sz != 0)
+		pg_shift = rte_bsf32(pg_sz);
+
+	mem_size = rte_mempool_ops_calc_mem_size(mp, n, pg_shift,
+		&min_chunk_size, &align);
+	if (mem_size < 0)
+		return mem_size;
+	/*
+	 * Chunks are small compared to the whole mempool: request them IOVA
+	 * contiguous rather than populating them page per page, so that a
+	 * failure does not free the other chunks.
+	 */
+	if (pg_sz != 0)
+		mz_flags |= RTE_MEMZONE_IOVA_CONTIG;
+
+	ret = snprintf(mz_name, sizeof(mz_name),
+		RTE_MEMPOOL_MZ_FORMAT "_%u", mp->name, el->mz_id);
+	if (ret < 0 || ret >= (int)sizeof(mz_name))
+		return -ENAMETOOLONG;
+
+	mz = rte_memzone_reserve_aligned(mz_name, mem_size, mp->socket_id,
+		mz_flags, align);
+	if (mz == NULL)
+		return -rte_errno;
+	el->mz_id++;
+
+	/* the memzone is freed along with the chunk, not by a callback */
+	ret = rte_mempool_populate_iova(mp, mz->addr,
+		(mp->flags & MEMPOOL_F_NO_IOVA_CONTIG) ? RTE_BAD_IOVA : mz->iova,
+		mz->len, NULL, NULL);
+	if (ret == 0) /* should not happen */
+		ret = -ENOBUFS;
+	if (ret < 0) {
+		rte_memzone_free(mz);
+		return ret;
+	}
+
+	/* keep the chunks sorted by address */
+	for (i = el->nb_chunks; i > 0; i--) {
+		if (el->chunks[i - 1].mz->addr_64 < mz->addr_64)
+			break;
+		el->chunks[i] = el->chunks[i - 1];
+	}
+	el->chunks[i].mz = mz;
+	el->chunks[i].nb_objs = ret;
+	el->chunks[i].nb_free = 0;
+	el->nb_chunks++;
+	el->nb_grow++;
+
+	return ret;
+}
+
+/* Find the chunk of an elastic mempool holding an object */
+static struct mempool_elastic_chunk *
+mempool_elastic_chunk_find(struct rte_mempool_elastic *el, const void *obj)
+{
+	uint32_t lo = 0, hi = el->nb_chunks, mid;
+	const struct rte_memzone *mz;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		mz = el->chunks[mid].mz;
+		if (obj < mz->addr)
+			hi = mid;
+		else if ((const char *)obj >= (const char *)mz->addr + mz->len)
+			lo = mid + 1;
+		else
+			return &el->chunks[mid];
+	}
+
+	return NULL;
+}
+
+static bool
+mempool_elastic_chunk_contains(const struct mempool_elastic_chunk *chunk,
+	const void *addr)
+{
+	return addr >= chunk->mz->addr &&
+		(const char *)addr < (const char *)chunk->mz->addr +
+		chunk->mz->len;
+}
+
+/* Remove a chunk, whose objects are all held by the caller, from a mempool */
+static void
+mempool_elastic_chunk_release(struct rte_mempool *mp,
+	struct mempool_elastic_chunk *chunk)
+{
+	struct rte_mempool_elastic *el = mp->elastic;
+	struct rte_mempool_objhdr_list elt_list;
+	struct rte_mempool_memhdr_list mem_list;
+	struct rte_mempool_objhdr *hdr;
+	struct rte_mempool_memhdr *memhdr;
+
+	STAILQ_INIT(&elt_list);
+	while (!STAILQ_EMPTY(&mp->elt_list)) {
+		hdr = STAILQ_FIRST(&mp->elt_list);
+		STAILQ_REMOVE_HEAD(&mp->elt_list, next);
+		STAILQ_INSERT_TAIL(&elt_list, hdr, next);
+	}
+	while (!STAILQ_EMPTY(&elt_list)) {
+		hdr = STAILQ_FIRST(&elt_list);
+		STAILQ_REMOVE_HEAD(&elt_list, next);
+		if (mempool_elastic_chunk_contains(chunk, hdr))
+			mp->populated_size--;
+		else
+			STAILQ_INSERT_TAIL(&mp->elt_list, hdr, next);
+	}
+
+	STAILQ_INIT(&mem_list);
+	while (!STAILQ_EMPTY(&mp->mem_list)) {
+		memhdr = STAILQ_FIRST(&mp->mem_list);
+		STAILQ_REMOVE_HEAD(&mp->mem_list, next);
+		STAILQ_INSERT_TAIL(&mem_list, memhdr, next);
+	}
+	while (!STAILQ_EMPTY(&mem_list)) {
+		memhdr = STAILQ_FIRST(&mem_list);
+		STAILQ_REMOVE_HEAD(&mem_list, next);
+		if (mempool_elastic_chunk_contains(chunk, memhdr->addr)) {
+			rte_free(memhdr);
+			mp->nb_mem_chunks--;
+		} else {
+			STAILQ_INSERT_TAIL(&mp->mem_list, memhdr, next);
+		}
+	}
+
+	rte_memzone_free(chunk->mz);
+	el->nb_chunks--;
+	memmove(chunk, chunk + 1,
+		(el->chunks + el->nb_chunks - chunk) * sizeof(*chunk));
+	el->nb_shrink++;
+}
+
+/*
+ * Take the objects of the common pool above the low watermark and release
+ * the chunks whose objects were all taken. The objects of the other chunks
+ * are given back.
+ */
+static int
+mempool_elastic_shrink(struct rte_mempool *mp, unsigned int count)
+{
+	struct rte_mempool_elastic *el = mp->elastic;
+	struct mempool_elastic_chunk *chunk;
+	unsigned int n, i, j, nb_objs = 0;
+	void **objs;
+
+	n = count - el->conf.low_watermark;
+	objs = rte_malloc(NULL, sizeof(*objs) * n, 0);
+	if (objs == NULL)
+		return -ENOMEM;
+
+	while (nb_objs < n) {
+		i = RTE_MIN(n - nb_objs, MEMPOOL_ELASTIC_SHRINK_BURST);
+		/* the datapath may have taken objects meanwhile */
+		if (rte_mempool_ops_dequeue_bulk(mp, &objs[nb_objs], i) < 0)
+			break;
+		nb_objs += i;
+	}
+
+	for (i = 0; i < el->nb_chunks; i++)
+		el->chunks[i].nb_free = 0;
+	for (i = 0; i < nb_objs; i++) {
+		chunk = mempool_elastic_chunk_find(el, objs[i]);
+		if (chunk != NULL)
+			chunk->nb_free++;
+	}
+
+	/* compact the objects of the chunks which are kept */
+	for (i = 0, j = 0; i < nb_objs; i++) {
+		chunk = mempool_elastic_chunk_find(el, objs[i]);
+		if (chunk == NULL || chunk->nb_free != chunk->nb_objs)
+			objs[j++] = objs[i];
+	}
+	for (i = 0; i < el->nb_chunks; ) {
+		if (el->chunks[i].nb_free == el->chunks[i].nb_objs)
+			mempool_elastic_chunk_release(mp, &el->chunks[i]);
+		else
+			i++;
+	}
+
+	if (j != 0)
+		rte_mempool_ops_enqueue_bulk(mp, objs, j);
+	rte_free(objs);
+
+	return 0;
+}
+
+int
+rte_mempool_elastic_adjust(struct rte_mempool *mp)
+{
+	struct rte_mempool_elastic *el;
+	unsigned int count;
+	int ret = 0;
+
+	if (mp == NULL || mp->elastic == NULL)
+		return -EINVAL;
+	el = mp->elastic;
+
+	rte_spinlock_lock(&el->lock);
+
+	count = rte_mempool_ops_get_count(mp);
+	while (count < el->conf.low_watermark &&
+			mp->populated_size < mp->size) {
+		ret = mempool_elastic_grow(mp);
+		if (ret < 0)
+			break;
+		count += ret;
+		ret = 0;
+	}
+
+	if (el->conf.high_watermark != 0 && count > el->conf.high_watermark)
+		ret = mempool_elastic_shrink(mp, count);
+
+	rte_spinlock_unlock(&el->lock);
+
+	return ret;
+}
+
+static void
+mempool_elastic_alarm_cb(void *arg)
+{
+	struct rte_mempool *mp = arg;
+
+	rte_mempool_elastic_adjust(mp);
+	rte_eal_alarm_set(mp->elastic->conf.period_ms * US_PER_S / MS_PER_S,
+		mempool_elastic_alarm_cb, mp);
+}
+
+/* Stop the adjustments of an elastic mempool */
+static void
+mempool_elastic_stop(struct rte_mempool *mp)
+{
+	if (mp->elastic != NULL && mp->elastic->conf.period_ms != 0)
+		rte_eal_alarm_cancel(mempool_elastic_alarm_cb, mp);
+}
+
+int
+rte_mempool_populate_elastic(struct rte_mempool *mp,
+	const struct rte_mempool_elastic_conf *conf)
+{
+	struct rte_mempool_elastic *el;
+	int ret;
+
+	if (mp == NULL || conf == NULL || conf->chunk_size == 0 ||
+			conf->low_watermark > mp->size ||
+			(conf->high_watermark != 0 && conf->high_watermark <
+			 conf->low_watermark + conf->chunk_size))
+		return -EINVAL;
+	if (mp->flags & (MEMPOOL_F_SP_PUT | MEMPOOL_F_SC_GET))
+		return -EINVAL;
+
+	ret = mempool_ops_alloc_once(mp);
+	if (ret != 0)
+		return ret;
+
+	/* mempool must not be populated */
+	if (mp->nb_mem_chunks != 0 || mp->elastic != NULL)
+		return -EEXIST;
+
+	el = rte_zmalloc_socket("MEMPOOL_ELASTIC", sizeof(*el), 0,
+		mp->socket_id);
+	if (el == NULL)
+		return -ENOMEM;
+	el->conf = *conf;
+	rte_spinlock_init(&el->lock);
+	mp->elastic = el;
+
+	/* at least one chunk, up to the low watermark */
+	do {
+		ret = mempool_elastic_grow(mp);
+	} while (ret > 0 && mp->populated_size < conf->low_watermark);
+	if (ret < 0) {
+		rte_mempool_free_memchunks(mp);
+		mempool_elastic_free(mp);
+		return ret;
+	}
+
+	if (conf->period_ms != 0) {
+		ret = rte_eal_alarm_set(conf->period_ms * US_PER_S / MS_PER_S,
+			mempool_elastic_alarm_cb, mp);
+		if (ret < 0) {
+			rte_mempool_free_memchunks(mp);
+			mempool_elastic_free(mp);
+			return ret;
+		}
+	}
+
+	return mp->populated_size;
+}
+
 /* free a mempool */
 void
 rte_mempool_free(struct rte_mempool *mp)
@@ -744,7 +1106,9 @@ rte_mempool_free(struct rte_mempool *mp)
 
 	mempool_event_callback_invoke(RTE_MEMPOOL_EVENT_DESTROY, mp);
 	rte_mempool_trace_free(mp);
+	mempool_elastic_stop(mp);
 	rte_mempool_free_memchunks(mp);
+	mempool_elastic_free(mp);
 	rte_mempool_ops_free(mp);
 	rte_memzone_free(mp->mz);
 }
@@ -757,6 +1121,19 @@ mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
 	cache->len = 0;
 }
 
+/*
+ * An adaptive cache starts small, so that lcores seldom using the
+ * mempool do not hoard objects, and grows up to max_size when needed.
+ */
+static void
+mempool_cache_adaptive_init(struct rte_mempool_cache *cache,
+	uint32_t max_size)
+{
+	cache->min_size = RTE_MAX(max_size / 8, 1U);
+	cache->max_size = max_size;
+	mempool_cache_init(cache, cache->min_size);
+}
+
 /*
  * Create and initialize a cache for objects that are retrieved from and
  * returned to an underlying mempool. This structure is identical to the
@@ -804,6 +1181,7 @@ rte_mempool_cache_free(struct rte_mempool_cache *cache)
 	| MEMPOOL_F_SC_GET \
 	| MEMPOOL_F_POOL_CREATED \
 	| MEMPOOL_F_NO_IOVA_CONTIG \
+	| MEMPOOL_F_ADAPTIVE_CACHE \
 	)
 /* create an empty mempool */
 struct rte_mempool *
@@ -932,9 +1310,14 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 
 	/* Init all default caches. */
 	if (cache_size != 0) {
-		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
-			mempool_cache_init(&mp->local_cache[lcore_id],
-					   cache_size);
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			if (flags & MEMPOOL_F_ADAPTIVE_CACHE)
+				mempool_cache_adaptive_init(
+					&mp->local_cache[lcore_id], cache_size);
+			else
+				mempool_cache_init(&mp->local_cache[lcore_id],
+						   cache_size);
+		}
 	}
 
 	te->data = mp;
@@ -1036,13 +1419,14 @@ rte_mempool_avail_count(const struct rte_mempool *mp)
 unsigned int
 rte_mempool_in_use_count(const struct rte_mempool *mp)
 {
-	return mp->size - rte_mempool_avail_count(mp);
+	return mp->populated_size - rte_mempool_avail_count(mp);
 }
 
 /* dump the cache status */
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_cache *cache;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
@@ -1054,15 +1438,61 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 		return count;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		cache = &mp->local_cache[lcore_id];
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
 		count += cache_count;
+		if (cache->stats.get_hit + cache->stats.get_miss +
+				cache->stats.put_hit + cache->stats.put_miss == 0)
+			continue;
+		if (cache->max_size != 0)
+			fprintf(f, "    cache_adaptive_size[%u]=%"PRIu32"\n",
+				lcore_id, cache->size);
+		fprintf(f, "    cache_get_hit[%u]=%"PRIu64"\n",
+			lcore_id, cache->stats.get_hit);
+		fprintf(f, "    cache_get_miss[%u]=%"PRIu64"\n",
+			lcore_id, cache->stats.get_miss);
+		fprintf(f, "    cache_put_hit[%u]=%"PRIu64"\n",
+			lcore_id, cache->stats.put_hit);
+		fprintf(f, "    cache_put_miss[%u]=%"PRIu64"\n",
+			lcore_id, cache->stats.put_miss);
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
 }
 
+int
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats)
+{
+	if (mp == NULL || stats == NULL || lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+	if (mp->cache_size == 0)
+		return -ENOTSUP;
+
+	*stats = mp->local_cache[lcore_id].stats;
+	return 0;
+}
+
+void
+rte_mempool_cache_stats_reset(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache *cache;
+	unsigned int lcore_id;
+
+	if (mp->cache_size == 0)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &mp->local_cache[lcore_id];
+		memset(&cache->stats, 0, sizeof(cache->stats));
+		/* restart the adaptation window along with the counters */
+		cache->adapt_accesses = 0;
+		cache->adapt_misses = 0;
+	}
+}
+
 #ifndef __INTEL_COMPILER
 #pragma GCC diagnostic ignored "-Wcast-qual"
 #endif
@@ -1277,6 +1707,19 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
 
+	if (mp->elastic != NULL) {
+		fprintf(f, "  elastic:\n");
+		fprintf(f, "    chunk_size=%"PRIu32"\n",
+			mp->elastic->conf.chunk_size);
+		fprintf(f, "    low_watermark=%"PRIu32"\n",
+			mp->elastic->conf.low_watermark);
+		fprintf(f, "    high_watermark=%"PRIu32"\n",
+			mp->elastic->conf.high_watermark);
+		fprintf(f, "    nb_chunks=%"PRIu32"\n", mp->elastic->nb_chunks);
+		fprintf(f, "    nb_grow=%"PRIu64"\n", mp->elastic->nb_grow);
+		fprintf(f, "    nb_shrink=%"PRIu64"\n", mp->elastic->nb_shrink);
+	}
+
 	/* sum and dump statistics */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	rte_mempool_ops_get_info(mp, &info);
@@ -1490,3 +1933,96 @@ rte_mempool_event_callback_unregister(rte_mempool_event_callback *func,
 	rte_errno = -ret;
 	return ret;
 }
+
+static void
+mempool_list_cb(struct rte_mempool *mp, void *arg)
+{
+	struct rte_tel_data *d = arg;
+
+	rte_tel_data_add_array_string(d, mp->name);
+}
+
+static int
+mempool_handle_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+	rte_mempool_walk(mempool_list_cb, d);
+
+	return 0;
+}
+
+static int
+mempool_handle_cache_stats(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	static const char * const names[] = {
+		"size", "get_hit", "get_miss", "put_hit", "put_miss",
+		"grow", "shrink",
+	};
+	struct rte_tel_data *arrays[RTE_DIM(names)];
+	struct rte_tel_data *lcores;
+	const struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	unsigned int lcore_id, i;
+
+	if (params == NULL || strlen(params) == 0)
+		return -EINVAL;
+
+	mp = rte_mempool_lookup(params);
+	if (mp == NULL)
+		return -EINVAL;
+	if (mp->cache_size == 0)
+		return -ENOTSUP;
+
+	lcores = rte_tel_data_alloc();
+	if (lcores == NULL)
+		return -ENOMEM;
+	rte_tel_data_start_array(lcores, RTE_TEL_INT_VAL);
+	for (i = 0; i < RTE_DIM(names); i++) {
+		arrays[i] = rte_tel_data_alloc();
+		if (arrays[i] == NULL) {
+			while (i-- > 0)
+				rte_tel_data_free(arrays[i]);
+			rte_tel_data_free(lcores);
+			return -ENOMEM;
+		}
+		rte_tel_data_start_array(arrays[i], RTE_TEL_U64_VAL);
+	}
+
+	/* one entry per lcore which used its cache */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &mp->local_cache[lcore_id];
+		if (cache->stats.get_hit + cache->stats.get_miss +
+				cache->stats.put_hit + cache->stats.put_miss == 0)
+			continue;
+		rte_tel_data_add_array_int(lcores, lcore_id);
+		rte_tel_data_add_array_u64(arrays[0], cache->size);
+		rte_tel_data_add_array_u64(arrays[1], cache->stats.get_hit);
+		rte_tel_data_add_array_u64(arrays[2], cache->stats.get_miss);
+		rte_tel_data_add_array_u64(arrays[3], cache->stats.put_hit);
+		rte_tel_data_add_array_u64(arrays[4], cache->stats.put_miss);
+		rte_tel_data_add_array_u64(arrays[5], cache->stats.grow);
+		rte_tel_data_add_array_u64(arrays[6], cache->stats.shrink);
+	}
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_string(d, "name", mp->name);
+	rte_tel_data_add_dict_u64(d, "cache_size", mp->cache_size);
+	rte_tel_data_add_dict_int(d, "adaptive",
+		!!(mp->flags & MEMPOOL_F_ADAPTIVE_CACHE));
+	rte_tel_data_add_dict_container(d, "lcore", lcores, 0);
+	for (i = 0; i < RTE_DIM(names); i++)
+		rte_tel_data_add_dict_container(d, names[i], arrays[i], 0);
+
+	return 0;
+}
+
+RTE_INIT(mempool_init_telemetry)
+{
+	rte_telemetry_register_cmd("/mempool/list", mempool_handle_list,
+		"Returns list of available mempool. Takes no parameters");
+	rte_telemetry_register_cmd("/mempool/cache_stats",
+		mempool_handle_cache_stats,
+		"Returns the per-lcore cache statistics of a mempool. Parameters: mempool name");
+}
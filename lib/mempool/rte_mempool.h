@@ -83,6 +83,21 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * A structure that stores the statistics of a mempool cache.
+ *
+ * A hit is a get or put operation served by the cache alone, a miss is an
+ * operation which had to access the common pool.
+ */
+struct rte_mempool_cache_stats {
+	uint64_t get_hit;  /**< Gets served from the cache. */
+	uint64_t get_miss; /**< Gets which dequeued from the common pool. */
+	uint64_t put_hit;  /**< Puts stored in the cache. */
+	uint64_t put_miss; /**< Puts which enqueued in the common pool. */
+	uint64_t grow;     /**< Increases of the adaptive cache size. */
+	uint64_t shrink;   /**< Decreases of the adaptive cache size. */
+};
+
 /**
  * A structure that stores a per-core object cache.
  */
@@ -90,6 +105,11 @@ struct rte_mempool_cache {
 	uint32_t size;	      /**< Size of the cache */
 	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	uint32_t len;	      /**< Current cache count */
+	uint32_t min_size;    /**< Min adaptive size, see MEMPOOL_F_ADAPTIVE_CACHE */
+	uint32_t max_size;    /**< Max adaptive size, 0 if size is fixed */
+	uint64_t adapt_accesses; /**< Accesses at the last adaptation */
+	uint64_t adapt_misses;   /**< Misses at the last adaptation */
+	struct rte_mempool_cache_stats stats; /**< Cache statistics */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -205,6 +225,28 @@ struct rte_mempool_info {
 	unsigned int contig_block_size;
 } __rte_cache_aligned;
 
+struct rte_mempool_elastic;
+
+/**
+ * Configuration of an elastic mempool, see rte_mempool_populate_elastic().
+ */
+struct rte_mempool_elastic_conf {
+	/** Number of objects added by each growth of the mempool. */
+	uint32_t chunk_size;
+	/** The mempool grows when fewer objects are in the common pool. */
+	uint32_t low_watermark;
+	/**
+	 * The memory chunks whose objects are all free are released when more
+	 * objects are in the common pool. Zero to never shrink the mempool.
+	 */
+	uint32_t high_watermark;
+	/**
+	 * Period in milliseconds of the automatic adjustment of the mempool.
+	 * Zero to only adjust it with rte_mempool_elastic_adjust().
+	 */
+	uint32_t period_ms;
+};
+
 /**
  * The RTE mempool structure.
  */
@@ -243,6 +285,8 @@ struct rte_mempool {
 	struct rte_mempool_objhdr_list elt_list; /**< List of objects in pool */
 	uint32_t nb_mem_chunks;          /**< Number of memory chunks */
 	struct rte_mempool_memhdr_list mem_list; /**< List of memory chunks */
+	/** Internal: elastic population state, NULL if not elastic. */
+	struct rte_mempool_elastic *elastic;
 
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	/** Per-lcore statistics. */
@@ -259,6 +303,11 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_IOVA_CONTIG 0x0020 /**< Don't need IOVA contiguous objs. */
 /** Internal: no object from the pool can be used for device IO (DMA). */
 #define MEMPOOL_F_NON_IO         0x0040
+/**
+ * Per-lcore caches are resized between cache_size / 8 and cache_size
+ * depending on how often they access the common pool.
+ */
+#define MEMPOOL_F_ADAPTIVE_CACHE 0x0080
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -988,6 +1037,10 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *     "single-consumer". Otherwise, it is "multi-consumers".
  *   - MEMPOOL_F_NO_IOVA_CONTIG: If set, allocated objects won't
  *     necessarily be contiguous in IO memory.
+ *   - MEMPOOL_F_ADAPTIVE_CACHE: If set, cache_size is the maximum size
+ *     of the per-lcore caches. Each cache starts at cache_size / 8 and
+ *     is doubled or halved depending on how often the lcore has to access
+ *     the common pool.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -1151,6 +1204,68 @@ int rte_mempool_populate_default(struct rte_mempool *mp);
  */
 int rte_mempool_populate_anon(struct rte_mempool *mp);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Populate an elastic mempool, which grows and shrinks with its usage.
+ *
+ * Instead of populating the mempool with its maximum number of objects,
+ * as rte_mempool_populate_default() does, memory chunks of chunk_size
+ * objects are reserved until low_watermark objects are available. Then,
+ * each adjustment of the mempool:
+ * - reserves new memory chunks while fewer than low_watermark objects are
+ *   in the common pool, up to the size of the mempool,
+ * - releases the memory chunks whose objects are all in the common pool
+ *   when more than high_watermark objects are there, as long as
+ *   low_watermark objects remain.
+ *
+ * The adjustments are done every period_ms, from the EAL alarm thread, or
+ * by calling rte_mempool_elastic_adjust(). They are not done in the
+ * datapath: a get fails if the common pool is exhausted before the next
+ * adjustment.
+ *
+ * The mempool must not have the MEMPOOL_F_SP_PUT and MEMPOOL_F_SC_GET
+ * flags, since the adjustments access the common pool concurrently with
+ * the datapath. With a non-zero period_ms, the mempool driver must also
+ * support being called from a non-EAL thread, as the ring drivers do.
+ * rte_mempool_obj_iter() and rte_mempool_mem_iter() must not be called
+ * concurrently with an adjustment.
+ *
+ * @param mp
+ *   A pointer to the mempool structure, created with
+ *   rte_mempool_create_empty() and not populated yet.
+ * @param conf
+ *   The elastic configuration. high_watermark, if not zero, must be above
+ *   low_watermark + chunk_size to avoid releasing chunks just reserved.
+ * @return
+ *   The number of objects added on success, a negative errno otherwise:
+ *   - -EINVAL: Invalid parameters.
+ *   - -EEXIST: The mempool is already populated.
+ *   - -ENOMEM: Not enough memory for the first chunks.
+ */
+__rte_experimental
+int
+rte_mempool_populate_elastic(struct rte_mempool *mp,
+	const struct rte_mempool_elastic_conf *conf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Grow or shrink an elastic mempool depending on its watermarks.
+ *
+ * @param mp
+ *   A pointer to a mempool populated by rte_mempool_populate_elastic().
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool is not elastic.
+ *   - -ENOMEM: Not enough memory to grow the mempool.
+ */
+__rte_experimental
+int
+rte_mempool_elastic_adjust(struct rte_mempool *mp);
+
 /**
  * Call a function for each mempool element
  *
@@ -1223,6 +1338,48 @@ rte_mempool_cache_create(uint32_t size, int socket_id);
 void
 rte_mempool_cache_free(struct rte_mempool_cache *cache);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of the default cache of an lcore.
+ *
+ * The statistics are always collected, whatever the build options. They
+ * are updated by the lcore owning the cache without synchronization, the
+ * values read from another lcore may be slightly outdated.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore identifier.
+ * @param stats
+ *   A pointer to a structure filled with the cache statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOTSUP: The mempool has no default cache.
+ */
+__rte_experimental
+int
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reset the statistics of the default caches of all lcores.
+ *
+ * The reset is not synchronized with the lcores using the mempool, an
+ * operation done meanwhile may be lost or accounted after the reset.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+__rte_experimental
+void
+rte_mempool_cache_stats_reset(struct rte_mempool *mp);
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
@@ -1269,6 +1426,58 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/** Misses of an adaptive cache between two resize decisions. */
+#define RTE_MEMPOOL_CACHE_ADAPT_WINDOW 16
+/** An adaptive cache grows when more than 1 access out of this misses. */
+#define RTE_MEMPOOL_CACHE_GROW_RATIO 16
+/** An adaptive cache shrinks when less than 1 access out of this misses. */
+#define RTE_MEMPOOL_CACHE_SHRINK_RATIO 64
+
+/**
+ * @internal Account a cache miss and, for an adaptive cache, resize it
+ * depending on its miss rate since the last resize decision.
+ *
+ * A busy lcore which keeps on going to the common pool gets a bigger cache,
+ * an lcore which rarely does gets a smaller one and releases its excess
+ * objects on its next flush.
+ *
+ * @param cache
+ *   A pointer to a mempool cache structure.
+ */
+static __rte_always_inline void
+__mempool_cache_adapt(struct rte_mempool_cache *cache)
+{
+	uint64_t accesses, misses;
+	uint32_t size;
+
+	if (likely(cache->max_size == 0))
+		return;
+
+	misses = cache->stats.get_miss + cache->stats.put_miss;
+	if (misses - cache->adapt_misses < RTE_MEMPOOL_CACHE_ADAPT_WINDOW)
+		return;
+
+	accesses = misses + cache->stats.get_hit + cache->stats.put_hit;
+	size = cache->size;
+	if (accesses - cache->adapt_accesses < RTE_MEMPOOL_CACHE_ADAPT_WINDOW *
+			RTE_MEMPOOL_CACHE_GROW_RATIO && size < cache->max_size) {
+		size = RTE_MIN(size * 2, cache->max_size);
+		cache->stats.grow++;
+	} else if (accesses - cache->adapt_accesses >
+			RTE_MEMPOOL_CACHE_ADAPT_WINDOW *
+			RTE_MEMPOOL_CACHE_SHRINK_RATIO &&
+			size > cache->min_size) {
+		size = RTE_MAX(size / 2, cache->min_size);
+		cache->stats.shrink++;
+	}
+
+	/* same threshold as CALC_CACHE_FLUSHTHRESH() */
+	cache->size = size;
+	cache->flushthresh = size + size / 2;
+	cache->adapt_accesses = accesses;
+	cache->adapt_misses = misses;
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1313,11 +1522,17 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		cache->stats.put_miss++;
+		__mempool_cache_adapt(cache);
+	} else {
+		cache->stats.put_hit++;
 	}
 
 	return;
 
 ring_enqueue:
+	if (cache != NULL)
+		cache->stats.put_miss++;
 
 	/* push remaining objects in ring */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
@@ -1439,6 +1654,10 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+		cache->stats.get_miss++;
+		__mempool_cache_adapt(cache);
+	} else {
+		cache->stats.get_hit++;
 	}
 
 	/* Now fill in the response ... */
@@ -1457,6 +1676,11 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	/* get remaining objects from ring */
 	ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
 
+	if (cache != NULL) {
+		cache->stats.get_miss++;
+		__mempool_cache_adapt(cache);
+	}
+
 	if (ret < 0) {
 		__MEMPOOL_STAT_ADD(mp, get_fail_bulk, 1);
 		__MEMPOOL_STAT_ADD(mp, get_fail_objs, n);
@@ -1557,6 +1781,158 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
 	return rte_mempool_get_bulk(mp, obj_p, 1);
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Start a zero-copy put of several objects in a mempool cache.
+ *
+ * Return the address where the objects are to be stored, inside the
+ * objects table of the cache, so that they are written only once, e.g.
+ * directly from the descriptors of a transmit queue being freed.
+ * The put is completed by rte_mempool_cache_zc_put_finish(). No other
+ * operation may be done on the cache in between.
+ *
+ * The cache is flushed to the common pool first if the objects would
+ * overflow its flush threshold.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param n
+ *   The maximum number of objects to put, up to RTE_MEMPOOL_CACHE_MAX_SIZE.
+ * @return
+ *   The address where to store up to n objects, NULL if n is too big or
+ *   the cache is NULL. The regular put functions must be used then.
+ */
+__rte_experimental
+static __rte_always_inline void **
+rte_mempool_cache_zc_put_bulk_start(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+		return NULL;
+
+	/* same flush as __mempool_generic_put(), done before storing */
+	if (cache->len + n >= cache->flushthresh && cache->len > cache->size) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
+				cache->len - cache->size);
+		cache->len = cache->size;
+		cache->stats.put_miss++;
+		__mempool_cache_adapt(cache);
+	} else {
+		cache->stats.put_hit++;
+	}
+
+	return &cache->objs[cache->len];
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete a zero-copy put started by rte_mempool_cache_zc_put_bulk_start().
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param n
+ *   The number of objects stored at the start of the returned address,
+ *   lower or equal to the number given at start.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_mempool_cache_zc_put_finish(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	__mempool_check_cookies(mp, &cache->objs[cache->len], n, 0);
+	__MEMPOOL_STAT_ADD(mp, put_bulk, 1);
+	__MEMPOOL_STAT_ADD(mp, put_objs, n);
+	RTE_SET_USED(mp);
+	cache->len += n;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Start a zero-copy get of several objects from a mempool cache.
+ *
+ * Return the address of the objects inside the objects table of the
+ * cache, so that they are read only once, e.g. directly into the
+ * descriptors of a receive queue being rearmed. The get is completed by
+ * rte_mempool_cache_zc_get_finish(). No other operation may be done on
+ * the cache in between.
+ *
+ * The cache is refilled from the common pool first if it does not hold
+ * enough objects.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param n
+ *   The number of objects to get, up to RTE_MEMPOOL_CACHE_MAX_SIZE.
+ * @return
+ *   The address of n objects, NULL if n is too big, the cache is NULL or
+ *   the common pool does not have enough objects. The regular get
+ *   functions must be used then.
+ */
+__rte_experimental
+static __rte_always_inline void **
+rte_mempool_cache_zc_get_bulk_start(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	uint32_t req;
+
+	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+		return NULL;
+
+	if (cache->len < n) {
+		/* same backfill as __mempool_generic_get() */
+		req = n + (cache->size - cache->len);
+		if (unlikely(rte_mempool_ops_dequeue_bulk(mp,
+				&cache->objs[cache->len], req) < 0))
+			return NULL;
+		cache->len += req;
+		cache->stats.get_miss++;
+		__mempool_cache_adapt(cache);
+	} else {
+		cache->stats.get_hit++;
+	}
+
+	return &cache->objs[cache->len - n];
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete a zero-copy get started by rte_mempool_cache_zc_get_bulk_start().
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param n
+ *   The number of objects taken, lower or equal to the number given at
+ *   start. When lower, the objects taken are the last n ones at the
+ *   returned address, the other ones remain in the cache.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_mempool_cache_zc_get_finish(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	cache->len -= n;
+	__mempool_check_cookies(mp, &cache->objs[cache->len], n, 1);
+	__MEMPOOL_STAT_ADD(mp, get_success_bulk, 1);
+	__MEMPOOL_STAT_ADD(mp, get_success_objs, n);
+	RTE_SET_USED(mp);
+}
+
 /**
  * Get a contiguous blocks of objects from the mempool.
  *
@@ -1644,7 +2020,7 @@ rte_mempool_in_use_count(const struct rte_mempool *mp);
 static inline int
 rte_mempool_full(const struct rte_mempool *mp)
 {
-	return rte_mempool_avail_count(mp) == mp->size;
+	return rte_mempool_avail_count(mp) == mp->populated_size;
 }
 
 /**
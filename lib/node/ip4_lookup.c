@@ -8,6 +8,7 @@
 #include <rte_debug.h>
 #include <rte_ethdev.h>
 #include <rte_ether.h>
+#include <rte_fib_vrf.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
 #include <rte_ip.h>
@@ -24,14 +25,27 @@
 #define IPV4_L3FWD_LPM_MAX_RULES 1024
 #define IPV4_L3FWD_LPM_NUMBER_TBL8S (1 << 8)
 
+#define IPV4_L3FWD_VRF_MAX_VRFS 256
+#define IPV4_L3FWD_VRF_MAX_RULES (1 << 16)
+#define IPV4_L3FWD_VRF_NUMBER_TBL8S (1 << 12)
+#define IPV4_L3FWD_VRF_MAX_LARGE 4
+#define IPV4_L3FWD_VRF_LARGE_RULES 1024
+
 /* IP4 Lookup global data struct */
 struct ip4_lookup_node_main {
 	struct rte_lpm *lpm_tbl[RTE_MAX_NUMA_NODES];
+	struct rte_fib_vrf *vrf_tbl[RTE_MAX_NUMA_NODES];
+	/* VRF of the packets received on each port */
+	uint16_t port_vrf[RTE_MAX_ETHPORTS];
 };
 
 struct ip4_lookup_node_ctx {
-	/* Socket's LPM table */
-	struct rte_lpm *lpm;
+	union {
+		/* Socket's LPM table */
+		struct rte_lpm *lpm;
+		/* Socket's multi-VRF FIB, when VRFs are used */
+		struct rte_fib_vrf *vrf;
+	};
 	/* Dynamic offset to mbuf priv1 */
 	int mbuf_priv1_off;
 };
@@ -43,6 +57,9 @@ static struct ip4_lookup_node_main ip4_lookup_nm;
 #define IP4_LOOKUP_NODE_LPM(ctx) \
 	(((struct ip4_lookup_node_ctx *)ctx)->lpm)
 
+#define IP4_LOOKUP_NODE_VRF(ctx) \
+	(((struct ip4_lookup_node_ctx *)ctx)->vrf)
+
 #define IP4_LOOKUP_NODE_PRIV1_OFF(ctx) \
 	(((struct ip4_lookup_node_ctx *)ctx)->mbuf_priv1_off)
 
@@ -123,6 +140,88 @@ ip4_lookup_node_process_scalar(struct rte_graph *graph, struct rte_node *node,
 	return nb_objs;
 }
 
+static uint16_t
+ip4_lookup_node_process_vrf(struct rte_graph *graph, struct rte_node *node,
+			void **objs, uint16_t nb_objs)
+{
+	struct rte_fib_vrf *fib = IP4_LOOKUP_NODE_VRF(node->ctx);
+	const int dyn = IP4_LOOKUP_NODE_PRIV1_OFF(node->ctx);
+	uint64_t next_hops[RTE_GRAPH_BURST_SIZE];
+	uint16_t vrf_ids[RTE_GRAPH_BURST_SIZE];
+	uint32_t ips[RTE_GRAPH_BURST_SIZE];
+	struct rte_ipv4_hdr *ipv4_hdr;
+	void **to_next, **from;
+	uint16_t last_spec = 0;
+	struct rte_mbuf *mbuf;
+	rte_edge_t next_index;
+	uint16_t held = 0;
+	int i, j, n;
+
+	/* Speculative next */
+	next_index = RTE_NODE_IP4_LOOKUP_NEXT_REWRITE;
+	from = objs;
+
+	/* Get stream for the speculated next node */
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, RTE_GRAPH_BURST_SIZE);
+
+		for (j = 0; j < n; j++) {
+			mbuf = (struct rte_mbuf *)objs[i + j];
+
+			/* Extract DIP of mbuf */
+			ipv4_hdr = rte_pktmbuf_mtod_offset(mbuf,
+					struct rte_ipv4_hdr *,
+					sizeof(struct rte_ether_hdr));
+			/* Extract cksum, ttl as ipv4 hdr is in cache */
+			node_mbuf_priv1(mbuf, dyn)->cksum =
+				ipv4_hdr->hdr_checksum;
+			node_mbuf_priv1(mbuf, dyn)->ttl =
+				ipv4_hdr->time_to_live;
+
+			ips[j] = rte_be_to_cpu_32(ipv4_hdr->dst_addr);
+			vrf_ids[j] = ip4_lookup_nm.port_vrf[mbuf->port];
+		}
+
+		/* Misses get the drop node from the FIB default next hop */
+		rte_fib_vrf_lookup_bulk(fib, vrf_ids, ips, next_hops, n);
+
+		for (j = 0; j < n; j++) {
+			uint16_t next;
+
+			mbuf = (struct rte_mbuf *)objs[i + j];
+			node_mbuf_priv1(mbuf, dyn)->nh = (uint16_t)next_hops[j];
+			next = (uint16_t)(next_hops[j] >> 16);
+
+			if (unlikely(next_index != next)) {
+				/* Copy things successfully speculated till now */
+				rte_memcpy(to_next, from,
+					   last_spec * sizeof(from[0]));
+				from += last_spec;
+				to_next += last_spec;
+				held += last_spec;
+				last_spec = 0;
+
+				rte_node_enqueue_x1(graph, node, next, from[0]);
+				from += 1;
+			} else {
+				last_spec += 1;
+			}
+		}
+	}
+
+	/* !!! Home run !!! */
+	if (likely(last_spec == nb_objs)) {
+		rte_node_next_stream_move(graph, node, next_index);
+		return nb_objs;
+	}
+	held += last_spec;
+	rte_memcpy(to_next, from, last_spec * sizeof(from[0]));
+	rte_node_next_stream_put(graph, node, next_index, held);
+
+	return nb_objs;
+}
+
 int
 rte_node_ip4_route_add(uint32_t ip, uint8_t depth, uint16_t next_hop,
 		       enum rte_node_ip4_lookup_next next_node)
@@ -179,6 +278,111 @@ setup_lpm(struct ip4_lookup_node_main *nm, int socket)
 	return 0;
 }
 
+static int
+setup_vrf(struct ip4_lookup_node_main *nm, int socket)
+{
+	struct rte_fib_vrf_conf config;
+	char s[RTE_MEMZONE_NAMESIZE];
+
+	/* One multi-VRF FIB per socket */
+	if (nm->vrf_tbl[socket])
+		return 0;
+
+	config.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.default_nh = ((uint64_t)RTE_NODE_IP4_LOOKUP_NEXT_PKT_DROP) << 16;
+	config.max_vrfs = IPV4_L3FWD_VRF_MAX_VRFS;
+	config.max_routes = IPV4_L3FWD_VRF_MAX_RULES;
+	config.num_tbl8 = IPV4_L3FWD_VRF_NUMBER_TBL8S;
+	config.max_large_vrfs = IPV4_L3FWD_VRF_MAX_LARGE;
+	config.large_vrf_routes = IPV4_L3FWD_VRF_LARGE_RULES;
+	snprintf(s, sizeof(s), "IPV4_L3FWD_VRF_%d", socket);
+	nm->vrf_tbl[socket] = rte_fib_vrf_create(s, socket, &config);
+	if (nm->vrf_tbl[socket] == NULL)
+		return -rte_errno;
+
+	return 0;
+}
+
+/* Setup the multi-VRF FIBs of all the sockets on first use */
+static int
+setup_vrf_all(struct ip4_lookup_node_main *nm)
+{
+	uint16_t socket, lcore_id;
+	int rc;
+
+	RTE_LCORE_FOREACH(lcore_id)
+	{
+		socket = rte_lcore_to_socket_id(lcore_id);
+		rc = setup_vrf(nm, socket);
+		if (rc) {
+			node_err("ip4_lookup",
+				 "Failed to setup vrf tbl for sock %u, rc=%d",
+				 socket, rc);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+int
+rte_node_ip4_vrf_port_set(uint16_t port_id, uint16_t vrf_id)
+{
+	int rc;
+
+	if (port_id >= RTE_MAX_ETHPORTS || vrf_id >= IPV4_L3FWD_VRF_MAX_VRFS)
+		return -EINVAL;
+
+	rc = setup_vrf_all(&ip4_lookup_nm);
+	if (rc)
+		return rc;
+
+	ip4_lookup_nm.port_vrf[port_id] = vrf_id;
+	return 0;
+}
+
+int
+rte_node_ip4_vrf_route_add(uint16_t vrf_id, uint32_t ip, uint8_t depth,
+			   uint16_t next_hop,
+			   enum rte_node_ip4_lookup_next next_node)
+{
+	char abuf[INET6_ADDRSTRLEN];
+	struct in_addr in;
+	uint8_t socket;
+	uint32_t val;
+	int ret;
+
+	if (vrf_id >= IPV4_L3FWD_VRF_MAX_VRFS)
+		return -EINVAL;
+
+	ret = setup_vrf_all(&ip4_lookup_nm);
+	if (ret)
+		return ret;
+
+	in.s_addr = htonl(ip);
+	inet_ntop(AF_INET, &in, abuf, sizeof(abuf));
+	/* Embedded next node id into 24 bit next hop */
+	val = ((next_node << 16) | next_hop) & ((1ull << 24) - 1);
+	node_dbg("ip4_lookup", "VRF %u: Adding route %s / %d nh (0x%x)",
+		 vrf_id, abuf, depth, val);
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		if (!ip4_lookup_nm.vrf_tbl[socket])
+			continue;
+
+		ret = rte_fib_vrf_add(ip4_lookup_nm.vrf_tbl[socket], vrf_id,
+				      ip, depth, val);
+		if (ret < 0) {
+			node_err("ip4_lookup",
+				 "Unable to add entry %s / %d nh (%x) to VRF %u table on sock %d, rc=%d\n",
+				 abuf, depth, val, vrf_id, socket, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
 static int
 ip4_lookup_node_init(const struct rte_graph *graph, struct rte_node *node)
 {
@@ -210,9 +414,19 @@ ip4_lookup_node_init(const struct rte_graph *graph, struct rte_node *node)
 		init_once = 1;
 	}
 
+	IP4_LOOKUP_NODE_PRIV1_OFF(node->ctx) = node_mbuf_priv1_dynfield_offset;
+
+	/* Ports mapped to VRFs, lookup in the socket's multi-VRF FIB */
+	if (ip4_lookup_nm.vrf_tbl[graph->socket] != NULL) {
+		IP4_LOOKUP_NODE_VRF(node->ctx) =
+			ip4_lookup_nm.vrf_tbl[graph->socket];
+		node->process = ip4_lookup_node_process_vrf;
+		node_dbg("ip4_lookup", "Initialized ip4_lookup node with VRFs");
+		return 0;
+	}
+
 	/* Update socket's LPM and mbuf dyn priv1 offset in node ctx */
 	IP4_LOOKUP_NODE_LPM(node->ctx) = ip4_lookup_nm.lpm_tbl[graph->socket];
-	IP4_LOOKUP_NODE_PRIV1_OFF(node->ctx) = node_mbuf_priv1_dynfield_offset;
 
 #if defined(__ARM_NEON) || defined(RTE_ARCH_X86)
 	if (rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_128)
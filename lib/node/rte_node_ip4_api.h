@@ -54,6 +54,47 @@ __rte_experimental
 int rte_node_ip4_route_add(uint32_t ip, uint8_t depth, uint16_t next_hop,
 			   enum rte_node_ip4_lookup_next next_node);
 
+/**
+ * Set the VRF of the packets received on a port.
+ *
+ * Once a port is set to a VRF, the ip4_lookup nodes of the graphs created
+ * afterwards look the packets up in the routes of the VRF of their input
+ * port, added with rte_node_ip4_vrf_route_add(), instead of the routes
+ * added with rte_node_ip4_route_add(). Ports not set use VRF 0.
+ *
+ * @param port_id
+ *   Input port id.
+ * @param vrf_id
+ *   VRF id of the port, lower than 256.
+ *
+ * @return
+ *   0 on success, negative otherwise.
+ */
+__rte_experimental
+int rte_node_ip4_vrf_port_set(uint16_t port_id, uint16_t vrf_id);
+
+/**
+ * Add ipv4 route to a VRF lookup table.
+ *
+ * @param vrf_id
+ *   VRF id of the route, lower than 256.
+ * @param ip
+ *   IP address of route to be added.
+ * @param depth
+ *   Depth of the rule to be added.
+ * @param next_hop
+ *   Next hop id of the rule result to be added.
+ * @param next_node
+ *   Next node to redirect traffic to.
+ *
+ * @return
+ *   0 on success, negative otherwise.
+ */
+__rte_experimental
+int rte_node_ip4_vrf_route_add(uint16_t vrf_id, uint32_t ip, uint8_t depth,
+			       uint16_t next_hop,
+			       enum rte_node_ip4_lookup_next next_node);
+
 /**
  * Add a next hop's rewrite data.
  *
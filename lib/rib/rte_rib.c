@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
@@ -28,6 +29,9 @@ EAL_REGISTER_TAILQ(rte_rib_tailq)
 #define RIB_MAXDEPTH		32
 /* Maximum length of a RIB name. */
 #define RTE_RIB_NAMESIZE	64
+/* Children of a node saved by rte_rib_save(), along with its flag */
+#define RIB_FILE_LEFT		2
+#define RIB_FILE_RIGHT		4
 
 struct rte_rib_node {
 	struct rte_rib_node	*left;
@@ -76,6 +80,19 @@ get_nxt_node(struct rte_rib_node *node, uint32_t ip)
 	return (ip & (1 << (31 - node->depth))) ? node->right : node->left;
 }
 
+/* Section written by rte_rib_save(): header, then the nodes in pre-order */
+struct rib_file_hdr {
+	uint32_t	nb_nodes;
+	uint32_t	ext_sz;
+};
+
+struct rib_file_node {
+	uint64_t	nh;
+	uint32_t	ip;
+	uint8_t		depth;
+	uint8_t		flag;
+};
+
 static struct rte_rib_node *
 node_alloc(struct rte_rib *rib)
 {
@@ -529,3 +546,125 @@ rte_rib_free(struct rte_rib *rib)
 	rte_free(rib);
 	rte_free(te);
 }
+
+static inline uint32_t
+get_ext_sz(struct rte_rib *rib)
+{
+	return rib->node_pool->elt_size - sizeof(struct rte_rib_node);
+}
+
+int
+rte_rib_save(struct rte_rib *rib, FILE *f)
+{
+	struct rib_file_hdr hdr;
+	struct rib_file_node ent;
+	struct rte_rib_node *node;
+
+	if ((rib == NULL) || (f == NULL))
+		return -EINVAL;
+
+	hdr.nb_nodes = rib->cur_nodes;
+	hdr.ext_sz = get_ext_sz(rib);
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1)
+		return -EIO;
+
+	memset(&ent, 0, sizeof(ent));
+	node = rib->tree;
+	while (node != NULL) {
+		ent.nh = node->nh;
+		ent.ip = node->ip;
+		ent.depth = node->depth;
+		ent.flag = (node->flag & RTE_RIB_VALID_NODE) |
+			((node->left != NULL) ? RIB_FILE_LEFT : 0) |
+			((node->right != NULL) ? RIB_FILE_RIGHT : 0);
+		if (fwrite(&ent, sizeof(ent), 1, f) != 1)
+			return -EIO;
+		if ((hdr.ext_sz != 0) &&
+				(fwrite(node->ext, hdr.ext_sz, 1, f) != 1))
+			return -EIO;
+
+		if (node->left != NULL) {
+			node = node->left;
+			continue;
+		}
+		if (node->right != NULL) {
+			node = node->right;
+			continue;
+		}
+		/* up to the first ancestor with a right subtree left to save */
+		while ((node->parent != NULL) && (is_right_node(node) ||
+				(node->parent->right == NULL)))
+			node = node->parent;
+		node = (node->parent != NULL) ? node->parent->right : NULL;
+	}
+	return 0;
+}
+
+int
+rte_rib_load(struct rte_rib *rib, FILE *f)
+{
+	struct rib_file_hdr hdr;
+	struct rib_file_node ent;
+	/* nodes whose right child comes after their left subtree */
+	struct rte_rib_node *stack[RIB_MAXDEPTH + 1];
+	struct rte_rib_node **link;
+	struct rte_rib_node *node, *parent = NULL;
+	uint32_t i, top = 0;
+
+	if ((rib == NULL) || (f == NULL) || (rib->tree != NULL))
+		return -EINVAL;
+
+	if ((fread(&hdr, sizeof(hdr), 1, f) != 1) ||
+			(hdr.ext_sz != get_ext_sz(rib)))
+		return -EINVAL;
+	if (hdr.nb_nodes == 0)
+		return 0;
+	if (hdr.nb_nodes > (uint32_t)rib->max_nodes)
+		return -ENOSPC;
+
+	/*
+	 * Each node is linked as soon as it is read, so that on error
+	 * the nodes read so far form a valid tree for rte_rib_free().
+	 */
+	link = &rib->tree;
+	for (i = 0; i < hdr.nb_nodes; i++) {
+		if ((link == NULL) || (fread(&ent, sizeof(ent), 1, f) != 1))
+			return -EINVAL;
+		/* a child is deeper than its parent */
+		if ((ent.depth > RIB_MAXDEPTH) || ((parent != NULL) &&
+				(ent.depth <= parent->depth)))
+			return -EINVAL;
+		node = node_alloc(rib);
+		if (node == NULL)
+			return -ENOMEM;
+		node->left = NULL;
+		node->right = NULL;
+		node->parent = parent;
+		node->ip = ent.ip;
+		node->depth = ent.depth;
+		node->flag = ent.flag & RTE_RIB_VALID_NODE;
+		node->nh = ent.nh;
+		*link = node;
+		if (is_valid_node(node))
+			++rib->cur_routes;
+		if ((hdr.ext_sz != 0) &&
+				(fread(node->ext, hdr.ext_sz, 1, f) != 1))
+			return -EINVAL;
+
+		if (ent.flag & RIB_FILE_LEFT) {
+			if (ent.flag & RIB_FILE_RIGHT)
+				stack[top++] = node;
+			parent = node;
+			link = &node->left;
+		} else if (ent.flag & RIB_FILE_RIGHT) {
+			parent = node;
+			link = &node->right;
+		} else if (top != 0) {
+			parent = stack[--top];
+			link = &parent->right;
+		} else
+			link = NULL;
+	}
+	/* every announced child must have been read */
+	return (link == NULL) ? 0 : -EINVAL;
+}
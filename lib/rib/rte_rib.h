@@ -14,6 +14,7 @@
  * Level compressed tree implementation for IPv4 Longest Prefix Match
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -271,6 +272,53 @@ rte_rib_find_existing(const char *name);
 void
 rte_rib_free(struct rte_rib *rib);
 
+/**
+ * Write the nodes of a RIB to a file.
+ *
+ * The nodes, with their extensions, are written in the order of a tree
+ * walk so that rte_rib_load() relinks them without searching the tree.
+ * The file can only be read by the same DPDK version on the same
+ * architecture.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param f
+ *   File to write to, from its current position
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EIO if the file cannot be written.
+ */
+__rte_experimental
+int
+rte_rib_save(struct rte_rib *rib, FILE *f);
+
+/**
+ * Read the nodes written by rte_rib_save() into an empty RIB.
+ *
+ * The RIB must have the same extension size as the saved one. On failure
+ * the RIB holds part of the nodes and should be freed.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param f
+ *   File to read from, from its current position
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments, a RIB not empty or an invalid file,
+ *   -ENOSPC if the RIB has fewer nodes than the saved one,
+ *   -ENOMEM if a node cannot be allocated.
+ */
+__rte_experimental
+int
+rte_rib_load(struct rte_rib *rib, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,8 @@
  * Level compressed tree implementation for IPv6 Longest Prefix Match
  */
 
+#include <stdio.h>
+
 #include <rte_memcpy.h>
 #include <rte_compat.h>
 #include <rte_common.h>
@@ -326,6 +328,53 @@ rte_rib6_find_existing(const char *name);
 void
 rte_rib6_free(struct rte_rib6 *rib);
 
+/**
+ * Write the nodes of a RIB to a file.
+ *
+ * The nodes, with their extensions, are written in the order of a tree
+ * walk so that rte_rib6_load() relinks them without searching the tree.
+ * The file can only be read by the same DPDK version on the same
+ * architecture.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param f
+ *   File to write to, from its current position
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments,
+ *   -EIO if the file cannot be written.
+ */
+__rte_experimental
+int
+rte_rib6_save(struct rte_rib6 *rib, FILE *f);
+
+/**
+ * Read the nodes written by rte_rib6_save() into an empty RIB.
+ *
+ * The RIB must have the same extension size as the saved one. On failure
+ * the RIB holds part of the nodes and should be freed.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param f
+ *   File to read from, from its current position
+ * @return
+ *   0 on success,
+ *   -EINVAL for incorrect arguments, a RIB not empty or an invalid file,
+ *   -ENOSPC if the RIB has fewer nodes than the saved one,
+ *   -ENOMEM if a node cannot be allocated.
+ */
+__rte_experimental
+int
+rte_rib6_load(struct rte_rib6 *rib, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
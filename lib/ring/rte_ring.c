@@ -31,6 +31,17 @@
 #include <rte_string_fns.h>
 #include <rte_spinlock.h>
 #include <rte_tailq.h>
+#include <rte_cycles.h>
+#include <rte_pause.h>
+#include <rte_telemetry.h>
+
+#ifdef RTE_EXEC_ENV_LINUX
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 #include "rte_ring.h"
 #include "rte_ring_elem.h"
@@ -45,7 +56,7 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* mask of all valid flag values to ring_create() */
 #define RING_F_MASK (RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ | \
 		     RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ |	       \
-		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ)
+		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ | RING_F_STATS)
 
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
@@ -209,6 +220,13 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 		return -EINVAL;
 	}
 
+	/* the statistics are in the memory reserved by rte_ring_create() */
+	if (flags & RING_F_STATS) {
+		RTE_LOG(ERR, RING,
+			"Ring statistics require rte_ring_create()\n");
+		return -EINVAL;
+	}
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	ret = strlcpy(r->name, name, sizeof(r->name));
@@ -253,7 +271,7 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 	struct rte_ring *r;
 	struct rte_tailq_entry *te;
 	const struct rte_memzone *mz;
-	ssize_t ring_size;
+	ssize_t ring_size, stats_size = 0;
 	int mz_flags = 0;
 	struct rte_ring_list* ring_list = NULL;
 	const unsigned int requested_count = count;
@@ -270,6 +288,8 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 		rte_errno = ring_size;
 		return NULL;
 	}
+	if (flags & RING_F_STATS)
+		stats_size = RTE_MAX_LCORE * sizeof(struct rte_ring_stats);
 
 	ret = snprintf(mz_name, sizeof(mz_name), "%s%s",
 		RTE_RING_MZ_PREFIX, name);
@@ -290,16 +310,19 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 	/* reserve a memory zone for this ring. If we can't get rte_config or
 	 * we are secondary process, the memzone_reserve function will set
 	 * rte_errno for us appropriately - hence no check in this this function */
-	mz = rte_memzone_reserve_aligned(mz_name, ring_size, socket_id,
-					 mz_flags, __alignof__(*r));
+	mz = rte_memzone_reserve_aligned(mz_name, ring_size + stats_size,
+					 socket_id, mz_flags, __alignof__(*r));
 	if (mz != NULL) {
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, requested_count, flags);
-
+		rte_ring_init(r, name, requested_count, flags & ~RING_F_STATS);
 		te->data = (void *) r;
 		r->memzone = mz;
+		if (flags & RING_F_STATS) {
+			memset(__rte_ring_stats(r), 0, stats_size);
+			r->flags |= RING_F_STATS;
+		}
 
 		TAILQ_INSERT_TAIL(ring_list, te, next);
 	} else {
@@ -381,6 +404,32 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
+	if (r->flags & RING_F_STATS) {
+		struct rte_ring_stats stats;
+		unsigned int i;
+
+		rte_ring_stats_get(r, &stats);
+		fprintf(f, "  stats:\n");
+		fprintf(f, "    enq_success_bulk=%"PRIu64"\n",
+			stats.enq_success_bulk);
+		fprintf(f, "    enq_success_objs=%"PRIu64"\n",
+			stats.enq_success_objs);
+		fprintf(f, "    enq_fail_bulk=%"PRIu64"\n", stats.enq_fail_bulk);
+		fprintf(f, "    enq_fail_objs=%"PRIu64"\n", stats.enq_fail_objs);
+		fprintf(f, "    deq_success_bulk=%"PRIu64"\n",
+			stats.deq_success_bulk);
+		fprintf(f, "    deq_success_objs=%"PRIu64"\n",
+			stats.deq_success_objs);
+		fprintf(f, "    deq_fail_bulk=%"PRIu64"\n", stats.deq_fail_bulk);
+		fprintf(f, "    deq_fail_objs=%"PRIu64"\n", stats.deq_fail_objs);
+		fprintf(f, "    high_watermark=%"PRIu64"\n",
+			stats.high_watermark);
+		fprintf(f, "    occupancy=");
+		for (i = 0; i < RTE_RING_STATS_OCCUPANCY_BUCKETS; i++)
+			fprintf(f, "%s%"PRIu64, i == 0 ? "" : " ",
+				stats.occupancy[i]);
+		fprintf(f, "\n");
+	}
 }
 
 /* dump the status of all rings on the console */
@@ -428,3 +477,284 @@ rte_ring_lookup(const char *name)
 
 	return r;
 }
+
+int
+rte_ring_stats_get(const struct rte_ring *r, struct rte_ring_stats *stats)
+{
+	const struct rte_ring_stats *lcore_stats;
+	unsigned int lcore_id, i;
+
+	if (r == NULL || stats == NULL)
+		return -EINVAL;
+	if ((r->flags & RING_F_STATS) == 0)
+		return -ENOTSUP;
+
+	memset(stats, 0, sizeof(*stats));
+	lcore_stats = __rte_ring_stats(r);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++,
+			lcore_stats++) {
+		stats->enq_success_bulk += lcore_stats->enq_success_bulk;
+		stats->enq_success_objs += lcore_stats->enq_success_objs;
+		stats->enq_fail_bulk += lcore_stats->enq_fail_bulk;
+		stats->enq_fail_objs += lcore_stats->enq_fail_objs;
+		stats->deq_success_bulk += lcore_stats->deq_success_bulk;
+		stats->deq_success_objs += lcore_stats->deq_success_objs;
+		stats->deq_fail_bulk += lcore_stats->deq_fail_bulk;
+		stats->deq_fail_objs += lcore_stats->deq_fail_objs;
+		stats->high_watermark = RTE_MAX(stats->high_watermark,
+			lcore_stats->high_watermark);
+		for (i = 0; i < RTE_RING_STATS_OCCUPANCY_BUCKETS; i++)
+			stats->occupancy[i] += lcore_stats->occupancy[i];
+	}
+
+	return 0;
+}
+
+int
+rte_ring_stats_reset(struct rte_ring *r)
+{
+	if (r == NULL)
+		return -EINVAL;
+	if ((r->flags & RING_F_STATS) == 0)
+		return -ENOTSUP;
+
+	memset(__rte_ring_stats(r), 0,
+		RTE_MAX_LCORE * sizeof(struct rte_ring_stats));
+	return 0;
+}
+
+/* number of polls of the ring before rte_ring_wait() sleeps */
+#define RING_WAIT_SPIN_COUNT 1024
+/* sleep period when futexes are not available */
+#define RING_WAIT_POLL_US 100
+
+#ifdef RTE_EXEC_ENV_LINUX
+/* the futex is the producer tail, which is updated by every enqueue;
+ * it is shared (not private) so that secondary processes can sleep on it
+ */
+static void
+ring_wait_sleep(struct rte_ring *r, uint32_t tail, uint64_t sleep_us)
+{
+	struct timespec ts, *pts = NULL;
+
+	if (sleep_us != RTE_RING_WAIT_FOREVER) {
+		ts.tv_sec = sleep_us / US_PER_S;
+		ts.tv_nsec = (sleep_us % US_PER_S) * (NS_PER_S / US_PER_S);
+		pts = &ts;
+	}
+	syscall(SYS_futex, &r->prod.tail, FUTEX_WAIT, tail, pts, NULL, 0);
+}
+
+void
+__rte_ring_wake(struct rte_ring *r)
+{
+	syscall(SYS_futex, &r->prod.tail, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#else
+static void
+ring_wait_sleep(struct rte_ring *r, uint32_t tail, uint64_t sleep_us)
+{
+	RTE_SET_USED(r);
+	RTE_SET_USED(tail);
+	rte_delay_us_sleep(RTE_MIN(sleep_us, (uint64_t)RING_WAIT_POLL_US));
+}
+
+void
+__rte_ring_wake(struct rte_ring *r)
+{
+	RTE_SET_USED(r);
+}
+#endif
+
+int
+rte_ring_wait(struct rte_ring *r, unsigned int n, uint64_t timeout_us)
+{
+	uint64_t deadline = 0, now, cycles_per_us;
+	uint64_t sleep_us = RTE_RING_WAIT_FOREVER;
+	unsigned int i;
+	uint32_t tail;
+
+	if (n > r->capacity)
+		return -EINVAL;
+
+	for (i = 0; i < RING_WAIT_SPIN_COUNT; i++) {
+		if (rte_ring_count(r) >= n)
+			return 0;
+		rte_pause();
+	}
+
+	cycles_per_us = (rte_get_timer_hz() + US_PER_S - 1) / US_PER_S;
+	if (timeout_us != RTE_RING_WAIT_FOREVER)
+		deadline = rte_get_timer_cycles() + timeout_us * cycles_per_us;
+
+	for (;;) {
+		if (timeout_us != RTE_RING_WAIT_FOREVER) {
+			now = rte_get_timer_cycles();
+			if (now >= deadline)
+				break;
+			sleep_us = (deadline - now) / cycles_per_us + 1;
+		}
+
+		/* register before reading the tail, rte_ring_wake() reads the
+		 * waiters after the tail update: either the producer sees the
+		 * waiter, or the consumer sees the new tail
+		 */
+		__atomic_fetch_add(&r->nb_waiters, 1, __ATOMIC_SEQ_CST);
+		tail = __atomic_load_n(&r->prod.tail, __ATOMIC_SEQ_CST);
+		if (rte_ring_count(r) >= n) {
+			__atomic_fetch_sub(&r->nb_waiters, 1, __ATOMIC_RELAXED);
+			return 0;
+		}
+		ring_wait_sleep(r, tail, sleep_us);
+		__atomic_fetch_sub(&r->nb_waiters, 1, __ATOMIC_RELAXED);
+
+		if (rte_ring_count(r) >= n)
+			return 0;
+	}
+
+	return rte_ring_count(r) >= n ? 0 : -ETIMEDOUT;
+}
+
+unsigned int
+rte_ring_dequeue_burst_elem_wait(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available,
+		uint64_t timeout_us)
+{
+	unsigned int nb_deq;
+
+	nb_deq = rte_ring_dequeue_burst_elem(r, obj_table, esize, n,
+			available);
+	if (nb_deq != 0 || rte_ring_wait(r, 1, timeout_us) != 0)
+		return nb_deq;
+
+	return rte_ring_dequeue_burst_elem(r, obj_table, esize, n, available);
+}
+
+unsigned int
+rte_ring_dequeue_burst_wait(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available, uint64_t timeout_us)
+{
+	return rte_ring_dequeue_burst_elem_wait(r, obj_table, sizeof(void *),
+			n, available, timeout_us);
+}
+
+static int
+ring_handle_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	const struct rte_tailq_entry *te;
+	struct rte_ring_list *ring_list;
+
+	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
+
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+
+	rte_mcfg_tailq_read_lock();
+	TAILQ_FOREACH(te, ring_list, next)
+		rte_tel_data_add_array_string(d,
+			((const struct rte_ring *)te->data)->name);
+	rte_mcfg_tailq_read_unlock();
+
+	return 0;
+}
+
+static const char *
+ring_sync_type_name(enum rte_ring_sync_type st)
+{
+	switch (st) {
+	case RTE_RING_SYNC_MT:
+		return "MT";
+	case RTE_RING_SYNC_ST:
+		return "ST";
+	case RTE_RING_SYNC_MT_RTS:
+		return "MT_RTS";
+	case RTE_RING_SYNC_MT_HTS:
+		return "MT_HTS";
+	default:
+		return "unknown";
+	}
+}
+
+static void
+ring_info_stats(const struct rte_ring *r, struct rte_tel_data *d)
+{
+	struct rte_ring_stats stats;
+	struct rte_tel_data *occupancy;
+	unsigned int i;
+
+	rte_ring_stats_get(r, &stats);
+	rte_tel_data_add_dict_u64(d, "enq_success_bulk",
+		stats.enq_success_bulk);
+	rte_tel_data_add_dict_u64(d, "enq_success_objs",
+		stats.enq_success_objs);
+	rte_tel_data_add_dict_u64(d, "enq_fail_bulk", stats.enq_fail_bulk);
+	rte_tel_data_add_dict_u64(d, "enq_fail_objs", stats.enq_fail_objs);
+	rte_tel_data_add_dict_u64(d, "deq_success_bulk",
+		stats.deq_success_bulk);
+	rte_tel_data_add_dict_u64(d, "deq_success_objs",
+		stats.deq_success_objs);
+	rte_tel_data_add_dict_u64(d, "deq_fail_bulk", stats.deq_fail_bulk);
+	rte_tel_data_add_dict_u64(d, "deq_fail_objs", stats.deq_fail_objs);
+	rte_tel_data_add_dict_u64(d, "high_watermark", stats.high_watermark);
+
+	occupancy = rte_tel_data_alloc();
+	if (occupancy == NULL)
+		return;
+	rte_tel_data_start_array(occupancy, RTE_TEL_U64_VAL);
+	for (i = 0; i < RTE_RING_STATS_OCCUPANCY_BUCKETS; i++)
+		rte_tel_data_add_array_u64(occupancy, stats.occupancy[i]);
+	rte_tel_data_add_dict_container(d, "occupancy", occupancy, 0);
+}
+
+static int
+ring_handle_info(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	const struct rte_tailq_entry *te;
+	struct rte_ring_list *ring_list;
+	const struct rte_ring *r = NULL;
+
+	if (params == NULL || strlen(params) == 0)
+		return -EINVAL;
+
+	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
+
+	rte_mcfg_tailq_read_lock();
+
+	TAILQ_FOREACH(te, ring_list, next) {
+		r = te->data;
+		if (strncmp(params, r->name, RTE_RING_NAMESIZE) == 0)
+			break;
+	}
+	if (te == NULL) {
+		rte_mcfg_tailq_read_unlock();
+		return -EINVAL;
+	}
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_string(d, "name", r->name);
+	rte_tel_data_add_dict_int(d, "socket", r->memzone->socket_id);
+	rte_tel_data_add_dict_int(d, "flags", r->flags);
+	rte_tel_data_add_dict_u64(d, "size", r->size);
+	rte_tel_data_add_dict_u64(d, "capacity", r->capacity);
+	rte_tel_data_add_dict_u64(d, "used_count", rte_ring_count(r));
+	rte_tel_data_add_dict_u64(d, "free_count", rte_ring_free_count(r));
+	rte_tel_data_add_dict_string(d, "prod_sync_type",
+		ring_sync_type_name(r->prod.sync_type));
+	rte_tel_data_add_dict_string(d, "cons_sync_type",
+		ring_sync_type_name(r->cons.sync_type));
+	if (r->flags & RING_F_STATS)
+		ring_info_stats(r, d);
+
+	rte_mcfg_tailq_read_unlock();
+
+	return 0;
+}
+
+RTE_INIT(ring_init_telemetry)
+{
+	rte_telemetry_register_cmd("/ring/list", ring_handle_list,
+		"Returns list of available rings. Takes no parameters");
+	rte_telemetry_register_cmd("/ring/info", ring_handle_info,
+		"Returns ring info and statistics. Parameters: ring name");
+}
@@ -160,6 +160,8 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
  *        is "multi-consumer HTS mode".
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
+ *   - RING_F_STATS: If this flag is set, the ring collects per lcore
+ *     statistics, see ``rte_ring_stats_get()``.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -802,6 +804,174 @@ rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table,
 			n, available);
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of a ring created with RING_F_STATS.
+ *
+ * The statistics of all the lcores are summed, the high watermark is the
+ * highest of the lcores.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param stats
+ *   A pointer to the structure filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOTSUP: The ring does not collect statistics.
+ */
+__rte_experimental
+int
+rte_ring_stats_get(const struct rte_ring *r, struct rte_ring_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reset the statistics of a ring created with RING_F_STATS.
+ *
+ * The operations running concurrently on the ring may not be reset.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOTSUP: The ring does not collect statistics.
+ */
+__rte_experimental
+int
+rte_ring_stats_reset(struct rte_ring *r);
+
+/** Timeout of rte_ring_wait() to wait until the objects are there. */
+#define RTE_RING_WAIT_FOREVER UINT64_MAX
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Wait until a ring holds at least n objects.
+ *
+ * The ring is polled for a short time, then the calling thread sleeps until
+ * a producer calls rte_ring_wake(), or the timeout expires. It is intended
+ * for the consumers of low rate rings, which would otherwise busy poll.
+ * On Linux, the thread sleeps on a futex, elsewhere it polls the ring
+ * periodically.
+ *
+ * The producers of a ring with waiting consumers must call rte_ring_wake()
+ * after their enqueues, the enqueue functions do not wake the consumers.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects to wait for, at most the ring capacity.
+ * @param timeout_us
+ *   The maximum waiting time in microseconds, or RTE_RING_WAIT_FOREVER.
+ * @return
+ *   - 0: At least n objects are in the ring.
+ *   - -EINVAL: n is greater than the ring capacity.
+ *   - -ETIMEDOUT: The timeout expired.
+ */
+__rte_experimental
+int
+rte_ring_wait(struct rte_ring *r, unsigned int n, uint64_t timeout_us);
+
+/**
+ * @internal Wake the consumers sleeping in rte_ring_wait().
+ */
+__rte_experimental
+void
+__rte_ring_wake(struct rte_ring *r);
+
+#ifdef ALLOW_EXPERIMENTAL_API
+
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Wake the consumers of a ring waiting in rte_ring_wait(), if any.
+ *
+ * To be called by the producers after enqueueing objects, on the rings
+ * whose consumers wait. When no consumer sleeps, it costs a memory barrier
+ * and a read of the ring header.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+__rte_experimental
+static inline void
+rte_ring_wake(struct rte_ring *r)
+{
+	/* order the tail update of the enqueue before reading the waiters,
+	 * as the waiters register before reading the tail
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (unlikely(__atomic_load_n(&r->nb_waiters, __ATOMIC_RELAXED) != 0))
+		__rte_ring_wake(r);
+}
+
+#endif /* ALLOW_EXPERIMENTAL_API */
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue several objects from a ring, waiting for at least one object if
+ * the ring is empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @param timeout_us
+ *   The maximum waiting time in microseconds, or RTE_RING_WAIT_FOREVER.
+ * @return
+ *   - Number of objects dequeued, 0 if the timeout expired.
+ */
+__rte_experimental
+unsigned int
+rte_ring_dequeue_burst_elem_wait(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available,
+		uint64_t timeout_us);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue several objects from a ring, waiting for at least one object if
+ * the ring is empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @param timeout_us
+ *   The maximum waiting time in microseconds, or RTE_RING_WAIT_FOREVER.
+ * @return
+ *   - Number of objects dequeued, 0 if the timeout expired.
+ */
+__rte_experimental
+unsigned int
+rte_ring_dequeue_burst_wait(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available, uint64_t timeout_us);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_string_fns.h>
+#include <rte_tailq.h>
+
+#include "rte_ring_bcast.h"
+
+TAILQ_HEAD(rte_ring_bcast_list, rte_tailq_entry);
+
+static struct rte_tailq_elem rte_ring_bcast_tailq = {
+	.name = "RTE_RING_BCAST",
+};
+EAL_REGISTER_TAILQ(rte_ring_bcast_tailq)
+
+/* true if x is a power of 2 */
+#define POWEROF2(x) ((((x)-1) & (x)) == 0)
+
+struct rte_ring_bcast *
+rte_ring_bcast_create(const char *name, unsigned int esize,
+	unsigned int count, unsigned int nb_cons, int socket_id,
+	unsigned int flags)
+{
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	struct rte_ring_bcast_list *ring_list;
+	struct rte_tailq_entry *te;
+	const struct rte_memzone *mz;
+	struct rte_ring_bcast *r;
+	size_t elems_off, ring_size;
+	int ret;
+
+	if (name == NULL || (esize % 4) != 0 || esize == 0 ||
+			!POWEROF2(count) || count < 2 ||
+			count > RTE_RING_SZ_MASK || nb_cons == 0 ||
+			nb_cons > RTE_RING_BCAST_MAX_CONSUMERS ||
+			(flags & ~RTE_RING_BCAST_F_LOSSY) != 0) {
+		RTE_LOG(ERR, RING, "Invalid broadcast ring parameters\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ret = snprintf(mz_name, sizeof(mz_name), "%s%s",
+		RTE_RING_BCAST_MZ_PREFIX, name);
+	if (ret < 0 || ret >= (int)sizeof(mz_name)) {
+		rte_errno = ENAMETOOLONG;
+		return NULL;
+	}
+
+	elems_off = sizeof(*r) + nb_cons * sizeof(r->cons[0]);
+	ring_size = elems_off + RTE_ALIGN((size_t)count * esize,
+		RTE_CACHE_LINE_SIZE);
+
+	te = rte_zmalloc("RING_BCAST_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, RING, "Cannot reserve memory for tailq\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	ring_list = RTE_TAILQ_CAST(rte_ring_bcast_tailq.head,
+		rte_ring_bcast_list);
+
+	rte_mcfg_tailq_write_lock();
+
+	mz = rte_memzone_reserve_aligned(mz_name, ring_size, socket_id, 0,
+		__alignof__(*r));
+	if (mz == NULL) {
+		RTE_LOG(ERR, RING, "Cannot reserve memory\n");
+		rte_mcfg_tailq_write_unlock();
+		rte_free(te);
+		return NULL;
+	}
+
+	r = mz->addr;
+	memset(r, 0, elems_off);
+	strlcpy(r->name, name, sizeof(r->name));
+	r->memzone = mz;
+	r->flags = flags;
+	r->esize = esize;
+	r->size = count;
+	r->mask = count - 1;
+	r->capacity = r->mask;
+	r->nb_cons = nb_cons;
+	r->elems = RTE_PTR_ADD(r, elems_off);
+
+	te->data = r;
+	TAILQ_INSERT_TAIL(ring_list, te, next);
+
+	rte_mcfg_tailq_write_unlock();
+
+	return r;
+}
+
+void
+rte_ring_bcast_free(struct rte_ring_bcast *r)
+{
+	struct rte_ring_bcast_list *ring_list;
+	struct rte_tailq_entry *te;
+
+	if (r == NULL)
+		return;
+
+	ring_list = RTE_TAILQ_CAST(rte_ring_bcast_tailq.head,
+		rte_ring_bcast_list);
+	rte_mcfg_tailq_write_lock();
+
+	TAILQ_FOREACH(te, ring_list, next) {
+		if (te->data == (void *)r)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(ring_list, te, next);
+
+	rte_mcfg_tailq_write_unlock();
+
+	if (te == NULL) {
+		RTE_LOG(ERR, RING, "Cannot find broadcast ring %s\n", r->name);
+		return;
+	}
+
+	rte_free(te);
+	if (rte_memzone_free(r->memzone) != 0)
+		RTE_LOG(ERR, RING, "Cannot free memory\n");
+}
+
+struct rte_ring_bcast *
+rte_ring_bcast_lookup(const char *name)
+{
+	struct rte_ring_bcast_list *ring_list;
+	struct rte_ring_bcast *r = NULL;
+	struct rte_tailq_entry *te;
+
+	ring_list = RTE_TAILQ_CAST(rte_ring_bcast_tailq.head,
+		rte_ring_bcast_list);
+
+	rte_mcfg_tailq_read_lock();
+
+	TAILQ_FOREACH(te, ring_list, next) {
+		r = (struct rte_ring_bcast *)te->data;
+		if (strncmp(name, r->name, RTE_RING_BCAST_NAMESIZE) == 0)
+			break;
+	}
+
+	rte_mcfg_tailq_read_unlock();
+
+	if (te == NULL) {
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
+	return r;
+}
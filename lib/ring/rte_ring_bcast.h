@@ -0,0 +1,423 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _RTE_RING_BCAST_H_
+#define _RTE_RING_BCAST_H_
+
+/**
+ * @file
+ * RTE Broadcast Ring
+ *
+ * A broadcast ring has one producer and a fixed number of consumers, each
+ * of them dequeuing every element enqueued. Fanning out elements to N
+ * consumers costs one enqueue, instead of N enqueues in N rings.
+ *
+ * Each consumer has its own tail, and must be used by one thread at a
+ * time. By default, the producer waits for the slowest consumer: the ring
+ * is full when one consumer did not dequeue capacity elements. With the
+ * RTE_RING_BCAST_F_LOSSY flag, the producer never waits: it overwrites the
+ * oldest elements, which the slow consumers lose.
+ *
+ * The elements are shared by the consumers: when enqueueing mbufs, the
+ * producer takes a reference per consumer, with rte_mbuf_refcnt_update(),
+ * and each consumer frees its reference. In lossy mode, the elements lost
+ * by a consumer are not seen by it, and must not carry such a reference.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memzone.h>
+#include <rte_ring_core.h>
+
+/** Prefix of the memzones of the broadcast rings. */
+#define RTE_RING_BCAST_MZ_PREFIX "RGB_"
+/** Maximum length of a broadcast ring name. */
+#define RTE_RING_BCAST_NAMESIZE (RTE_MEMZONE_NAMESIZE - \
+	sizeof(RTE_RING_BCAST_MZ_PREFIX) + 1)
+
+/** Maximum number of consumers of a broadcast ring. */
+#define RTE_RING_BCAST_MAX_CONSUMERS 64
+
+/**
+ * The producer overwrites the elements not dequeued by all the consumers,
+ * instead of waiting for the slowest consumer.
+ */
+#define RTE_RING_BCAST_F_LOSSY 0x0001
+
+/** @internal Consumer of a broadcast ring. */
+struct rte_ring_bcast_cons {
+	volatile uint32_t tail; /**< Position of the next element to dequeue */
+	uint64_t lost;          /**< Elements overwritten before dequeue */
+} __rte_cache_aligned;
+
+/**
+ * The broadcast ring structure, followed by its consumers and elements.
+ */
+struct rte_ring_bcast {
+	char name[RTE_RING_BCAST_NAMESIZE] __rte_cache_aligned;
+	/**< Name of the ring. */
+	const struct rte_memzone *memzone;
+	/**< Memzone, if any, containing the ring. */
+	uint32_t flags;        /**< Flags supplied at creation. */
+	uint32_t esize;        /**< Size of an element, in bytes. */
+	uint32_t size;         /**< Size of the ring, in elements. */
+	uint32_t mask;         /**< Mask (size-1) of the ring. */
+	uint32_t capacity;     /**< Usable size of the ring, in elements. */
+	uint32_t nb_cons;      /**< Number of consumers. */
+	void *elems;           /**< Ring memory, after the consumers. */
+
+	/** Producer status, updated by the producer only. */
+	volatile uint32_t prod_head __rte_cache_aligned;
+	/**< Position after the last element being written. */
+	volatile uint32_t prod_tail;
+	/**< Position after the last element visible to the consumers. */
+	uint32_t cons_tail;
+	/**< Tail of the slowest consumer, as last seen by the producer. */
+
+	struct rte_ring_bcast_cons cons[] __rte_cache_aligned;
+	/**< Consumers status. */
+};
+
+/**
+ * @internal Copy n elements from/to the ring at position pos, wrapping at
+ * the end of the ring memory.
+ */
+static __rte_always_inline void
+__rte_ring_bcast_copy(const struct rte_ring_bcast *r, uint32_t pos,
+	void *obj_table, uint32_t n, int enqueue)
+{
+	const uint32_t esize = r->esize;
+	uint32_t idx = pos & r->mask;
+	uint32_t n1 = RTE_MIN(n, r->size - idx);
+	void *elem = RTE_PTR_ADD(r->elems, (size_t)idx * esize);
+
+	if (enqueue) {
+		memcpy(elem, obj_table, (size_t)n1 * esize);
+		memcpy(r->elems, RTE_PTR_ADD(obj_table, (size_t)n1 * esize),
+			(size_t)(n - n1) * esize);
+	} else {
+		memcpy(obj_table, elem, (size_t)n1 * esize);
+		memcpy(RTE_PTR_ADD(obj_table, (size_t)n1 * esize), r->elems,
+			(size_t)(n - n1) * esize);
+	}
+}
+
+/**
+ * @internal Return the free room in the ring for the producer, refreshing
+ * the tail of the slowest consumer if less than n elements are free.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_bcast_free_count(struct rte_ring_bcast *r, uint32_t head,
+	uint32_t n)
+{
+	uint32_t i, used, max_used = 0;
+	uint32_t free;
+
+	if (r->flags & RTE_RING_BCAST_F_LOSSY)
+		return r->capacity;
+
+	free = r->capacity + r->cons_tail - head;
+	if (free >= n)
+		return free;
+
+	for (i = 0; i < r->nb_cons; i++) {
+		used = head - __atomic_load_n(&r->cons[i].tail,
+			__ATOMIC_ACQUIRE);
+		max_used = RTE_MAX(max_used, used);
+	}
+	r->cons_tail = head - max_used;
+
+	return r->capacity - max_used;
+}
+
+/**
+ * @internal Enqueue several elements on a broadcast ring.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_bcast_do_enqueue(struct rte_ring_bcast *r, const void *obj_table,
+	unsigned int n, enum rte_ring_queue_behavior behavior,
+	unsigned int *free_space)
+{
+	uint32_t head = r->prod_tail;
+	uint32_t free;
+
+	free = __rte_ring_bcast_free_count(r, head, n);
+	if (n > free)
+		n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : free;
+
+	if (n != 0) {
+		if (r->flags & RTE_RING_BCAST_F_LOSSY) {
+			/* let the consumers detect the elements overwritten */
+			__atomic_store_n(&r->prod_head, head + n,
+				__ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_RELEASE);
+		}
+		__rte_ring_bcast_copy(r, head, (void *)(uintptr_t)obj_table,
+			n, 1);
+		__atomic_store_n(&r->prod_tail, head + n, __ATOMIC_RELEASE);
+	}
+
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several elements from a broadcast ring.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_bcast_do_dequeue(struct rte_ring_bcast *r, unsigned int cons_id,
+	void *obj_table, unsigned int n, enum rte_ring_queue_behavior behavior,
+	unsigned int *available)
+{
+	struct rte_ring_bcast_cons *cons = &r->cons[cons_id];
+	uint32_t tail = cons->tail;
+	uint32_t entries, first;
+	unsigned int max = n;
+
+	RTE_ASSERT(cons_id < r->nb_cons);
+
+	for (;;) {
+		/* Restore n as it may change every loop */
+		n = max;
+		entries = __atomic_load_n(&r->prod_tail, __ATOMIC_ACQUIRE) -
+			tail;
+		if (entries > r->capacity) {
+			/* overwritten elements, skip to the oldest one */
+			cons->lost += entries - r->capacity;
+			tail += entries - r->capacity;
+			entries = r->capacity;
+		}
+		if (n > entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : entries;
+		if (n == 0)
+			break;
+
+		__rte_ring_bcast_copy(r, tail, obj_table, n, 0);
+		if (!(r->flags & RTE_RING_BCAST_F_LOSSY))
+			break;
+
+		/* check that the elements were not overwritten while copied */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		first = __atomic_load_n(&r->prod_head, __ATOMIC_RELAXED) -
+			r->capacity;
+		if ((int32_t)(first - tail) <= 0)
+			break;
+		cons->lost += first - tail;
+		tail = first;
+	}
+
+	__atomic_store_n(&cons->tail, tail + n, __ATOMIC_RELEASE);
+
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create a new broadcast ring in memory.
+ *
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of the elements, in bytes. It must be a multiple of 4.
+ * @param count
+ *   The size of the ring, in elements. It must be a power of 2, the
+ *   capacity of the ring being count - 1.
+ * @param nb_cons
+ *   The number of consumers, at most RTE_RING_BCAST_MAX_CONSUMERS.
+ * @param socket_id
+ *   The socket identifier in case of NUMA. The value can be SOCKET_ID_ANY
+ *   if there is no NUMA constraint for the reserved zone.
+ * @param flags
+ *   0, or RTE_RING_BCAST_F_LOSSY.
+ * @return
+ *   The new ring, or NULL on error with rte_errno set appropriately:
+ *    - EINVAL: Invalid parameters.
+ *    - ENAMETOOLONG: The name is too long.
+ *    - EEXIST: A memzone with the same name already exists.
+ *    - ENOMEM: No appropriate memory area found.
+ */
+__rte_experimental
+struct rte_ring_bcast *
+rte_ring_bcast_create(const char *name, unsigned int esize,
+	unsigned int count, unsigned int nb_cons, int socket_id,
+	unsigned int flags);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Free a broadcast ring created by rte_ring_bcast_create().
+ *
+ * @param r
+ *   The ring to free. If NULL, the function does nothing.
+ */
+__rte_experimental
+void
+rte_ring_bcast_free(struct rte_ring_bcast *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Search a broadcast ring from its name.
+ *
+ * @param name
+ *   The name of the ring.
+ * @return
+ *   The ring, or NULL with rte_errno set to ENOENT if not found.
+ */
+__rte_experimental
+struct rte_ring_bcast *
+rte_ring_bcast_lookup(const char *name);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue a fixed number of elements on a broadcast ring, for all the
+ * consumers.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements of the size given at the ring creation.
+ * @param n
+ *   The number of elements to enqueue.
+ * @param free_space
+ *   If non-NULL, returns the room left in the ring for the slowest consumer
+ *   after the enqueue.
+ * @return
+ *   The number of elements enqueued, either 0 or n.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_bcast_enqueue_bulk(struct rte_ring_bcast *r, const void *obj_table,
+	unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_bcast_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue up to n elements on a broadcast ring, for all the consumers.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements of the size given at the ring creation.
+ * @param n
+ *   The number of elements to enqueue.
+ * @param free_space
+ *   If non-NULL, returns the room left in the ring for the slowest consumer
+ *   after the enqueue.
+ * @return
+ *   The number of elements enqueued.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_bcast_enqueue_burst(struct rte_ring_bcast *r, const void *obj_table,
+	unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_bcast_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue a fixed number of elements for one consumer of a broadcast ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param cons_id
+ *   The consumer, lower than the number of consumers of the ring.
+ * @param obj_table
+ *   A pointer to a table of elements of the size given at the ring creation.
+ * @param n
+ *   The number of elements to dequeue.
+ * @param available
+ *   If non-NULL, returns the number of elements left for the consumer after
+ *   the dequeue.
+ * @return
+ *   The number of elements dequeued, either 0 or n.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_bcast_dequeue_bulk(struct rte_ring_bcast *r, unsigned int cons_id,
+	void *obj_table, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_bcast_do_dequeue(r, cons_id, obj_table, n,
+		RTE_RING_QUEUE_FIXED, available);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue up to n elements for one consumer of a broadcast ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param cons_id
+ *   The consumer, lower than the number of consumers of the ring.
+ * @param obj_table
+ *   A pointer to a table of elements of the size given at the ring creation.
+ * @param n
+ *   The number of elements to dequeue.
+ * @param available
+ *   If non-NULL, returns the number of elements left for the consumer after
+ *   the dequeue.
+ * @return
+ *   The number of elements dequeued.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_bcast_dequeue_burst(struct rte_ring_bcast *r, unsigned int cons_id,
+	void *obj_table, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_bcast_do_dequeue(r, cons_id, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, available);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Return the number of elements lost by a consumer of a lossy broadcast
+ * ring, overwritten by the producer before being dequeued.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param cons_id
+ *   The consumer, lower than the number of consumers of the ring.
+ * @return
+ *   The number of elements lost.
+ */
+__rte_experimental
+static inline uint64_t
+rte_ring_bcast_lost(const struct rte_ring_bcast *r, unsigned int cons_id)
+{
+	return r->cons[cons_id].lost;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_BCAST_H_ */
@@ -107,6 +107,32 @@ struct rte_ring_hts_headtail {
 	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
+/** Number of buckets of the ring occupancy histogram. */
+#define RTE_RING_STATS_OCCUPANCY_BUCKETS 8
+/** The occupancy is sampled every RTE_RING_STATS_SAMPLE_PERIOD enqueues. */
+#define RTE_RING_STATS_SAMPLE_PERIOD 64
+
+/**
+ * Ring statistics, kept per lcore for the rings created with RING_F_STATS,
+ * at the end of the ring memzone.
+ */
+struct rte_ring_stats {
+	uint64_t enq_success_bulk; /**< Enqueues of at least one object. */
+	uint64_t enq_success_objs; /**< Objects enqueued. */
+	uint64_t enq_fail_bulk;    /**< Enqueues of no object. */
+	uint64_t enq_fail_objs;    /**< Objects not enqueued, ring full. */
+	uint64_t deq_success_bulk; /**< Dequeues of at least one object. */
+	uint64_t deq_success_objs; /**< Objects dequeued. */
+	uint64_t deq_fail_bulk;    /**< Dequeues of no object. */
+	uint64_t deq_fail_objs;    /**< Objects not dequeued, ring empty. */
+	uint64_t high_watermark;   /**< Highest number of objects in ring. */
+	/**
+	 * Sampled number of objects in ring after an enqueue, the bucket i
+	 * counting the samples between i and i + 1 eighths of the capacity.
+	 */
+	uint64_t occupancy[RTE_RING_STATS_OCCUPANCY_BUCKETS];
+} __rte_cache_aligned;
+
 /**
  * An RTE ring structure.
  *
@@ -131,6 +157,7 @@ struct rte_ring {
 	uint32_t size;           /**< Size of ring. */
 	uint32_t mask;           /**< Mask (size-1) of ring. */
 	uint32_t capacity;       /**< Usable size of ring */
+	uint32_t nb_waiters;     /**< Consumers sleeping in rte_ring_wait() */
 
 	char pad0 __rte_cache_aligned; /**< empty cache line */
 
@@ -174,6 +201,15 @@ struct rte_ring {
 #define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
 #define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 
+/**
+ * Ring collects per lcore statistics, see rte_ring_stats_get().
+ * The enqueue and dequeue operations of unregistered non-EAL threads and of
+ * the peek and zero copy APIs are not accounted.
+ * This flag is only supported by rte_ring_create() and
+ * rte_ring_create_elem(), which reserve the memory for the statistics.
+ */
+#define RING_F_STATS 0x0080
+
 #ifdef __cplusplus
 }
 #endif
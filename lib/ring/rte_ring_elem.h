@@ -92,6 +92,8 @@ ssize_t rte_ring_get_memsize_elem(unsigned int esize, unsigned int count);
  *        is "multi-consumer HTS mode".
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
+ *   - RING_F_STATS: If this flag is set, the ring collects per lcore
+ *     statistics, see ``rte_ring_stats_get()``.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -613,8 +615,12 @@ static __rte_always_inline unsigned int
 rte_ring_mc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
 		unsigned int esize, unsigned int n, unsigned int *available)
 {
-	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+	unsigned int nb_deq;
+
+	nb_deq = __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
 			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT, available);
+	RTE_LCORE_POLL_BUSYNESS_RING_TIMESTAMP(nb_deq);
+	return nb_deq;
 }
 
 /**
@@ -642,8 +648,12 @@ static __rte_always_inline unsigned int
 rte_ring_sc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
 		unsigned int esize, unsigned int n, unsigned int *available)
 {
-	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+	unsigned int nb_deq;
+
+	nb_deq = __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
 			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_ST, available);
+	RTE_LCORE_POLL_BUSYNESS_RING_TIMESTAMP(nb_deq);
+	return nb_deq;
 }
 
 /**
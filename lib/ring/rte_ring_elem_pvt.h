@@ -10,6 +10,79 @@
 #ifndef _RTE_RING_ELEM_PVT_H_
 #define _RTE_RING_ELEM_PVT_H_
 
+/**
+ * @internal Return the per lcore statistics of a ring created with
+ * RING_F_STATS, reserved at the end of its memzone.
+ */
+static __rte_always_inline struct rte_ring_stats *
+__rte_ring_stats(const struct rte_ring *r)
+{
+	const struct rte_memzone *mz = r->memzone;
+
+	return (struct rte_ring_stats *)RTE_PTR_ADD(mz->addr, mz->len) -
+		RTE_MAX_LCORE;
+}
+
+/**
+ * @internal Account an enqueue in the statistics of the calling lcore.
+ */
+static __rte_always_inline void
+__rte_ring_stats_enqueue(struct rte_ring *r, uint32_t req, uint32_t n,
+		uint32_t free_space)
+{
+	struct rte_ring_stats *stats;
+	unsigned int lcore_id;
+	uint32_t used;
+
+	if (likely((r->flags & RING_F_STATS) == 0))
+		return;
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	stats = &__rte_ring_stats(r)[lcore_id];
+	stats->enq_fail_objs += req - n;
+	if (n == 0) {
+		stats->enq_fail_bulk++;
+		return;
+	}
+	stats->enq_success_bulk++;
+	stats->enq_success_objs += n;
+
+	used = r->capacity - free_space;
+	if (used > stats->high_watermark)
+		stats->high_watermark = used;
+	if ((stats->enq_success_bulk & (RTE_RING_STATS_SAMPLE_PERIOD - 1)) == 0)
+		stats->occupancy[(uint64_t)used *
+			RTE_RING_STATS_OCCUPANCY_BUCKETS /
+			((uint64_t)r->capacity + 1)]++;
+}
+
+/**
+ * @internal Account a dequeue in the statistics of the calling lcore.
+ */
+static __rte_always_inline void
+__rte_ring_stats_dequeue(struct rte_ring *r, uint32_t req, uint32_t n)
+{
+	struct rte_ring_stats *stats;
+	unsigned int lcore_id;
+
+	if (likely((r->flags & RING_F_STATS) == 0))
+		return;
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	stats = &__rte_ring_stats(r)[lcore_id];
+	stats->deq_fail_objs += req - n;
+	if (n == 0) {
+		stats->deq_fail_bulk++;
+		return;
+	}
+	stats->deq_success_bulk++;
+	stats->deq_success_objs += n;
+}
+
 static __rte_always_inline void
 __rte_ring_enqueue_elems_32(struct rte_ring *r, const uint32_t size,
 		uint32_t idx, const void *obj_table, uint32_t n)
@@ -319,6 +392,7 @@ __rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
 {
 	uint32_t prod_head, prod_next;
 	uint32_t free_entries;
+	const uint32_t req = n;
 
 	n = __rte_ring_move_prod_head(r, is_sp, n, behavior,
 			&prod_head, &prod_next, &free_entries);
@@ -329,6 +403,7 @@ __rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
 
 	__rte_ring_update_tail(&r->prod, prod_head, prod_next, is_sp, 1);
 end:
+	__rte_ring_stats_enqueue(r, req, n, free_entries - n);
 	if (free_space != NULL)
 		*free_space = free_entries - n;
 	return n;
@@ -366,6 +441,7 @@ __rte_ring_do_dequeue_elem(struct rte_ring *r, void *obj_table,
 {
 	uint32_t cons_head, cons_next;
 	uint32_t entries;
+	const uint32_t req = n;
 
 	n = __rte_ring_move_cons_head(r, (int)is_sc, n, behavior,
 			&cons_head, &cons_next, &entries);
@@ -377,6 +453,7 @@ __rte_ring_do_dequeue_elem(struct rte_ring *r, void *obj_table,
 	__rte_ring_update_tail(&r->cons, cons_head, cons_next, is_sc, 0);
 
 end:
+	__rte_ring_stats_dequeue(r, req, n);
 	if (available != NULL)
 		*available = entries - n;
 	return n;
@@ -189,6 +189,7 @@ __rte_ring_do_hts_enqueue_elem(struct rte_ring *r, const void *obj_table,
 	uint32_t *free_space)
 {
 	uint32_t free, head;
+	const uint32_t req = n;
 
 	n =  __rte_ring_hts_move_prod_head(r, n, behavior, &head, &free);
 
@@ -197,6 +198,7 @@ __rte_ring_do_hts_enqueue_elem(struct rte_ring *r, const void *obj_table,
 		__rte_ring_hts_update_tail(&r->hts_prod, head, n, 1);
 	}
 
+	__rte_ring_stats_enqueue(r, req, n, free - n);
 	if (free_space != NULL)
 		*free_space = free - n;
 	return n;
@@ -230,6 +232,7 @@ __rte_ring_do_hts_dequeue_elem(struct rte_ring *r, void *obj_table,
 	uint32_t *available)
 {
 	uint32_t entries, head;
+	const uint32_t req = n;
 
 	n = __rte_ring_hts_move_cons_head(r, n, behavior, &head, &entries);
 
@@ -238,6 +241,7 @@ __rte_ring_do_hts_dequeue_elem(struct rte_ring *r, void *obj_table,
 		__rte_ring_hts_update_tail(&r->hts_cons, head, n, 0);
 	}
 
+	__rte_ring_stats_dequeue(r, req, n);
 	if (available != NULL)
 		*available = entries - n;
 	return n;
@@ -0,0 +1,528 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2021 Marvell International Ltd.
+ */
+
+#ifndef _RTE_RING_MSG_H_
+#define _RTE_RING_MSG_H_
+
+/**
+ * @file
+ * RTE Ring Message API
+ *
+ * Pass variable length messages through a ring of 8-byte elements,
+ * without a pointer ring and a separate allocation per message.
+ *
+ * Each message is stored as a record made of one header element followed
+ * by the message, padded to a multiple of 8 bytes. A record is always
+ * contiguous in the ring memory: when it does not fit before the end of
+ * the ring, a padding record fills the end of the ring and the record
+ * starts at its beginning. Hence messages are 8-byte aligned, and can be
+ * accessed in place with the zero copy functions:
+ * - rte_ring_msg_enqueue_reserve() / rte_ring_msg_enqueue_commit(),
+ * - rte_ring_msg_dequeue_peek() / rte_ring_msg_dequeue_release().
+ *
+ * The ring must be created with rte_ring_create_elem() or
+ * rte_ring_init_elem() and an element size of RTE_RING_MSG_ALIGN. All the
+ * sync modes are supported for the producers and the consumers: SP/SC,
+ * MP/MC, MP_RTS/MC_RTS and MP_HTS/MC_HTS.
+ *
+ * A message is at most about half of the ring size, see
+ * rte_ring_msg_enqueue_reserve(). rte_ring_count() and rte_ring_free_count()
+ * return a number of elements, not of messages.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include <rte_ring_elem.h>
+
+/** Size of the ring elements, and alignment of the messages in the ring. */
+#define RTE_RING_MSG_ALIGN 8
+
+/**
+ * Zero copy information about a message in the ring.
+ */
+struct rte_ring_msg_zc {
+	void *msg;          /**< Message in the ring memory */
+	uint32_t len;       /**< Length of the message in bytes */
+	uint32_t head;      /**< Internal: position of the record */
+	uint32_t nb_elems;  /**< Internal: elements of the record and padding */
+};
+
+/** @internal Record header. */
+struct __rte_ring_msg_hdr {
+	uint32_t len;       /**< Length of the message */
+	uint32_t nb_elems;  /**< Elements of the record, header included */
+};
+
+/** @internal Length of a padding record, filling the end of the ring. */
+#define __RTE_RING_MSG_PAD UINT32_MAX
+
+/**
+ * @internal Return the number of elements to reserve at head for a record
+ * of nb_elems, including the padding up to the end of the ring, if any.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_msg_prod_elems(const struct rte_ring *r, uint32_t head,
+	uint32_t nb_elems)
+{
+	uint32_t end = r->size - (head & r->mask);
+
+	return nb_elems <= end ? nb_elems : end + nb_elems;
+}
+
+/**
+ * @internal Move the producer head of n elements for a record of nb_elems,
+ * n depending on the position of the head.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_msg_move_prod_head(struct rte_ring *r, uint32_t nb_elems,
+	uint32_t *old_head)
+{
+	const uint32_t capacity = r->capacity;
+	union __rte_ring_rts_poscnt orts, nrts;
+	union __rte_ring_hts_pos ohts, nhts;
+	uint32_t head, free, n;
+
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT:
+		head = __atomic_load_n(&r->prod.head, __ATOMIC_RELAXED);
+		do {
+			/* Ensure the head is read before tail */
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			free = capacity - head +
+				__atomic_load_n(&r->cons.tail, __ATOMIC_ACQUIRE);
+			n = __rte_ring_msg_prod_elems(r, head, nb_elems);
+			if (n > free)
+				return 0;
+			if (r->prod.sync_type == RTE_RING_SYNC_ST) {
+				r->prod.head = head + n;
+				break;
+			}
+		} while (__atomic_compare_exchange_n(&r->prod.head, &head,
+				head + n, 0, __ATOMIC_RELAXED,
+				__ATOMIC_RELAXED) == 0);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		ohts.raw = __atomic_load_n(&r->hts_prod.ht.raw,
+			__ATOMIC_ACQUIRE);
+		do {
+			__rte_ring_hts_head_wait(&r->hts_prod, &ohts);
+			free = capacity - ohts.pos.head +
+				__atomic_load_n(&r->cons.tail, __ATOMIC_ACQUIRE);
+			n = __rte_ring_msg_prod_elems(r, ohts.pos.head,
+				nb_elems);
+			if (n > free)
+				return 0;
+			nhts.pos.tail = ohts.pos.tail;
+			nhts.pos.head = ohts.pos.head + n;
+		} while (__atomic_compare_exchange_n(&r->hts_prod.ht.raw,
+				&ohts.raw, nhts.raw, 0, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE) == 0);
+		head = ohts.pos.head;
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		orts.raw = __atomic_load_n(&r->rts_prod.head.raw,
+			__ATOMIC_ACQUIRE);
+		do {
+			__rte_ring_rts_head_wait(&r->rts_prod, &orts);
+			free = capacity - orts.val.pos +
+				__atomic_load_n(&r->cons.tail, __ATOMIC_ACQUIRE);
+			n = __rte_ring_msg_prod_elems(r, orts.val.pos,
+				nb_elems);
+			if (n > free)
+				return 0;
+			nrts.val.pos = orts.val.pos + n;
+			nrts.val.cnt = orts.val.cnt + 1;
+		} while (__atomic_compare_exchange_n(&r->rts_prod.head.raw,
+				&orts.raw, nrts.raw, 0, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE) == 0);
+		head = orts.val.pos;
+		break;
+	default:
+		/* valid ring should never reach this point */
+		RTE_ASSERT(0);
+		return 0;
+	}
+
+	*old_head = head;
+	return n;
+}
+
+/**
+ * @internal Return the number of elements to dequeue at head for the next
+ * record, including the padding before it, if any. The index of the record
+ * is returned in idx.
+ * The elements read may be overwritten if head is not current anymore,
+ * the caller checks it before using the result.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_msg_cons_elems(const struct rte_ring *r, uint32_t head,
+	uint32_t *idx)
+{
+	const uint64_t *ring = (const uint64_t *)&r[1];
+	const struct __rte_ring_msg_hdr *hdr;
+	uint32_t n = 0;
+
+	*idx = head & r->mask;
+	hdr = (const struct __rte_ring_msg_hdr *)&ring[*idx];
+	if (hdr->len == __RTE_RING_MSG_PAD) {
+		n = hdr->nb_elems;
+		*idx = 0;
+		hdr = (const struct __rte_ring_msg_hdr *)&ring[0];
+	}
+
+	return n + hdr->nb_elems;
+}
+
+/**
+ * @internal Move the consumer head over the next record, its number of
+ * elements being read at the head of the ring.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_msg_move_cons_head(struct rte_ring *r, uint32_t *old_head,
+	uint32_t *idx)
+{
+	union __rte_ring_rts_poscnt orts, nrts;
+	union __rte_ring_hts_pos ohts, nhts;
+	uint32_t head, entries, n;
+
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT:
+		head = __atomic_load_n(&r->cons.head, __ATOMIC_RELAXED);
+		for (;;) {
+			/* Ensure the head is read before tail */
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			entries = __atomic_load_n(&r->prod.tail,
+				__ATOMIC_ACQUIRE) - head;
+			if (entries == 0)
+				return 0;
+			n = __rte_ring_msg_cons_elems(r, head, idx);
+			if (r->cons.sync_type == RTE_RING_SYNC_ST) {
+				r->cons.head = head + n;
+				break;
+			}
+			/* on failure, head is updated */
+			if (n <= entries && __atomic_compare_exchange_n(
+					&r->cons.head, &head, head + n, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+			/* the record read was overwritten, head is stale */
+			if (n > entries)
+				head = __atomic_load_n(&r->cons.head,
+					__ATOMIC_RELAXED);
+		}
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		ohts.raw = __atomic_load_n(&r->hts_cons.ht.raw,
+			__ATOMIC_ACQUIRE);
+		do {
+			__rte_ring_hts_head_wait(&r->hts_cons, &ohts);
+			entries = __atomic_load_n(&r->prod.tail,
+				__ATOMIC_ACQUIRE) - ohts.pos.head;
+			if (entries == 0)
+				return 0;
+			n = __rte_ring_msg_cons_elems(r, ohts.pos.head, idx);
+			/* the record read was overwritten, head is stale */
+			if (n > entries)
+				ohts.raw = __atomic_load_n(&r->hts_cons.ht.raw,
+					__ATOMIC_ACQUIRE);
+			nhts.pos.tail = ohts.pos.tail;
+			nhts.pos.head = ohts.pos.head + n;
+		} while (n > entries ||
+			__atomic_compare_exchange_n(&r->hts_cons.ht.raw,
+				&ohts.raw, nhts.raw, 0, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE) == 0);
+		head = ohts.pos.head;
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		orts.raw = __atomic_load_n(&r->rts_cons.head.raw,
+			__ATOMIC_ACQUIRE);
+		do {
+			__rte_ring_rts_head_wait(&r->rts_cons, &orts);
+			entries = __atomic_load_n(&r->prod.tail,
+				__ATOMIC_ACQUIRE) - orts.val.pos;
+			if (entries == 0)
+				return 0;
+			n = __rte_ring_msg_cons_elems(r, orts.val.pos, idx);
+			/* the record read was overwritten, head is stale */
+			if (n > entries)
+				orts.raw = __atomic_load_n(&r->rts_cons.head.raw,
+					__ATOMIC_ACQUIRE);
+			nrts.val.pos = orts.val.pos + n;
+			nrts.val.cnt = orts.val.cnt + 1;
+		} while (n > entries ||
+			__atomic_compare_exchange_n(&r->rts_cons.head.raw,
+				&orts.raw, nrts.raw, 0, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE) == 0);
+		head = orts.val.pos;
+		break;
+	default:
+		/* valid ring should never reach this point */
+		RTE_ASSERT(0);
+		return 0;
+	}
+
+	*old_head = head;
+	return n;
+}
+
+/**
+ * @internal Update the producer or consumer tail after a record is
+ * written or read.
+ */
+static __rte_always_inline void
+__rte_ring_msg_update_tail(struct rte_ring *r, uint32_t head, uint32_t n,
+	uint32_t enqueue)
+{
+	enum rte_ring_sync_type st;
+
+	st = enqueue ? r->prod.sync_type : r->cons.sync_type;
+	switch (st) {
+	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT:
+		__rte_ring_update_tail(enqueue ? &r->prod : &r->cons, head,
+			head + n, st == RTE_RING_SYNC_ST, enqueue);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		__rte_ring_hts_update_tail(enqueue ? &r->hts_prod :
+			&r->hts_cons, head, n, enqueue);
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		__rte_ring_rts_update_tail(enqueue ? &r->rts_prod :
+			&r->rts_cons);
+		break;
+	default:
+		/* valid ring should never reach this point */
+		RTE_ASSERT(0);
+	}
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reserve room in the ring for a message, to be written in place.
+ *
+ * The message is written at zc->msg, 8-byte aligned, then made visible to
+ * the consumers by rte_ring_msg_enqueue_commit(). Until then, the other
+ * producers of a MP or MP_RTS ring can reserve room but their messages
+ * are not visible either, and the producers of a MP_HTS ring wait.
+ *
+ * @param r
+ *   A pointer to the ring structure, with elements of RTE_RING_MSG_ALIGN
+ *   bytes.
+ * @param len
+ *   The length of the message in bytes. With the 8-byte header, it must
+ *   not use more than half of the ring elements, rounded up.
+ * @param zc
+ *   A pointer to the zero copy information filled on success.
+ * @return
+ *   - 0: Success, the message can be written at zc->msg.
+ *   - -EINVAL: The message is too long for the ring.
+ *   - -ENOBUFS: Not enough room in the ring.
+ */
+__rte_experimental
+static __rte_always_inline int
+rte_ring_msg_enqueue_reserve(struct rte_ring *r, uint32_t len,
+	struct rte_ring_msg_zc *zc)
+{
+	uint64_t *ring = (uint64_t *)&r[1];
+	struct __rte_ring_msg_hdr *hdr;
+	uint32_t nb_elems, head, idx, n;
+
+	/* a record and a padding shorter than it fit in an empty ring */
+	if (unlikely((uint64_t)len > ((uint64_t)(r->capacity + 1) / 2 - 1) *
+			RTE_RING_MSG_ALIGN))
+		return -EINVAL;
+	nb_elems = 1 + len / RTE_RING_MSG_ALIGN +
+		(len % RTE_RING_MSG_ALIGN != 0);
+
+	n = __rte_ring_msg_move_prod_head(r, nb_elems, &head);
+	if (n == 0)
+		return -ENOBUFS;
+
+	idx = head & r->mask;
+	if (n != nb_elems) {
+		hdr = (struct __rte_ring_msg_hdr *)&ring[idx];
+		hdr->len = __RTE_RING_MSG_PAD;
+		hdr->nb_elems = n - nb_elems;
+		idx = 0;
+	}
+	hdr = (struct __rte_ring_msg_hdr *)&ring[idx];
+	hdr->len = len;
+	hdr->nb_elems = nb_elems;
+
+	zc->msg = &ring[idx + 1];
+	zc->len = len;
+	zc->head = head;
+	zc->nb_elems = n;
+
+	return 0;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete the enqueue of a message reserved by
+ * rte_ring_msg_enqueue_reserve().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zc
+ *   The zero copy information returned by rte_ring_msg_enqueue_reserve().
+ *   zc->len may be lowered, if the message is shorter than reserved.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_ring_msg_enqueue_commit(struct rte_ring *r,
+	const struct rte_ring_msg_zc *zc)
+{
+	struct __rte_ring_msg_hdr *hdr;
+
+	hdr = RTE_PTR_SUB(zc->msg, sizeof(*hdr));
+	RTE_ASSERT(zc->len <= hdr->len);
+	hdr->len = zc->len;
+
+	__rte_ring_msg_update_tail(r, zc->head, zc->nb_elems, 1);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the next message of the ring, to be read in place.
+ *
+ * The message is read at zc->msg, then its room is given back to the
+ * producers by rte_ring_msg_dequeue_release().
+ *
+ * @param r
+ *   A pointer to the ring structure, with elements of RTE_RING_MSG_ALIGN
+ *   bytes.
+ * @param zc
+ *   A pointer to the zero copy information filled on success.
+ * @return
+ *   - 0: Success, the message can be read at zc->msg.
+ *   - -ENOENT: The ring is empty.
+ */
+__rte_experimental
+static __rte_always_inline int
+rte_ring_msg_dequeue_peek(struct rte_ring *r, struct rte_ring_msg_zc *zc)
+{
+	uint64_t *ring = (uint64_t *)&r[1];
+	const struct __rte_ring_msg_hdr *hdr;
+	uint32_t head, idx, n;
+
+	n = __rte_ring_msg_move_cons_head(r, &head, &idx);
+	if (n == 0)
+		return -ENOENT;
+
+	hdr = (const struct __rte_ring_msg_hdr *)&ring[idx];
+	zc->msg = &ring[idx + 1];
+	zc->len = hdr->len;
+	zc->head = head;
+	zc->nb_elems = n;
+
+	return 0;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete the dequeue of a message returned by rte_ring_msg_dequeue_peek().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zc
+ *   The zero copy information returned by rte_ring_msg_dequeue_peek().
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_ring_msg_dequeue_release(struct rte_ring *r,
+	const struct rte_ring_msg_zc *zc)
+{
+	__rte_ring_msg_update_tail(r, zc->head, zc->nb_elems, 0);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue a message on the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure, with elements of RTE_RING_MSG_ALIGN
+ *   bytes.
+ * @param msg
+ *   A pointer to the message.
+ * @param len
+ *   The length of the message in bytes.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The message is too long for the ring.
+ *   - -ENOBUFS: Not enough room in the ring.
+ */
+__rte_experimental
+static __rte_always_inline int
+rte_ring_msg_enqueue(struct rte_ring *r, const void *msg, uint32_t len)
+{
+	struct rte_ring_msg_zc zc;
+	int ret;
+
+	ret = rte_ring_msg_enqueue_reserve(r, len, &zc);
+	if (ret != 0)
+		return ret;
+
+	memcpy(zc.msg, msg, len);
+	rte_ring_msg_enqueue_commit(r, &zc);
+
+	return 0;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue a message from the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure, with elements of RTE_RING_MSG_ALIGN
+ *   bytes.
+ * @param buf
+ *   A pointer to the buffer receiving the message.
+ * @param size
+ *   The size of the buffer. A longer message is truncated.
+ * @return
+ *   - The length of the message on success, which may be greater than
+ *     size.
+ *   - -ENOENT: The ring is empty.
+ */
+__rte_experimental
+static __rte_always_inline int
+rte_ring_msg_dequeue(struct rte_ring *r, void *buf, uint32_t size)
+{
+	struct rte_ring_msg_zc zc;
+	int ret;
+
+	ret = rte_ring_msg_dequeue_peek(r, &zc);
+	if (ret != 0)
+		return ret;
+
+	memcpy(buf, zc.msg, RTE_MIN(zc.len, size));
+	rte_ring_msg_dequeue_release(r, &zc);
+
+	return zc.len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_MSG_H_ */
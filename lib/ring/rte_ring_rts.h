@@ -163,8 +163,12 @@ static __rte_always_inline unsigned int
 rte_ring_mc_rts_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
 	unsigned int esize, unsigned int n, unsigned int *available)
 {
-	return __rte_ring_do_rts_dequeue_elem(r, obj_table, esize, n,
+	unsigned int nb_deq;
+
+	nb_deq = __rte_ring_do_rts_dequeue_elem(r, obj_table, esize, n,
 			RTE_RING_QUEUE_VARIABLE, available);
+	RTE_LCORE_POLL_BUSYNESS_RING_TIMESTAMP(nb_deq);
+	return nb_deq;
 }
 
 /**
@@ -204,6 +204,7 @@ __rte_ring_do_rts_enqueue_elem(struct rte_ring *r, const void *obj_table,
 	uint32_t *free_space)
 {
 	uint32_t free, head;
+	const uint32_t req = n;
 
 	n =  __rte_ring_rts_move_prod_head(r, n, behavior, &head, &free);
 
@@ -212,6 +213,7 @@ __rte_ring_do_rts_enqueue_elem(struct rte_ring *r, const void *obj_table,
 		__rte_ring_rts_update_tail(&r->rts_prod);
 	}
 
+	__rte_ring_stats_enqueue(r, req, n, free - n);
 	if (free_space != NULL)
 		*free_space = free - n;
 	return n;
@@ -245,6 +247,7 @@ __rte_ring_do_rts_dequeue_elem(struct rte_ring *r, void *obj_table,
 	uint32_t *available)
 {
 	uint32_t entries, head;
+	const uint32_t req = n;
 
 	n = __rte_ring_rts_move_cons_head(r, n, behavior, &head, &entries);
 
@@ -253,6 +256,7 @@ __rte_ring_do_rts_dequeue_elem(struct rte_ring *r, void *obj_table,
 		__rte_ring_rts_update_tail(&r->rts_cons);
 	}
 
+	__rte_ring_stats_dequeue(r, req, n);
 	if (available != NULL)
 		*available = entries - n;
 	return n;